@@ -29,7 +29,7 @@ namespace OC
     // There is no implementation in this file since the mock directly links the client and server
     // apps.
     InProcServerWrapper::InProcServerWrapper(
-            std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
+            std::weak_ptr<CsdkLock> csdkLock, PlatformConfig cfg)
          : m_threadRun(false), m_csdkLock(csdkLock),
            m_cfg { cfg }
     {
@@ -59,7 +59,7 @@ using namespace OC;
     OCPlatform_impl::OCPlatform_impl(const PlatformConfig& config) :
         m_cfg             { config },
         m_WrapperInstance { make_unique<WrapperFactory>() },
-        m_csdkLock        { std::make_shared<std::recursive_mutex>() }
+        m_csdkLock        { std::make_shared<CsdkLock>() }
     {
     }
 
@@ -714,6 +714,29 @@ typedef void (*CAErrorCallback)(const CAEndpoint_t *object,
  */
 typedef void (*CANetworkMonitorCallback)(const CAEndpoint_t *info, CANetworkStatus_t status);
 
+/**
+ * Callback function type called when received data is queued for
+ * CAHandleRequestResponse(). It runs on the thread that received the data,
+ * so it should only wake the thread calling CAHandleRequestResponse().
+ */
+typedef void (*CAReceiveQueueCallback)();
+
+/**
+ * Callback function type for the blocks of a received block-wise payload.
+ * @param[out]   object       Endpoint object from which the payload is received.
+ * @param[out]   info         Received message. Its payload is the current block.
+ * @param[out]   offset       Offset of the block in the whole payload. A transfer
+ *                            that is restarted after a lost block starts at 0 again.
+ * @param[out]   totalLength  Length of the whole payload taken from the Size1 or
+ *                            Size2 option, or 0 if the sender did not announce it.
+ * @param[out]   isLast       Whether the block is the last one of the payload.
+ * @return true to consume the payload block by block. The value returned for the
+ *         first block decides for the whole payload: if it is true, blocks are not
+ *         reassembled and the request or response is delivered without payload.
+ */
+typedef bool (*CABlockPayloadCallback)(const CAEndpoint_t *object, const CAInfo_t *info,
+                                       size_t offset, size_t totalLength, bool isLast);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
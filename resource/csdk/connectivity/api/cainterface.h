@@ -132,6 +132,14 @@ CAResult_t CAStartDiscoveryServer();
 void CARegisterHandler(CARequestCallback ReqHandler, CAResponseCallback RespHandler,
                        CAErrorCallback ErrorHandler);
 
+/**
+ * Register a callback called whenever received data is queued, so the
+ * thread calling CAHandleRequestResponse() does not have to poll for it.
+ * @param[in]   receiveQueueHandler   Receive queue callback, or NULL.
+ * @see     CAReceiveQueueCallback
+ */
+void CARegisterReceiveQueueHandler(CAReceiveQueueCallback receiveQueueHandler);
+
 /**
  * Create an endpoint description.
  * @param[in]   flags                 how the adapter should be used.
@@ -262,6 +270,16 @@ CAResult_t CASetProxyUri(const char *uri);
 CAResult_t CAGetLinkLocalZoneId(uint32_t ifindex, char **zoneId);
 #endif
 
+#ifdef WITH_BWT
+/**
+ * Register a callback that sees each block of received block-wise payloads
+ * before it is reassembled.
+ * @param[in]   blockPayloadHandler   Block payload callback, or NULL to
+ *                                    reassemble all payloads.
+ */
+void CARegisterBlockPayloadHandler(CABlockPayloadCallback blockPayloadHandler);
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
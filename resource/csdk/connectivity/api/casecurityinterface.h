@@ -269,6 +269,16 @@ CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint);
  */
 void CAcloseSslConnectionAll(CATransportAdapter_t transportType);
 
+/**
+ * Drop all sessions kept for TLS session resumption: the sessions saved by
+ * the client side, the session ID cache of the server side and the session
+ * ticket keys. Has to be called when credentials, the CRL or the ownership
+ * state change, so that a resumed handshake cannot skip the new checks.
+ * Established sessions are not closed. Can be called from the handshake
+ * callback.
+ */
+void CAsslClearSessionCache();
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
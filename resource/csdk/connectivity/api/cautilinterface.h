@@ -133,6 +133,21 @@ CAResult_t CASetPortNumberToAssign(CATransportAdapter_t adapter,
  */
 uint16_t CAGetAssignedPortNumber(CATransportAdapter_t adapter, CATransportFlags_t flag);
 
+/**
+ * Set the number of received messages that can wait for the application.
+ * When the queue is full new messages are refused and unicast requests are
+ * answered with 5.03. Takes effect at the next CAInitialize.
+ * @param[in]   capacity    receive queue capacity, 0 restores the default.
+ */
+void CAUtilSetReceiveQueueCapacity(uint32_t capacity);
+
+/**
+ * Get the number of received messages refused because the receive queue was full.
+ *
+ * @return  refused message count since CAInitialize.
+ */
+uint32_t CAUtilGetReceiveQueueOverflowCount();
+
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
 /**
  * Initializes the Connection Manager
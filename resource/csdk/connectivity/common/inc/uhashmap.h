@@ -0,0 +1,142 @@
+/* ****************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#ifndef U_HASHMAP_H_
+#define U_HASHMAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * hash map node structure. Defined in uhashmap.c.
+ */
+typedef struct u_hashmap_node_t u_hashmap_node_t;
+
+/**
+ * hash map structure.
+ *
+ * @note
+ * Members should be treated as private and not accessed directly. Instead
+ * all access should be through the defined u_hashmap_*() functions.
+ */
+typedef struct u_hashmap_t
+{
+    u_hashmap_node_t **buckets;
+    size_t bucketCount;
+    size_t length;
+} u_hashmap_t;
+
+/**
+ * hash map iterator structure.
+ *
+ * Initialize with ::u_hashmap_iterator_init and advance with ::u_hashmap_next.
+ * The only modification allowed while iterating is removing the entry that
+ * was returned last.
+ */
+typedef struct u_hashmap_iterator_t
+{
+    const u_hashmap_t *map;
+    size_t bucket;
+    u_hashmap_node_t *nextNode;
+} u_hashmap_iterator_t;
+
+/**
+ * API to create hash map.
+ * @param[in] capacity   number of entries expected. The map grows on demand,
+ *                       so 0 selects a small default.
+ * @return  u_hashmap_t if Success, NULL otherwise.
+ */
+u_hashmap_t *u_hashmap_create(size_t capacity);
+
+/**
+ * Resets and deletes the hash map.
+ * Stored data pointers are not freed. Calling function must take care of
+ * freeing dynamic memory referenced by the map before freeing it.
+ * @param[in] map        u_hashmap pointer
+ */
+void u_hashmap_free(u_hashmap_t **map);
+
+/**
+ * Add data to the hash map. Data already stored with an equal key is replaced.
+ * @param[in] map         pointer of hash map.
+ * @param[in] key         pointer of key bytes.
+ * @param[in] keyLength   length of key in bytes.
+ * @param[in] data        pointer of data.
+ * @return true if success, false otherwise.
+ */
+bool u_hashmap_put(u_hashmap_t *map, const void *key, size_t keyLength, void *data);
+
+/**
+ * Returns the data stored with the key.
+ * @param[in] map         pointer of hash map.
+ * @param[in] key         pointer of key bytes.
+ * @param[in] keyLength   length of key in bytes.
+ * @return void pointer of data if found or NULL pointer otherwise.
+ */
+void *u_hashmap_get(const u_hashmap_t *map, const void *key, size_t keyLength);
+
+/**
+ * Remove the data stored with the key.
+ * @param[in] map         pointer of hash map.
+ * @param[in] key         pointer of key bytes.
+ * @param[in] keyLength   length of key in bytes.
+ * @return void pointer of the removed data if found or NULL pointer otherwise.
+ */
+void *u_hashmap_remove(u_hashmap_t *map, const void *key, size_t keyLength);
+
+/**
+ * Returns the number of entries in the hash map.
+ * @param[in] map        pointer of hash map.
+ * @return number of entries.
+ */
+size_t u_hashmap_length(const u_hashmap_t *map);
+
+/**
+ * Prepare an iterator over all entries of the hash map.
+ * @param[in] map        pointer of hash map.
+ * @param[out] iterator  iterator to initialize.
+ */
+void u_hashmap_iterator_init(const u_hashmap_t *map, u_hashmap_iterator_t *iterator);
+
+/**
+ * Advance the iterator to the next entry. Entries are returned in no
+ * particular order.
+ * @param[in,out] iterator  iterator prepared by ::u_hashmap_iterator_init.
+ * @param[out] data         data of the next entry.
+ * @return true if an entry was returned, false at the end of the map.
+ */
+bool u_hashmap_next(u_hashmap_iterator_t *iterator, void **data);
+
+/**
+ * Hash function used by the map (32-bit FNV-1a). Exposed so that users can
+ * derive stable bucket or shard numbers from the same keys.
+ * @param[in] key         pointer of key bytes.
+ * @param[in] keyLength   length of key in bytes.
+ * @return hash value.
+ */
+uint32_t u_hashmap_hash(const void *key, size_t keyLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* U_HASHMAP_H_ */
@@ -65,6 +65,8 @@ typedef struct u_queue_t
 {
     /** Head of the queue. */
     u_queue_element *element;
+    /** Tail of the queue. */
+    u_queue_element *tail;
     /** Number of messages in Queue. */
     uint32_t count;
 } u_queue_t;
@@ -0,0 +1,117 @@
+/* ****************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the APIs for a bounded lock-free ring buffer of queue
+ * messages. Any number of threads may push and pop concurrently; the
+ * queueing thread uses it with many producers and a single consumer.
+ */
+
+#ifndef U_RINGBUFFER_H_
+#define U_RINGBUFFER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "uqueue.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/**
+ * ring buffer slot structure. Defined in uringbuffer.c.
+ */
+typedef struct u_ringbuffer_slot_t u_ringbuffer_slot_t;
+
+/**
+ * ring buffer structure.
+ *
+ * @note
+ * Members should be treated as private and not accessed directly. Instead
+ * all access should be through the defined u_ringbuffer_*() functions.
+ */
+typedef struct u_ringbuffer_t
+{
+    /** Preallocated slots. */
+    u_ringbuffer_slot_t *slots;
+    /** Number of slots, a power of two. */
+    uint32_t capacity;
+    /** Position of the next push. */
+    volatile int32_t tail;
+    /** Position of the next pop. */
+    volatile int32_t head;
+} u_ringbuffer_t;
+
+/**
+ * API to create ring buffer.
+ * @param[in] capacity   number of messages the ring buffer can hold. Rounded
+ *                       up to a power of two.
+ * @return  u_ringbuffer_t if Success, NULL otherwise.
+ */
+u_ringbuffer_t *u_ringbuffer_create(uint32_t capacity);
+
+/**
+ * Deletes the ring buffer.
+ * Messages still in the ring buffer are not freed. Calling function must pop
+ * and free them before deleting the ring buffer.
+ * @param[in] ringBuffer  pointer of ring buffer.
+ */
+void u_ringbuffer_delete(u_ringbuffer_t *ringBuffer);
+
+/**
+ * Adds message at the end of the ring buffer without blocking.
+ * @param[in] ringBuffer  pointer of ring buffer.
+ * @param[in] message     message to copy into the ring buffer.
+ * @return true if success, false if the ring buffer is full.
+ */
+bool u_ringbuffer_push(u_ringbuffer_t *ringBuffer, const u_queue_message_t *message);
+
+/**
+ * Removes the first message of the ring buffer without blocking.
+ * @param[in]  ringBuffer  pointer of ring buffer.
+ * @param[out] message     first message.
+ * @return true if a message was removed, false if the ring buffer is empty.
+ */
+bool u_ringbuffer_pop(u_ringbuffer_t *ringBuffer, u_queue_message_t *message);
+
+/**
+ * Removes up to count messages from the front of the ring buffer.
+ * @param[in]  ringBuffer  pointer of ring buffer.
+ * @param[out] messages    array receiving the messages.
+ * @param[in]  count       size of the messages array.
+ * @return number of messages removed.
+ */
+uint32_t u_ringbuffer_pop_batch(u_ringbuffer_t *ringBuffer, u_queue_message_t *messages,
+                                uint32_t count);
+
+/**
+ * Returns the number of messages in the ring buffer. The value is a snapshot
+ * and may be stale as soon as it is returned.
+ * @param[in] ringBuffer  pointer of ring buffer.
+ * @return number of messages.
+ */
+uint32_t u_ringbuffer_get_size(u_ringbuffer_t *ringBuffer);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* U_RINGBUFFER_H_ */
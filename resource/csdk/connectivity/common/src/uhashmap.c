@@ -0,0 +1,286 @@
+/******************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "uhashmap.h"
+#include "logger.h"
+#include "oic_malloc.h"
+
+#define TAG "OIC_UHASHMAP"
+
+/**
+ * Use this default bucket count when no capacity is requested.
+ * Must be a power of two.
+ */
+#define U_HASHMAP_DEFAULT_BUCKETS 16
+
+/**
+ * FNV-1a parameters.
+ */
+#define U_HASHMAP_FNV_OFFSET_BASIS 2166136261U
+#define U_HASHMAP_FNV_PRIME 16777619U
+
+struct u_hashmap_node_t
+{
+    struct u_hashmap_node_t *next;
+    uint32_t hash;
+    size_t keyLength;
+    void *data;
+    uint8_t key[];
+};
+
+uint32_t u_hashmap_hash(const void *key, size_t keyLength)
+{
+    const uint8_t *bytes = (const uint8_t *) key;
+    uint32_t hash = U_HASHMAP_FNV_OFFSET_BASIS;
+
+    for (size_t i = 0; i < keyLength; i++)
+    {
+        hash ^= bytes[i];
+        hash *= U_HASHMAP_FNV_PRIME;
+    }
+    return hash;
+}
+
+static size_t u_hashmap_bucket_count_for(size_t capacity)
+{
+    size_t count = U_HASHMAP_DEFAULT_BUCKETS;
+
+    // Keep the load factor at or below 3/4 for the requested capacity.
+    while ((count * 3) / 4 < capacity)
+    {
+        count *= 2;
+    }
+    return count;
+}
+
+static u_hashmap_node_t **u_hashmap_find_slot(const u_hashmap_t *map, uint32_t hash,
+                                              const void *key, size_t keyLength)
+{
+    u_hashmap_node_t **slot = &map->buckets[hash & (map->bucketCount - 1)];
+
+    while (*slot)
+    {
+        if (((*slot)->hash == hash) && ((*slot)->keyLength == keyLength)
+            && (memcmp((*slot)->key, key, keyLength) == 0))
+        {
+            break;
+        }
+        slot = &(*slot)->next;
+    }
+    return slot;
+}
+
+static void u_hashmap_grow(u_hashmap_t *map)
+{
+    size_t newCount = map->bucketCount * 2;
+    u_hashmap_node_t **newBuckets =
+        (u_hashmap_node_t **) OICCalloc(newCount, sizeof(u_hashmap_node_t *));
+    if (!newBuckets)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory, keeping current bucket count");
+        // Considered non-fatal, lookups just get longer chains.
+        return;
+    }
+
+    for (size_t i = 0; i < map->bucketCount; i++)
+    {
+        u_hashmap_node_t *node = map->buckets[i];
+        while (node)
+        {
+            u_hashmap_node_t *next = node->next;
+            size_t index = node->hash & (newCount - 1);
+            node->next = newBuckets[index];
+            newBuckets[index] = node;
+            node = next;
+        }
+    }
+
+    OICFree(map->buckets);
+    map->buckets = newBuckets;
+    map->bucketCount = newCount;
+}
+
+u_hashmap_t *u_hashmap_create(size_t capacity)
+{
+    u_hashmap_t *map = (u_hashmap_t *) OICCalloc(1, sizeof(u_hashmap_t));
+    if (!map)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        return NULL;
+    }
+
+    map->bucketCount = u_hashmap_bucket_count_for(capacity);
+    map->buckets = (u_hashmap_node_t **) OICCalloc(map->bucketCount,
+                                                    sizeof(u_hashmap_node_t *));
+    if (!map->buckets)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        OICFree(map);
+        return NULL;
+    }
+    return map;
+}
+
+void u_hashmap_free(u_hashmap_t **map)
+{
+    if (!map || !(*map))
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < (*map)->bucketCount; i++)
+    {
+        u_hashmap_node_t *node = (*map)->buckets[i];
+        while (node)
+        {
+            u_hashmap_node_t *next = node->next;
+            OICFree(node);
+            node = next;
+        }
+    }
+
+    OICFree((*map)->buckets);
+    OICFree(*map);
+
+    *map = NULL;
+}
+
+bool u_hashmap_put(u_hashmap_t *map, const void *key, size_t keyLength, void *data)
+{
+    if (!map || (!key && keyLength))
+    {
+        return false;
+    }
+
+    uint32_t hash = u_hashmap_hash(key, keyLength);
+    u_hashmap_node_t **slot = u_hashmap_find_slot(map, hash, key, keyLength);
+    if (*slot)
+    {
+        (*slot)->data = data;
+        return true;
+    }
+
+    u_hashmap_node_t *node =
+        (u_hashmap_node_t *) OICMalloc(sizeof(u_hashmap_node_t) + keyLength);
+    if (!node)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        return false;
+    }
+    node->next = NULL;
+    node->hash = hash;
+    node->keyLength = keyLength;
+    node->data = data;
+    if (keyLength)
+    {
+        memcpy(node->key, key, keyLength);
+    }
+
+    *slot = node;
+    map->length++;
+
+    if (map->length > (map->bucketCount * 3) / 4)
+    {
+        u_hashmap_grow(map);
+    }
+    return true;
+}
+
+void *u_hashmap_get(const u_hashmap_t *map, const void *key, size_t keyLength)
+{
+    if (!map || (!key && keyLength))
+    {
+        return NULL;
+    }
+
+    u_hashmap_node_t *node = *u_hashmap_find_slot(map, u_hashmap_hash(key, keyLength),
+                                                  key, keyLength);
+    return node ? node->data : NULL;
+}
+
+void *u_hashmap_remove(u_hashmap_t *map, const void *key, size_t keyLength)
+{
+    if (!map || (!key && keyLength))
+    {
+        return NULL;
+    }
+
+    u_hashmap_node_t **slot = u_hashmap_find_slot(map, u_hashmap_hash(key, keyLength),
+                                                  key, keyLength);
+    u_hashmap_node_t *node = *slot;
+    if (!node)
+    {
+        return NULL;
+    }
+
+    void *removed = node->data;
+    *slot = node->next;
+    OICFree(node);
+    map->length--;
+
+    return removed;
+}
+
+size_t u_hashmap_length(const u_hashmap_t *map)
+{
+    if (!map)
+    {
+        OIC_LOG(DEBUG, TAG, "Invalid Parameter");
+        return 0;
+    }
+    return map->length;
+}
+
+void u_hashmap_iterator_init(const u_hashmap_t *map, u_hashmap_iterator_t *iterator)
+{
+    if (!iterator)
+    {
+        return;
+    }
+
+    iterator->map = map;
+    iterator->bucket = 0;
+    iterator->nextNode = (map && map->bucketCount) ? map->buckets[0] : NULL;
+}
+
+bool u_hashmap_next(u_hashmap_iterator_t *iterator, void **data)
+{
+    if (!iterator || !iterator->map)
+    {
+        return false;
+    }
+
+    const u_hashmap_t *map = iterator->map;
+    while (!iterator->nextNode)
+    {
+        if (++iterator->bucket >= map->bucketCount)
+        {
+            return false;
+        }
+        iterator->nextNode = map->buckets[iterator->bucket];
+    }
+
+    u_hashmap_node_t *node = iterator->nextNode;
+    // Remember the successor now so the caller may remove this entry.
+    iterator->nextNode = node->next;
+    if (data)
+    {
+        *data = node->data;
+    }
+    return true;
+}
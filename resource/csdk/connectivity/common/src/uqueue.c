@@ -48,6 +48,7 @@ u_queue_t *u_queue_create()
 
     queuePtr->count = NO_MESSAGES;
     queuePtr->element = NULL;
+    queuePtr->tail = NULL;
 
     return queuePtr;
 }
@@ -79,16 +80,12 @@ CAResult_t u_queue_add_element(u_queue_t *queue, u_queue_message_t *message)
     element->message = message;
     element->next = NULL;
 
-    ptr = queue->element;
+    ptr = queue->tail;
 
-    if (NULL != ptr)
+    if (NULL != queue->element && NULL != ptr)
     {
-        while (NULL != ptr->next)
-        {
-            ptr = ptr->next;
-        }
-
         ptr->next = element;
+        queue->tail = element;
         queue->count++;
 
         OIC_LOG_V(DEBUG, TAG, "Queue Count : %d", queue->count);
@@ -105,6 +102,7 @@ CAResult_t u_queue_add_element(u_queue_t *queue, u_queue_message_t *message)
         }
 
         queue->element = element;
+        queue->tail = element;
         queue->count++;
         OIC_LOG_V(DEBUG, TAG, "Queue Count : %d", queue->count);
     }
@@ -131,6 +129,10 @@ u_queue_message_t *u_queue_get_element(u_queue_t *queue)
     }
 
     queue->element = element->next;
+    if (NULL == queue->element)
+    {
+        queue->tail = NULL;
+    }
     queue->count--;
 
     message = element->message;
@@ -163,6 +165,10 @@ CAResult_t u_queue_remove_element(u_queue_t *queue)
     OICFree(remove);
 
     queue->element = next;
+    if (NULL == next)
+    {
+        queue->tail = NULL;
+    }
     queue->count--;
 
     return CA_STATUS_OK;
@@ -0,0 +1,206 @@
+/******************************************************************
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <stdlib.h>
+#include "uringbuffer.h"
+#include "ocatomic.h"
+#include "logger.h"
+#include "oic_malloc.h"
+
+#define TAG "OIC_URINGBUFFER"
+
+/**
+ * Largest supported capacity. Positions are compared as signed differences,
+ * so the capacity must stay well below 2^31.
+ */
+#define U_RINGBUFFER_MAX_CAPACITY (1U << 30)
+
+/**
+ * Each slot carries a sequence number telling whose turn it is: a slot at
+ * position pos can be pushed when its sequence is pos and popped when it is
+ * pos + 1. Popping hands the slot to the push one lap later (pos + capacity).
+ */
+struct u_ringbuffer_slot_t
+{
+    volatile int32_t sequence;
+    u_queue_message_t message;
+};
+
+static int32_t u_ringbuffer_load(volatile int32_t *value)
+{
+    // Atomic read with a full barrier.
+    return oc_atomic_add(value, 0);
+}
+
+u_ringbuffer_t *u_ringbuffer_create(uint32_t capacity)
+{
+    if (0 == capacity || capacity > U_RINGBUFFER_MAX_CAPACITY)
+    {
+        OIC_LOG(DEBUG, TAG, "Invalid capacity");
+        return NULL;
+    }
+
+    uint32_t slotCount = 1;
+    while (slotCount < capacity)
+    {
+        slotCount <<= 1;
+    }
+
+    u_ringbuffer_t *ringBuffer = (u_ringbuffer_t *) OICCalloc(1, sizeof(u_ringbuffer_t));
+    if (!ringBuffer)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        return NULL;
+    }
+
+    ringBuffer->slots = (u_ringbuffer_slot_t *) OICCalloc(slotCount,
+                                                         sizeof(u_ringbuffer_slot_t));
+    if (!ringBuffer->slots)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        OICFree(ringBuffer);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < slotCount; i++)
+    {
+        ringBuffer->slots[i].sequence = (int32_t) i;
+    }
+    ringBuffer->capacity = slotCount;
+    ringBuffer->head = 0;
+    ringBuffer->tail = 0;
+
+    return ringBuffer;
+}
+
+void u_ringbuffer_delete(u_ringbuffer_t *ringBuffer)
+{
+    if (!ringBuffer)
+    {
+        return;
+    }
+
+    OICFree(ringBuffer->slots);
+    OICFree(ringBuffer);
+}
+
+bool u_ringbuffer_push(u_ringbuffer_t *ringBuffer, const u_queue_message_t *message)
+{
+    if (!ringBuffer || !message)
+    {
+        return false;
+    }
+
+    uint32_t mask = ringBuffer->capacity - 1;
+    u_ringbuffer_slot_t *slot = NULL;
+    int32_t pos = u_ringbuffer_load(&ringBuffer->tail);
+
+    for (;;)
+    {
+        slot = &ringBuffer->slots[(uint32_t) pos & mask];
+        int32_t diff = (int32_t) ((uint32_t) u_ringbuffer_load(&slot->sequence) - (uint32_t) pos);
+        if (0 == diff)
+        {
+            if (oc_atomic_cmpxchg(&ringBuffer->tail, pos, (int32_t) ((uint32_t) pos + 1)))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds the message pushed one lap ago.
+            return false;
+        }
+        pos = u_ringbuffer_load(&ringBuffer->tail);
+    }
+
+    slot->message = *message;
+    // Publish the message: sequence pos -> pos + 1.
+    oc_atomic_increment(&slot->sequence);
+    return true;
+}
+
+bool u_ringbuffer_pop(u_ringbuffer_t *ringBuffer, u_queue_message_t *message)
+{
+    if (!ringBuffer || !message)
+    {
+        return false;
+    }
+
+    uint32_t mask = ringBuffer->capacity - 1;
+    u_ringbuffer_slot_t *slot = NULL;
+    int32_t pos = u_ringbuffer_load(&ringBuffer->head);
+
+    for (;;)
+    {
+        slot = &ringBuffer->slots[(uint32_t) pos & mask];
+        int32_t diff = (int32_t) ((uint32_t) u_ringbuffer_load(&slot->sequence)
+                                  - ((uint32_t) pos + 1));
+        if (0 == diff)
+        {
+            if (oc_atomic_cmpxchg(&ringBuffer->head, pos, (int32_t) ((uint32_t) pos + 1)))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Nothing has been published at this position yet.
+            return false;
+        }
+        pos = u_ringbuffer_load(&ringBuffer->head);
+    }
+
+    *message = slot->message;
+    // Release the slot for the next lap: sequence pos + 1 -> pos + capacity.
+    oc_atomic_add(&slot->sequence, (int32_t) (ringBuffer->capacity - 1));
+    return true;
+}
+
+uint32_t u_ringbuffer_pop_batch(u_ringbuffer_t *ringBuffer, u_queue_message_t *messages,
+                                uint32_t count)
+{
+    if (!ringBuffer || !messages)
+    {
+        return 0;
+    }
+
+    uint32_t popped = 0;
+    while (popped < count && u_ringbuffer_pop(ringBuffer, &messages[popped]))
+    {
+        popped++;
+    }
+    return popped;
+}
+
+uint32_t u_ringbuffer_get_size(u_ringbuffer_t *ringBuffer)
+{
+    if (!ringBuffer)
+    {
+        OIC_LOG(DEBUG, TAG, "Invalid Parameter");
+        return 0;
+    }
+
+    int32_t head = u_ringbuffer_load(&ringBuffer->head);
+    int32_t tail = u_ringbuffer_load(&ringBuffer->tail);
+    int32_t size = (int32_t) ((uint32_t) tail - (uint32_t) head);
+
+    if (size < 0)
+    {
+        return 0;
+    }
+    return ((uint32_t) size > ringBuffer->capacity) ? ringBuffer->capacity : (uint32_t) size;
+}
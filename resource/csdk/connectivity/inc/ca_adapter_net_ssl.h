@@ -38,6 +38,16 @@ typedef void (*CAPacketReceivedCallback)(const CASecureEndpoint_t *sep,
 typedef ssize_t (*CAPacketSendCallback)(CAEndpoint_t *endpoint,
                                         const void *data, size_t dataLength);
 
+/**
+ * TLS session resumption counters.
+ */
+typedef struct
+{
+    uint32_t hits;          /**< handshakes that resumed a cached session. */
+    uint32_t misses;        /**< full handshakes. */
+    size_t savedSessions;   /**< sessions saved by the client side. */
+} CASslSessionCacheStats_t;
+
 /**
  * Select the cipher suite for dtls handshake
  *
@@ -140,6 +150,27 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint, void *data, size_t dataLen
  */
 CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dataLen);
 
+/**
+ * Configure TLS session resumption. Applies to the session ID cache and
+ * session tickets of the server side and to the sessions saved by the client
+ * side. Only certificate-authenticated sessions are resumed.
+ *
+ * @param[in] maxEntries  maximum number of cached sessions, 0 disables resumption.
+ * @param[in] lifetime    lifetime of cached sessions and tickets in seconds.
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAsetSslSessionCacheConfig(size_t maxEntries, uint32_t lifetime);
+
+/**
+ * Get TLS session resumption counters.
+ *
+ * @param[out] stats  counters.
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAgetSslSessionCacheStats(CASslSessionCacheStats_t *stats);
+
 /**
  * Initiate TLS handshake with selected cipher suite.
  *
@@ -32,6 +32,7 @@
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uarraylist.h"
+#include "uhashmap.h"
 #include "cacommon.h"
 #include "caprotocolmessage.h"
 #include "camessagehandler.h"
@@ -53,6 +54,21 @@ typedef void (*CASendThreadFunc)(CAData_t *data);
  */
 typedef void (*CAReceiveThreadFunc)(CAData_t *data);
 
+/**
+ * Time in milliseconds after which a transfer without any block exchanged is
+ * dropped. Matches EXCHANGE_LIFETIME of RFC 7252.
+ */
+#define CA_BLOCK_DATA_IDLE_TIMEOUT_MS   (247 * 1000)
+
+/**
+ * Largest total payload length from a Size1 or Size2 option that is allocated
+ * up front. A larger announcement is not trusted; the buffer then grows as the
+ * blocks arrive.
+ */
+#define CA_MAX_BLOCKWISE_PAYLOAD        (64 * 1024)
+
+struct CABlockData;
+
 /**
  * context of blockwise transfer.
  */
@@ -64,14 +80,23 @@ typedef struct
     /** callback function for received message. **/
     CAReceiveThreadFunc receivedThreadFunc;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** block data on which the thread is operating, keyed by ::CABlockDataID_t. **/
+    u_hashmap_t *dataMap;
+
+    /** block data used least recently, the first one to time out. **/
+    struct CABlockData *idleHead;
+
+    /** block data used most recently. **/
+    struct CABlockData *idleTail;
 
     /** data list mutex for synchronization. **/
     oc_mutex blockDataListMutex;
 
     /** sender mutex for synchronization. **/
     oc_mutex blockDataSenderMutex;
+
+    /** callback function for each received block payload. **/
+    CABlockPayloadCallback blockPayloadCallback;
 } CABlockWiseContext_t;
 
 /**
@@ -86,7 +111,7 @@ typedef struct
 /**
  * Block Data Set.
  */
-typedef struct
+typedef struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
@@ -94,8 +119,13 @@ typedef struct
     CABlockDataID_t* blockDataId;        /**< ID set of CABlockData. */
     CAData_t *sentData;                 /**< sent request or response data information. */
     CAPayload_t payload;                /**< payload buffer. */
+    size_t payloadCapacity;             /**< allocated length of payload buffer. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
+    bool isPayloadConsumed;             /**< payload is consumed by the block callback. */
+    uint64_t lastActivity;              /**< time of last use in milliseconds. */
+    struct CABlockData *idlePrev;       /**< block data used before this one. */
+    struct CABlockData *idleNext;       /**< block data used after this one. */
 } CABlockData_t;
 
 /**
@@ -367,15 +397,18 @@ bool CAIsPayloadLengthInPduWithBlockSizeOption(coap_pdu_t *pdu,
 
 /**
  * update the total payload with the received payload.
+ * The payload buffer is allocated once for the length of the size option if
+ * the sender announced it, and grows geometrically otherwise.
  * @param[in]   currData    stored block data information.
  * @param[in]   receivedData    received CAData.
  * @param[in]   status  block-wise state.
- * @param[in]   isSizeOption    size option.
+ * @param[in]   block    received block option.
  * @param[in]   blockType    block option type.
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *receivedData,
-                               uint8_t status, bool isSizeOption, uint16_t blockType);
+                               uint8_t status, const coap_block_t *block,
+                               uint16_t blockType);
 
 /**
  * Generate CAData structure  from the given information.
@@ -545,6 +578,22 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
 CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
                                           size_t *fullPayloadLen);
 
+/**
+ * Take the full payload out of block-wise list. The block data keeps no
+ * reference to the returned payload, which has to be freed by the caller.
+ * @param[in]   blockID     ID set of CABlockData.
+ * @param[out]  fullPayloadLen  received full payload length.
+ * @return payload.
+ */
+CAPayload_t CATakePayloadFromBlockDataList(const CABlockDataID_t *blockID,
+                                           size_t *fullPayloadLen);
+
+/**
+ * Set the callback function for each received block payload.
+ * @param[in]   blockPayloadCallback    callback, or NULL to reassemble all payloads.
+ */
+void CASetBlockPayloadCallback(CABlockPayloadCallback blockPayloadCallback);
+
 /**
  * Create the block data from given data and add the data in block-wise transfer list.
  * @param[in]   sendData    data to be added to a list.
@@ -566,6 +615,14 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID);
  */
 CAResult_t CARemoveAllBlockDataFromList();
 
+/**
+ * Remove the block data of transfers that have been idle for longer than
+ * ::CA_BLOCK_DATA_IDLE_TIMEOUT_MS.
+ * @param[in]   currentTime   current time in milliseconds.
+ * @return number of removed block data.
+ */
+size_t CARemoveExpiredBlockData(uint64_t currentTime);
+
 /**
  * Find the block data with seed info and remove it from block-wise transfer list.
  * @param[in]   token         token of the message.
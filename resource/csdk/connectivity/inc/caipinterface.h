@@ -178,6 +178,26 @@ int CAGetPollingInterval(int interval);
  */
 void CAWakeUpForChange();
 
+/**
+ * Rebuild the list of interfaces that multicast messages are sent out of.
+ * The IP server does it when the listen server starts and on netlink or
+ * Windows address change events. A network monitor that learns about
+ * interface changes some other way has to call it.
+ */
+void CAIPRefreshMulticastInterfaces();
+
+/**
+ * Get the interfaces that multicast messages of one address family are sent
+ * out of. Each interface is listed once, however many addresses it has.
+ *
+ * @param[in]  family   AF_INET or AF_INET6.
+ * @param[out] indexes  interface indexes.
+ * @param[in]  size     number of entries in indexes.
+ *
+ * @return  number of indexes written.
+ */
+size_t CAIPGetMulticastInterfaces(uint16_t family, uint32_t *indexes, size_t size);
+
 /**
  * Set callback for error handling.
  *
@@ -97,6 +97,25 @@ void CAHandleRequestResponseCallbacks();
  */
 void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler);
 
+/**
+ * Setting the callback function called when received data is queued.
+ * @param[in] receiveQueueHandler    callback for queued data, or NULL.
+ */
+void CASetReceiveQueueCallback(CAReceiveQueueCallback receiveQueueHandler);
+
+/**
+ * Set the number of received messages that can wait for the application.
+ * Takes effect at the next CAInitializeMessageHandler.
+ * @param[in] capacity    receive queue capacity, 0 restores the default.
+ */
+void CASetReceiveQueueCapacity(uint32_t capacity);
+
+/**
+ * Get the number of received messages refused because the receive queue was full.
+ * @return  refused message count since the message handler was initialized.
+ */
+uint32_t CAGetReceiveQueueOverflowCount();
+
 #ifdef WITH_BWT
 /**
  * Add the data to the send queue thread.
@@ -32,6 +32,7 @@
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uqueue.h"
+#include "uringbuffer.h"
 #include "cacommon.h"
 #ifdef __cplusplus
 extern "C"
@@ -44,6 +45,19 @@ typedef void (*CAThreadTask)(void *threadData);
 /** Data destroy function. **/
 typedef void (*CADataDestroyFunction)(void *data, uint32_t size);
 
+/** What to do with new data when a ring backed queue is full. **/
+typedef enum
+{
+    /** Drop the oldest queued data to make room. **/
+    CA_QUEUE_OVERFLOW_DROP_OLDEST = 0,
+    /** Drop the new data. **/
+    CA_QUEUE_OVERFLOW_DROP_NEWEST,
+    /** Wait until the thread has made room. **/
+    CA_QUEUE_OVERFLOW_BLOCK,
+    /** Refuse the new data, which stays with the caller. **/
+    CA_QUEUE_OVERFLOW_REJECT
+} CAQueueOverflowPolicy_t;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -60,6 +74,18 @@ typedef struct
     bool isStop;
     /** Que on which the thread is operating. **/
     u_queue_t *dataQueue;
+    /** Lock-free ring used instead of dataQueue, NULL for the list backend. **/
+    u_ringbuffer_t *dataRing;
+    /** What to do when dataRing is full. **/
+    CAQueueOverflowPolicy_t overflowPolicy;
+    /** conditional for producers waiting for room in dataRing. **/
+    oc_cond spaceCond;
+    /** Non zero while the thread waits for data. **/
+    volatile int32_t waitingForData;
+    /** Number of producers waiting for room in dataRing. **/
+    volatile int32_t waitingForSpace;
+    /** Number of data dropped or refused because dataRing was full. **/
+    volatile int32_t overflowCount;
 } CAQueueingThread_t;
 
 /**
@@ -73,6 +99,25 @@ typedef struct
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy);
 
+/**
+ * Initializes the queuing thread with a bounded lock-free ring buffer instead of
+ * a linked list. Adding data does not allocate and does not take the thread mutex
+ * unless the thread is waiting, and the thread takes queued data in batches.
+ * Data dropped because the ring is full is freed with the destroy function, except
+ * with ::CA_QUEUE_OVERFLOW_REJECT where CAQueueingThreadAddData fails and the caller
+ * keeps the data.
+ * @param[in]   thread       thread data for each thread.
+ * @param[in]   handle       thread pool handle created.
+ * @param[in]   task         function to be called for each data.
+ * @param[in]   destroy      function to data destroy.
+ * @param[in]   capacity     number of data the ring can hold.
+ * @param[in]   policy       what to do with new data when the ring is full.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadInitializeRing(CAQueueingThread_t *thread, ca_thread_pool_t handle,
+                                          CAThreadTask task, CADataDestroyFunction destroy,
+                                          uint32_t capacity, CAQueueOverflowPolicy_t policy);
+
 /**
  * Start the queuing thread.
  * @param[in]   thread        thread data that needs to be started.
@@ -89,6 +134,13 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Get the number of data a ring backed queue dropped or refused because it was full.
+ * @param[in]   thread       thread data.
+ * @return  number of data lost to overflow since the thread was initialized.
+ */
+uint32_t CAQueueingThreadGetOverflowCount(CAQueueingThread_t *thread);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
@@ -31,6 +31,7 @@
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uarraylist.h"
+#include "uhashmap.h"
 #include "cacommon.h"
 
 /** IP, EDR, LE. **/
@@ -91,8 +92,17 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** pending CON messages as a min-heap ordered by next retransmission time. **/
+    struct CARetransmissionData_t **dataHeap;
+
+    /** number of pending CON messages. **/
+    size_t dataCount;
+
+    /** allocated size of dataHeap. **/
+    size_t dataCapacity;
+
+    /** pending CON messages indexed by adapter and message id. **/
+    u_hashmap_t *dataIndex;
 
 } CARetransmission_t;
 
@@ -70,6 +70,8 @@ typedef struct CATCPSessionInfo_t
     CATCPConnectionState_t state;       /**< current tcp session state */
     bool isClient;                      /**< Host Mode of Operation. */
     struct CATCPSessionInfo_t *next;    /**< Linked list; for multiple session list. */
+    struct CATCPSessionInfo_t *prev;    /**< Linked list; for multiple session list. */
+    struct CATCPSessionInfo_t *addrNext;/**< Next session with the same address and port. */
 } CATCPSessionInfo_t;
 
 /**
@@ -33,7 +33,11 @@
 #include "ocrandom.h"
 #include "byte_array.h"
 #include "octhread.h"
+#include "ocatomic.h"
 #include "octimer.h"
+#include "oic_time.h"
+#include "uhashmap.h"
+#include <coap/utlist.h>
 
 // headers required for mbed TLS
 #include "mbedtls/platform.h"
@@ -44,6 +48,8 @@
 #include "mbedtls/ssl_internal.h"
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/oid.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
 #ifdef __WITH_DTLS__
 #include "mbedtls/timing.h"
 #include "mbedtls/ssl_cookie.h"
@@ -106,6 +112,36 @@
  */
 
 #define TLS_MSG_BUF_LEN (16384)
+/**
+ * @def SSL_MAX_PEERS
+ * @brief Maximum number of TLS sessions kept at the same time. Each session holds
+ * its own record buffers, so when the limit is reached the least recently used
+ * established session is closed to make room for a new one. If every session is
+ * still in its handshake, new sessions are refused.
+ */
+#ifndef SSL_MAX_PEERS
+#define SSL_MAX_PEERS (256)
+#endif
+/**
+ * @def SSL_SESSION_CACHE_SIZE
+ * @brief Default number of sessions kept for resumption, separately on the client
+ * and on the server side. Can be changed with CAsetSslSessionCacheConfig().
+ */
+#ifndef SSL_SESSION_CACHE_SIZE
+#define SSL_SESSION_CACHE_SIZE (50)
+#endif
+/**
+ * @def SSL_SESSION_CACHE_LIFETIME
+ * @brief Default lifetime of cached sessions and session tickets in seconds.
+ * Sessions are also dropped by CAsslClearSessionCache() whenever credentials
+ * or the ownership state change.
+ */
+#ifndef SSL_SESSION_CACHE_LIFETIME
+#define SSL_SESSION_CACHE_LIFETIME (3600)
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_TICKET_C)
+#define SSL_SESSION_TICKETS
+#endif
 /**
  * @def PSK_LENGTH
  * @brief PSK keys max length
@@ -368,8 +404,23 @@ typedef struct TlsCallBacks
  */
 typedef struct SslContext
 {
-    u_arraylist_t *peerList;         /**< peer list which holds the mapping between
-                                              peer id, it's n/w address and mbedTLS context. */
+    struct SslEndPoint *peerList;    /**< peer list which holds the mapping between
+                                              peer id, it's n/w address and mbedTLS context.
+                                              Least recently used peer first. */
+    u_hashmap_t *peerIndex;          /**< peers indexed by SslPeerKey_t. */
+    size_t peerCount;                /**< number of peers in peerList. */
+    struct SslSession *sessionList;  /**< sessions saved by the client side for resumption.
+                                              Oldest first. */
+    u_hashmap_t *sessionIndex;       /**< saved sessions indexed by SslPeerKey_t. */
+    size_t sessionCount;             /**< number of sessions in sessionList. */
+    uint32_t sessionHits;            /**< handshakes that resumed a session. */
+    uint32_t sessionMisses;          /**< full handshakes. */
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_context sessionCache;  /**< session ID cache of the server side. */
+#endif
+#ifdef SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_context ticketCtx;    /**< session ticket keys of the server side. */
+#endif
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context rnd;
     mbedtls_x509_crt ca;
@@ -429,6 +480,26 @@ static oc_mutex g_sslContextMutex = NULL;
  */
 static CAErrorCallback g_sslCallback = NULL;
 
+/**
+ * @var g_sessionCacheSize
+ * @brief Maximum number of sessions kept for resumption. 0 disables resumption.
+ */
+static size_t g_sessionCacheSize = SSL_SESSION_CACHE_SIZE;
+
+/**
+ * @var g_sessionCacheLifetime
+ * @brief Lifetime of cached sessions in seconds.
+ */
+static uint32_t g_sessionCacheLifetime = SSL_SESSION_CACHE_LIFETIME;
+
+/**
+ * @var g_clearSessionCache
+ * @brief Set by CAsslClearSessionCache(). Security calls it from the handshake
+ * callback too, which runs with g_sslContextMutex held, so the sessions are
+ * dropped by ClearSessionCacheIfRequested() before they can be used next.
+ */
+static volatile int32_t g_clearSessionCache = 0;
+
 /**
  * Data structure for holding the data to be received.
  */
@@ -453,8 +524,35 @@ typedef struct SslEndPoint
 #ifdef __WITH_DTLS__
     mbedtls_timing_delay_context timer;
 #endif // __WITH_DTLS__
+    bool resumed;
+    struct SslEndPoint *prev;
+    struct SslEndPoint *next;
 } SslEndPoint_t;
 
+/**
+ * Key of the peer index. Zero-filled before use so that it can be hashed and
+ * compared as raw bytes.
+ */
+typedef struct SslPeerKey
+{
+    CATransportAdapter_t adapter;
+    uint16_t port;
+    char addr[MAX_ADDR_STR_SIZE_CA];
+} SslPeerKey_t;
+
+/**
+ * Session saved by the client side to resume it on the next handshake
+ * with the same peer.
+ */
+typedef struct SslSession
+{
+    SslPeerKey_t key;
+    mbedtls_ssl_session session;
+    uint64_t savedTime;
+    struct SslSession *prev;
+    struct SslSession *next;
+} SslSession_t;
+
 void CAsetPskCredentialsCallback(CAgetPskCredentialsHandler credCallback)
 {
     // TODO Does this method needs protection of tlsContextMutex?
@@ -801,6 +899,24 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
     OIC_LOG_V(WARNING, NET_SSL_TAG, "Out %s", __func__);
     return -1;
 }
+/**
+ * Fills the peer index key for endpoint. BLE peers are identified by address
+ * only, so the port is left out for them.
+ *
+ * @param[in]  endpoint    remote address
+ * @param[out] key         key to fill
+ */
+static void MakeSslPeerKey(const CAEndpoint_t *endpoint, SslPeerKey_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->adapter = endpoint->adapter;
+    if (CA_ADAPTER_GATT_BTLE != endpoint->adapter)
+    {
+        key->port = endpoint->port;
+    }
+    strncpy(key->addr, endpoint->addr, sizeof(key->addr) - 1);
+}
+
 /**
  * Gets session corresponding for endpoint.
  *
@@ -810,37 +926,21 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
  */
 static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     VERIFY_NON_NULL_RET(peer, NET_SSL_TAG, "TLS peer is NULL", NULL);
     VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", NULL);
 
-    SslEndPoint_t *tep = NULL;
-    listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (listIndex = 0; listIndex < listLength; listIndex++)
+    SslPeerKey_t key;
+    MakeSslPeerKey(peer, &key);
+    SslEndPoint_t *tep = (SslEndPoint_t *) u_hashmap_get(g_caSslContext->peerIndex,
+                                                         &key, sizeof(key));
+    if (NULL == tep)
     {
-        tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
-
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Compare [%s:%d] and [%s:%d] for %d adapter",
-                  peer->addr, peer->port, tep->sep.endpoint.addr, tep->sep.endpoint.port,
-                  peer->adapter);
-
-        if((peer->adapter == tep->sep.endpoint.adapter)
-                && (0 == strncmp(peer->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA))
-                && (peer->port == tep->sep.endpoint.port || CA_ADAPTER_GATT_BTLE == peer->adapter))
-        {
-            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-            return tep;
-        }
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "No session for [%s:%d] on %d adapter",
+                  peer->addr, peer->port, peer->adapter);
     }
-    OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return NULL;
+    return tep;
 }
 
 /**
@@ -1021,6 +1121,20 @@ static void DeleteSslEndPoint(SslEndPoint_t * tep)
     OICFree(tep);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
+/**
+ * Removes endpoint session from list and index without deleting it.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void UnlinkSslPeer(SslEndPoint_t *tep)
+{
+    SslPeerKey_t key;
+    MakeSslPeerKey(&tep->sep.endpoint, &key);
+    u_hashmap_remove(g_caSslContext->peerIndex, &key, sizeof(key));
+    DL_DELETE(g_caSslContext->peerList, tep);
+    g_caSslContext->peerCount--;
+}
+
 /**
  * Removes endpoint session from list.
  *
@@ -1030,24 +1144,308 @@ static void RemovePeerFromList(CAEndpoint_t * endpoint)
 {
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
     VERIFY_NON_NULL_VOID(endpoint, NET_SSL_TAG, "endpoint");
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+
+    SslPeerKey_t key;
+    MakeSslPeerKey(endpoint, &key);
+    SslEndPoint_t *tep = (SslEndPoint_t *) u_hashmap_get(g_caSslContext->peerIndex,
+                                                         &key, sizeof(key));
+    if (NULL != tep)
+    {
+        UnlinkSslPeer(tep);
+        DeleteSslEndPoint(tep);
+    }
+}
+
+/**
+ * Marks endpoint session as most recently used.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void TouchSslPeer(SslEndPoint_t *tep)
+{
+    if (tep != g_caSslContext->peerList->prev)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
+        DL_DELETE(g_caSslContext->peerList, tep);
+        DL_APPEND(g_caSslContext->peerList, tep);
+    }
+}
+
+/**
+ * Adds endpoint session to list. If the list is full, the least recently
+ * used session that has finished its handshake is closed first, and the
+ * handshake callback gets ::CA_DESTINATION_DISCONNECTED for it. Sessions
+ * still in their handshake are kept, so if there are only such sessions
+ * the new one is refused.
+ *
+ * @param[in]  tep    endpoint with session info
+ *
+ * @return  true on success or false on error
+ */
+static bool AddPeerToList(SslEndPoint_t *tep)
+{
+    if (SSL_MAX_PEERS <= g_caSslContext->peerCount)
+    {
+        SslEndPoint_t *idle = NULL;
+        DL_FOREACH(g_caSslContext->peerList, idle)
         {
-            continue;
+            if (MBEDTLS_SSL_HANDSHAKE_OVER == idle->ssl.state)
+            {
+                break;
+            }
         }
-        if(0 == strncmp(endpoint->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA)
-                && (endpoint->port == tep->sep.endpoint.port))
+        if (NULL == idle)
         {
-            u_arraylist_remove(g_caSslContext->peerList, listIndex);
-            DeleteSslEndPoint(tep);
-            return;
+            OIC_LOG_V(ERROR, NET_SSL_TAG, "Peer limit reached, refusing session [%s:%d]",
+                      tep->sep.endpoint.addr, tep->sep.endpoint.port);
+            return false;
         }
+
+        OIC_LOG_V(INFO, NET_SSL_TAG, "Peer limit reached, closing session [%s:%d]",
+                  idle->sep.endpoint.addr, idle->sep.endpoint.port);
+        int ret = 0;
+        SSL_CLOSE_NOTIFY(idle, ret);
+        OC_UNUSED(ret);
+        UnlinkSslPeer(idle);
+        SSL_RES(idle, CA_DESTINATION_DISCONNECTED);
+        DeleteSslEndPoint(idle);
+    }
+
+    SslPeerKey_t key;
+    MakeSslPeerKey(&tep->sep.endpoint, &key);
+    if (!u_hashmap_put(g_caSslContext->peerIndex, &key, sizeof(key), tep))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "u_hashmap_put failed!");
+        return false;
+    }
+    DL_APPEND(g_caSslContext->peerList, tep);
+    g_caSslContext->peerCount++;
+    return true;
+}
+
+/**
+ * Deletes saved session.
+ *
+ * @param[in]  entry    saved session
+ */
+static void DeleteSslSession(SslSession_t *entry)
+{
+    u_hashmap_remove(g_caSslContext->sessionIndex, &entry->key, sizeof(entry->key));
+    DL_DELETE(g_caSslContext->sessionList, entry);
+    g_caSslContext->sessionCount--;
+    mbedtls_ssl_session_free(&entry->session);
+    OICFree(entry);
+}
+
+/**
+ * Deletes saved session for endpoint, so that the next handshake with it
+ * is a full one.
+ *
+ * @param[in]  endpoint    remote address
+ */
+static void RemoveSslSession(const CAEndpoint_t *endpoint)
+{
+    VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
+    VERIFY_NON_NULL_VOID(endpoint, NET_SSL_TAG, "endpoint");
+
+    SslPeerKey_t key;
+    MakeSslPeerKey(endpoint, &key);
+    SslSession_t *entry = (SslSession_t *) u_hashmap_get(g_caSslContext->sessionIndex,
+                                                         &key, sizeof(key));
+    if (NULL != entry)
+    {
+        DeleteSslSession(entry);
+    }
+}
+
+/**
+ * Deletes oldest saved sessions until at most maxCount are left.
+ *
+ * @param[in]  maxCount    number of sessions to keep
+ */
+static void TrimSslSessions(size_t maxCount)
+{
+    while (g_caSslContext->sessionCount > maxCount)
+    {
+        DeleteSslSession(g_caSslContext->sessionList);
     }
 }
 
+/**
+ * Saves session of a completed client handshake.
+ *
+ * Only certificate-authenticated sessions are saved. A resumed session skips
+ * the PSK callback, so the peer identity of PSK sessions would be lost.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void SaveSslSession(SslEndPoint_t *tep)
+{
+    if (0 == g_sessionCacheSize || NULL == tep->ssl.session
+        || NULL == tep->ssl.session->peer_cert)
+    {
+        return;
+    }
+
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    if (0 != mbedtls_ssl_get_session(&tep->ssl, &session))
+    {
+        OIC_LOG(WARNING, NET_SSL_TAG, "Failed to copy session");
+        mbedtls_ssl_session_free(&session);
+        return;
+    }
+
+    RemoveSslSession(&tep->sep.endpoint);
+    TrimSslSessions(g_sessionCacheSize - 1);
+
+    SslSession_t *entry = (SslSession_t *) OICCalloc(1, sizeof(SslSession_t));
+    if (NULL == entry)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Malloc failed!");
+        mbedtls_ssl_session_free(&session);
+        return;
+    }
+    MakeSslPeerKey(&tep->sep.endpoint, &entry->key);
+    entry->session = session;
+    entry->savedTime = OICGetCurrentTime(TIME_IN_MS);
+
+    if (!u_hashmap_put(g_caSslContext->sessionIndex, &entry->key, sizeof(entry->key), entry))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "u_hashmap_put failed!");
+        mbedtls_ssl_session_free(&entry->session);
+        OICFree(entry);
+        return;
+    }
+    DL_APPEND(g_caSslContext->sessionList, entry);
+    g_caSslContext->sessionCount++;
+}
+
+/**
+ * Offers the saved session of the peer for resumption, if there is one that
+ * has not expired and uses a cipher suite still allowed by config.
+ *
+ * @param[in]  tep       endpoint with session info
+ * @param[in]  config    mbedTLS configuration of the handshake
+ */
+static void LoadSslSession(SslEndPoint_t *tep, const mbedtls_ssl_config *config)
+{
+    SslPeerKey_t key;
+    MakeSslPeerKey(&tep->sep.endpoint, &key);
+    SslSession_t *entry = (SslSession_t *) u_hashmap_get(g_caSslContext->sessionIndex,
+                                                         &key, sizeof(key));
+    if (NULL == entry)
+    {
+        return;
+    }
+
+    uint64_t age = OICGetCurrentTime(TIME_IN_MS) - entry->savedTime;
+    if (age > (uint64_t) g_sessionCacheLifetime * MS_PER_SEC)
+    {
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Saved session expired");
+        DeleteSslSession(entry);
+        return;
+    }
+
+    const int *cipher = config->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_3];
+    while (NULL != cipher && 0 != *cipher && entry->session.ciphersuite != *cipher)
+    {
+        cipher++;
+    }
+    if (NULL == cipher || 0 == *cipher)
+    {
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Cipher suite of saved session is not allowed");
+        return;
+    }
+
+    if (0 != mbedtls_ssl_set_session(&tep->ssl, &entry->session))
+    {
+        OIC_LOG(WARNING, NET_SSL_TAG, "Failed to offer saved session");
+    }
+}
+
+/**
+ * Deletes saved session list.
+ */
+static void DeleteSessionList()
+{
+    SslSession_t *entry = NULL;
+    SslSession_t *tmp = NULL;
+    DL_FOREACH_SAFE(g_caSslContext->sessionList, entry, tmp)
+    {
+        mbedtls_ssl_session_free(&entry->session);
+        OICFree(entry);
+    }
+    g_caSslContext->sessionList = NULL;
+    g_caSslContext->sessionCount = 0;
+    u_hashmap_free(&g_caSslContext->sessionIndex);
+}
+
+/**
+ * Drops the saved sessions, the session ID cache and the session ticket keys
+ * if CAsslClearSessionCache() was called since the last time.
+ * Caller must hold g_sslContextMutex.
+ */
+static void ClearSessionCacheIfRequested()
+{
+    if (!oc_atomic_cmpxchg(&g_clearSessionCache, 1, 0))
+    {
+        return;
+    }
+
+    OIC_LOG_V(INFO, NET_SSL_TAG, "Dropping %" PRIuPTR " saved sessions",
+              g_caSslContext->sessionCount);
+    TrimSslSessions(0);
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, (int) g_sessionCacheSize);
+    mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, (int) g_sessionCacheLifetime);
+#endif
+#ifdef SSL_SESSION_TICKETS
+    // New keys, so that the tickets issued so far are no longer accepted.
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, mbedtls_ctr_drbg_random,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                      g_sessionCacheLifetime))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+    }
+#endif
+}
+
+#ifdef MBEDTLS_SSL_CACHE_C
+/**
+ * Session cache callback of the server side. Same restriction as for
+ * SaveSslSession().
+ */
+static int SetServerSslSession(void *data, const mbedtls_ssl_session *session)
+{
+    if (0 == g_sessionCacheSize || NULL == session->peer_cert)
+    {
+        return -1;
+    }
+    return mbedtls_ssl_cache_set(data, session);
+}
+#endif // MBEDTLS_SSL_CACHE_C
+
+#ifdef SSL_SESSION_TICKETS
+/**
+ * Session ticket callback of the server side. Same restriction as for
+ * SaveSslSession(); mbedTLS sends an empty ticket on failure.
+ */
+static int WriteSslSessionTicket(void *data, const mbedtls_ssl_session *session,
+                                 unsigned char *start, const unsigned char *end,
+                                 size_t *tlen, uint32_t *lifetime)
+{
+    if (0 == g_sessionCacheSize || NULL == session->peer_cert)
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+    return mbedtls_ssl_ticket_write(data, session, start, end, tlen, lifetime);
+}
+#endif // SSL_SESSION_TICKETS
+
  /**
   * Checks handshake result. Removes peer from list and sends alert
   * if handshake failed.
@@ -1096,6 +1494,7 @@ static bool checkSslOperation(SslEndPoint_t*  peer,
             SSL_RES((peer), CA_DTLS_AUTHENTICATION_FAILURE);
         }
 
+        RemoveSslSession(&(peer)->sep.endpoint);
         RemovePeerFromList(&(peer)->sep.endpoint);
         return false;
     }
@@ -1110,14 +1509,10 @@ static void DeletePeerList()
 {
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+    SslEndPoint_t *tep = NULL;
+    SslEndPoint_t *tmp = NULL;
+    DL_FOREACH_SAFE(g_caSslContext->peerList, tep, tmp)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
         if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
         {
             int ret = 0;
@@ -1129,7 +1524,9 @@ static void DeletePeerList()
         }
         DeleteSslEndPoint(tep);
     }
-    u_arraylist_free(&g_caSslContext->peerList);
+    g_caSslContext->peerList = NULL;
+    g_caSslContext->peerCount = 0;
+    u_hashmap_free(&g_caSslContext->peerIndex);
 }
 
 CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
@@ -1177,16 +1574,12 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
         return;
     }
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    OIC_LOG_V(DEBUG, NET_SSL_TAG,
-            "Required transport [%d], peer count [%" PRIuPTR "]", transportType, listLength);
-    for (size_t i = listLength; i > 0; i--)
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Required transport [%d], peer count [%" PRIuPTR "]",
+              transportType, g_caSslContext->peerCount);
+    SslEndPoint_t *tep = NULL;
+    SslEndPoint_t *tmp = NULL;
+    DL_FOREACH_SAFE(g_caSslContext->peerList, tep, tmp)
     {
-        SslEndPoint_t *tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, i - 1);
-        if (NULL == tep)
-        {
-            continue;
-        }
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "SSL Connection [%s:%d], Transport [%d]",
                   tep->sep.endpoint.addr, tep->sep.endpoint.port, tep->sep.endpoint.adapter);
 
@@ -1206,7 +1599,7 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
         while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);*/
 
         // delete from list
-        u_arraylist_remove(g_caSslContext->peerList, i - 1);
+        UnlinkSslPeer(tep);
         DeleteSslEndPoint(tep);
     }
     oc_mutex_unlock(g_sslContextMutex);
@@ -1419,11 +1812,11 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
 
     //Load allowed SVR suites from SVR DB
     SetupCipher(config, endpoint->adapter, endpoint->remoteId);
+    ClearSessionCacheIfRequested();
+    LoadSslSession(tep, config);
 
-    ret = u_arraylist_add(g_caSslContext->peerList, (void *) tep);
-    if (!ret)
+    if (!AddPeerToList(tep))
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
         DeleteSslEndPoint(tep);
         return NULL;
     }
@@ -1479,6 +1872,7 @@ void CAdeinitSslAdapter()
 
     // Clear all lists
     DeletePeerList();
+    DeleteSessionList();
 
     // De-initialize mbedTLS
     mbedtls_x509_crt_free(&g_caSslContext->crt);
@@ -1492,6 +1886,12 @@ void CAdeinitSslAdapter()
     mbedtls_ssl_config_free(&g_caSslContext->serverDtlsConf);
     mbedtls_ssl_cookie_free(&g_caSslContext->cookieCtx);
 #endif // __WITH_DTLS__
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+#endif
+#ifdef SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+#endif
     mbedtls_ctr_drbg_free(&g_caSslContext->rnd);
     mbedtls_entropy_free(&g_caSslContext->entropy);
 #ifdef __WITH_DTLS__
@@ -1539,6 +1939,18 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
     }
 #endif // __WITH_DTLS__
 
+    if (MBEDTLS_SSL_IS_SERVER == mode)
+    {
+#ifdef MBEDTLS_SSL_CACHE_C
+        mbedtls_ssl_conf_session_cache(conf, &g_caSslContext->sessionCache,
+                                       mbedtls_ssl_cache_get, SetServerSslSession);
+#endif
+#ifdef SSL_SESSION_TICKETS
+        mbedtls_ssl_conf_session_tickets_cb(conf, WriteSslSessionTicket, mbedtls_ssl_ticket_parse,
+                                            &g_caSslContext->ticketCtx);
+#endif
+    }
+
     /* Set TLS 1.2 as the minimum allowed version. */
     mbedtls_ssl_conf_min_version(conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
 
@@ -1557,9 +1969,8 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
  */
 static void StartRetransmit()
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     SslEndPoint_t *tep = NULL;
+    SslEndPoint_t *tmp = NULL;
 
     oc_mutex_lock(g_sslContextMutex);
     if (NULL == g_caSslContext)
@@ -1574,12 +1985,9 @@ static void StartRetransmit()
         //clear previous timer
         unregisterTimer(g_caSslContext->timerId);
 
-        listLength = u_arraylist_length(g_caSslContext->peerList);
-        for (listIndex = 0; listIndex < listLength; listIndex++)
+        DL_FOREACH_SAFE(g_caSslContext->peerList, tep, tmp)
         {
-            tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-            if (NULL == tep
-                || (tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
+            if ((tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
                 || MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
             {
                 continue;
@@ -1636,12 +2044,15 @@ CAResult_t CAinitSslAdapter()
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // Create peer list
-    g_caSslContext->peerList = u_arraylist_create();
+    // Create peer and saved session indexes
+    g_caSslContext->peerIndex = u_hashmap_create(0);
+    g_caSslContext->sessionIndex = u_hashmap_create(0);
 
-    if(NULL == g_caSslContext->peerList)
+    if(NULL == g_caSslContext->peerIndex || NULL == g_caSslContext->sessionIndex)
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "peerList initialization failed!");
+        OIC_LOG(ERROR, NET_SSL_TAG, "peerIndex initialization failed!");
+        u_hashmap_free(&g_caSslContext->peerIndex);
+        u_hashmap_free(&g_caSslContext->sessionIndex);
         OICFree(g_caSslContext);
         g_caSslContext = NULL;
         oc_mutex_unlock(g_sslContextMutex);
@@ -1666,6 +2077,14 @@ CAResult_t CAinitSslAdapter()
      */
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, (int) g_sessionCacheSize);
+    mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, (int) g_sessionCacheLifetime);
+#endif
+#ifdef SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+#endif
 
     if(0 != mbedtls_ctr_drbg_seed(&g_caSslContext->rnd, mbedtls_entropy_func,
                                   &g_caSslContext->entropy,
@@ -1678,6 +2097,18 @@ CAResult_t CAinitSslAdapter()
     }
     mbedtls_ctr_drbg_set_prediction_resistance(&g_caSslContext->rnd, MBEDTLS_CTR_DRBG_PR_ON);
 
+#ifdef SSL_SESSION_TICKETS
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, mbedtls_ctr_drbg_random,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                      g_sessionCacheLifetime))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+        oc_mutex_unlock(g_sslContextMutex);
+        CAdeinitSslAdapter();
+        return CA_STATUS_FAILED;
+    }
+#endif
+
 #ifdef __WITH_TLS__
     if (0 != InitConfig(&g_caSslContext->clientTlsConf,
                         MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_IS_CLIENT))
@@ -1820,6 +2251,10 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
     {
         tep = InitiateTlsHandshake(endpoint);
     }
+    else
+    {
+        TouchSslPeer(tep);
+    }
     if (NULL == tep)
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "TLS handshake failed");
@@ -1953,7 +2388,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
         oc_mutex_unlock(g_sslContextMutex);
         return CA_STATUS_FAILED;
     }
-
+    ClearSessionCacheIfRequested();
 
     SslEndPoint_t * peer = GetSslPeer(&sep->endpoint);
     if (NULL == peer)
@@ -1971,15 +2406,17 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
         //Load allowed TLS suites from SVR DB
         SetupCipher(config, sep->endpoint.adapter, NULL);
 
-        ret = u_arraylist_add(g_caSslContext->peerList, (void *) peer);
-        if (!ret)
+        if (!AddPeerToList(peer))
         {
-            OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
             DeleteSslEndPoint(peer);
             oc_mutex_unlock(g_sslContextMutex);
             return CA_STATUS_FAILED;
         }
     }
+    else
+    {
+        TouchSslPeer(peer);
+    }
 
     peer->recBuf.buff = data;
     peer->recBuf.len = dataLen;
@@ -2029,6 +2466,12 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
         {
             memcpy(peer->master, peer->ssl.session_negotiate->master, sizeof(peer->master));
             g_caSslContext->selectedCipher = peer->ssl.session_negotiate->ciphersuite;
+            peer->resumed = (0 != peer->ssl.handshake->resume);
+            if (peer->resumed)
+            {
+                /* A resumed handshake has no key exchange step, take the randoms here. */
+                memcpy(peer->random, peer->ssl.handshake->randbytes, sizeof(peer->random));
+            }
         }
         if (MBEDTLS_SSL_CLIENT_KEY_EXCHANGE == peer->ssl.state)
         {
@@ -2037,6 +2480,15 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
 
         if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
         {
+            if (peer->resumed)
+            {
+                OIC_LOG(DEBUG, NET_SSL_TAG, "(D)TLS Session was resumed");
+                g_caSslContext->sessionHits++;
+            }
+            else
+            {
+                g_caSslContext->sessionMisses++;
+            }
             SSL_RES(peer, CA_STATUS_OK);
             if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
             {
@@ -2168,6 +2620,11 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                 peer->sep.publicKeyLength = 0;
             }
 
+            if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
+            {
+                SaveSslSession(peer);
+            }
+
             oc_mutex_unlock(g_sslContextMutex);
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
             return CA_STATUS_OK;
@@ -2351,6 +2808,65 @@ CAResult_t CAsetTlsCipherSuite(const uint32_t cipher)
     return CA_STATUS_OK;
 }
 
+CAResult_t CAsetSslSessionCacheConfig(size_t maxEntries, uint32_t lifetime)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_TRUE_RET(0 != lifetime, NET_SSL_TAG, "lifetime is zero", CA_STATUS_INVALID_PARAM);
+    VERIFY_TRUE_RET(INT_MAX >= maxEntries && INT_MAX >= lifetime, NET_SSL_TAG,
+                    "Param out of range", CA_STATUS_INVALID_PARAM);
+
+    if (NULL != g_sslContextMutex)
+    {
+        oc_mutex_lock(g_sslContextMutex);
+    }
+    g_sessionCacheSize = maxEntries;
+    g_sessionCacheLifetime = lifetime;
+    if (NULL != g_caSslContext)
+    {
+        TrimSslSessions(maxEntries);
+#ifdef MBEDTLS_SSL_CACHE_C
+        mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, (int) maxEntries);
+        mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, (int) lifetime);
+#endif
+#ifdef SSL_SESSION_TICKETS
+        g_caSslContext->ticketCtx.ticket_lifetime = lifetime;
+#endif
+    }
+    if (NULL != g_sslContextMutex)
+    {
+        oc_mutex_unlock(g_sslContextMutex);
+    }
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAgetSslSessionCacheStats(CASslSessionCacheStats_t *stats)
+{
+    VERIFY_NON_NULL_RET(stats, NET_SSL_TAG, "Param stats is NULL", CA_STATUS_INVALID_PARAM);
+
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL == g_caSslContext)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Context is NULL");
+        oc_mutex_unlock(g_sslContextMutex);
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+    ClearSessionCacheIfRequested();
+    stats->hits = g_caSslContext->sessionHits;
+    stats->misses = g_caSslContext->sessionMisses;
+    stats->savedSessions = g_caSslContext->sessionCount;
+    oc_mutex_unlock(g_sslContextMutex);
+    return CA_STATUS_OK;
+}
+
+void CAsslClearSessionCache()
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    oc_atomic_or(&g_clearSessionCache, 1);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
 CAResult_t CAinitiateSslHandshake(const CAEndpoint_t *endpoint)
 {
     CAResult_t res = CA_STATUS_OK;
@@ -2367,6 +2883,8 @@ CAResult_t CAinitiateSslHandshake(const CAEndpoint_t *endpoint)
     }
 
     oc_mutex_lock(g_sslContextMutex);
+    // An explicit handshake request always negotiates a new session.
+    RemoveSslSession(endpoint);
     if (NULL == InitiateTlsHandshake(endpoint))
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "TLS handshake failed");
@@ -42,6 +42,7 @@
 #include "cablockwisetransfer.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
 #include "octhread.h"
 #include "logger.h"
 
@@ -57,7 +58,95 @@
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
-                                          .dataList = NULL };
+                                          .dataMap = NULL,
+                                          .idleHead = NULL,
+                                          .idleTail = NULL,
+                                          .blockPayloadCallback = NULL };
+
+/*
+ * Block data is indexed by its ID in g_context.dataMap and additionally kept
+ * in a list ordered by last use, so that idle transfers are found at the head
+ * of the list without looking at the active ones. All helpers below expect
+ * blockDataListMutex to be held.
+ */
+
+static void CAAppendIdleBlockData(CABlockData_t *data)
+{
+    data->idlePrev = g_context.idleTail;
+    data->idleNext = NULL;
+    if (g_context.idleTail)
+    {
+        g_context.idleTail->idleNext = data;
+    }
+    else
+    {
+        g_context.idleHead = data;
+    }
+    g_context.idleTail = data;
+}
+
+static void CAUnlinkIdleBlockData(CABlockData_t *data)
+{
+    if (data->idlePrev)
+    {
+        data->idlePrev->idleNext = data->idleNext;
+    }
+    else
+    {
+        g_context.idleHead = data->idleNext;
+    }
+
+    if (data->idleNext)
+    {
+        data->idleNext->idlePrev = data->idlePrev;
+    }
+    else
+    {
+        g_context.idleTail = data->idlePrev;
+    }
+    data->idlePrev = NULL;
+    data->idleNext = NULL;
+}
+
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!blockID->id)
+    {
+        return NULL;
+    }
+
+    CABlockData_t *data = (CABlockData_t *) u_hashmap_get(g_context.dataMap, blockID->id,
+                                                          blockID->idLength);
+    if (data)
+    {
+        // a transfer stays alive as long as any of its blocks is handled
+        data->lastActivity = OICGetCurrentTime(TIME_IN_MS);
+        if (g_context.idleTail != data)
+        {
+            CAUnlinkIdleBlockData(data);
+            CAAppendIdleBlockData(data);
+        }
+    }
+    return data;
+}
+
+static void CADestroyBlockData(CABlockData_t *data)
+{
+    if (data->sentData)
+    {
+        CADestroyDataSet(data->sentData);
+    }
+    CADestroyBlockID(data->blockDataId);
+    OICFree(data->payload);
+    OICFree(data);
+}
+
+static void CARemoveBlockData(CABlockData_t *data)
+{
+    u_hashmap_remove(g_context.dataMap, data->blockDataId->id, data->blockDataId->idLength);
+    CAUnlinkIdleBlockData(data);
+    CADestroyBlockData(data);
+}
 
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
@@ -92,16 +181,15 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.receivedThreadFunc = receivedThreadFunc;
     }
 
-    if (!g_context.dataList)
+    if (!g_context.dataMap)
     {
-        g_context.dataList = u_arraylist_create();
+        g_context.dataMap = u_hashmap_create(0);
     }
 
     CAResult_t res = CAInitBlockWiseMutexVariables();
     if (CA_STATUS_OK != res)
     {
-        u_arraylist_free(&g_context.dataList);
-        g_context.dataList = NULL;
+        u_hashmap_free(&g_context.dataMap);
         OIC_LOG(ERROR, TAG, "init has failed");
     }
 
@@ -112,10 +200,10 @@ CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "CATerminateBlockWiseTransfer");
 
-    if (g_context.dataList)
+    if (g_context.dataMap)
     {
         CARemoveAllBlockDataFromList();
-        u_arraylist_free(&g_context.dataList);
+        u_hashmap_free(&g_context.dataMap);
     }
 
     CATerminateBlockWiseMutexVariables();
@@ -168,6 +256,8 @@ CAResult_t CASendBlockWiseData(const CAData_t *sendData)
 {
     VERIFY_NON_NULL(sendData, TAG, "sendData");
 
+    CARemoveExpiredBlockData(OICGetCurrentTime(TIME_IN_MS));
+
     // check if message type is CA_MSG_RESET
     if (sendData->requestInfo)
     {
@@ -314,6 +404,8 @@ CAResult_t CAReceiveBlockWiseData(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
     VERIFY_TRUE((pdu->transport_hdr->udp.token_length <= UINT8_MAX), TAG,
                 "pdu->transport_hdr->udp.token_length");
 
+    CARemoveExpiredBlockData(OICGetCurrentTime(TIME_IN_MS));
+
     // check if received message type is CA_MSG_RESET
     if (CA_EMPTY == pdu->transport_hdr->udp.code)
     {
@@ -779,8 +871,10 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     {
         OICFree(data->payload);
         data->payload = NULL;
+        data->payloadCapacity = 0;
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
+        data->isPayloadConsumed = false;
         data->block1.num = 0;
         data->block2.num = 0;
     }
@@ -788,11 +882,53 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     return CA_STATUS_OK;
 }
 
+static CAResult_t CASetPayloadToCAData(CAData_t *data, CAPayload_t payload, size_t payloadLen)
+{
+    CAInfo_t *info = NULL;
+    switch (data->dataType)
+    {
+        case CA_REQUEST_DATA:
+            if (data->requestInfo)
+            {
+                info = &data->requestInfo->info;
+            }
+            break;
+
+        case CA_RESPONSE_DATA:
+            if (data->responseInfo)
+            {
+                info = &data->responseInfo->info;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (!info)
+    {
+        OIC_LOG(ERROR, TAG, "no info to take the payload");
+        return CA_STATUS_FAILED;
+    }
+
+    OICFree(info->payload);
+    info->payload = payload;
+    info->payloadSize = payloadLen;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *receivedData)
 {
     VERIFY_NON_NULL(blockID, TAG, "blockID");
     VERIFY_NON_NULL(receivedData, TAG, "receivedData");
 
+    CABlockData_t *data = CAGetBlockDataFromBlockDataList(blockID);
+    if (data && !data->payload && !data->isPayloadConsumed && data->receivedPayloadLen)
+    {
+        OIC_LOG(DEBUG, TAG, "payload was already handed over");
+        return CA_STATUS_OK;
+    }
+
     // total block data have to notify to Application
     CAData_t *cloneData = CACloneCAData(receivedData);
     if (!cloneData)
@@ -801,15 +937,16 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // update payload
+    // hand the reassembled payload over without copying it
     size_t fullPayloadLen = 0;
-    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
-    if (fullPayload)
+    CAPayload_t fullPayload = CATakePayloadFromBlockDataList(blockID, &fullPayloadLen);
+    if (fullPayload || (data && data->isPayloadConsumed))
     {
-        CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
+        CAResult_t res = CASetPayloadToCAData(cloneData, fullPayload, fullPayloadLen);
         if (CA_STATUS_OK != res)
         {
             OIC_LOG(ERROR, TAG, "update has failed");
+            OICFree(fullPayload);
             CADestroyDataSet(cloneData);
             return res;
         }
@@ -909,8 +1046,7 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
         OIC_LOG_V(INFO, TAG, "num:%d, M:%d", block.num, block.m);
 
         // check the size option
-        bool isSizeOption = CAIsPayloadLengthInPduWithBlockSizeOption(pdu, COAP_OPTION_SIZE1,
-                                                                      &(data->payloadLength));
+        CAIsPayloadLengthInPduWithBlockSizeOption(pdu, COAP_OPTION_SIZE1, &(data->payloadLength));
 
         blockWiseStatus = CACheckBlockErrorType(data, &block, receivedData,
                                                 COAP_OPTION_BLOCK1, dataLen);
@@ -919,7 +1055,7 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
         {
             // store the received payload and merge
             res = CAUpdatePayloadData(data, receivedData, blockWiseStatus,
-                                      isSizeOption, COAP_OPTION_BLOCK1);
+                                      &block, COAP_OPTION_BLOCK1);
             if (CA_STATUS_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "update has failed");
@@ -1097,9 +1233,8 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             OIC_LOG(DEBUG, TAG, "received response message with block option2");
 
             // check the size option
-            bool isSizeOption = CAIsPayloadLengthInPduWithBlockSizeOption(pdu,
-                                                                          COAP_OPTION_SIZE2,
-                                                                          &(data->payloadLength));
+            CAIsPayloadLengthInPduWithBlockSizeOption(pdu, COAP_OPTION_SIZE2,
+                                                      &(data->payloadLength));
 
             uint32_t responseCode = CA_RESPONSE_CODE(pdu->transport_hdr->udp.code);
             if (CA_REQUEST_ENTITY_INCOMPLETE != responseCode && CA_REQUEST_ENTITY_TOO_LARGE != responseCode)
@@ -1113,7 +1248,7 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             {
                 // store the received payload and merge
                 res = CAUpdatePayloadData(data, receivedData, blockWiseStatus,
-                                          isSizeOption, COAP_OPTION_BLOCK2);
+                                          &block, COAP_OPTION_BLOCK2);
                 if (CA_STATUS_OK != res)
                 {
                     OIC_LOG(ERROR, TAG, "update has failed");
@@ -1968,13 +2103,78 @@ uint8_t CACheckBlockErrorType(CABlockData_t *currData, coap_block_t *receivedBlo
     return CA_BLOCK_UNKNOWN;
 }
 
+static CAResult_t CAReservePayloadData(CABlockData_t *currData, size_t requiredLen)
+{
+    if (requiredLen <= currData->payloadCapacity)
+    {
+        return CA_STATUS_OK;
+    }
+
+    size_t capacity = 0;
+    if (currData->payloadLength >= requiredLen
+        && currData->payloadLength <= CA_MAX_BLOCKWISE_PAYLOAD)
+    {
+        // the size option announced a plausible total payload length
+        capacity = currData->payloadLength;
+    }
+    else
+    {
+        capacity = (currData->payloadCapacity <= SIZE_MAX / 2) ?
+                currData->payloadCapacity * 2 : SIZE_MAX;
+        if (capacity < requiredLen)
+        {
+            capacity = requiredLen;
+        }
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "allocate %" PRIuPTR " bytes for the total payload", capacity);
+    CAPayload_t newPayload = OICRealloc(currData->payload, capacity);
+    if (NULL == newPayload)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    currData->payload = newPayload;
+    currData->payloadCapacity = capacity;
+
+    return CA_STATUS_OK;
+}
+
+static bool CANotifyBlockPayload(CABlockData_t *currData, const CAData_t *receivedData,
+                                 const CAPayload_t blockPayload, size_t blockPayloadLen,
+                                 bool isLast)
+{
+    CABlockPayloadCallback callback = g_context.blockPayloadCallback;
+    if (!callback || !currData->sentData)
+    {
+        return currData->isPayloadConsumed;
+    }
+
+    const CAInfo_t *receivedInfo = receivedData->requestInfo ?
+            &receivedData->requestInfo->info : &receivedData->responseInfo->info;
+    CAInfo_t info = *receivedInfo;
+    info.payload = blockPayload;
+    info.payloadSize = blockPayloadLen;
+
+    size_t offset = currData->receivedPayloadLen;
+    bool isConsumed = callback(currData->sentData->remoteEndpoint, &info, offset,
+                               currData->payloadLength, isLast);
+    if (0 == offset)
+    {
+        currData->isPayloadConsumed = isConsumed;
+    }
+    return currData->isPayloadConsumed;
+}
+
 CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *receivedData,
-                               uint8_t status, bool isSizeOption, uint16_t blockType)
+                               uint8_t status, const coap_block_t *block,
+                               uint16_t blockType)
 {
     OIC_LOG(DEBUG, TAG, "IN-UpdatePayloadData");
 
     VERIFY_NON_NULL(currData, TAG, "currData");
     VERIFY_NON_NULL(receivedData, TAG, "receivedData");
+    VERIFY_NON_NULL(block, TAG, "block");
 
     // if error code is 4.08, do not update payload
     if (CA_BLOCK_INCOMPLETE == status)
@@ -1988,51 +2188,27 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
 
     if (CA_BLOCK_TOO_LARGE == status)
     {
-        blockPayloadLen = (COAP_OPTION_BLOCK2 == blockType) ?
+        size_t blockSize = (COAP_OPTION_BLOCK2 == blockType) ?
                 BLOCK_SIZE(currData->block2.szx) : BLOCK_SIZE(currData->block1.szx);
+        if (blockPayloadLen > blockSize)
+        {
+            blockPayloadLen = blockSize;
+        }
     }
 
-    // memory allocation for the received block payload
-    size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        bool isLast = (0 == block->m && CA_BLOCK_TOO_LARGE != status);
+        if (!CANotifyBlockPayload(currData, receivedData, blockPayload, blockPayloadLen,
+                                  isLast))
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
-            {
-                CAPayload_t prePayload = currData->payload;
-
-                OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
-                {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
-            }
-
-            // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
-        }
-        else
-        {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
-
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
+            // append the block to the total payload
+            size_t prePayloadLen = currData->receivedPayloadLen;
+            CAResult_t res = CAReservePayloadData(currData, prePayloadLen + blockPayloadLen);
+            if (CA_STATUS_OK != res)
             {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return CA_MEMORY_ALLOC_FAILED;
+                return res;
             }
-
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
             memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
         }
 
@@ -2293,17 +2469,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID, uint16_t bloc
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2318,16 +2490,12 @@ uint16_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return currData->type;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2341,15 +2509,11 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData->sentData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2364,17 +2528,13 @@ CABlockData_t *CAUpdateDataSetFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CADestroyDataSet(currData->sentData);
-            currData->sentData = CACloneCAData(sendData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
+        CADestroyDataSet(currData->sentData);
+        currData->sentData = CACloneCAData(sendData);
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2391,15 +2551,8 @@ CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    for (CABlockData_t *currData = g_context.idleHead; currData; currData = currData->idleNext)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (NULL == currData)
-        {
-            continue;
-        }
-
         if (NULL != currData->sentData && NULL != currData->sentData->requestInfo)
         {
             if (pdu->transport_hdr->udp.id == currData->sentData->requestInfo->info.messageId &&
@@ -2471,15 +2624,11 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2493,28 +2642,23 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockTyp
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    coap_block_t *block = NULL;
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else if (COAP_OPTION_BLOCK1 == blockType)
-            {
-                return &currData->block1;
-            }
+            block = &currData->block2;
+        }
+        else if (COAP_OPTION_BLOCK1 == blockType)
+        {
+            block = &currData->block1;
         }
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-    return NULL;
+    return block;
 }
 
 CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
@@ -2526,17 +2670,13 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
-        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        *fullPayloadLen = currData->receivedPayloadLen;
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return currData->payload;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2544,6 +2684,43 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
     return NULL;
 }
 
+CAPayload_t CATakePayloadFromBlockDataList(const CABlockDataID_t *blockID,
+                                           size_t *fullPayloadLen)
+{
+    VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
+    VERIFY_NON_NULL_RET(fullPayloadLen, TAG, "fullPayloadLen", NULL);
+
+    CAPayload_t payload = NULL;
+
+    oc_mutex_lock(g_context.blockDataListMutex);
+
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData && currData->payload)
+    {
+        payload = currData->payload;
+        *fullPayloadLen = currData->receivedPayloadLen;
+        if (currData->payloadCapacity > *fullPayloadLen && *fullPayloadLen)
+        {
+            // give back the unused end of a geometrically grown buffer
+            CAPayload_t shrunk = OICRealloc(payload, *fullPayloadLen);
+            if (shrunk)
+            {
+                payload = shrunk;
+            }
+        }
+        currData->payload = NULL;
+        currData->payloadCapacity = 0;
+    }
+    oc_mutex_unlock(g_context.blockDataListMutex);
+
+    return payload;
+}
+
+void CASetBlockPayloadCallback(CABlockPayloadCallback blockPayloadCallback)
+{
+    g_context.blockPayloadCallback = blockPayloadCallback;
+}
+
 CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 {
     OIC_LOG(DEBUG, TAG, "IN-CACreateNewBlockData");
@@ -2604,16 +2781,29 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    bool res = u_arraylist_add(g_context.dataList, (void *) data);
+    CABlockData_t *staleData = (CABlockData_t *) u_hashmap_get(g_context.dataMap,
+                                                               blockDataID->id,
+                                                               blockDataID->idLength);
+    bool res = u_hashmap_put(g_context.dataMap, blockDataID->id, blockDataID->idLength,
+                             (void *) data);
     if (!res)
     {
         OIC_LOG(ERROR, TAG, "add has failed");
-        CADestroyBlockID(data->blockDataId);
-        CADestroyDataSet(data->sentData);
-        OICFree(data);
+        CADestroyBlockData(data);
         oc_mutex_unlock(g_context.blockDataListMutex);
         return NULL;
     }
+
+    if (staleData)
+    {
+        // the new exchange supersedes an unfinished one with the same token and endpoint
+        OIC_LOG(DEBUG, TAG, "replace block data with the same id");
+        CAUnlinkIdleBlockData(staleData);
+        CADestroyBlockData(staleData);
+    }
+
+    data->lastActivity = OICGetCurrentTime(TIME_IN_MS);
+    CAAppendIdleBlockData(data);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
@@ -2627,28 +2817,12 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = blockID->id ?
+            (CABlockData_t *) u_hashmap_get(g_context.dataMap, blockID->id, blockID->idLength) :
+            NULL;
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
-            {
-                OIC_LOG(ERROR, TAG, "data is NULL");
-                oc_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
-
-            // destroy memory
-            CADestroyDataSet(removedData->sentData);
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
-        }
+        CARemoveBlockData(currData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2661,27 +2835,35 @@ CAResult_t CARemoveAllBlockDataFromList()
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = len; i > 0; i--)
+    while (g_context.idleHead)
     {
-        CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i - 1);
-        if (removedData)
-        {
-            // destroy memory
-            if (removedData->sentData)
-            {
-                CADestroyDataSet(removedData->sentData);
-            }
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
-        }
+        CARemoveBlockData(g_context.idleHead);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     return CA_STATUS_OK;
 }
 
+size_t CARemoveExpiredBlockData(uint64_t currentTime)
+{
+    size_t removed = 0;
+
+    oc_mutex_lock(g_context.blockDataListMutex);
+
+    // the list is ordered by last use, so the sweep stops at the first active transfer
+    while (g_context.idleHead
+           && currentTime > g_context.idleHead->lastActivity
+           && currentTime - g_context.idleHead->lastActivity >= CA_BLOCK_DATA_IDLE_TIMEOUT_MS)
+    {
+        OIC_LOG(DEBUG, TAG, "remove block data of an idle transfer");
+        CARemoveBlockData(g_context.idleHead);
+        removed++;
+    }
+    oc_mutex_unlock(g_context.blockDataListMutex);
+
+    return removed;
+}
+
 void CADestroyDataSet(CAData_t* data)
 {
     VERIFY_NON_NULL_VOID(data, TAG, "data");
@@ -40,6 +40,10 @@
 #include "catcpadapter.h"
 #endif
 
+#ifdef WITH_BWT
+#include "cablockwisetransfer.h"
+#endif
+
 CAGlobals_t caglobals = { .clientFlags = 0,
                           .serverFlags = 0, };
 
@@ -137,6 +141,19 @@ void CARegisterHandler(CARequestCallback ReqHandler, CAResponseCallback RespHand
     CASetInterfaceCallbacks(ReqHandler, RespHandler, ErrorHandler);
 }
 
+void CARegisterReceiveQueueHandler(CAReceiveQueueCallback receiveQueueHandler)
+{
+    OIC_LOG(DEBUG, TAG, "CARegisterReceiveQueueHandler");
+
+    if (!g_isInitialized)
+    {
+        OIC_LOG(DEBUG, TAG, "CA is not initialized");
+        return;
+    }
+
+    CASetReceiveQueueCallback(receiveQueueHandler);
+}
+
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
 
 CAResult_t CAGetSecureEndpointData(const CAEndpoint_t *peer, CASecureEndpoint_t *sep)
@@ -635,3 +652,10 @@ void CARegisterKeepAliveHandler(CAKeepAliveConnectionCallback ConnHandler)
     CATCPSetKeepAliveCallbacks(ConnHandler);
 }
 #endif
+
+#ifdef WITH_BWT
+void CARegisterBlockPayloadHandler(CABlockPayloadCallback blockPayloadHandler)
+{
+    CASetBlockPayloadCallback(blockPayloadHandler);
+}
+#endif
@@ -54,6 +54,15 @@
 #define SINGLE_HANDLE
 #define MAX_THREAD_POOL_SIZE    20
 
+// capacity of the send and receive rings
+#define CA_SEND_QUEUE_CAPACITY      1024
+#ifndef CA_RECEIVE_QUEUE_CAPACITY
+#define CA_RECEIVE_QUEUE_CAPACITY   1024
+#endif
+
+// receive ring capacity used by the next CAInitializeMessageHandler
+static uint32_t g_receiveQueueCapacity = CA_RECEIVE_QUEUE_CAPACITY;
+
 // thread pool handle
 static ca_thread_pool_t g_threadPoolHandle = NULL;
 
@@ -74,6 +83,7 @@ static CARequestCallback g_requestHandler = NULL;
 static CAResponseCallback g_responseHandler = NULL;
 static CAErrorCallback g_errorHandler = NULL;
 static CANetworkMonitorCallback g_nwMonitorHandler = NULL;
+static CAReceiveQueueCallback g_receiveQueueHandler = NULL;
 
 static void CAErrorHandler(const CAEndpoint_t *endpoint,
                            const void *data, size_t dataLen,
@@ -101,6 +111,58 @@ static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoi
  */
 static void CALogPDUInfo(const CAData_t *data, const coap_pdu_t *pdu);
 
+#ifndef SINGLE_THREAD
+/**
+ * Add received data to the receive queue. When the queue is full the data is
+ * destroyed and, if it is a unicast request from the network, the sender gets
+ * a 5.03 response so it can retry later instead of waiting for a timeout.
+ * @param[in] data          received data, owned by the queue afterwards.
+ * @param[in] replyIfFull   true to answer a refused request with 5.03.
+ * @return  CA_STATUS_OK if the data was queued.
+ */
+static CAResult_t CAQueueReceivedData(CAData_t *data, bool replyIfFull)
+{
+    CAResult_t res = CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+    if (CA_STATUS_OK == res)
+    {
+        if (g_receiveQueueHandler)
+        {
+            g_receiveQueueHandler();
+        }
+        return res;
+    }
+
+    CARequestInfo_t *request = data->requestInfo;
+    if (replyIfFull && request && !request->isMulticast && data->remoteEndpoint)
+    {
+        OIC_LOG(WARNING, TAG, "receive queue is full, responding with 5.03");
+
+        CAResponseInfo_t response = { .result = CA_SERVICE_UNAVAILABLE };
+        response.info.type = (CA_MSG_CONFIRM == request->info.type) ?
+                             CA_MSG_ACKNOWLEDGE : CA_MSG_NONCONFIRM;
+        response.info.messageId = (CA_MSG_CONFIRM == request->info.type) ?
+                                  request->info.messageId : 0;
+        response.info.token = request->info.token;
+        response.info.tokenLength = request->info.tokenLength;
+        response.info.resourceUri = request->info.resourceUri;
+        response.info.dataType = CA_RESPONSE_DATA;
+
+        if (CA_STATUS_OK != CADetachSendMessage(data->remoteEndpoint, &response,
+                                                CA_RESPONSE_DATA))
+        {
+            OIC_LOG(ERROR, TAG, "failed to send 5.03 for refused request");
+        }
+    }
+    else
+    {
+        OIC_LOG(WARNING, TAG, "receive queue is full, received data dropped");
+    }
+
+    CADestroyData(data, sizeof(CAData_t));
+    return res;
+}
+#endif // SINGLE_THREAD
+
 #ifdef WITH_BWT
 void CAAddDataToSendThread(CAData_t *data)
 {
@@ -115,7 +177,7 @@ void CAAddDataToReceiveThread(CAData_t *data)
     VERIFY_NON_NULL_VOID(data, TAG, "data");
 
     // add thread
-    CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+    CAQueueReceivedData(data, true);
 }
 #endif
 
@@ -333,7 +395,7 @@ static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uin
 #ifdef SINGLE_THREAD
     CAProcessReceivedData(cadata);
 #else
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAQueueReceivedData(cadata, false);
 #endif
 }
 
@@ -831,7 +893,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         if (CA_NOT_SUPPORTED == res || CA_REQUEST_TIMEOUT == res)
         {
             OIC_LOG(DEBUG, TAG, "this message does not have block option");
-            CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+            CAQueueReceivedData(cadata, true);
         }
         else
         {
@@ -841,7 +903,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     else
 #endif
     {
-        CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+        CAQueueReceivedData(cadata, true);
     }
 #endif // SINGLE_THREAD
 
@@ -861,42 +923,41 @@ void CAHandleRequestResponseCallbacks()
     CARetransmissionBaseRoutine((void *)&g_retransmissionContext);
 #else
 #ifdef SINGLE_HANDLE
-    // parse the data and call the callbacks.
-    // #1 parse the data
-    // #2 get endpoint
-
-    oc_mutex_lock(g_receiveThread.threadMutex);
-
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
-
-    oc_mutex_unlock(g_receiveThread.threadMutex);
-
-    if (NULL == item || NULL == item->msg)
+    // Handle what is queued now; data arriving meanwhile waits for the next
+    // call so a busy network cannot keep the caller here.
+    uint32_t count = u_ringbuffer_get_size(g_receiveThread.dataRing);
+    while (count--)
     {
-        return;
-    }
+        u_queue_message_t item;
+        if (!u_ringbuffer_pop(g_receiveThread.dataRing, &item))
+        {
+            break;
+        }
+        if (NULL == item.msg)
+        {
+            continue;
+        }
 
-    // get endpoint
-    CAData_t *td = (CAData_t *) item->msg;
+        CAData_t *td = (CAData_t *) item.msg;
 
-    if (td->requestInfo && g_requestHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
-        g_requestHandler(td->remoteEndpoint, td->requestInfo);
-    }
-    else if (td->responseInfo && g_responseHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
-        g_responseHandler(td->remoteEndpoint, td->responseInfo);
-    }
-    else if (td->errorInfo && g_errorHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
-        g_errorHandler(td->remoteEndpoint, td->errorInfo);
-    }
+        if (td->requestInfo && g_requestHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
+            g_requestHandler(td->remoteEndpoint, td->requestInfo);
+        }
+        else if (td->responseInfo && g_responseHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
+            g_responseHandler(td->remoteEndpoint, td->responseInfo);
+        }
+        else if (td->errorInfo && g_errorHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
+            g_errorHandler(td->remoteEndpoint, td->errorInfo);
+        }
 
-    CADestroyData(item->msg, sizeof(CAData_t));
-    OICFree(item);
+        CADestroyData(item.msg, sizeof(CAData_t));
+    }
 
 #endif // SINGLE_HANDLE
 #endif // SINGLE_THREAD
@@ -988,7 +1049,7 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
 
 #ifdef ARDUINO
     // If max retransmission queue is reached, then don't handle new request
-    if (CA_MAX_RT_ARRAY_SIZE == u_arraylist_length(g_retransmissionContext.dataList))
+    if (CA_MAX_RT_ARRAY_SIZE == g_retransmissionContext.dataCount)
     {
         OIC_LOG(ERROR, TAG, "max RT queue size reached!");
         return CA_SEND_FAILED;
@@ -1028,8 +1089,9 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     {
         OIC_LOG(DEBUG, TAG,
                 "This is a loopback message. Transfer it to the receive queue directly");
-        CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
-        return CA_STATUS_OK;
+        // The local sender is told directly rather than through a 5.03.
+        return (CA_STATUS_OK == CAQueueReceivedData(data, false)) ? CA_STATUS_OK
+                                                                   : CA_SEND_FAILED;
     }
 #ifdef WITH_BWT
     if (CAIsSupportedBlockwiseTransfer(endpoint->adapter))
@@ -1071,6 +1133,29 @@ void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler)
     g_nwMonitorHandler = nwMonitorHandler;
 }
 
+void CASetReceiveQueueCallback(CAReceiveQueueCallback receiveQueueHandler)
+{
+    g_receiveQueueHandler = receiveQueueHandler;
+}
+
+void CASetReceiveQueueCapacity(uint32_t capacity)
+{
+#ifndef SINGLE_THREAD
+    g_receiveQueueCapacity = capacity ? capacity : CA_RECEIVE_QUEUE_CAPACITY;
+#else
+    (void)capacity;
+#endif
+}
+
+uint32_t CAGetReceiveQueueOverflowCount()
+{
+#ifndef SINGLE_THREAD
+    return CAQueueingThreadGetOverflowCount(&g_receiveThread);
+#else
+    return 0;
+#endif
+}
+
 CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
 {
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
@@ -1086,8 +1171,10 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     }
 
     // send thread initialize
-    res = CAQueueingThreadInitialize(&g_sendThread, g_threadPoolHandle,
-                                     CASendThreadProcess, CADestroyData);
+    // Senders wait for room rather than lose data.
+    res = CAQueueingThreadInitializeRing(&g_sendThread, g_threadPoolHandle,
+                                         CASendThreadProcess, CADestroyData,
+                                         CA_SEND_QUEUE_CAPACITY, CA_QUEUE_OVERFLOW_BLOCK);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize send queue thread");
@@ -1103,8 +1190,12 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     }
 
     // receive thread initialize
-    res = CAQueueingThreadInitialize(&g_receiveThread, g_threadPoolHandle,
-                                     CAReceiveThreadProcess, CADestroyData);
+    // New data is refused when the application falls behind, so requests
+    // already queued are kept and refused requests get a 5.03.
+    res = CAQueueingThreadInitializeRing(&g_receiveThread, g_threadPoolHandle,
+                                         CAReceiveThreadProcess, CADestroyData,
+                                         g_receiveQueueCapacity,
+                                         CA_QUEUE_OVERFLOW_REJECT);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize receive queue thread");
@@ -1173,6 +1264,8 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
 
 void CATerminateMessageHandler()
 {
+    g_receiveQueueHandler = NULL;
+
 #ifndef SINGLE_THREAD
     // stop adapters
     CAStopAdapters();
@@ -1294,7 +1387,7 @@ void CAErrorHandler(const CAEndpoint_t *endpoint,
 
     cadata->errorInfo->result = result;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAQueueReceivedData(cadata, false);
     coap_delete_pdu(pdu);
 #else
     (void)result;
@@ -1347,7 +1440,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     cadata->errorInfo = errorInfo;
     cadata->dataType = CA_ERROR_DATA;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAQueueReceivedData(cadata, false);
 #endif
     OIC_LOG(DEBUG, TAG, "CASendErrorInfo OUT");
 }
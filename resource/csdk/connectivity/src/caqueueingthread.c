@@ -19,6 +19,7 @@
  ******************************************************************/
 
 #include "iotivity_config.h"
+#include "platform_features.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,10 +32,29 @@
 
 #include "caqueueingthread.h"
 #include "oic_malloc.h"
+#include "ocatomic.h"
 #include "logger.h"
 
 #define TAG PCF("OIC_CA_QING")
 
+/** Number of data the ring backed thread takes from the ring at once. **/
+#define CA_QUEUEING_THREAD_BATCH_SIZE 16
+
+/** Time a producer waits for room in a full ring before checking again. **/
+#define CA_QUEUEING_THREAD_SPACE_WAIT_US 10000
+
+static void CAQueueingThreadDestroyData(CAQueueingThread_t *thread, void *data, uint32_t size)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(data, size);
+    }
+    else
+    {
+        OICFree(data);
+    }
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -103,6 +123,60 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
     OIC_LOG(DEBUG, TAG, "message handler main thread end..");
 }
 
+static void CAQueueingThreadRingRoutine(void *threadValue)
+{
+    OIC_LOG(DEBUG, TAG, "message handler ring thread start..");
+
+    CAQueueingThread_t *thread = (CAQueueingThread_t *) threadValue;
+
+    if (NULL == thread)
+    {
+        OIC_LOG(ERROR, TAG, "thread data passing error!!");
+        return;
+    }
+
+    u_queue_message_t messages[CA_QUEUEING_THREAD_BATCH_SIZE];
+
+    while (!thread->isStop)
+    {
+        uint32_t count = u_ringbuffer_pop_batch(thread->dataRing, messages,
+                                                CA_QUEUEING_THREAD_BATCH_SIZE);
+        if (0 == count)
+        {
+            // Producers only signal when they see waitingForData, which is set
+            // before the ring is checked again under the mutex.
+            oc_mutex_lock(thread->threadMutex);
+            oc_atomic_increment(&thread->waitingForData);
+            if (!thread->isStop && 0 == u_ringbuffer_get_size(thread->dataRing))
+            {
+                oc_cond_wait(thread->threadCond, thread->threadMutex);
+            }
+            oc_atomic_decrement(&thread->waitingForData);
+            oc_mutex_unlock(thread->threadMutex);
+            continue;
+        }
+
+        if (oc_atomic_add(&thread->waitingForSpace, 0))
+        {
+            oc_mutex_lock(thread->threadMutex);
+            oc_cond_broadcast(thread->spaceCond);
+            oc_mutex_unlock(thread->threadMutex);
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            thread->threadTask(messages[i].msg);
+            CAQueueingThreadDestroyData(thread, messages[i].msg, messages[i].size);
+        }
+    }
+
+    oc_mutex_lock(thread->threadMutex);
+    oc_cond_signal(thread->threadCond);
+    oc_mutex_unlock(thread->threadMutex);
+
+    OIC_LOG(DEBUG, TAG, "message handler ring thread end..");
+}
+
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy)
 {
@@ -128,6 +202,11 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     thread->isStop = true;
     thread->threadTask = task;
     thread->destroy = destroy;
+    thread->dataRing = NULL;
+    thread->spaceCond = NULL;
+    thread->waitingForData = 0;
+    thread->waitingForSpace = 0;
+    thread->overflowCount = 0;
     if (NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
     {
         goto ERROR_MEM_FAILURE;
@@ -154,6 +233,30 @@ ERROR_MEM_FAILURE:
     return CA_MEMORY_ALLOC_FAILED;
 }
 
+CAResult_t CAQueueingThreadInitializeRing(CAQueueingThread_t *thread, ca_thread_pool_t handle,
+                                          CAThreadTask task, CADataDestroyFunction destroy,
+                                          uint32_t capacity, CAQueueOverflowPolicy_t policy)
+{
+    CAResult_t res = CAQueueingThreadInitialize(thread, handle, task, destroy);
+    if (CA_STATUS_OK != res)
+    {
+        return res;
+    }
+
+    // dataQueue stays empty, all data goes through the ring.
+    thread->dataRing = u_ringbuffer_create(capacity);
+    thread->spaceCond = oc_cond_new();
+    thread->overflowPolicy = policy;
+    if (NULL == thread->dataRing || NULL == thread->spaceCond)
+    {
+        OIC_LOG(ERROR, TAG, "ring initialize error.");
+        CAQueueingThreadDestroy(thread);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -180,7 +283,9 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
     // mutex unlock
     oc_mutex_unlock(thread->threadMutex);
 
-    CAResult_t res = ca_thread_pool_add_task(thread->threadPool, CAQueueingThreadBaseRoutine,
+    CAResult_t res = ca_thread_pool_add_task(thread->threadPool,
+                                             thread->dataRing ? CAQueueingThreadRingRoutine
+                                                              : CAQueueingThreadBaseRoutine,
                                              thread);
     if (res != CA_STATUS_OK)
     {
@@ -195,6 +300,67 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
     return res;
 }
 
+static CAResult_t CAQueueingThreadAddRingData(CAQueueingThread_t *thread, void *data,
+                                              uint32_t size)
+{
+    u_queue_message_t message = { .msg = data, .size = size };
+
+    while (!u_ringbuffer_push(thread->dataRing, &message))
+    {
+        if (CA_QUEUE_OVERFLOW_DROP_OLDEST == thread->overflowPolicy)
+        {
+            // Popping here is safe, the ring allows concurrent consumers.
+            u_queue_message_t oldest;
+            if (u_ringbuffer_pop(thread->dataRing, &oldest))
+            {
+                int32_t overflowCount = oc_atomic_increment(&thread->overflowCount);
+                OIC_LOG_V(WARNING, TAG, "queue is full, oldest data dropped (%d so far)",
+                          overflowCount);
+                OC_UNUSED(overflowCount);
+                CAQueueingThreadDestroyData(thread, oldest.msg, oldest.size);
+            }
+        }
+        else if (CA_QUEUE_OVERFLOW_REJECT == thread->overflowPolicy)
+        {
+            int32_t overflowCount = oc_atomic_increment(&thread->overflowCount);
+            OIC_LOG_V(WARNING, TAG, "queue is full, data refused (%d so far)", overflowCount);
+            OC_UNUSED(overflowCount);
+            return CA_STATUS_FAILED;
+        }
+        else if (CA_QUEUE_OVERFLOW_BLOCK == thread->overflowPolicy && !thread->isStop)
+        {
+            oc_mutex_lock(thread->threadMutex);
+            oc_atomic_increment(&thread->waitingForSpace);
+            if (!thread->isStop
+                && u_ringbuffer_get_size(thread->dataRing) >= thread->dataRing->capacity)
+            {
+                oc_cond_wait_for(thread->spaceCond, thread->threadMutex,
+                                 CA_QUEUEING_THREAD_SPACE_WAIT_US);
+            }
+            oc_atomic_decrement(&thread->waitingForSpace);
+            oc_mutex_unlock(thread->threadMutex);
+        }
+        else
+        {
+            // Drop newest, or nobody is draining a blocking queue.
+            int32_t overflowCount = oc_atomic_increment(&thread->overflowCount);
+            OIC_LOG_V(ERROR, TAG, "queue is full, data dropped (%d so far)", overflowCount);
+            OC_UNUSED(overflowCount);
+            CAQueueingThreadDestroyData(thread, data, size);
+            return CA_SEND_FAILED;
+        }
+    }
+
+    if (oc_atomic_add(&thread->waitingForData, 0))
+    {
+        oc_mutex_lock(thread->threadMutex);
+        oc_cond_signal(thread->threadCond);
+        oc_mutex_unlock(thread->threadMutex);
+    }
+
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size)
 {
     if (NULL == thread)
@@ -209,6 +375,11 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
+    if (thread->dataRing)
+    {
+        return CAQueueingThreadAddRingData(thread, data, size);
+    }
+
     // create thread data
     u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
 
@@ -236,6 +407,15 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
     return CA_STATUS_OK;
 }
 
+uint32_t CAQueueingThreadGetOverflowCount(CAQueueingThread_t *thread)
+{
+    if (NULL == thread)
+    {
+        return 0;
+    }
+    return (uint32_t) oc_atomic_add(&thread->overflowCount, 0);
+}
+
 CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -274,12 +454,28 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
     u_queue_delete(thread->dataQueue);
     thread->dataQueue = NULL;
 
+    if (thread->dataRing)
+    {
+        u_queue_message_t message;
+        while (u_ringbuffer_pop(thread->dataRing, &message))
+        {
+            CAQueueingThreadDestroyData(thread, message.msg, message.size);
+        }
+        u_ringbuffer_delete(thread->dataRing);
+        thread->dataRing = NULL;
+    }
+
     // mutex unlock
     oc_mutex_unlock(thread->threadMutex);
 
     oc_mutex_free(thread->threadMutex);
     thread->threadMutex = NULL;
     oc_cond_free(thread->threadCond);
+    if (thread->spaceCond)
+    {
+        oc_cond_free(thread->spaceCond);
+        thread->spaceCond = NULL;
+    }
 
     return CA_STATUS_OK;
 }
@@ -75,9 +75,11 @@
 
 #define TAG "OIC_CA_RETRANS"
 
-typedef struct
+typedef struct CARetransmissionData_t
 {
     uint64_t timeStamp;                 /**< last sent time. microseconds */
+    uint64_t nextTime;                  /**< next retransmission time. microseconds */
+    size_t heapIndex;                   /**< position in dataHeap + 1, 0 if not queued */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
@@ -93,6 +95,26 @@ static const uint64_t USECS_PER_SEC = 1000000;
 static const uint64_t USECS_PER_MSEC = 1000;
 static const uint64_t MSECS_PER_SEC = 1000;
 
+/** initial size of the retransmission heap. **/
+#define RETRANSMISSION_HEAP_INITIAL_SIZE 8
+
+/**
+ * Key of the dataIndex map. Messages are matched by adapter and message id.
+ */
+typedef struct
+{
+    uint16_t messageId;
+    CATransportAdapter_t adapter;
+} CARetransmissionKey_t;
+
+static void CAMakeRetransmissionKey(CATransportAdapter_t adapter, uint16_t messageId,
+                                    CARetransmissionKey_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->messageId = messageId;
+    key->adapter = adapter;
+}
+
 #ifndef SINGLE_THREAD
 /**
  * @brief   timeout value is
@@ -141,36 +163,142 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 #endif
 
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   calculate the time the data is due for retransmission
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  microseconds
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetNextRetransmissionTime(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint64_t milliTimeoutValue = retData->timeout / USECS_PER_MSEC;
     uint64_t timeout = (milliTimeoutValue << retData->triedCount) * USECS_PER_MSEC;
+#else
+    uint64_t timeout = (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+#endif
+    return retData->timeStamp + timeout;
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+static void CASetHeapNode(CARetransmission_t *context, size_t pos,
+                          CARetransmissionData_t *retData)
+{
+    context->dataHeap[pos] = retData;
+    retData->heapIndex = pos + 1;
+}
+
+static void CASiftUpHeap(CARetransmission_t *context, size_t pos)
+{
+    CARetransmissionData_t *retData = context->dataHeap[pos];
+    while (pos > 0)
     {
-        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
-                  timeout, retData->triedCount);
-        return true;
+        size_t parent = (pos - 1) / 2;
+        if (context->dataHeap[parent]->nextTime <= retData->nextTime)
+        {
+            break;
+        }
+        CASetHeapNode(context, pos, context->dataHeap[parent]);
+        pos = parent;
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+    CASetHeapNode(context, pos, retData);
+}
 
-    if (currentTime >= retData->timeStamp + timeOut)
+static void CASiftDownHeap(CARetransmission_t *context, size_t pos)
+{
+    CARetransmissionData_t *retData = context->dataHeap[pos];
+    for (;;)
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        size_t child = 2 * pos + 1;
+        if (child >= context->dataCount)
+        {
+            break;
+        }
+        if (child + 1 < context->dataCount
+            && context->dataHeap[child + 1]->nextTime < context->dataHeap[child]->nextTime)
+        {
+            child++;
+        }
+        if (retData->nextTime <= context->dataHeap[child]->nextTime)
+        {
+            break;
+        }
+        CASetHeapNode(context, pos, context->dataHeap[child]);
+        pos = child;
     }
-#endif
-    return false;
+    CASetHeapNode(context, pos, retData);
+}
+
+/**
+ * @brief   add retransmission data to the heap and the index
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ * @return  CA_STATUS_OK or CA_MEMORY_ALLOC_FAILED
+ */
+static CAResult_t CAAddRetransmissionData(CARetransmission_t *context,
+                                          CARetransmissionData_t *retData)
+{
+    if (context->dataCount == context->dataCapacity)
+    {
+        size_t capacity = context->dataCapacity ?
+                          context->dataCapacity * 2 : RETRANSMISSION_HEAP_INITIAL_SIZE;
+        CARetransmissionData_t **heap = (CARetransmissionData_t **) OICRealloc(
+                context->dataHeap, capacity * sizeof(CARetransmissionData_t *));
+        if (NULL == heap)
+        {
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        context->dataHeap = heap;
+        context->dataCapacity = capacity;
+    }
+
+    CARetransmissionKey_t key;
+    CAMakeRetransmissionKey(retData->endpoint->adapter, retData->messageId, &key);
+    if (!u_hashmap_put(context->dataIndex, &key, sizeof(key), retData))
+    {
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    retData->nextTime = CAGetNextRetransmissionTime(retData);
+    CASetHeapNode(context, context->dataCount++, retData);
+    CASiftUpHeap(context, context->dataCount - 1);
+    return CA_STATUS_OK;
+}
+
+/**
+ * @brief   remove retransmission data from the heap and the index
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ */
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    CARetransmissionKey_t key;
+    CAMakeRetransmissionKey(retData->endpoint->adapter, retData->messageId, &key);
+    u_hashmap_remove(context->dataIndex, &key, sizeof(key));
+
+    if (!retData->heapIndex)
+    {
+        return;
+    }
+
+    size_t pos = retData->heapIndex - 1;
+    retData->heapIndex = 0;
+    context->dataCount--;
+    if (pos == context->dataCount)
+    {
+        return;
+    }
+
+    // Move the last node into the hole; it may need to go either way.
+    CARetransmissionData_t *last = context->dataHeap[context->dataCount];
+    CASetHeapNode(context, pos, last);
+    CASiftUpHeap(context, pos);
+    CASiftDownHeap(context, last->heapIndex - 1);
+}
+
+static void CADestroyRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
 }
 
 static void CACheckRetransmissionList(CARetransmission_t *context)
@@ -184,64 +312,49 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
 
-    for (size_t i = 0; i < len; i++)
+    // Only the data whose time is up is visited, earliest first.
+    while (context->dataCount > 0 && context->dataHeap[0]->nextTime <= currentTime)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
+        CARetransmissionData_t *retData = context->dataHeap[0];
 
-        if (NULL == retData)
-        {
-            continue;
-        }
-
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
+                  retData->nextTime - retData->timeStamp, retData->triedCount);
 
-        if (CACheckTimeout(currentTime, retData))
+        // #2. if time's up, send the data.
+        if (NULL != context->dataSendMethod)
         {
-            // #2. if time's up, send the data.
-            if (NULL != context->dataSendMethod)
-            {
-                OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
-                          retData->messageId);
-                context->dataSendMethod(retData->endpoint, retData->pdu,
-                                        retData->size, retData->dataType);
-            }
-
-            // #3. increase the retransmission count and update timestamp.
-            retData->timeStamp = currentTime;
-            retData->triedCount++;
+            OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
+                      retData->messageId);
+            context->dataSendMethod(retData->endpoint, retData->pdu,
+                                    retData->size, retData->dataType);
         }
 
-        // #4. if tried count is max, remove the retransmission data from list.
+        // #3. increase the retransmission count and update timestamp.
+        retData->timeStamp = currentTime;
+        retData->triedCount++;
+
+        // #4. if tried count is max, remove the retransmission data.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                oc_mutex_unlock(context->threadMutex);
-                return;
-            }
+            CARemoveRetransmissionData(context, retData);
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu,
+                                         retData->size);
             }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+            CADestroyRetransmissionData(retData);
+        }
+        else
+        {
+            retData->nextTime = CAGetNextRetransmissionTime(retData);
+            CASiftDownHeap(context, 0);
         }
     }
 
@@ -276,7 +389,7 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         oc_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        if (!context->isStop && 0 == context->dataCount)
         {
             // if list is empty, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
@@ -288,13 +401,19 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+            // sleep until the earliest retransmission is due. New data wakes
+            // the thread up, since it may be due earlier.
+            uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+            uint64_t nextTime = context->dataHeap[0]->nextTime;
+            if (nextTime > currentTime)
+            {
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
+                          nextTime - currentTime);
 
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            oc_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+                // wait (0 would mean wait forever)
+                oc_cond_wait_for(context->threadCond, context->threadMutex,
+                                 nextTime - currentTime);
+            }
         }
         else
         {
@@ -344,8 +463,10 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
 
     memset(context, 0, sizeof(CARetransmission_t));
 
-    CARetransmissionConfig_t cfg = { .supportType = DEFAULT_RETRANSMISSION_TYPE,
-                                     .tryingCount = DEFAULT_RETRANSMISSION_COUNT };
+    // The cast keeps the file valid C++ for caretransmission_test.cpp.
+    CARetransmissionConfig_t cfg =
+        { .supportType = (CATransportAdapter_t) DEFAULT_RETRANSMISSION_TYPE,
+          .tryingCount = DEFAULT_RETRANSMISSION_COUNT };
 
     if (config)
     {
@@ -360,7 +481,15 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->timeoutCallback = timeoutCallback;
     context->config = cfg;
     context->isStop = false;
-    context->dataList = u_arraylist_create();
+    context->dataHeap = NULL;
+    context->dataCount = 0;
+    context->dataCapacity = 0;
+    context->dataIndex = u_hashmap_create(0);
+    if (NULL == context->dataIndex)
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
 
     return CA_STATUS_OK;
 }
@@ -436,48 +565,43 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     retData->pdu = pduData;
     retData->size = size;
     retData->dataType = dataType;
-#ifndef SINGLE_THREAD
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
-
-    // #3. add data into list
-    for (size_t i = 0; i < len; i++)
+    // #3. add data into heap
+    CARetransmissionKey_t key;
+    CAMakeRetransmissionKey(endpoint->adapter, messageId, &key);
+    if (NULL != u_hashmap_get(context->dataIndex, &key, sizeof(key)))
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-        if (NULL == currData)
-        {
-            continue;
-        }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        CADestroyRetransmissionData(retData);
+        return CA_STATUS_FAILED;
+    }
 
-            // mutex unlock
-            oc_mutex_unlock(context->threadMutex);
+    if (CA_STATUS_OK != CAAddRetransmissionData(context, retData))
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
-    }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-    u_arraylist_add(context->dataList, (void *) retData);
+        CADestroyRetransmissionData(retData);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
 
+#ifndef SINGLE_THREAD
     // notify the thread
     oc_cond_signal(context->threadCond);
 
     // mutex unlock
     oc_mutex_unlock(context->threadMutex);
-
 #else
-    u_arraylist_add(context->dataList, (void *) retData);
+    // mutex unlock
+    oc_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -519,73 +643,50 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
 
     // mutex lock
     oc_mutex_lock(context->threadMutex);
-    size_t len = u_arraylist_length(context->dataList);
 
-    for (size_t i = 0; i < len; i++)
-    {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
+    CARetransmissionKey_t key;
+    CAMakeRetransmissionKey(endpoint->adapter, messageId, &key);
+    CARetransmissionData_t *retData =
+        (CARetransmissionData_t *) u_hashmap_get(context->dataIndex, &key, sizeof(key));
 
-        if (NULL == retData)
+    if (NULL != retData)
+    {
+        // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+        // if retransmission was finish..token will be unavailable.
+        if (CA_EMPTY == code)
         {
-            continue;
-        }
+            OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
+            if (NULL == retData->pdu)
             {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
+                OIC_LOG(ERROR, TAG, "retData->pdu is null");
+
+                // mutex unlock
+                oc_mutex_unlock(context->threadMutex);
+
+                return CA_STATUS_FAILED;
             }
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            // copy PDU data
+            (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+            if ((*retransmissionPdu) == NULL)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+                OIC_LOG(ERROR, TAG, "memory error");
 
                 // mutex unlock
                 oc_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy((*retransmissionPdu), retData->pdu, retData->size);
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // #2. remove data from heap
+        CARemoveRetransmissionData(context, retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+        OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+        CADestroyRetransmissionData(retData);
     }
 
     // mutex unlock
@@ -633,24 +734,20 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     OIC_LOG(DEBUG, TAG, "retransmission context destroy..");
 
     oc_mutex_lock(context->threadMutex);
-    size_t len = u_arraylist_length(context->dataList);
-    for (size_t i = 0; i < len; i++)
+    for (size_t i = 0; i < context->dataCount; i++)
     {
-        CARetransmissionData_t *data = u_arraylist_get(context->dataList, i);
-        if (NULL == data)
-        {
-            continue;
-        }
-        CAFreeEndpoint(data->endpoint);
-        OICFree(data->pdu);
-        OICFree(data);
+        CADestroyRetransmissionData(context->dataHeap[i]);
     }
+    OICFree(context->dataHeap);
+    context->dataHeap = NULL;
+    context->dataCount = 0;
+    context->dataCapacity = 0;
+    u_hashmap_free(&context->dataIndex);
     oc_mutex_unlock(context->threadMutex);
 
     oc_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     oc_cond_free(context->threadCond);
-    u_arraylist_free(&context->dataList);
 
     return CA_STATUS_OK;
 }
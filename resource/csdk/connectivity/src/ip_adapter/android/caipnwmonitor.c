@@ -510,6 +510,7 @@ Java_org_iotivity_ca_CaIpInterface_caIpStateEnabled(JNIEnv *env, jclass class)
 
     }
     u_arraylist_destroy(iflist);
+    CAIPRefreshMulticastInterfaces();
 }
 
 JNIEXPORT void JNICALL
@@ -520,6 +521,7 @@ Java_org_iotivity_ca_CaIpInterface_caIpStateDisabled(JNIEnv *env, jclass class)
 
     OIC_LOG(DEBUG, TAG, "Wifi is in Deactivated State");
     CAIPPassNetworkChangesToAdapter(CA_INTERFACE_DOWN);
+    CAIPRefreshMulticastInterfaces();
 }
 
 CAResult_t CAGetLinkLocalZoneIdInternal(uint32_t ifindex, char **zoneId)
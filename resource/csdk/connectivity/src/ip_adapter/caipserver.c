@@ -46,6 +46,10 @@
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
+#if defined(__linux__) && defined(HAVE_SYS_EPOLL_H)
+#include <sys/epoll.h>
+#define CA_IP_USE_EPOLL
+#endif
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
@@ -77,6 +81,14 @@
 #undef USE_IP_MREQN
 #endif
 
+/*
+ * Multicast sends pick the outgoing interface with packet info instead of
+ * setting IP_MULTICAST_IF / IPV6_MULTICAST_IF on the socket for every packet.
+ */
+#if !defined(_WIN32) && defined(IP_PKTINFO) && defined(IPV6_PKTINFO)
+#define CA_IP_SEND_PKTINFO
+#endif
+
 /*
  * Logging tag for module name
  */
@@ -89,6 +101,18 @@
 
 #define SELECT_TIMEOUT 1     // select() seconds (and termination latency)
 
+#ifdef CA_IP_USE_EPOLL
+#define CA_IP_EPOLL_EVENTS 16   // epoll events handled per wakeup
+#define CA_IP_RECV_BATCH   16   // datagrams read per recvmmsg() call
+#endif
+
+/*
+ * Most interfaces remembered for multicast sends, per address family.
+ */
+#ifndef CA_IP_MAX_MULTICAST_INTERFACES
+#define CA_IP_MAX_MULTICAST_INTERFACES 16
+#endif
+
 #define IPv4_MULTICAST     "224.0.1.187"
 static struct in_addr IPv4MulticastAddress = { 0 };
 
@@ -147,6 +171,26 @@ static CAIPErrorHandleCallback g_ipErrorHandler = NULL;
 
 static CAIPPacketReceivedCallback g_packetReceivedCallback = NULL;
 
+/*
+ * Interface that multicast messages are sent out of.
+ */
+typedef struct
+{
+    uint16_t family;
+    uint32_t index;
+} CAMulticastInterface_t;
+
+/*
+ * Snapshot of the interfaces that are up and running, so that multicast sends
+ * do not have to enumerate the interfaces for every packet. It is refreshed
+ * when the listen server starts and on every address change notification.
+ * The mutex is kept for the life of the process since sends may race with
+ * the server being stopped.
+ */
+static CAMulticastInterface_t g_multicastInterfaces[2 * CA_IP_MAX_MULTICAST_INTERFACES];
+static size_t g_multicastInterfaceCount = 0;
+static oc_mutex g_multicastInterfaceMutex = NULL;
+
 static void CAFindReadyMessage();
 #if !defined(WSA_WAIT_EVENT_0)
 static void CASelectReturned(fd_set *readFds, int ret);
@@ -155,10 +199,55 @@ static void CAEventReturned(CASocketFd_t socket);
 #endif
 
 static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags);
+static void CAProcessReceivedMessage(CATransportFlags_t flags,
+                                     struct sockaddr_storage *srcAddr, int namelen,
+                                     unsigned char *pktinfo, char *recvBuffer, size_t recvLen);
+
+#ifdef CA_IP_USE_EPOLL
+/**
+ * Control buffer large enough for the IPv4 and IPv6 packet info.
+ */
+typedef union
+{
+    struct cmsghdr cmsg;
+    unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+} CAIPControlBuffer_t;
+
+/**
+ * State owned by an epoll based receive thread. The sockets are registered
+ * once when the server starts and the buffers are reused for every read.
+ */
+typedef struct
+{
+    int epollFd;
+    struct mmsghdr msgs[CA_IP_RECV_BATCH];
+    struct iovec iovs[CA_IP_RECV_BATCH];
+    struct sockaddr_storage srcAddrs[CA_IP_RECV_BATCH];
+    CAIPControlBuffer_t controls[CA_IP_RECV_BATCH];
+    char buffers[CA_IP_RECV_BATCH][COAP_MAX_PDU_SIZE];
+} CAIPEpollContext_t;
+
+static CAIPEpollContext_t *CACreateEpollContext();
+static void CADestroyEpollContext(CAIPEpollContext_t *context);
+static void CAWaitForEpollEvents(CAIPEpollContext_t *context);
+#endif
 
 static void CAReceiveHandler(void *data)
 {
+#ifdef CA_IP_USE_EPOLL
+    CAIPEpollContext_t *context = (CAIPEpollContext_t *)data;
+    if (context)
+    {
+        while (!caglobals.ip.terminate)
+        {
+            CAWaitForEpollEvents(context);
+        }
+        CADestroyEpollContext(context);
+        return;
+    }
+#else
     (void)data;
+#endif
 
     while (!caglobals.ip.terminate)
     {
@@ -189,6 +278,28 @@ static void CAReceiveHandler(void *data)
     }
 
 
+static void CAHandleNetlinkEvent()
+{
+#if NETWORK_INTERFACE_CHANGED_LOGGING
+    OIC_LOG_V(DEBUG, TAG, "Netlink event detacted");
+#endif
+    u_arraylist_t *iflist = CAFindInterfaceChange();
+    if (iflist)
+    {
+        size_t listLength = u_arraylist_length(iflist);
+        for (size_t i = 0; i < listLength; i++)
+        {
+            CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
+            if (ifitem)
+            {
+                CAProcessNewInterface(ifitem);
+            }
+        }
+        u_arraylist_destroy(iflist);
+    }
+    CAIPRefreshMulticastInterfaces();
+}
+
 static void CAFindReadyMessage()
 {
     fd_set readFds;
@@ -258,23 +369,7 @@ static void CASelectReturned(fd_set *readFds, int ret)
         else ISSET(m4s, readFds, CA_MULTICAST | CA_IPV4 | CA_SECURE)
         else if ((caglobals.ip.netlinkFd != OC_INVALID_SOCKET) && FD_ISSET(caglobals.ip.netlinkFd, readFds))
         {
-#if NETWORK_INTERFACE_CHANGED_LOGGING
-            OIC_LOG_V(DEBUG, TAG, "Netlink event detacted");
-#endif
-            u_arraylist_t *iflist = CAFindInterfaceChange();
-            if (iflist)
-            {
-                size_t listLength = u_arraylist_length(iflist);
-                for (size_t i = 0; i < listLength; i++)
-                {
-                    CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-                    if (ifitem)
-                    {
-                        CAProcessNewInterface(ifitem);
-                    }
-                }
-                u_arraylist_destroy(iflist);
-            }
+            CAHandleNetlinkEvent();
             break;
         }
         else if (FD_ISSET(caglobals.ip.shutdownFds[0], readFds))
@@ -442,6 +537,7 @@ static void CAFindReadyMessage()
                             }
                             u_arraylist_destroy(iflist);
                         }
+                        CAIPRefreshMulticastInterfaces();
                         break;
                     }
 
@@ -510,6 +606,224 @@ static void CAEventReturned(CASocketFd_t socket)
 
 #endif
 
+#ifdef CA_IP_USE_EPOLL
+
+#define ADD_EPOLL(CONTEXT, TYPE, FLAGS) \
+    if (caglobals.ip.TYPE.fd != OC_INVALID_SOCKET) \
+    { \
+        if (!CAAddToEpoll(CONTEXT, caglobals.ip.TYPE.fd, FLAGS, true)) \
+        { \
+            goto exit; \
+        } \
+    }
+
+/**
+ * Registers fd with the epoll instance. The transport flags are stored next to
+ * the fd in the event data so no lookup is needed when the fd becomes ready.
+ */
+static bool CAAddToEpoll(CAIPEpollContext_t *context, int fd, CATransportFlags_t flags,
+                         bool edgeTriggered)
+{
+    struct epoll_event event = { .events = EPOLLIN };
+    if (edgeTriggered)
+    {
+        event.events |= EPOLLET;
+    }
+    event.data.u64 = ((uint64_t)(uint32_t)flags << 32) | (uint32_t)fd;
+
+    if (-1 == epoll_ctl(context->epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static CAIPEpollContext_t *CACreateEpollContext()
+{
+    CAIPEpollContext_t *context = (CAIPEpollContext_t *)OICCalloc(1, sizeof (CAIPEpollContext_t));
+    if (!context)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        return NULL;
+    }
+
+    context->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == context->epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed: %s", strerror(errno));
+        OICFree(context);
+        return NULL;
+    }
+
+    // Data sockets are drained completely on every event, so edge triggering
+    // avoids waking up again for datagrams that were already read.
+    ADD_EPOLL(context, u6,  CA_IPV6)
+    ADD_EPOLL(context, u6s, CA_IPV6 | CA_SECURE)
+    ADD_EPOLL(context, u4,  CA_IPV4)
+    ADD_EPOLL(context, u4s, CA_IPV4 | CA_SECURE)
+    ADD_EPOLL(context, m6,  CA_MULTICAST | CA_IPV6)
+    ADD_EPOLL(context, m6s, CA_MULTICAST | CA_IPV6 | CA_SECURE)
+    ADD_EPOLL(context, m4,  CA_MULTICAST | CA_IPV4)
+    ADD_EPOLL(context, m4s, CA_MULTICAST | CA_IPV4 | CA_SECURE)
+
+    // The netlink and shutdown handlers read one message at a time.
+    if (caglobals.ip.netlinkFd != OC_INVALID_SOCKET
+        && !CAAddToEpoll(context, caglobals.ip.netlinkFd, CA_DEFAULT_FLAGS, false))
+    {
+        goto exit;
+    }
+    if (caglobals.ip.shutdownFds[0] != -1
+        && !CAAddToEpoll(context, caglobals.ip.shutdownFds[0], CA_DEFAULT_FLAGS, false))
+    {
+        goto exit;
+    }
+
+    for (size_t i = 0; i < CA_IP_RECV_BATCH; i++)
+    {
+        context->iovs[i].iov_base = context->buffers[i];
+        context->iovs[i].iov_len = sizeof (context->buffers[i]);
+        context->msgs[i].msg_hdr.msg_iov = &context->iovs[i];
+        context->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    return context;
+
+exit:
+    CADestroyEpollContext(context);
+    return NULL;
+}
+
+static void CADestroyEpollContext(CAIPEpollContext_t *context)
+{
+    if (context)
+    {
+        close(context->epollFd);
+        OICFree(context);
+    }
+}
+
+/**
+ * Reads every datagram queued on a socket, CA_IP_RECV_BATCH at a time.
+ */
+static void CAReceiveMessages(CAIPEpollContext_t *context, int fd, CATransportFlags_t flags)
+{
+    int namelen = 0;
+    int level = 0;
+    int type = 0;
+    if (flags & CA_IPV6)
+    {
+        namelen = sizeof (struct sockaddr_in6);
+        level = IPPROTO_IPV6;
+        type = IPV6_PKTINFO;
+    }
+    else
+    {
+        namelen = sizeof (struct sockaddr_in);
+        level = IPPROTO_IP;
+        type = IP_PKTINFO;
+    }
+
+    while (!caglobals.ip.terminate)
+    {
+        for (size_t i = 0; i < CA_IP_RECV_BATCH; i++)
+        {
+            struct msghdr *hdr = &context->msgs[i].msg_hdr;
+            hdr->msg_name = &context->srcAddrs[i];
+            hdr->msg_namelen = namelen;
+            hdr->msg_control = &context->controls[i];
+            hdr->msg_controllen = sizeof (context->controls[i]);
+            hdr->msg_flags = 0;
+        }
+
+        int count = recvmmsg(fd, context->msgs, CA_IP_RECV_BATCH, MSG_DONTWAIT, NULL);
+        if (-1 == count)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+            {
+                OIC_LOG_V(ERROR, TAG, "recvmmsg failed %s", strerror(errno));
+            }
+            return;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            struct msghdr *hdr = &context->msgs[i].msg_hdr;
+            unsigned char *pktinfo = NULL;
+            for (struct cmsghdr *cmp = CMSG_FIRSTHDR(hdr); cmp != NULL;
+                 cmp = CMSG_NXTHDR(hdr, cmp))
+            {
+                if (cmp->cmsg_level == level && cmp->cmsg_type == type)
+                {
+                    pktinfo = CMSG_DATA(cmp);
+                }
+            }
+            if (!pktinfo)
+            {
+                OIC_LOG(ERROR, TAG, "pktinfo is null");
+                continue;
+            }
+
+            CAProcessReceivedMessage(flags, &context->srcAddrs[i], namelen, pktinfo,
+                                     context->buffers[i], context->msgs[i].msg_len);
+        }
+
+        if (count < CA_IP_RECV_BATCH)
+        {
+            return;
+        }
+    }
+}
+
+static void CAWaitForEpollEvents(CAIPEpollContext_t *context)
+{
+    struct epoll_event events[CA_IP_EPOLL_EVENTS];
+    int timeout = caglobals.ip.selectTimeout == -1 ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    int ret = epoll_wait(context->epollFd, events, CA_IP_EPOLL_EVENTS, timeout);
+
+    if (caglobals.ip.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.ip.terminate; i++)
+    {
+        int fd = (int)(uint32_t)events[i].data.u64;
+        CATransportFlags_t flags = (CATransportFlags_t)(events[i].data.u64 >> 32);
+
+        if (fd == caglobals.ip.netlinkFd)
+        {
+            CAHandleNetlinkEvent();
+        }
+        else if (fd == caglobals.ip.shutdownFds[0])
+        {
+            char buf[10] = {0};
+            (void)read(caglobals.ip.shutdownFds[0], buf, sizeof (buf));
+        }
+        else
+        {
+            CAReceiveMessages(context, fd, flags);
+        }
+    }
+}
+
+#endif // CA_IP_USE_EPOLL
+
 void CAUnregisterForAddressChanges()
 {
 #ifdef _WIN32
@@ -649,6 +963,15 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
         return CA_STATUS_FAILED;
     }
 
+    CAProcessReceivedMessage(flags, &srcAddr, namelen, pktinfo, recvBuffer, recvLen);
+
+    return CA_STATUS_OK;
+}
+
+static void CAProcessReceivedMessage(CATransportFlags_t flags,
+                                     struct sockaddr_storage *srcAddr, int namelen,
+                                     unsigned char *pktinfo, char *recvBuffer, size_t recvLen)
+{
     CASecureEndpoint_t sep = {.endpoint = {.adapter = CA_ADAPTER_IP, .flags = flags}};
 
     if (flags & CA_IPV6)
@@ -681,7 +1004,7 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
         }
     }
 
-    CAConvertAddrToName(&srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
+    CAConvertAddrToName(srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
 
     if (flags & CA_SECURE)
     {
@@ -702,8 +1025,6 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
             g_packetReceivedCallback(&sep, recvBuffer, recvLen);
         }
     }
-
-    return CA_STATUS_OK;
 }
 
 void CAIPPullData()
@@ -955,6 +1276,16 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
         caglobals.ip.ipv4enabled = true;  // only needed to run CA tests
     }
 
+    if (!g_multicastInterfaceMutex)
+    {
+        g_multicastInterfaceMutex = oc_mutex_new();
+        if (!g_multicastInterfaceMutex)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create multicast interface mutex");
+            return CA_STATUS_FAILED;
+        }
+    }
+
     if (caglobals.ip.ipv6enabled)
     {
         NEWSOCKET(AF_INET6, u6, false);
@@ -1009,11 +1340,20 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
         return res;
     }
 
+    void *receiveContext = NULL;
+#ifdef CA_IP_USE_EPOLL
+    // Fall back to select() if epoll can't be set up.
+    receiveContext = CACreateEpollContext();
+#endif
+
     caglobals.ip.terminate = false;
-    res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
+    res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, receiveContext);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread_pool_add_task failed");
+#ifdef CA_IP_USE_EPOLL
+        CADestroyEpollContext((CAIPEpollContext_t *)receiveContext);
+#endif
         return res;
     }
     OIC_LOG(DEBUG, TAG, "CAReceiveHandler thread started successfully.");
@@ -1217,6 +1557,7 @@ CAResult_t CAIPStartListenServer()
     }
 
     u_arraylist_destroy(iflist);
+    CAIPRefreshMulticastInterfaces();
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return CA_STATUS_OK;
 }
@@ -1287,8 +1628,160 @@ void CAIPSetPacketReceiveCallback(CAIPPacketReceivedCallback callback)
     g_packetReceivedCallback = callback;
 }
 
+void CAIPRefreshMulticastInterfaces()
+{
+    if (!g_multicastInterfaceMutex)
+    {
+        return;
+    }
+
+    u_arraylist_t *iflist = CAIPGetInterfaceInformation(0);
+    if (!iflist)
+    {
+        OIC_LOG_V(ERROR, TAG, "get interface info failed: %s", strerror(errno));
+        return;
+    }
+
+    CAMulticastInterface_t interfaces[2 * CA_IP_MAX_MULTICAST_INTERFACES];
+    size_t count = 0;
+    size_t count4 = 0;
+    size_t count6 = 0;
+
+    size_t len = u_arraylist_length(iflist);
+    for (size_t i = 0; i < len; i++)
+    {
+        CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
+        if (!ifitem)
+        {
+            continue;
+        }
+        if ((ifitem->flags & IFF_UP_RUNNING_FLAGS) != IFF_UP_RUNNING_FLAGS)
+        {
+            continue;
+        }
+        if (ifitem->family != AF_INET && ifitem->family != AF_INET6)
+        {
+            continue;
+        }
+
+        // There is one entry per address; send only once per interface.
+        bool found = false;
+        for (size_t j = 0; j < count && !found; j++)
+        {
+            found = (interfaces[j].family == ifitem->family)
+                    && (interfaces[j].index == ifitem->index);
+        }
+        if (found)
+        {
+            continue;
+        }
+
+        size_t *familyCount = (ifitem->family == AF_INET6) ? &count6 : &count4;
+        if (*familyCount >= CA_IP_MAX_MULTICAST_INTERFACES)
+        {
+            OIC_LOG_V(WARNING, TAG, "Too many interfaces, interface(%u) not used for multicast",
+                      ifitem->index);
+            continue;
+        }
+        (*familyCount)++;
+        interfaces[count].family = ifitem->family;
+        interfaces[count].index = ifitem->index;
+        count++;
+    }
+    u_arraylist_destroy(iflist);
+
+    oc_mutex_lock(g_multicastInterfaceMutex);
+    memcpy(g_multicastInterfaces, interfaces, count * sizeof (CAMulticastInterface_t));
+    g_multicastInterfaceCount = count;
+    oc_mutex_unlock(g_multicastInterfaceMutex);
+}
+
+size_t CAIPGetMulticastInterfaces(uint16_t family, uint32_t *indexes, size_t size)
+{
+    if (!g_multicastInterfaceMutex)
+    {
+        return 0;
+    }
+
+    size_t count = 0;
+    oc_mutex_lock(g_multicastInterfaceMutex);
+    for (size_t i = 0; i < g_multicastInterfaceCount && count < size; i++)
+    {
+        if (g_multicastInterfaces[i].family == family)
+        {
+            indexes[count++] = g_multicastInterfaces[i].index;
+        }
+    }
+    oc_mutex_unlock(g_multicastInterfaceMutex);
+    return count;
+}
+
+/*
+ * Whether the receive thread is told about address changes, which keeps the
+ * multicast interface snapshot current.
+ */
+static bool CAHasAddressChangeNotifications()
+{
+#ifdef _WIN32
+    return (caglobals.ip.addressChangeEvent != WSA_INVALID_EVENT);
+#else
+    return (caglobals.ip.netlinkFd != OC_INVALID_SOCKET);
+#endif
+}
+
+#if defined(CA_IP_SEND_PKTINFO)
+/*
+ * Sends a datagram out of the interface ifindex by passing it as packet info.
+ */
+static ssize_t sendToInterface(CASocketFd_t fd, struct sockaddr_storage *sock,
+                               socklen_t socklen, uint32_t ifindex,
+                               const void *data, size_t dlen)
+{
+    struct iovec iov = { .iov_base = (void *)data, .iov_len = dlen };
+    union
+    {
+        struct cmsghdr align;
+        unsigned char buf[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+    } control;
+    memset(&control, 0, sizeof (control));
+
+    struct msghdr msg = { .msg_name = sock,
+                          .msg_namelen = socklen,
+                          .msg_iov = &iov,
+                          .msg_iovlen = 1,
+                          .msg_control = control.buf };
+
+    if (sock->ss_family == AF_INET6)
+    {
+        msg.msg_controllen = CMSG_SPACE(sizeof (struct in6_pktinfo));
+        struct cmsghdr *cmp = CMSG_FIRSTHDR(&msg);
+        cmp->cmsg_level = IPPROTO_IPV6;
+        cmp->cmsg_type = IPV6_PKTINFO;
+        cmp->cmsg_len = CMSG_LEN(sizeof (struct in6_pktinfo));
+        struct in6_pktinfo *info = (struct in6_pktinfo *)CMSG_DATA(cmp);
+        info->ipi6_ifindex = ifindex;
+    }
+    else
+    {
+        msg.msg_controllen = CMSG_SPACE(sizeof (struct in_pktinfo));
+        struct cmsghdr *cmp = CMSG_FIRSTHDR(&msg);
+        cmp->cmsg_level = IPPROTO_IP;
+        cmp->cmsg_type = IP_PKTINFO;
+        cmp->cmsg_len = CMSG_LEN(sizeof (struct in_pktinfo));
+        struct in_pktinfo *info = (struct in_pktinfo *)CMSG_DATA(cmp);
+        info->ipi_ifindex = ifindex;
+    }
+
+    return sendmsg(fd, &msg, 0);
+}
+#endif
+
+/*
+ * A non-zero ifindex sends out of that interface; otherwise the routing table
+ * (or a previously set multicast interface) decides.
+ */
 static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
-                     const void *data, size_t dlen,
+                     const void *data, size_t dlen, uint32_t ifindex,
                      const char *cast, const char *fam)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
@@ -1305,6 +1798,7 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
 
     (void)cast;  // eliminates release warning
     (void)fam;
+    (void)ifindex;
 
     struct sockaddr_storage sock = { .ss_family = 0 };
     CAConvertNameToAddr(endpoint->addr, endpoint->port, &sock);
@@ -1323,7 +1817,17 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
     const char *secure = (endpoint->flags & CA_SECURE) ? "secure " : "";
 #endif
 #if !defined(_WIN32)
-    ssize_t len = sendto(fd, data, dlen, 0, (struct sockaddr *)&sock, socklen);
+    ssize_t len = 0;
+#if defined(CA_IP_SEND_PKTINFO)
+    if (ifindex)
+    {
+        len = sendToInterface(fd, &sock, socklen, ifindex, data, dlen);
+    }
+    else
+#endif
+    {
+        len = sendto(fd, data, dlen, 0, (struct sockaddr *)&sock, socklen);
+    }
     if (OC_SOCKET_ERROR == len)
     {
          // If logging is not defined/enabled.
@@ -1383,8 +1887,7 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
 #endif
 }
 
-static void sendMulticastData6(const u_arraylist_t *iflist,
-                               CAEndpoint_t *endpoint,
+static void sendMulticastData6(CAEndpoint_t *endpoint,
                                const void *data, size_t datalen)
 {
     if (!endpoint)
@@ -1403,39 +1906,28 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), ipv6mcname);
     CASocketFd_t fd = caglobals.ip.u6.fd;
 
-    size_t len = u_arraylist_length(iflist);
+    uint32_t indexes[CA_IP_MAX_MULTICAST_INTERFACES];
+    size_t len = CAIPGetMulticastInterfaces(AF_INET6, indexes, CA_IP_MAX_MULTICAST_INTERFACES);
     for (size_t i = 0; i < len; i++)
     {
-        CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-        if (!ifitem)
-        {
-            continue;
-        }
-        if ((ifitem->flags & IFF_UP_RUNNING_FLAGS) != IFF_UP_RUNNING_FLAGS)
-        {
-            continue;
-        }
-        if (ifitem->family != AF_INET6)
-        {
-            continue;
-        }
-
-        int index = ifitem->index;
+#if !defined(CA_IP_SEND_PKTINFO)
+        int index = indexes[i];
         if (setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, OPTVAL_T(&index), sizeof (index)))
         {
             OIC_LOG_V(ERROR, TAG, "setsockopt6 failed: %s", CAIPS_GET_ERROR);
             return;
         }
-        sendData(fd, endpoint, data, datalen, "multicast", "ipv6");
+#endif
+        sendData(fd, endpoint, data, datalen, indexes[i], "multicast", "ipv6");
     }
 }
 
-static void sendMulticastData4(const u_arraylist_t *iflist,
-                               CAEndpoint_t *endpoint,
+static void sendMulticastData4(CAEndpoint_t *endpoint,
                                const void *data, size_t datalen)
 {
     VERIFY_NON_NULL_VOID(endpoint, TAG, "endpoint is NULL");
 
+#if !defined(CA_IP_SEND_PKTINFO)
 #if defined(USE_IP_MREQN)
     struct ip_mreqn mreq = { .imr_multiaddr = IPv4MulticastAddress,
                              .imr_address.s_addr = htonl(INADDR_ANY),
@@ -1443,38 +1935,29 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
 #else
     struct ip_mreq mreq  = { .imr_multiaddr.s_addr = IPv4MulticastAddress.s_addr,
                              .imr_interface = {0}};
+#endif
 #endif
 
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), IPv4_MULTICAST);
     CASocketFd_t fd = caglobals.ip.u4.fd;
 
-    size_t len = u_arraylist_length(iflist);
+    uint32_t indexes[CA_IP_MAX_MULTICAST_INTERFACES];
+    size_t len = CAIPGetMulticastInterfaces(AF_INET, indexes, CA_IP_MAX_MULTICAST_INTERFACES);
     for (size_t i = 0; i < len; i++)
     {
-        CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-        if (!ifitem)
-        {
-            continue;
-        }
-        if ((ifitem->flags & IFF_UP_RUNNING_FLAGS) != IFF_UP_RUNNING_FLAGS)
-        {
-            continue;
-        }
-        if (ifitem->family != AF_INET)
-        {
-            continue;
-        }
+#if !defined(CA_IP_SEND_PKTINFO)
 #if defined(USE_IP_MREQN)
-        mreq.imr_ifindex = ifitem->index;
+        mreq.imr_ifindex = indexes[i];
 #else
-        mreq.imr_interface.s_addr = htonl(ifitem->index);
+        mreq.imr_interface.s_addr = htonl(indexes[i]);
 #endif
         if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, OPTVAL_T(&mreq), sizeof (mreq)))
         {
             OIC_LOG_V(ERROR, TAG, "send IP_MULTICAST_IF failed: %s (using defualt)",
                     CAIPS_GET_ERROR);
         }
-        sendData(fd, endpoint, data, datalen, "multicast", "ipv4");
+#endif
+        sendData(fd, endpoint, data, datalen, indexes[i], "multicast", "ipv4");
     }
 }
 
@@ -1490,23 +1973,20 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
     {
         endpoint->port = isSecure ? CA_SECURE_COAP : CA_COAP;
 
-        u_arraylist_t *iflist = CAIPGetInterfaceInformation(0);
-        if (!iflist)
+        if (!CAHasAddressChangeNotifications())
         {
-            OIC_LOG_V(ERROR, TAG, "get interface info failed: %s", strerror(errno));
-            return;
+            // Nothing keeps the snapshot current; take it again for every send.
+            CAIPRefreshMulticastInterfaces();
         }
 
         if ((endpoint->flags & CA_IPV6) && caglobals.ip.ipv6enabled)
         {
-            sendMulticastData6(iflist, endpoint, data, datalen);
+            sendMulticastData6(endpoint, data, datalen);
         }
         if ((endpoint->flags & CA_IPV4) && caglobals.ip.ipv4enabled)
         {
-            sendMulticastData4(iflist, endpoint, data, datalen);
+            sendMulticastData4(endpoint, data, datalen);
         }
-
-        u_arraylist_destroy(iflist);
     }
     else
     {
@@ -1522,7 +2002,7 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
 #ifndef __WITH_DTLS__
             fd = caglobals.ip.u6.fd;
 #endif
-            sendData(fd, endpoint, data, datalen, "unicast", "ipv6");
+            sendData(fd, endpoint, data, datalen, 0, "unicast", "ipv6");
         }
         if (caglobals.ip.ipv4enabled && (endpoint->flags & CA_IPV4))
         {
@@ -1530,7 +2010,7 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
 #ifndef __WITH_DTLS__
             fd = caglobals.ip.u4.fd;
 #endif
-            sendData(fd, endpoint, data, datalen, "unicast", "ipv4");
+            sendData(fd, endpoint, data, datalen, 0, "unicast", "ipv4");
         }
     }
 }
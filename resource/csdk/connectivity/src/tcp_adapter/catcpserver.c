@@ -36,6 +36,10 @@
 #ifdef HAVE_SYS_POLL_H
 #include <sys/poll.h>
 #endif
+#if defined(__linux__) && defined(HAVE_SYS_EPOLL_H)
+#include <sys/epoll.h>
+#define CA_TCP_USE_EPOLL
+#endif
 #include <stdio.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -63,6 +67,7 @@
 #include "octhread.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "uhashmap.h"
 
 #include <coap/pdu.h>
 #include <coap/utlist.h>
@@ -87,6 +92,13 @@
  */
 #define TLS_HEADER_SIZE 5
 
+#ifdef CA_TCP_USE_EPOLL
+/**
+ * Number of epoll events handled per wakeup.
+ */
+#define CA_TCP_EPOLL_EVENTS 64
+#endif
+
 /**
  * Mutex to synchronize device object list.
  */
@@ -117,6 +129,34 @@ static CATCPConnectionHandleCallback g_connectionCallback = NULL;
  */
 static CATCPSessionInfo_t *g_sessionList = NULL;
 
+/**
+ * Sessions indexed by remote address and port. Plain and secure sessions to
+ * the same peer share a key, so each entry heads a chain linked by addrNext.
+ */
+static u_hashmap_t *g_sessionAddrIndex = NULL;
+
+/**
+ * Sessions indexed by socket file descriptor.
+ */
+static u_hashmap_t *g_sessionFdIndex = NULL;
+
+/**
+ * Key of ::g_sessionAddrIndex.
+ */
+typedef struct
+{
+    char addr[MAX_ADDR_STR_SIZE_CA];
+    uint16_t port;
+} CATCPSessionKey_t;
+
+#ifdef CA_TCP_USE_EPOLL
+/**
+ * epoll instance watching the accept sockets, the wakeup pipes and every
+ * connected session. -1 when the select() loop is used.
+ */
+static int g_epollFd = -1;
+#endif
+
 static CAResult_t CATCPCreateMutex();
 static void CATCPDestroyMutex();
 static CAResult_t CATCPCreateCond();
@@ -132,6 +172,12 @@ static void CASocketEventReturned(CASocketFd_t socket, long networkEvents);
 static void CAReceiveMessage(CASocketFd_t fd);
 static void CAReceiveHandler(void *data);
 static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem);
+static CAResult_t CAAddSession(CATCPSessionInfo_t *session);
+static void CARemoveSession(CATCPSessionInfo_t *session);
+static CATCPSessionInfo_t *CAFindSession(const CAEndpoint_t *endpoint);
+#ifdef CA_TCP_USE_EPOLL
+static void CAWaitForEpollEvents();
+#endif
 
 #if defined(WSA_WAIT_EVENT_0)
 #define CHECKFD(FD)
@@ -213,6 +259,13 @@ static void CAReceiveHandler(void *data)
 
     while (!caglobals.tcp.terminate)
     {
+#ifdef CA_TCP_USE_EPOLL
+        if (-1 != g_epollFd)
+        {
+            CAWaitForEpollEvents();
+            continue;
+        }
+#endif
         CAFindReadyMessage();
     }
 
@@ -521,6 +574,275 @@ static void CASocketEventReturned(CASocketFd_t s, long networkEvents)
 
 #endif // WSA_WAIT_EVENT_0
 
+#ifdef CA_TCP_USE_EPOLL
+static void CAAddToEpoll(CASocketFd_t fd)
+{
+    if (-1 == g_epollFd || OC_INVALID_SOCKET == fd)
+    {
+        return;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN };
+    event.data.fd = fd;
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl add failed: %s", strerror(errno));
+    }
+}
+
+static void CARemoveFromEpoll(CASocketFd_t fd)
+{
+    if (-1 == g_epollFd || OC_INVALID_SOCKET == fd)
+    {
+        return;
+    }
+
+    // A closed fd leaves the epoll set by itself; removing it first keeps a
+    // duplicated fd from reporting events for a deleted session.
+    struct epoll_event event = { .events = 0 };
+    (void)epoll_ctl(g_epollFd, EPOLL_CTL_DEL, fd, &event);
+}
+
+static void CACreateEpoll()
+{
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed, using select: %s", strerror(errno));
+        return;
+    }
+
+    CAAddToEpoll(caglobals.tcp.ipv4.fd);
+    CAAddToEpoll(caglobals.tcp.ipv4s.fd);
+    CAAddToEpoll(caglobals.tcp.ipv6.fd);
+    CAAddToEpoll(caglobals.tcp.ipv6s.fd);
+    CAAddToEpoll(caglobals.tcp.shutdownFds[0]);
+    CAAddToEpoll(caglobals.tcp.connectionFds[0]);
+}
+
+static void CADestroyEpoll()
+{
+    if (-1 != g_epollFd)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+}
+
+static void CAWaitForEpollEvents()
+{
+    struct epoll_event events[CA_TCP_EPOLL_EVENTS];
+    int timeout = caglobals.tcp.selectTimeout == -1 ? -1 : caglobals.tcp.selectTimeout * 1000;
+
+    int ret = epoll_wait(g_epollFd, events, CA_TCP_EPOLL_EVENTS, timeout);
+
+    if (caglobals.tcp.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < ret && !caglobals.tcp.terminate; i++)
+    {
+        CASocketFd_t fd = events[i].data.fd;
+
+        if (fd == caglobals.tcp.ipv4.fd)
+        {
+            CAAcceptConnection(CA_IPV4, &caglobals.tcp.ipv4);
+        }
+        else if (fd == caglobals.tcp.ipv4s.fd)
+        {
+            CAAcceptConnection(CA_IPV4 | CA_SECURE, &caglobals.tcp.ipv4s);
+        }
+        else if (fd == caglobals.tcp.ipv6.fd)
+        {
+            CAAcceptConnection(CA_IPV6, &caglobals.tcp.ipv6);
+        }
+        else if (fd == caglobals.tcp.ipv6s.fd)
+        {
+            CAAcceptConnection(CA_IPV6 | CA_SECURE, &caglobals.tcp.ipv6s);
+        }
+        else if (fd == caglobals.tcp.connectionFds[0])
+        {
+            // Connected sockets are added to epoll directly, the pipe only
+            // has to be drained.
+            char buf[MAX_ADDR_STR_SIZE_CA] = {0};
+            ssize_t len = read(caglobals.tcp.connectionFds[0], buf, sizeof (buf) - 1);
+            if (0 < len)
+            {
+                OIC_LOG_V(DEBUG, TAG, "Received new connection event with [%s]", buf);
+            }
+        }
+        else if (fd == caglobals.tcp.shutdownFds[0])
+        {
+            // only closed on shutdown, terminate is already set.
+            continue;
+        }
+        else
+        {
+            CAReceiveMessage(fd);
+        }
+    }
+}
+#endif // CA_TCP_USE_EPOLL
+
+static void CAMakeSessionKey(const CAEndpoint_t *endpoint, CATCPSessionKey_t *key)
+{
+    memset(key, 0, sizeof (*key));
+    OICStrcpy(key->addr, sizeof (key->addr), endpoint->addr);
+    key->port = endpoint->port;
+}
+
+static CAResult_t CACreateSessionIndexes()
+{
+    if (!g_sessionAddrIndex)
+    {
+        g_sessionAddrIndex = u_hashmap_create(0);
+    }
+    if (!g_sessionFdIndex)
+    {
+        g_sessionFdIndex = u_hashmap_create(0);
+    }
+    if (!g_sessionAddrIndex || !g_sessionFdIndex)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create session indexes!");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    return CA_STATUS_OK;
+}
+
+static void CADestroySessionIndexes()
+{
+    u_hashmap_free(&g_sessionAddrIndex);
+    u_hashmap_free(&g_sessionFdIndex);
+}
+
+/**
+ * Index the session by its socket fd. Call with g_mutexObjectList held.
+ */
+static void CAIndexSessionFD(CATCPSessionInfo_t *session)
+{
+    if (OC_INVALID_SOCKET == session->fd)
+    {
+        return;
+    }
+    if (!u_hashmap_put(g_sessionFdIndex, &session->fd, sizeof (session->fd), session))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to index session fd");
+    }
+}
+
+/**
+ * Add the session to the session list and indexes.
+ * Call with g_mutexObjectList held.
+ */
+static CAResult_t CAAddSession(CATCPSessionInfo_t *session)
+{
+    CATCPSessionKey_t key;
+    CAMakeSessionKey(&session->sep.endpoint, &key);
+
+    // Append to the chain so that lookups find the oldest session first, as
+    // the list scan did.
+    session->addrNext = NULL;
+    CATCPSessionInfo_t *head = (CATCPSessionInfo_t *)u_hashmap_get(g_sessionAddrIndex,
+                                                                   &key, sizeof (key));
+    if (head)
+    {
+        CATCPSessionInfo_t *last = head;
+        while (last->addrNext)
+        {
+            last = last->addrNext;
+        }
+        last->addrNext = session;
+    }
+    else if (!u_hashmap_put(g_sessionAddrIndex, &key, sizeof (key), session))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to index session");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    DL_APPEND(g_sessionList, session);
+    CAIndexSessionFD(session);
+    return CA_STATUS_OK;
+}
+
+/**
+ * Remove the session from the session list and indexes without closing it.
+ * Call with g_mutexObjectList held.
+ */
+static void CARemoveSession(CATCPSessionInfo_t *session)
+{
+    CATCPSessionKey_t key;
+    CAMakeSessionKey(&session->sep.endpoint, &key);
+
+    CATCPSessionInfo_t *head = (CATCPSessionInfo_t *)u_hashmap_get(g_sessionAddrIndex,
+                                                                   &key, sizeof (key));
+    if (head == session)
+    {
+        if (session->addrNext)
+        {
+            u_hashmap_put(g_sessionAddrIndex, &key, sizeof (key), session->addrNext);
+        }
+        else
+        {
+            u_hashmap_remove(g_sessionAddrIndex, &key, sizeof (key));
+        }
+    }
+    else
+    {
+        for (CATCPSessionInfo_t *prev = head; prev; prev = prev->addrNext)
+        {
+            if (prev->addrNext == session)
+            {
+                prev->addrNext = session->addrNext;
+                break;
+            }
+        }
+    }
+    session->addrNext = NULL;
+
+    if (OC_INVALID_SOCKET != session->fd
+        && session == u_hashmap_get(g_sessionFdIndex, &session->fd, sizeof (session->fd)))
+    {
+        u_hashmap_remove(g_sessionFdIndex, &session->fd, sizeof (session->fd));
+    }
+#ifdef CA_TCP_USE_EPOLL
+    CARemoveFromEpoll(session->fd);
+#endif
+
+    DL_DELETE(g_sessionList, session);
+}
+
+/**
+ * Find the first session to the endpoint's address and port that shares a
+ * transport flag with it. Call with g_mutexObjectList held.
+ */
+static CATCPSessionInfo_t *CAFindSession(const CAEndpoint_t *endpoint)
+{
+    CATCPSessionKey_t key;
+    CAMakeSessionKey(endpoint, &key);
+
+    CATCPSessionInfo_t *session = (CATCPSessionInfo_t *)u_hashmap_get(g_sessionAddrIndex,
+                                                                      &key, sizeof (key));
+    for (; session; session = session->addrNext)
+    {
+        if (session->sep.endpoint.flags & endpoint->flags)
+        {
+            return session;
+        }
+    }
+    return NULL;
+}
+
 static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
 {
     VERIFY_NON_NULL_VOID(sock, TAG, "sock is NULL");
@@ -553,10 +875,19 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
                             svritem->sep.endpoint.addr, &svritem->sep.endpoint.port);
 
         oc_mutex_lock(g_mutexObjectList);
-        LL_APPEND(g_sessionList, svritem);
+        CAResult_t res = CAAddSession(svritem);
         oc_mutex_unlock(g_mutexObjectList);
+        if (CA_STATUS_OK != res)
+        {
+            OC_CLOSE_SOCKET(sockfd);
+            OICFree(svritem);
+            return;
+        }
 
         CHECKFD(sockfd);
+#ifdef CA_TCP_USE_EPOLL
+        CAAddToEpoll(sockfd);
+#endif
 
         // pass the connection information to CA Common Layer.
         if (g_connectionCallback)
@@ -889,7 +1220,10 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
         OIC_LOG_V(ERROR, TAG, "create socket failed: %s", strerror(errno));
         return CA_SOCKET_OPERATION_FAILED;
     }
+    oc_mutex_lock(g_mutexObjectList);
     svritem->fd = fd;
+    CAIndexSessionFD(svritem);
+    oc_mutex_unlock(g_mutexObjectList);
 
     // #2. convert address from string to binary.
     struct sockaddr_storage sa = { .ss_family = (short)family };
@@ -924,6 +1258,9 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
     OIC_LOG(DEBUG, TAG, "connect socket success");
     svritem->state = CONNECTED;
     CHECKFD(svritem->fd);
+#ifdef CA_TCP_USE_EPOLL
+    CAAddToEpoll(svritem->fd);
+#endif
 #if !defined(WSA_WAIT_EVENT_0)
     ssize_t len = CAWakeUpForReadFdsUpdate(svritem->sep.endpoint.addr);
     if (-1 == len)
@@ -1080,6 +1417,10 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     {
         res = CATCPCreateCond();
     }
+    if (CA_STATUS_OK == res)
+    {
+        res = CACreateSessionIndexes();
+    }
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "failed to create mutex/cond");
@@ -1126,6 +1467,10 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     CHECKFD(caglobals.tcp.connectionFds[1]);
 #endif
 
+#ifdef CA_TCP_USE_EPOLL
+    CACreateEpoll();
+#endif
+
     caglobals.tcp.terminate = false;
     res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
@@ -1189,6 +1534,10 @@ void CATCPStopServer()
     oc_mutex_unlock(g_mutexObjectList);
 
     CATCPDisconnectAll();
+#ifdef CA_TCP_USE_EPOLL
+    CADestroyEpoll();
+#endif
+    CADestroySessionIndexes();
     CATCPDestroyMutex();
     CATCPDestroyCond();
 
@@ -1408,13 +1757,19 @@ CASocketFd_t CAConnectTCPSession(const CAEndpoint_t *endpoint)
         return OC_INVALID_SOCKET;
     }
     svritem->sep.endpoint = *endpoint;
+    svritem->fd = OC_INVALID_SOCKET;
     svritem->state = CONNECTING;
     svritem->isClient = true;
 
     // #2. add TCP connection info to list
     oc_mutex_lock(g_mutexObjectList);
-    LL_APPEND(g_sessionList, svritem);
+    CAResult_t res = CAAddSession(svritem);
     oc_mutex_unlock(g_mutexObjectList);
+    if (CA_STATUS_OK != res)
+    {
+        OICFree(svritem);
+        return OC_INVALID_SOCKET;
+    }
 
     // #3. create the socket and connect to TCP server
     int family = (svritem->sep.endpoint.flags & CA_IPV6) ? AF_INET6 : AF_INET;
@@ -1469,11 +1824,11 @@ void CATCPDisconnectAll()
     oc_mutex_lock(g_mutexObjectList);
     CATCPSessionInfo_t *session = NULL;
     CATCPSessionInfo_t *tmp = NULL;
-    LL_FOREACH_SAFE(g_sessionList, session, tmp)
+    DL_FOREACH_SAFE(g_sessionList, session, tmp)
     {
         if (session)
         {
-            LL_DELETE(g_sessionList, session);
+            CARemoveSession(session);
             // disconnect session from remote device.
             CADisconnectTCPSession(session);
         }
@@ -1494,23 +1849,17 @@ CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint
 
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
-    // get connection info from list
+    // get connection info from index
     oc_mutex_lock(g_mutexObjectList);
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    CATCPSessionInfo_t *session = CAFindSession(endpoint);
+    oc_mutex_unlock(g_mutexObjectList);
+
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        return session;
     }
 
-    oc_mutex_unlock(g_mutexObjectList);
     OIC_LOG(DEBUG, TAG, "Session not found");
     return NULL;
 }
@@ -1521,23 +1870,18 @@ CASocketFd_t CAGetSocketFDFromEndpoint(const CAEndpoint_t *endpoint)
 
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
-    // get connection info from list.
+    // get connection info from index.
     oc_mutex_lock(g_mutexObjectList);
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    CATCPSessionInfo_t *session = CAFindSession(endpoint);
+    CASocketFd_t fd = session ? session->fd : OC_INVALID_SOCKET;
+    oc_mutex_unlock(g_mutexObjectList);
+
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session->fd;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        return fd;
     }
 
-    oc_mutex_unlock(g_mutexObjectList);
     OIC_LOG(DEBUG, TAG, "Session not found");
     return OC_INVALID_SOCKET;
 }
@@ -1545,19 +1889,11 @@ CASocketFd_t CAGetSocketFDFromEndpoint(const CAEndpoint_t *endpoint)
 CATCPSessionInfo_t *CAGetSessionInfoFromFD(CASocketFd_t fd)
 {
     oc_mutex_lock(g_mutexObjectList);
-
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
-    {
-        if (session && session->fd == fd)
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            return session;
-        }
-    }
-
+    CATCPSessionInfo_t *session =
+        (CATCPSessionInfo_t *)u_hashmap_get(g_sessionFdIndex, &fd, sizeof (fd));
     oc_mutex_unlock(g_mutexObjectList);
-    return NULL;
+
+    return session;
 }
 
 CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
@@ -1566,24 +1902,16 @@ CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
 
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
-    // get connection info from list
-    CATCPSessionInfo_t *session = NULL;
-    CATCPSessionInfo_t *tmp = NULL;
-
+    // get connection info from index
     oc_mutex_lock(g_mutexObjectList);
-    LL_FOREACH_SAFE(g_sessionList, session, tmp)
+    CATCPSessionInfo_t *session = CAFindSession(endpoint);
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            LL_DELETE(g_sessionList, session);
-            CADisconnectTCPSession(session);
-            oc_mutex_unlock(g_mutexObjectList);
-            return CA_STATUS_OK;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        CARemoveSession(session);
+        CADisconnectTCPSession(session);
+        oc_mutex_unlock(g_mutexObjectList);
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_mutexObjectList);
 
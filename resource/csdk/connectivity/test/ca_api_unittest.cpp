@@ -25,6 +25,8 @@
 #include "cacommon.h"
 #include "oic_string.h"
 #include "oic_malloc.h"
+#include "oic_time.h"
+#include "octhread.h"
 #include "cafragmentation.h"
 #include "caleinterface.h"
 
@@ -503,6 +505,103 @@ TEST_F(CATests, HandlerRequestResponseTest)
     EXPECT_EQ(CA_STATUS_OK, CAHandleRequestResponse());
 }
 
+#ifdef IP_ADAPTER
+#define RECEIVE_QUEUE_REQUESTS      3
+#define RECEIVE_QUEUE_TIMEOUT_US    (5 * 1000 * 1000)
+
+static oc_mutex g_receiveQueueMutex = NULL;
+static oc_cond g_receiveQueueCond = NULL;
+static int g_queuedCount = 0;
+static int g_handledCount = 0;
+
+static void count_queued()
+{
+    oc_mutex_lock(g_receiveQueueMutex);
+    g_queuedCount++;
+    oc_cond_signal(g_receiveQueueCond);
+    oc_mutex_unlock(g_receiveQueueMutex);
+}
+
+static void count_request(const CAEndpoint_t * /*object*/,
+                          const CARequestInfo_t * /*requestInfo*/)
+{
+    g_handledCount++;
+}
+
+// CARegisterReceiveQueueHandler TC
+TEST_F(CATests, ReceiveQueueHandlerCalledForQueuedData)
+{
+    g_receiveQueueMutex = oc_mutex_new();
+    g_receiveQueueCond = oc_cond_new();
+    g_queuedCount = 0;
+    g_handledCount = 0;
+
+    CARegisterHandler(count_request, response_handler, error_handler);
+    CARegisterReceiveQueueHandler(count_queued);
+    EXPECT_EQ(CA_STATUS_OK, CASelectNetwork(CA_ADAPTER_IP));
+    EXPECT_EQ(CA_STATUS_OK, CAStartListeningServer());
+
+    // Send to our own unsecured IPv4 port over loopback.
+    size_t size = 0;
+    CAEndpoint_t *info = NULL;
+    EXPECT_EQ(CA_STATUS_OK, CAGetNetworkInformation(&info, &size));
+    uint16_t port = 0;
+    for (size_t i = 0; i < size && !port; i++)
+    {
+        if (CA_ADAPTER_IP == info[i].adapter && (info[i].flags & CA_IPV4)
+            && !(info[i].flags & CA_SECURE))
+        {
+            port = info[i].port;
+        }
+    }
+    free(info);
+    ASSERT_NE(0, port);
+
+    CAEndpoint_t *self = NULL;
+    ASSERT_EQ(CA_STATUS_OK, CACreateEndpoint(CA_IPV4, CA_ADAPTER_IP, "127.0.0.1", port, &self));
+    for (int i = 0; i < RECEIVE_QUEUE_REQUESTS; i++)
+    {
+        CAToken_t token = NULL;
+        CAGenerateToken(&token, tokenLength);
+
+        CARequestInfo_t request;
+        memset(&request, 0, sizeof(request));
+        request.method = CA_GET;
+        request.info.type = CA_MSG_NONCONFIRM;
+        request.info.token = token;
+        request.info.tokenLength = tokenLength;
+        request.info.resourceUri = (CAURI_t) "/a/queue";
+        EXPECT_EQ(CA_STATUS_OK, CASendRequest(self, &request));
+
+        CADestroyToken(token);
+    }
+    CADestroyEndpoint(self);
+
+    // Each request announces itself without anyone polling for it.
+    oc_mutex_lock(g_receiveQueueMutex);
+    while (g_queuedCount < RECEIVE_QUEUE_REQUESTS)
+    {
+        if (OC_WAIT_TIMEDOUT == oc_cond_wait_for(g_receiveQueueCond, g_receiveQueueMutex,
+                                                 RECEIVE_QUEUE_TIMEOUT_US))
+        {
+            break;
+        }
+    }
+    EXPECT_EQ(RECEIVE_QUEUE_REQUESTS, g_queuedCount);
+    oc_mutex_unlock(g_receiveQueueMutex);
+
+    // One call handles everything that was queued.
+    EXPECT_EQ(0, g_handledCount);
+    EXPECT_EQ(CA_STATUS_OK, CAHandleRequestResponse());
+    EXPECT_EQ(RECEIVE_QUEUE_REQUESTS, g_handledCount);
+
+    CARegisterReceiveQueueHandler(NULL);
+    CARegisterHandler(request_handler, response_handler, error_handler);
+    oc_cond_free(g_receiveQueueCond);
+    oc_mutex_free(g_receiveQueueMutex);
+}
+#endif // IP_ADAPTER
+
 // CAGetNetworkInformation TC
 TEST_F (CATests, GetNetworkInformationTest)
 {
@@ -23,13 +23,18 @@
 #pragma warning(disable : 4200)
 #endif
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "cainterface.h"
 #include "cautilinterface.h"
 #include "cacommon.h"
 #include "cablockwisetransfer.h"
+#include "oic_malloc.h"
+#include "oic_time.h"
 
 #define LARGE_PAYLOAD_LENGTH    1024
+#define DEFAULT_BLOCK_LENGTH    (1 << (CA_DEFAULT_BLOCK_SIZE + 4))
 
 class CABlockTransferTests : public testing::Test {
     protected:
@@ -193,6 +198,96 @@ TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListTest)
     free(requestData.payload);
 }
 
+static CABlockData_t *CreateBlockDataWithToken(CAEndpoint_t *endpoint, uint16_t tokenSeed)
+{
+    char token[2] = { (char) (tokenSeed >> 8), (char) (tokenSeed & 0xFF) };
+
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = CA_GET;
+    requestInfo.info.type = CA_MSG_NONCONFIRM;
+    requestInfo.info.token = token;
+    requestInfo.info.tokenLength = sizeof(token);
+
+    CAData_t cadata;
+    memset(&cadata, 0, sizeof(CAData_t));
+    cadata.type = SEND_TYPE_UNICAST;
+    cadata.remoteEndpoint = endpoint;
+    cadata.requestInfo = &requestInfo;
+    cadata.dataType = CA_REQUEST_DATA;
+
+    return CACreateNewBlockData(&cadata);
+}
+
+TEST_F(CABlockTransferTests, CAGetBlockDataFromManyTransfers)
+{
+    const uint16_t transferCount = 500;
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CABlockData_t *created[transferCount];
+    for (uint16_t i = 0; i < transferCount; i++)
+    {
+        created[i] = CreateBlockDataWithToken(tempRep, i);
+        ASSERT_TRUE(created[i] != NULL);
+    }
+
+    for (uint16_t i = 0; i < transferCount; i++)
+    {
+        EXPECT_EQ(created[i], CAGetBlockDataFromBlockDataList(created[i]->blockDataId));
+    }
+
+    // a new transfer with the same token and endpoint replaces the old one
+    CABlockData_t *replaced = CreateBlockDataWithToken(tempRep, 0);
+    ASSERT_TRUE(replaced != NULL);
+    EXPECT_EQ(replaced, CAGetBlockDataFromBlockDataList(replaced->blockDataId));
+    created[0] = replaced;
+
+    for (uint16_t i = 0; i < transferCount; i += 2)
+    {
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(created[i]->blockDataId));
+    }
+    for (uint16_t i = 1; i < transferCount; i += 2)
+    {
+        EXPECT_EQ(created[i], CAGetBlockDataFromBlockDataList(created[i]->blockDataId));
+    }
+
+    EXPECT_EQ(CA_STATUS_OK, CARemoveAllBlockDataFromList());
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CARemoveExpiredBlockDataTest)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CABlockData_t *idleData = CreateBlockDataWithToken(tempRep, 1);
+    CABlockData_t *activeData = CreateBlockDataWithToken(tempRep, 2);
+    ASSERT_TRUE(idleData != NULL);
+    ASSERT_TRUE(activeData != NULL);
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    EXPECT_EQ(0u, CARemoveExpiredBlockData(now));
+
+    CABlockDataID_t *idleId = CACreateBlockDatablockId((CAToken_t) "\0\1", 2,
+                                                       tempRep->addr, tempRep->port);
+    ASSERT_TRUE(idleId != NULL);
+    idleData->lastActivity = now - CA_BLOCK_DATA_IDLE_TIMEOUT_MS;
+
+    EXPECT_EQ(1u, CARemoveExpiredBlockData(now));
+    EXPECT_TRUE(CAGetBlockDataFromBlockDataList(idleId) == NULL);
+    EXPECT_EQ(activeData, CAGetBlockDataFromBlockDataList(activeData->blockDataId));
+
+    // looking a transfer up keeps it alive
+    EXPECT_EQ(0u, CARemoveExpiredBlockData(now + CA_BLOCK_DATA_IDLE_TIMEOUT_MS - 1));
+    EXPECT_EQ(1u, CARemoveExpiredBlockData(OICGetCurrentTime(TIME_IN_MS)
+                                           + CA_BLOCK_DATA_IDLE_TIMEOUT_MS));
+
+    CADestroyBlockID(idleId);
+    CADestroyEndpoint(tempRep);
+}
+
 TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
 {
     CAEndpoint_t* tempRep = NULL;
@@ -240,6 +335,185 @@ TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
     free(requestData.payload);
 }
 
+static CAResult_t UpdatePayloadWithBlock(CABlockData_t *currData, uint8_t fill,
+                                         size_t blockLength, bool isLast)
+{
+    std::vector<uint8_t> block(blockLength, fill);
+
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.type = CA_MSG_NONCONFIRM;
+    responseInfo.info.payload = block.data();
+    responseInfo.info.payloadSize = blockLength;
+
+    CAData_t receivedData;
+    memset(&receivedData, 0, sizeof(CAData_t));
+    receivedData.type = SEND_TYPE_UNICAST;
+    receivedData.responseInfo = &responseInfo;
+    receivedData.dataType = CA_RESPONSE_DATA;
+
+    coap_block_t blockOption = { 0, 0, 0 };
+    blockOption.m = isLast ? 0 : 1;
+    blockOption.szx = CA_DEFAULT_BLOCK_SIZE;
+
+    return CAUpdatePayloadData(currData, &receivedData, CA_BLOCK_UNKNOWN, &blockOption,
+                               COAP_OPTION_BLOCK2);
+}
+
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataPresizedBySizeOption)
+{
+    const size_t blockLength = DEFAULT_BLOCK_LENGTH;
+    const size_t blockCount = 8;
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CABlockData_t *currData = CreateBlockDataWithToken(tempRep, 1);
+    ASSERT_TRUE(currData != NULL);
+    currData->payloadLength = blockCount * blockLength - 1;
+
+    CAPayload_t buffer = NULL;
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        bool isLast = (blockCount - 1 == i);
+        size_t length = isLast ? blockLength - 1 : blockLength;
+        EXPECT_EQ(CA_STATUS_OK, UpdatePayloadWithBlock(currData, (uint8_t) i, length, isLast));
+
+        // the buffer is allocated once for the announced length
+        if (0 == i)
+        {
+            buffer = currData->payload;
+        }
+        EXPECT_EQ(buffer, currData->payload);
+        EXPECT_EQ(currData->payloadLength, currData->payloadCapacity);
+    }
+
+    size_t fullPayloadLen = 0;
+    CAPayload_t payload = CATakePayloadFromBlockDataList(currData->blockDataId,
+                                                         &fullPayloadLen);
+    ASSERT_TRUE(payload != NULL);
+    EXPECT_EQ(currData->payloadLength, fullPayloadLen);
+    for (size_t i = 0; i < fullPayloadLen; i++)
+    {
+        ASSERT_EQ((uint8_t) (i / blockLength), payload[i]);
+    }
+    EXPECT_TRUE(currData->payload == NULL);
+    OICFree(payload);
+
+    CARemoveBlockDataFromList(currData->blockDataId);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataIgnoresOversizedSizeOption)
+{
+    const size_t blockLength = DEFAULT_BLOCK_LENGTH;
+    const size_t blockCount = 4;
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CABlockData_t *currData = CreateBlockDataWithToken(tempRep, 1);
+    ASSERT_TRUE(currData != NULL);
+    currData->payloadLength = UINT32_MAX;
+
+    // the announced length is not allocated, the buffer follows the blocks
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, UpdatePayloadWithBlock(currData, (uint8_t) i, blockLength,
+                                                       blockCount - 1 == i));
+        EXPECT_GE(currData->payloadCapacity, currData->receivedPayloadLen);
+        EXPECT_GE(2 * currData->receivedPayloadLen, currData->payloadCapacity);
+    }
+
+    size_t fullPayloadLen = 0;
+    CAPayload_t payload = CATakePayloadFromBlockDataList(currData->blockDataId,
+                                                         &fullPayloadLen);
+    ASSERT_TRUE(payload != NULL);
+    EXPECT_EQ(blockCount * blockLength, fullPayloadLen);
+    for (size_t i = 0; i < fullPayloadLen; i++)
+    {
+        ASSERT_EQ((uint8_t) (i / blockLength), payload[i]);
+    }
+    OICFree(payload);
+
+    CARemoveBlockDataFromList(currData->blockDataId);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataGrowsGeometrically)
+{
+    const size_t blockLength = DEFAULT_BLOCK_LENGTH;
+    const size_t blockCount = 256;
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CABlockData_t *currData = CreateBlockDataWithToken(tempRep, 1);
+    ASSERT_TRUE(currData != NULL);
+
+    size_t growCount = 0;
+    size_t capacity = 0;
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, UpdatePayloadWithBlock(currData, (uint8_t) i, blockLength,
+                                                       blockCount - 1 == i));
+        if (capacity != currData->payloadCapacity)
+        {
+            capacity = currData->payloadCapacity;
+            growCount++;
+        }
+    }
+    EXPECT_EQ(blockCount * blockLength, currData->receivedPayloadLen);
+    EXPECT_GE(9u, growCount);
+
+    CARemoveBlockDataFromList(currData->blockDataId);
+    CADestroyEndpoint(tempRep);
+}
+
+static size_t g_blockPayloadOffset = 0;
+static bool g_blockPayloadIsLast = false;
+
+static bool ConsumeBlockPayload(const CAEndpoint_t *object, const CAInfo_t *info,
+                                size_t offset, size_t totalLength, bool isLast)
+{
+    (void) object;
+    (void) totalLength;
+    EXPECT_EQ(g_blockPayloadOffset, offset);
+    g_blockPayloadOffset += info->payloadSize;
+    g_blockPayloadIsLast = isLast;
+    return true;
+}
+
+TEST_F(CABlockTransferTests, CARegisterBlockPayloadHandlerConsumesBlocks)
+{
+    const size_t blockLength = DEFAULT_BLOCK_LENGTH;
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CABlockData_t *currData = CreateBlockDataWithToken(tempRep, 1);
+    ASSERT_TRUE(currData != NULL);
+
+    g_blockPayloadOffset = 0;
+    g_blockPayloadIsLast = false;
+    CARegisterBlockPayloadHandler(ConsumeBlockPayload);
+
+    EXPECT_EQ(CA_STATUS_OK, UpdatePayloadWithBlock(currData, 1, blockLength, false));
+    EXPECT_EQ(CA_STATUS_OK, UpdatePayloadWithBlock(currData, 2, 10, true));
+
+    CARegisterBlockPayloadHandler(NULL);
+
+    EXPECT_EQ(blockLength + 10, g_blockPayloadOffset);
+    EXPECT_TRUE(g_blockPayloadIsLast);
+    EXPECT_TRUE(currData->isPayloadConsumed);
+    EXPECT_TRUE(currData->payload == NULL);
+    EXPECT_EQ(blockLength + 10, currData->receivedPayloadLen);
+
+    CARemoveBlockDataFromList(currData->blockDataId);
+    CADestroyEndpoint(tempRep);
+}
+
 // request and block option1
 TEST_F(CABlockTransferTests, CAAddBlockOptionTest)
 {
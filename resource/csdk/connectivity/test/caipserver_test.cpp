@@ -0,0 +1,243 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "cacommon.h"
+#include "caipinterface.h"
+#include "caipnwmonitor.h"
+#include "cathreadpool.h"
+#include "octhread.h"
+
+// More than one recvmmsg() batch, so the loop has to go around.
+#define BURST_SIZE          40
+#define RECEIVE_TIMEOUT_US  (5 * 1000 * 1000)
+#define MAX_INTERFACES      64
+
+typedef struct
+{
+    std::string addr;
+    uint16_t port;
+    uint32_t ifindex;
+    CATransportFlags_t flags;
+    std::string payload;
+} ReceivedPacket;
+
+static oc_mutex g_packetMutex = NULL;
+static oc_cond g_packetCond = NULL;
+static std::vector<ReceivedPacket> g_packets;
+
+static void PacketReceived(const CASecureEndpoint_t *sep, const void *data, size_t dataLength)
+{
+    ReceivedPacket packet;
+    packet.addr = sep->endpoint.addr;
+    packet.port = sep->endpoint.port;
+    packet.ifindex = sep->endpoint.ifindex;
+    packet.flags = sep->endpoint.flags;
+    packet.payload.assign((const char *) data, dataLength);
+
+    oc_mutex_lock(g_packetMutex);
+    g_packets.push_back(packet);
+    oc_cond_signal(g_packetCond);
+    oc_mutex_unlock(g_packetMutex);
+}
+
+class CAIPServerTests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_packets.clear();
+        g_packetMutex = oc_mutex_new();
+        g_packetCond = oc_cond_new();
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &threadPool));
+
+        // What CAInitializeIP() does for an IPv4 only server.
+        caglobals.ip.u6.fd = caglobals.ip.u6s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.u4.fd = caglobals.ip.u4s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.m6.fd = caglobals.ip.m6s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.m4.fd = caglobals.ip.m4s.fd = OC_INVALID_SOCKET;
+        caglobals.ip.u4.port = caglobals.ip.u4s.port = 0;
+        caglobals.ip.m4.port = CA_COAP;
+        caglobals.ip.m4s.port = CA_SECURE_COAP;
+        caglobals.ip.ipv4enabled = true;
+        caglobals.ip.ipv6enabled = false;
+
+        CAIPSetPacketReceiveCallback(PacketReceived);
+        ASSERT_EQ(CA_STATUS_OK, CAIPStartServer(threadPool));
+        ASSERT_NE(0, caglobals.ip.u4.port);
+    }
+
+    virtual void TearDown()
+    {
+        CAIPStopServer();
+        ca_thread_pool_free(threadPool);
+        CAIPSetPacketReceiveCallback(NULL);
+        CADeInitializeIPGlobals();
+        oc_cond_free(g_packetCond);
+        oc_mutex_free(g_packetMutex);
+    }
+
+    static int CreateSender(uint16_t *port)
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (-1 == fd)
+        {
+            return -1;
+        }
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (0 != bind(fd, (struct sockaddr *) &addr, sizeof(addr))
+            || 0 != getsockname(fd, (struct sockaddr *) &addr, &len))
+        {
+            close(fd);
+            return -1;
+        }
+        *port = ntohs(addr.sin_port);
+        return fd;
+    }
+
+    static bool WaitForPackets(size_t count)
+    {
+        bool received = true;
+        oc_mutex_lock(g_packetMutex);
+        while (g_packets.size() < count)
+        {
+            if (OC_WAIT_TIMEDOUT == oc_cond_wait_for(g_packetCond, g_packetMutex,
+                                                     RECEIVE_TIMEOUT_US))
+            {
+                received = false;
+                break;
+            }
+        }
+        oc_mutex_unlock(g_packetMutex);
+        return received;
+    }
+
+    ca_thread_pool_t threadPool;
+};
+
+TEST_F(CAIPServerTests, ReceivesBurstWithSourceAndInterface)
+{
+    uint16_t senderPorts[2];
+    int senders[2];
+    senders[0] = CreateSender(&senderPorts[0]);
+    senders[1] = CreateSender(&senderPorts[1]);
+    ASSERT_NE(-1, senders[0]);
+    ASSERT_NE(-1, senders[1]);
+
+    struct sockaddr_in server;
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.sin_port = htons(caglobals.ip.u4.port);
+
+    for (int i = 0; i < BURST_SIZE; i++)
+    {
+        char payload[32];
+        int length = snprintf(payload, sizeof(payload), "packet-%d", i);
+        EXPECT_EQ(length, sendto(senders[i % 2], payload, length, 0,
+                                 (struct sockaddr *) &server, sizeof(server)));
+    }
+
+    EXPECT_TRUE(WaitForPackets(BURST_SIZE));
+    close(senders[0]);
+    close(senders[1]);
+
+    oc_mutex_lock(g_packetMutex);
+    std::vector<ReceivedPacket> packets = g_packets;
+    oc_mutex_unlock(g_packetMutex);
+    ASSERT_EQ(static_cast<size_t>(BURST_SIZE), packets.size());
+
+    // Datagrams from one sender arrive in order, each with its own source.
+    int next[2] = { 0, 1 };
+    uint32_t loopback = if_nametoindex("lo");
+    for (size_t i = 0; i < packets.size(); i++)
+    {
+        const ReceivedPacket &packet = packets[i];
+        int sender = (packet.port == senderPorts[0]) ? 0 : 1;
+        ASSERT_EQ(senderPorts[sender], packet.port);
+
+        char expected[32];
+        snprintf(expected, sizeof(expected), "packet-%d", next[sender]);
+        EXPECT_EQ(std::string(expected), packet.payload);
+        next[sender] += 2;
+
+        EXPECT_EQ(std::string("127.0.0.1"), packet.addr);
+        EXPECT_EQ(loopback, packet.ifindex);
+        EXPECT_TRUE(packet.flags & CA_IPV4);
+        EXPECT_FALSE(packet.flags & CA_MULTICAST);
+        EXPECT_FALSE(packet.flags & CA_SECURE);
+    }
+    EXPECT_EQ(BURST_SIZE, next[0]);
+    EXPECT_EQ(BURST_SIZE + 1, next[1]);
+}
+
+TEST_F(CAIPServerTests, MulticastInterfacesListEachInterfaceOnce)
+{
+    // What the snapshot is built from, one entry per address.
+    std::set<uint32_t> expected;
+    u_arraylist_t *iflist = CAIPGetInterfaceInformation(0);
+    ASSERT_TRUE(iflist != NULL);
+    for (size_t i = 0; i < u_arraylist_length(iflist); i++)
+    {
+        CAInterface_t *ifitem = (CAInterface_t *) u_arraylist_get(iflist, i);
+        if (ifitem && AF_INET == ifitem->family
+            && (ifitem->flags & (IFF_UP | IFF_RUNNING)) == (IFF_UP | IFF_RUNNING))
+        {
+            expected.insert(ifitem->index);
+        }
+    }
+    u_arraylist_destroy(iflist);
+
+    // Built when the listen server started, and the same after a refresh.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        uint32_t indexes[MAX_INTERFACES];
+        size_t count = CAIPGetMulticastInterfaces(AF_INET, indexes, MAX_INTERFACES);
+        std::set<uint32_t> actual(indexes, indexes + count);
+        EXPECT_EQ(count, actual.size());
+        EXPECT_EQ(expected, actual);
+
+        CAIPRefreshMulticastInterfaces();
+    }
+
+    // The output size is respected.
+    uint32_t index = 0;
+    EXPECT_GE(static_cast<size_t>(1), CAIPGetMulticastInterfaces(AF_INET, &index, 1));
+}
+
+#endif // __linux__
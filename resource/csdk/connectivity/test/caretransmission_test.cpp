@@ -0,0 +1,241 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+// The heap is internal to caretransmission.c, so the tests build their own
+// copy of it under different names, the way ssladapter_test.cpp does.
+#define CARetransmissionInitialize CARetransmissionInitializeTest
+#define CARetransmissionStart CARetransmissionStartTest
+#define CARetransmissionSentData CARetransmissionSentDataTest
+#define CARetransmissionReceivedData CARetransmissionReceivedDataTest
+#define CARetransmissionStop CARetransmissionStopTest
+#define CARetransmissionDestroy CARetransmissionDestroyTest
+#define CARetransmissionBaseRoutine CARetransmissionBaseRoutineTest
+
+#include "../src/caretransmission.c"
+#include "oic_string.h"
+
+#define CON_GET         0x40    // version 1, CON, no token
+#define ACK_EMPTY       0x60    // version 1, ACK, no token
+#define CODE_GET        0x01
+#define CODE_EMPTY      0x00
+#define CODE_CONTENT    0x45
+
+static std::vector<uint16_t> g_sentMessageIds;
+
+static CAResult_t RecordSentData(const CAEndpoint_t *endpoint, const void *pdu,
+                                 uint32_t size, CADataType_t dataType)
+{
+    (void) endpoint;
+    (void) dataType;
+    g_sentMessageIds.push_back(CAGetMessageIdFromPduBinaryData(pdu, size));
+    return CA_STATUS_OK;
+}
+
+class CARetransmissionTests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_sentMessageIds.clear();
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.flags = CA_IPV4;
+        OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "127.0.0.1");
+        endpoint.port = 5683;
+
+        // The retransmission thread is never started; tests drive the heap.
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &threadPool));
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitializeTest(&context, threadPool,
+                                                               RecordSentData, NULL, NULL));
+    }
+
+    virtual void TearDown()
+    {
+        CARetransmissionDestroyTest(&context);
+        ca_thread_pool_free(threadPool);
+    }
+
+    CAResult_t Send(uint8_t type, uint8_t code, uint16_t messageId)
+    {
+        uint8_t pdu[4] = { type, code, (uint8_t) (messageId >> 8), (uint8_t) messageId };
+        return CARetransmissionSentDataTest(&context, &endpoint, CA_REQUEST_DATA,
+                                            pdu, sizeof(pdu));
+    }
+
+    CAResult_t Receive(uint8_t type, uint8_t code, uint16_t messageId, void **retransmissionPdu)
+    {
+        uint8_t pdu[4] = { type, code, (uint8_t) (messageId >> 8), (uint8_t) messageId };
+        return CARetransmissionReceivedDataTest(&context, &endpoint, pdu, sizeof(pdu),
+                                                retransmissionPdu);
+    }
+
+    CARetransmissionData_t *Find(uint16_t messageId)
+    {
+        uint8_t pdu[4] = { CON_GET, CODE_GET, (uint8_t) (messageId >> 8), (uint8_t) messageId };
+        CARetransmissionKey_t key;
+        CAMakeRetransmissionKey(endpoint.adapter,
+                                CAGetMessageIdFromPduBinaryData(pdu, sizeof(pdu)), &key);
+        return (CARetransmissionData_t *) u_hashmap_get(context.dataIndex, &key, sizeof(key));
+    }
+
+    // Every parent is due no later than its children, and every node knows
+    // where it is.
+    void ExpectValidHeap()
+    {
+        for (size_t i = 0; i < context.dataCount; i++)
+        {
+            CARetransmissionData_t *node = context.dataHeap[i];
+            EXPECT_EQ(i + 1, node->heapIndex);
+            if (i > 0)
+            {
+                EXPECT_LE(context.dataHeap[(i - 1) / 2]->nextTime, node->nextTime);
+            }
+        }
+    }
+
+    ca_thread_pool_t threadPool;
+    CARetransmission_t context;
+    CAEndpoint_t endpoint;
+};
+
+TEST_F(CARetransmissionTests, HeapStaysOrdered)
+{
+    for (uint16_t id = 1; id <= 50; id++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, Send(CON_GET, CODE_GET, id));
+        ExpectValidHeap();
+    }
+    EXPECT_EQ(static_cast<size_t>(50), context.dataCount);
+
+    // Only CON messages are tracked, and a message id only once.
+    EXPECT_EQ(CA_NOT_SUPPORTED, Send(ACK_EMPTY, CODE_EMPTY, 100));
+    EXPECT_EQ(CA_STATUS_FAILED, Send(CON_GET, CODE_GET, 1));
+    EXPECT_EQ(static_cast<size_t>(50), context.dataCount);
+}
+
+TEST_F(CARetransmissionTests, DueMessagesAreResentEarliestFirst)
+{
+    for (uint16_t id = 1; id <= 20; id++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, Send(CON_GET, CODE_GET, id));
+    }
+
+    // Make everything due without changing the order.
+    std::vector<std::pair<uint64_t, uint16_t> > due;
+    for (size_t i = 0; i < context.dataCount; i++)
+    {
+        CARetransmissionData_t *node = context.dataHeap[i];
+        node->timeStamp -= 60 * USECS_PER_SEC;
+        node->nextTime -= 60 * USECS_PER_SEC;
+        due.push_back(std::make_pair(node->nextTime, node->messageId));
+    }
+    std::sort(due.begin(), due.end());
+
+    CACheckRetransmissionList(&context);
+
+    ASSERT_EQ(due.size(), g_sentMessageIds.size());
+    for (size_t i = 0; i < due.size(); i++)
+    {
+        EXPECT_EQ(due[i].second, g_sentMessageIds[i]);
+    }
+
+    // Each was sent once and rescheduled, nothing is due again yet.
+    EXPECT_EQ(static_cast<size_t>(20), context.dataCount);
+    ExpectValidHeap();
+    g_sentMessageIds.clear();
+    CACheckRetransmissionList(&context);
+    EXPECT_TRUE(g_sentMessageIds.empty());
+}
+
+TEST_F(CARetransmissionTests, AckCancelsRetransmission)
+{
+    for (uint16_t id = 1; id <= 3; id++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, Send(CON_GET, CODE_GET, id));
+    }
+
+    // An empty ACK returns the request so the caller can recover its token.
+    void *retransmissionPdu = NULL;
+    EXPECT_EQ(CA_STATUS_OK, Receive(ACK_EMPTY, CODE_EMPTY, 2, &retransmissionPdu));
+    ASSERT_TRUE(retransmissionPdu != NULL);
+    EXPECT_EQ(CON_GET, ((uint8_t *) retransmissionPdu)[0]);
+    OICFree(retransmissionPdu);
+    EXPECT_EQ(static_cast<size_t>(2), context.dataCount);
+    EXPECT_TRUE(Find(2) == NULL);
+
+    // A piggybacked response cancels without copying the request.
+    retransmissionPdu = NULL;
+    EXPECT_EQ(CA_STATUS_OK, Receive(ACK_EMPTY, CODE_CONTENT, 3, &retransmissionPdu));
+    EXPECT_TRUE(retransmissionPdu == NULL);
+    EXPECT_EQ(static_cast<size_t>(1), context.dataCount);
+    EXPECT_TRUE(Find(3) == NULL);
+
+    // Unknown or repeated ACKs change nothing.
+    EXPECT_EQ(CA_STATUS_OK, Receive(ACK_EMPTY, CODE_CONTENT, 3, &retransmissionPdu));
+    EXPECT_EQ(CA_STATUS_OK, Receive(ACK_EMPTY, CODE_CONTENT, 99, &retransmissionPdu));
+    EXPECT_EQ(static_cast<size_t>(1), context.dataCount);
+    EXPECT_TRUE(Find(1) != NULL);
+    ExpectValidHeap();
+}
+
+TEST_F(CARetransmissionTests, RemoveFromMiddleOfHeap)
+{
+    for (uint16_t id = 1; id <= 31; id++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, Send(CON_GET, CODE_GET, id));
+    }
+
+    // Remove a leaf, an inner node, the root and the last node in turn.
+    size_t positions[] = { 20, 3, 0, SIZE_MAX };
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+    {
+        size_t count = context.dataCount;
+        size_t pos = std::min(positions[i], count - 1);
+        uint16_t messageId = context.dataHeap[pos]->messageId;
+        uint8_t *raw = (uint8_t *) &messageId;
+
+        void *retransmissionPdu = NULL;
+        uint8_t ack[4] = { ACK_EMPTY, CODE_CONTENT, raw[0], raw[1] };
+        EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedDataTest(&context, &endpoint, ack,
+                                                                 sizeof(ack),
+                                                                 &retransmissionPdu));
+        EXPECT_EQ(count - 1, context.dataCount);
+        ExpectValidHeap();
+
+        CARetransmissionKey_t key;
+        CAMakeRetransmissionKey(endpoint.adapter, messageId, &key);
+        EXPECT_TRUE(u_hashmap_get(context.dataIndex, &key, sizeof(key)) == NULL);
+    }
+
+    // Everything left can still be found through the index.
+    for (size_t i = 0; i < context.dataCount; i++)
+    {
+        CARetransmissionKey_t key;
+        CAMakeRetransmissionKey(endpoint.adapter, context.dataHeap[i]->messageId, &key);
+        EXPECT_EQ(context.dataHeap[i],
+                  u_hashmap_get(context.dataIndex, &key, sizeof(key)));
+    }
+}
@@ -0,0 +1,213 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#if defined(__linux__) && defined(TCP_ADAPTER)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "cacommon.h"
+#include "catcpinterface.h"
+#include "cathreadpool.h"
+#include "oic_string.h"
+#include "oic_time.h"
+
+#define DISCONNECT_TIMEOUT_MS   5000
+
+// Same values as catcpadapter.c.
+#define TEST_TCP_SELECT_TIMEOUT     10
+#define TEST_TCP_LISTEN_BACKLOG     3
+
+class CATCPServerTests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &threadPool));
+
+        // What CAInitializeTCP() does before the server starts.
+        caglobals.tcp.ipv4.fd = caglobals.tcp.ipv4s.fd = OC_INVALID_SOCKET;
+        caglobals.tcp.ipv6.fd = caglobals.tcp.ipv6s.fd = OC_INVALID_SOCKET;
+        caglobals.tcp.ipv4.port = caglobals.tcp.ipv4s.port = 0;
+        caglobals.tcp.ipv6.port = caglobals.tcp.ipv6s.port = 0;
+        caglobals.tcp.selectTimeout = TEST_TCP_SELECT_TIMEOUT;
+        caglobals.tcp.listenBacklog = TEST_TCP_LISTEN_BACKLOG;
+
+        ASSERT_EQ(CA_STATUS_OK, CATCPStartServer(threadPool));
+    }
+
+    virtual void TearDown()
+    {
+        CATCPStopServer();
+        ca_thread_pool_free(threadPool);
+    }
+
+    // Plain listening socket standing in for the remote device.
+    static int CreatePeer(uint16_t *port)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (-1 == fd)
+        {
+            return -1;
+        }
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (0 != bind(fd, (struct sockaddr *) &addr, sizeof(addr))
+            || 0 != listen(fd, 1)
+            || 0 != getsockname(fd, (struct sockaddr *) &addr, &len))
+        {
+            close(fd);
+            return -1;
+        }
+        *port = ntohs(addr.sin_port);
+        return fd;
+    }
+
+    static CAEndpoint_t MakeEndpoint(uint16_t port)
+    {
+        CAEndpoint_t endpoint;
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_TCP;
+        endpoint.flags = CA_IPV4;
+        OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "127.0.0.1");
+        endpoint.port = port;
+        return endpoint;
+    }
+
+    static bool WaitForSessionRemoval(CASocketFd_t fd)
+    {
+        uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + DISCONNECT_TIMEOUT_MS;
+        while (CAGetSessionInfoFromFD(fd))
+        {
+            if (OICGetCurrentTime(TIME_IN_MS) > deadline)
+            {
+                return false;
+            }
+            usleep(10 * 1000);
+        }
+        return true;
+    }
+
+    ca_thread_pool_t threadPool;
+};
+
+TEST_F(CATCPServerTests, ConnectAndLookUpSession)
+{
+    uint16_t peerPort = 0;
+    int peer = CreatePeer(&peerPort);
+    ASSERT_NE(-1, peer);
+
+    CAEndpoint_t endpoint = MakeEndpoint(peerPort);
+    CASocketFd_t fd = CAConnectTCPSession(&endpoint);
+    ASSERT_NE(OC_INVALID_SOCKET, fd);
+    int accepted = accept(peer, NULL, NULL);
+    EXPECT_NE(-1, accepted);
+
+    CATCPSessionInfo_t *session = CAGetTCPSessionInfoFromEndpoint(&endpoint);
+    ASSERT_TRUE(session != NULL);
+    EXPECT_EQ(fd, session->fd);
+    EXPECT_EQ(CONNECTED, session->state);
+    EXPECT_TRUE(session->isClient);
+    EXPECT_EQ(fd, CAGetSocketFDFromEndpoint(&endpoint));
+    EXPECT_EQ(session, CAGetSessionInfoFromFD(fd));
+
+    // A different port or an unknown fd is not a match.
+    CAEndpoint_t other = MakeEndpoint(peerPort + 1);
+    EXPECT_TRUE(CAGetTCPSessionInfoFromEndpoint(&other) == NULL);
+    EXPECT_EQ(OC_INVALID_SOCKET, CAGetSocketFDFromEndpoint(&other));
+    EXPECT_TRUE(CAGetSessionInfoFromFD(accepted) == NULL);
+
+    close(accepted);
+    close(peer);
+}
+
+TEST_F(CATCPServerTests, SessionsAreIndexedSeparately)
+{
+    uint16_t peerPorts[2];
+    int peers[2];
+    peers[0] = CreatePeer(&peerPorts[0]);
+    peers[1] = CreatePeer(&peerPorts[1]);
+    ASSERT_NE(-1, peers[0]);
+    ASSERT_NE(-1, peers[1]);
+
+    CAEndpoint_t endpoints[2] = { MakeEndpoint(peerPorts[0]), MakeEndpoint(peerPorts[1]) };
+    CASocketFd_t fds[2];
+    int accepted[2];
+    for (int i = 0; i < 2; i++)
+    {
+        fds[i] = CAConnectTCPSession(&endpoints[i]);
+        ASSERT_NE(OC_INVALID_SOCKET, fds[i]);
+        accepted[i] = accept(peers[i], NULL, NULL);
+        EXPECT_NE(-1, accepted[i]);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        CATCPSessionInfo_t *session = CAGetTCPSessionInfoFromEndpoint(&endpoints[i]);
+        ASSERT_TRUE(session != NULL);
+        EXPECT_EQ(fds[i], session->fd);
+        EXPECT_EQ(peerPorts[i], session->sep.endpoint.port);
+        EXPECT_EQ(session, CAGetSessionInfoFromFD(fds[i]));
+    }
+
+    // Deleting one session leaves the other reachable both ways.
+    EXPECT_EQ(CA_STATUS_OK, CASearchAndDeleteTCPSession(&endpoints[0]));
+    EXPECT_TRUE(CAGetTCPSessionInfoFromEndpoint(&endpoints[0]) == NULL);
+    EXPECT_TRUE(CAGetSessionInfoFromFD(fds[0]) == NULL);
+    EXPECT_EQ(fds[1], CAGetSocketFDFromEndpoint(&endpoints[1]));
+    EXPECT_TRUE(CAGetSessionInfoFromFD(fds[1]) != NULL);
+
+    for (int i = 0; i < 2; i++)
+    {
+        close(accepted[i]);
+        close(peers[i]);
+    }
+}
+
+TEST_F(CATCPServerTests, SessionRemovedWhenPeerDisconnects)
+{
+    uint16_t peerPort = 0;
+    int peer = CreatePeer(&peerPort);
+    ASSERT_NE(-1, peer);
+
+    CAEndpoint_t endpoint = MakeEndpoint(peerPort);
+    CASocketFd_t fd = CAConnectTCPSession(&endpoint);
+    ASSERT_NE(OC_INVALID_SOCKET, fd);
+    int accepted = accept(peer, NULL, NULL);
+    ASSERT_NE(-1, accepted);
+    ASSERT_TRUE(CAGetSessionInfoFromFD(fd) != NULL);
+
+    // The receive thread sees the end of stream and drops the session.
+    close(accepted);
+    EXPECT_TRUE(WaitForSessionRemoval(fd));
+    EXPECT_TRUE(CAGetTCPSessionInfoFromEndpoint(&endpoint) == NULL);
+    EXPECT_EQ(OC_INVALID_SOCKET, CAGetSocketFDFromEndpoint(&endpoint));
+
+    close(peer);
+}
+
+#endif // __linux__ && TCP_ADAPTER
@@ -24,6 +24,8 @@
 #endif
 
 #include <cinttypes>
+#include <utility>
+#include <vector>
 #include "iotivity_config.h"
 #include "gtest/gtest.h"
 #include "time.h"
@@ -48,6 +50,9 @@
 #define GetCASecureEndpointData GetCASecureEndpointDataTest
 #define SetCASecureEndpointAttribute SetCASecureEndpointAttributeTest
 #define GetCASecureEndpointAttributes GetCASecureEndpointAttributesTest
+#define CAsetSslSessionCacheConfig CAsetSslSessionCacheConfigTest
+#define CAgetSslSessionCacheStats CAgetSslSessionCacheStatsTest
+#define CAsslClearSessionCache CAsslClearSessionCacheTest
 
 #include "../src/adapter_util/ca_adapter_net_ssl.c"
 
@@ -85,6 +90,7 @@
 #endif //HAVE_WINDOWS_H
 #include "platform_features.h"
 #include "logger.h"
+#include "oic_string.h"
 
 
 #define SEED "PREDICTED_SEED"
@@ -3289,3 +3295,185 @@ TEST(TLSAdapter, TestCertsValid)
     EXPECT_EQ(0, ret) << "Failed to parse CA cert";
     mbedtls_x509_crt_free(&cert);
 }
+
+static std::vector<std::pair<uint16_t, CAResult_t> > g_peerResults;
+
+static ssize_t DiscardSendCB(CAEndpoint_t *, const void *, size_t buflen)
+{
+    return buflen;
+}
+
+static void DiscardReceivedCB(const CASecureEndpoint_t *, const void *, size_t)
+{
+}
+
+static void RecordPeerResult(const CAEndpoint_t *endpoint, const CAErrorInfo_t *info)
+{
+    g_peerResults.push_back(std::make_pair(endpoint->port, info->result));
+}
+
+static SslEndPoint_t *NewTestPeer(uint16_t port)
+{
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_TCP;
+    endpoint.flags = CA_IPV4;
+    OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "127.0.0.1");
+    endpoint.port = port;
+    return NewSslEndPoint(&endpoint, &g_caSslContext->serverTlsConf);
+}
+
+// Fills the peer list and adds one more peer. The caller holds g_sslContextMutex,
+// so a failed assertion only returns from here and the test can still unlock it.
+static void FillPeerListAndEvict()
+{
+    for (uint16_t i = 0; i < SSL_MAX_PEERS; i++)
+    {
+        SslEndPoint_t *tep = NewTestPeer(10000 + i);
+        ASSERT_TRUE(tep != NULL);
+        ASSERT_TRUE(AddPeerToList(tep));
+    }
+    EXPECT_EQ(static_cast<size_t>(SSL_MAX_PEERS), g_caSslContext->peerCount);
+
+    // Every peer is still in its handshake, so none of them is dropped.
+    SslEndPoint_t *extra = NewTestPeer(20000);
+    ASSERT_TRUE(extra != NULL);
+    EXPECT_FALSE(AddPeerToList(extra));
+    DeleteSslEndPoint(extra);
+    EXPECT_EQ(static_cast<size_t>(SSL_MAX_PEERS), g_caSslContext->peerCount);
+    EXPECT_TRUE(g_peerResults.empty());
+
+    // The least recently used established peer makes room.
+    CAEndpoint_t endpoint = g_caSslContext->peerList->sep.endpoint;
+    endpoint.port = 10009;
+    SslEndPoint_t *peer = GetSslPeer(&endpoint);
+    ASSERT_TRUE(peer != NULL);
+    peer->ssl.state = MBEDTLS_SSL_HANDSHAKE_OVER;
+    endpoint.port = 10005;
+    peer = GetSslPeer(&endpoint);
+    ASSERT_TRUE(peer != NULL);
+    peer->ssl.state = MBEDTLS_SSL_HANDSHAKE_OVER;
+
+    extra = NewTestPeer(20000);
+    ASSERT_TRUE(extra != NULL);
+    EXPECT_TRUE(AddPeerToList(extra));
+    EXPECT_EQ(static_cast<size_t>(SSL_MAX_PEERS), g_caSslContext->peerCount);
+    EXPECT_TRUE(GetSslPeer(&endpoint) == NULL);
+    endpoint.port = 10009;
+    EXPECT_TRUE(GetSslPeer(&endpoint) != NULL);
+    endpoint.port = 20000;
+    EXPECT_EQ(extra, GetSslPeer(&endpoint));
+}
+
+TEST(TLSAdapter, PeerLimitEvictsOnlyIdlePeers)
+{
+    g_peerResults.clear();
+    ASSERT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+    CAsetSslAdapterCallbacks(DiscardReceivedCB, DiscardSendCB, CA_ADAPTER_TCP);
+    CAsetSslHandshakeCallback(RecordPeerResult);
+
+    oc_mutex_lock(g_sslContextMutex);
+    FillPeerListAndEvict();
+    oc_mutex_unlock(g_sslContextMutex);
+
+    if (!HasFatalFailure())
+    {
+        EXPECT_EQ(static_cast<size_t>(1), g_peerResults.size());
+        if (1 == g_peerResults.size())
+        {
+            EXPECT_EQ(10005, g_peerResults[0].first);
+            EXPECT_EQ(CA_DESTINATION_DISCONNECTED, g_peerResults[0].second);
+        }
+    }
+
+    CAsetSslHandshakeCallback(NULL);
+    CAdeinitSslAdapter();
+}
+
+static void AddTestSession(uint16_t port)
+{
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_TCP;
+    OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "127.0.0.1");
+    endpoint.port = port;
+
+    SslSession_t *entry = (SslSession_t *) OICCalloc(1, sizeof(SslSession_t));
+    ASSERT_TRUE(entry != NULL);
+    mbedtls_ssl_session_init(&entry->session);
+    MakeSslPeerKey(&endpoint, &entry->key);
+    entry->savedTime = OICGetCurrentTime(TIME_IN_MS);
+    ASSERT_TRUE(u_hashmap_put(g_caSslContext->sessionIndex, &entry->key, sizeof(entry->key),
+                              entry));
+    DL_APPEND(g_caSslContext->sessionList, entry);
+    g_caSslContext->sessionCount++;
+}
+
+TEST(TLSAdapter, ClearSessionCacheDropsResumableSessions)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    session.ciphersuite = MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CCM_8;
+    session.id_len = 32;
+    memset(session.id, 0x5A, session.id_len);
+
+    oc_mutex_lock(g_sslContextMutex);
+    AddTestSession(10001);
+    AddTestSession(10002);
+#ifdef MBEDTLS_SSL_CACHE_C
+    EXPECT_EQ(0, mbedtls_ssl_cache_set(&g_caSslContext->sessionCache, &session));
+    mbedtls_ssl_session cached = session;
+    EXPECT_EQ(0, mbedtls_ssl_cache_get(&g_caSslContext->sessionCache, &cached));
+#endif
+#ifdef SSL_SESSION_TICKETS
+    unsigned char ticket[512];
+    unsigned char parsed[512];
+    size_t ticketLen = 0;
+    uint32_t lifetime = 0;
+    ASSERT_EQ(0, mbedtls_ssl_ticket_write(&g_caSslContext->ticketCtx, &session, ticket,
+                                          ticket + sizeof(ticket), &ticketLen, &lifetime));
+    EXPECT_EQ(static_cast<uint32_t>(SSL_SESSION_CACHE_LIFETIME), lifetime);
+    memcpy(parsed, ticket, ticketLen);
+    mbedtls_ssl_session fromTicket;
+    mbedtls_ssl_session_init(&fromTicket);
+    EXPECT_EQ(0, mbedtls_ssl_ticket_parse(&g_caSslContext->ticketCtx, &fromTicket, parsed,
+                                          ticketLen));
+    mbedtls_ssl_session_free(&fromTicket);
+#endif
+
+    // Like a handshake callback, which runs with the context locked. The
+    // sessions are dropped the next time the adapter takes the lock.
+    CAsslClearSessionCache();
+    EXPECT_EQ(static_cast<size_t>(2), g_caSslContext->sessionCount);
+    oc_mutex_unlock(g_sslContextMutex);
+
+    CASslSessionCacheStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAgetSslSessionCacheStats(&stats));
+    EXPECT_EQ(static_cast<size_t>(0), stats.savedSessions);
+    oc_mutex_lock(g_sslContextMutex);
+    EXPECT_TRUE(g_caSslContext->sessionList == NULL);
+#ifdef MBEDTLS_SSL_CACHE_C
+    cached = session;
+    EXPECT_NE(0, mbedtls_ssl_cache_get(&g_caSslContext->sessionCache, &cached));
+#endif
+#ifdef SSL_SESSION_TICKETS
+    // Tickets issued before are no longer accepted, new ones are.
+    memcpy(parsed, ticket, ticketLen);
+    mbedtls_ssl_session_init(&fromTicket);
+    EXPECT_NE(0, mbedtls_ssl_ticket_parse(&g_caSslContext->ticketCtx, &fromTicket, parsed,
+                                          ticketLen));
+    mbedtls_ssl_session_free(&fromTicket);
+    ASSERT_EQ(0, mbedtls_ssl_ticket_write(&g_caSslContext->ticketCtx, &session, ticket,
+                                          ticket + sizeof(ticket), &ticketLen, &lifetime));
+    mbedtls_ssl_session_init(&fromTicket);
+    EXPECT_EQ(0, mbedtls_ssl_ticket_parse(&g_caSslContext->ticketCtx, &fromTicket, ticket,
+                                          ticketLen));
+    mbedtls_ssl_session_free(&fromTicket);
+#endif
+    oc_mutex_unlock(g_sslContextMutex);
+
+    mbedtls_ssl_session_free(&session);
+    CAdeinitSslAdapter();
+}
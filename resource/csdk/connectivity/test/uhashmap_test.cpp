@@ -0,0 +1,144 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+#include "uhashmap.h"
+
+class UHashMapF : public testing::Test
+{
+public:
+    UHashMapF() :
+      testing::Test(),
+      map(NULL)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        map = u_hashmap_create(0);
+        ASSERT_TRUE(map != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        u_hashmap_free(&map);
+        ASSERT_EQ(NULL, map);
+    }
+
+    u_hashmap_t *map;
+};
+
+TEST(UHashMap, Base)
+{
+    u_hashmap_t *map = u_hashmap_create(0);
+    ASSERT_TRUE(map != NULL);
+
+    u_hashmap_free(&map);
+    ASSERT_EQ(NULL, map);
+}
+
+TEST(UHashMap, FreeNull)
+{
+    u_hashmap_free(NULL);
+}
+
+TEST_F(UHashMapF, PutGet)
+{
+    int first = 1;
+    int second = 2;
+
+    EXPECT_TRUE(u_hashmap_put(map, "/a/led", strlen("/a/led"), &first));
+    EXPECT_TRUE(u_hashmap_put(map, "/a/fan", strlen("/a/fan"), &second));
+    ASSERT_EQ(static_cast<size_t>(2), u_hashmap_length(map));
+
+    EXPECT_EQ(&first, u_hashmap_get(map, "/a/led", strlen("/a/led")));
+    EXPECT_EQ(&second, u_hashmap_get(map, "/a/fan", strlen("/a/fan")));
+    EXPECT_EQ(NULL, u_hashmap_get(map, "/a/light", strlen("/a/light")));
+
+    // Prefix of a stored key must not match.
+    EXPECT_EQ(NULL, u_hashmap_get(map, "/a/le", strlen("/a/le")));
+}
+
+TEST_F(UHashMapF, PutReplaces)
+{
+    int first = 1;
+    int second = 2;
+
+    EXPECT_TRUE(u_hashmap_put(map, "key", 3, &first));
+    EXPECT_TRUE(u_hashmap_put(map, "key", 3, &second));
+    ASSERT_EQ(static_cast<size_t>(1), u_hashmap_length(map));
+    EXPECT_EQ(&second, u_hashmap_get(map, "key", 3));
+}
+
+TEST_F(UHashMapF, Remove)
+{
+    size_t dummy[1000] = {0};
+    size_t cap = sizeof(dummy) / sizeof(dummy[0]);
+
+    for (size_t i = 0; i < cap; ++i)
+    {
+        dummy[i] = i;
+        EXPECT_TRUE(u_hashmap_put(map, &i, sizeof(i), &dummy[i]));
+    }
+    ASSERT_EQ(cap, u_hashmap_length(map));
+
+    for (size_t i = 0; i < cap; i += 2)
+    {
+        EXPECT_EQ(&dummy[i], u_hashmap_remove(map, &i, sizeof(i)));
+    }
+    ASSERT_EQ(cap / 2, u_hashmap_length(map));
+
+    for (size_t i = 0; i < cap; ++i)
+    {
+        EXPECT_EQ((i % 2) ? &dummy[i] : NULL, u_hashmap_get(map, &i, sizeof(i)));
+    }
+    EXPECT_EQ(NULL, u_hashmap_remove(map, "missing", 7));
+}
+
+TEST_F(UHashMapF, Iterate)
+{
+    size_t dummy[100] = {0};
+    size_t cap = sizeof(dummy) / sizeof(dummy[0]);
+
+    for (size_t i = 0; i < cap; ++i)
+    {
+        dummy[i] = i;
+        EXPECT_TRUE(u_hashmap_put(map, &i, sizeof(i), &dummy[i]));
+    }
+
+    size_t visited = 0;
+    size_t sum = 0;
+    void *data = NULL;
+    u_hashmap_iterator_t iterator;
+    u_hashmap_iterator_init(map, &iterator);
+    while (u_hashmap_next(&iterator, &data))
+    {
+        size_t value = *static_cast<size_t *>(data);
+        sum += value;
+        visited++;
+        // Removing the entry just returned is allowed.
+        EXPECT_EQ(data, u_hashmap_remove(map, &value, sizeof(value)));
+    }
+    EXPECT_EQ(cap, visited);
+    EXPECT_EQ(cap * (cap - 1) / 2, sum);
+    EXPECT_EQ(static_cast<size_t>(0), u_hashmap_length(map));
+}
@@ -0,0 +1,290 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "uringbuffer.h"
+#include "caqueueingthread.h"
+#include "uqueue.h"
+#include "octhread.h"
+
+
+#define PRODUCER_COUNT      4
+#define MESSAGES_PER_THREAD 2000
+
+class URingBufferF : public testing::Test {
+public:
+    URingBufferF() :
+      testing::Test(),
+      ringBuffer(NULL)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        ringBuffer = u_ringbuffer_create(8);
+        ASSERT_TRUE(ringBuffer != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        u_ringbuffer_delete(ringBuffer);
+    }
+
+    u_ringbuffer_t *ringBuffer;
+};
+
+static u_queue_message_t MakeMessage(uintptr_t value)
+{
+    u_queue_message_t message;
+    message.msg = (void *) value;
+    message.size = 0;
+    return message;
+}
+
+TEST(URingBuffer, Base)
+{
+    u_ringbuffer_t *ringBuffer = u_ringbuffer_create(16);
+    ASSERT_TRUE(ringBuffer != NULL);
+
+    u_ringbuffer_delete(ringBuffer);
+}
+
+TEST(URingBuffer, InvalidCapacity)
+{
+    EXPECT_TRUE(u_ringbuffer_create(0) == NULL);
+}
+
+TEST(URingBuffer, CapacityRoundsUp)
+{
+    u_ringbuffer_t *ringBuffer = u_ringbuffer_create(5);
+    ASSERT_TRUE(ringBuffer != NULL);
+
+    for (uintptr_t i = 0; i < 8; ++i)
+    {
+        u_queue_message_t message = MakeMessage(i);
+        EXPECT_TRUE(u_ringbuffer_push(ringBuffer, &message));
+    }
+    u_queue_message_t message = MakeMessage(8);
+    EXPECT_FALSE(u_ringbuffer_push(ringBuffer, &message));
+
+    u_ringbuffer_delete(ringBuffer);
+}
+
+TEST_F(URingBufferF, PushPopOrder)
+{
+    u_queue_message_t message;
+    EXPECT_FALSE(u_ringbuffer_pop(ringBuffer, &message));
+
+    // Go around the ring several times.
+    for (uintptr_t round = 0; round < 5; ++round)
+    {
+        for (uintptr_t i = 0; i < 6; ++i)
+        {
+            message = MakeMessage(round * 100 + i);
+            EXPECT_TRUE(u_ringbuffer_push(ringBuffer, &message));
+        }
+        EXPECT_EQ(static_cast<uint32_t>(6), u_ringbuffer_get_size(ringBuffer));
+
+        for (uintptr_t i = 0; i < 6; ++i)
+        {
+            ASSERT_TRUE(u_ringbuffer_pop(ringBuffer, &message));
+            EXPECT_EQ((void *) (round * 100 + i), message.msg);
+        }
+        EXPECT_EQ(static_cast<uint32_t>(0), u_ringbuffer_get_size(ringBuffer));
+    }
+}
+
+TEST_F(URingBufferF, Full)
+{
+    u_queue_message_t message;
+    for (uintptr_t i = 0; i < 8; ++i)
+    {
+        message = MakeMessage(i);
+        EXPECT_TRUE(u_ringbuffer_push(ringBuffer, &message));
+    }
+    message = MakeMessage(8);
+    EXPECT_FALSE(u_ringbuffer_push(ringBuffer, &message));
+    EXPECT_EQ(static_cast<uint32_t>(8), u_ringbuffer_get_size(ringBuffer));
+
+    ASSERT_TRUE(u_ringbuffer_pop(ringBuffer, &message));
+    EXPECT_EQ((void *) 0, message.msg);
+
+    message = MakeMessage(8);
+    EXPECT_TRUE(u_ringbuffer_push(ringBuffer, &message));
+}
+
+TEST_F(URingBufferF, PopBatch)
+{
+    u_queue_message_t message;
+    for (uintptr_t i = 0; i < 5; ++i)
+    {
+        message = MakeMessage(i);
+        EXPECT_TRUE(u_ringbuffer_push(ringBuffer, &message));
+    }
+
+    u_queue_message_t batch[4];
+    ASSERT_EQ(static_cast<uint32_t>(4), u_ringbuffer_pop_batch(ringBuffer, batch, 4));
+    for (uintptr_t i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ((void *) i, batch[i].msg);
+    }
+    ASSERT_EQ(static_cast<uint32_t>(1), u_ringbuffer_pop_batch(ringBuffer, batch, 4));
+    EXPECT_EQ((void *) 4, batch[0].msg);
+    EXPECT_EQ(static_cast<uint32_t>(0), u_ringbuffer_pop_batch(ringBuffer, batch, 4));
+}
+
+typedef struct
+{
+    u_ringbuffer_t *ringBuffer;
+    uintptr_t producerId;
+} ProducerArgs;
+
+static void *ProducerThread(void *arg)
+{
+    ProducerArgs *args = (ProducerArgs *) arg;
+    for (uintptr_t i = 0; i < MESSAGES_PER_THREAD; ++i)
+    {
+        // Encode producer and sequence so the consumer can check per-producer order.
+        u_queue_message_t message = MakeMessage(args->producerId * MESSAGES_PER_THREAD + i + 1);
+        while (!u_ringbuffer_push(args->ringBuffer, &message))
+        {
+            // Ring is full; wait for the consumer.
+        }
+    }
+    return NULL;
+}
+
+TEST(URingBuffer, MultipleProducers)
+{
+    u_ringbuffer_t *ringBuffer = u_ringbuffer_create(1024);
+    ASSERT_TRUE(ringBuffer != NULL);
+
+    oc_thread threads[PRODUCER_COUNT];
+    ProducerArgs args[PRODUCER_COUNT];
+    for (uintptr_t i = 0; i < PRODUCER_COUNT; ++i)
+    {
+        args[i].ringBuffer = ringBuffer;
+        args[i].producerId = i;
+        ASSERT_EQ(OC_THREAD_SUCCESS, oc_thread_new(&threads[i], ProducerThread, &args[i]));
+    }
+
+    std::vector<uintptr_t> lastSeen(PRODUCER_COUNT, 0);
+    uint32_t received = 0;
+    while (received < PRODUCER_COUNT * MESSAGES_PER_THREAD)
+    {
+        u_queue_message_t message;
+        if (!u_ringbuffer_pop(ringBuffer, &message))
+        {
+            continue;
+        }
+        uintptr_t value = (uintptr_t) message.msg - 1;
+        uintptr_t producer = value / MESSAGES_PER_THREAD;
+        uintptr_t sequence = value % MESSAGES_PER_THREAD + 1;
+        ASSERT_LT(producer, static_cast<uintptr_t>(PRODUCER_COUNT));
+        EXPECT_EQ(lastSeen[producer] + 1, sequence);
+        lastSeen[producer] = sequence;
+        received++;
+    }
+
+    for (int i = 0; i < PRODUCER_COUNT; ++i)
+    {
+        oc_thread_wait(threads[i]);
+        oc_thread_free(threads[i]);
+    }
+
+    EXPECT_EQ(static_cast<uint32_t>(0), u_ringbuffer_get_size(ringBuffer));
+    u_ringbuffer_delete(ringBuffer);
+}
+
+static int g_destroyedData = 0;
+
+static void CountDestroyedData(void *data, uint32_t size)
+{
+    (void) data;
+    (void) size;
+    ++g_destroyedData;
+}
+
+class CAQueueingThreadRing : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_destroyedData = 0;
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &threadPool));
+    }
+
+    virtual void TearDown()
+    {
+        ca_thread_pool_free(threadPool);
+    }
+
+    ca_thread_pool_t threadPool;
+    CAQueueingThread_t thread;
+};
+
+TEST_F(CAQueueingThreadRing, RejectLeavesDataWithCaller)
+{
+    int data[9];
+
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitializeRing(&thread, threadPool, NULL,
+                                                           CountDestroyedData, 8,
+                                                           CA_QUEUE_OVERFLOW_REJECT));
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&thread, &data[i], sizeof(int)));
+    }
+    EXPECT_NE(CA_STATUS_OK, CAQueueingThreadAddData(&thread, &data[8], sizeof(int)));
+    EXPECT_EQ(0, g_destroyedData);
+    EXPECT_EQ(static_cast<uint32_t>(1), CAQueueingThreadGetOverflowCount(&thread));
+
+    // The queued data is kept in order.
+    u_queue_message_t message;
+    ASSERT_TRUE(u_ringbuffer_pop(thread.dataRing, &message));
+    EXPECT_EQ(&data[0], message.msg);
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&thread, &data[8], sizeof(int)));
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+    EXPECT_EQ(8, g_destroyedData);
+}
+
+TEST_F(CAQueueingThreadRing, DropOldestCountsOverflow)
+{
+    int data[10];
+
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitializeRing(&thread, threadPool, NULL,
+                                                           CountDestroyedData, 8,
+                                                           CA_QUEUE_OVERFLOW_DROP_OLDEST));
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&thread, &data[i], sizeof(int)));
+    }
+    EXPECT_EQ(2, g_destroyedData);
+    EXPECT_EQ(static_cast<uint32_t>(2), CAQueueingThreadGetOverflowCount(&thread));
+
+    u_queue_message_t message;
+    ASSERT_TRUE(u_ringbuffer_pop(thread.dataRing, &message));
+    EXPECT_EQ(&data[2], message.msg);
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+    EXPECT_EQ(9, g_destroyedData);
+}
@@ -23,6 +23,7 @@
 #include "cabtpairinginterface.h"
 #include "cautilinterface.h"
 #include "cainterfacecontroller.h"
+#include "camessagehandler.h"
 #include "cacommon.h"
 #include "logger.h"
 
@@ -197,6 +198,18 @@ uint16_t CAGetAssignedPortNumber(CATransportAdapter_t adapter, CATransportFlags_
     return 0;
 }
 
+void CAUtilSetReceiveQueueCapacity(uint32_t capacity)
+{
+    OIC_LOG_V(DEBUG, TAG, "CAUtilSetReceiveQueueCapacity %u", capacity);
+
+    CASetReceiveQueueCapacity(capacity);
+}
+
+uint32_t CAUtilGetReceiveQueueOverflowCount()
+{
+    return CAGetReceiveQueueOverflowCount();
+}
+
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
 CAResult_t CAUtilCMInitailize()
 {
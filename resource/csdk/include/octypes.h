@@ -1199,6 +1199,12 @@ typedef struct {
     int (* unlink)(const char *path);
 } OCPersistentStorage;
 
+/**
+ * Persistent storage rename handler, registered with OCRegisterPersistentStorageRename.
+ * Replaces newPath with oldPath and returns 0 on success, like rename().
+ */
+typedef int (* OCPersistentStorageRename)(const char *oldPath, const char *newPath);
+
 /**
  * Possible returned values from entity handler.
  */
@@ -1518,6 +1524,23 @@ typedef struct OCRepPayload
     struct OCRepPayload* next;
 } OCRepPayload;
 
+/**
+ * Read-only view of a CBOR encoded representation. Properties are decoded in
+ * place on access, so the encoded buffer must outlive the view.
+ * See OCRepPayloadViewInit.
+ */
+typedef struct
+{
+    /** Start of the encoded map, pointing into the received buffer.*/
+    const uint8_t* data;
+
+    /** Number of bytes from data to the end of the buffer.*/
+    size_t size;
+
+    /** Root views don't report href, rt and if as properties.*/
+    bool isRoot;
+} OCRepPayloadView;
+
 // used inside a resource payload
 typedef struct OCEndpointPayload
 {
@@ -1677,6 +1700,17 @@ typedef struct
 
     /** An array of the received vendor specific header options.*/
     OCHeaderOption rcvdVendorSpecificHeaderOptions[MAX_HEADER_OPTIONS];
+
+    /** The encoded payload of the response PDU, only valid during the callback.
+     * payload is NULL if the request asked for it not to be parsed, see
+     * ::OC_DO_REQUEST_LAZY_PAYLOAD.*/
+    const uint8_t *rawPayload;
+
+    /** Size of rawPayload in bytes.*/
+    size_t rawPayloadSize;
+
+    /** Format of rawPayload.*/
+    OCPayloadFormat payloadFormat;
 } OCClientResponse;
 
 /**
@@ -1785,6 +1819,21 @@ typedef OCStackApplicationResult (* OCClientResponseHandler)(void *context, OCDo
  */
 typedef void (* OCClientContextDeleter)(void *context);
 
+/**
+ * Flags changing how the stack handles a request, see OCDoRequestWithFlags().
+ */
+typedef enum
+{
+    /** Handled as by OCDoRequest().*/
+    OC_DO_REQUEST_DEFAULT = 0,
+
+    /** Representation responses are passed to the callback undecoded:
+     * OCClientResponse::payload is NULL and the callback reads
+     * OCClientResponse::rawPayload, e.g. through an OCRepPayloadView.
+     * Responses that aren't a single CBOR map are still decoded.*/
+    OC_DO_REQUEST_LAZY_PAYLOAD = (1 << 0)
+} OCDoRequestFlags;
+
 /**
  * This info is passed from application to OC Stack when initiating a request to Server.
  */
@@ -86,6 +86,90 @@ static sqlite3 *gRDDB = NULL;
     "FOREIGN KEY("XSTR(LINK_ID)") REFERENCES RD_DEVICE_LINK_LIST("XSTR(OC_RSRVD_INS)") " \
     "ON DELETE CASCADE);"
 
+#define RD_INDEXES \
+    "create index if not exists RD_DEVICE_LINK_LIST_DEVICE_ID on " \
+    "RD_DEVICE_LINK_LIST(DEVICE_ID, " XSTR(OC_RSRVD_HREF) ");" \
+    "create index if not exists RD_LINK_RT_LINK_ID on RD_LINK_RT(LINK_ID);" \
+    "create index if not exists RD_LINK_RT_RT on RD_LINK_RT(" XSTR(OC_RSRVD_RESOURCE_TYPE) ");" \
+    "create index if not exists RD_LINK_IF_LINK_ID on RD_LINK_IF(LINK_ID);" \
+    "create index if not exists RD_LINK_IF_IF on RD_LINK_IF(" XSTR(OC_RSRVD_INTERFACE) ");" \
+    "create index if not exists RD_LINK_EP_LINK_ID on RD_LINK_EP(LINK_ID);"
+
+/**
+ * Statements that are prepared once and kept until the database is closed.
+ */
+typedef enum
+{
+    RD_STMT_DELETE_RT = 0,
+    RD_STMT_INSERT_RT,
+    RD_STMT_DELETE_IF,
+    RD_STMT_INSERT_IF,
+    RD_STMT_DELETE_EP,
+    RD_STMT_INSERT_EP,
+    RD_STMT_INSERT_LINK,
+    RD_STMT_UPDATE_LINK,
+    RD_STMT_SELECT_LINK,
+    RD_STMT_INSERT_DEVICE,
+    RD_STMT_UPDATE_DEVICE,
+    RD_STMT_SELECT_DEVICE,
+    RD_STMT_DELETE_DEVICE,
+    RD_STMT_DELETE_LINK,
+    RD_STMT_COUNT
+} RDStatement;
+
+static const char *gRDStatementSql[RD_STMT_COUNT] =
+{
+    [RD_STMT_DELETE_RT] = "DELETE FROM RD_LINK_RT WHERE LINK_ID=@id",
+    [RD_STMT_INSERT_RT] = "INSERT INTO RD_LINK_RT VALUES(@resourceType, @id)",
+    [RD_STMT_DELETE_IF] = "DELETE FROM RD_LINK_IF WHERE LINK_ID=@id",
+    [RD_STMT_INSERT_IF] = "INSERT INTO RD_LINK_IF VALUES(@interfaceType, @id)",
+    [RD_STMT_DELETE_EP] = "DELETE FROM RD_LINK_EP WHERE LINK_ID=@id",
+    [RD_STMT_INSERT_EP] = "INSERT INTO RD_LINK_EP VALUES(@ep, @pri, @id)",
+    [RD_STMT_INSERT_LINK] = "INSERT OR IGNORE INTO RD_DEVICE_LINK_LIST (ins, href, DEVICE_ID) "
+        "VALUES((SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri),@uri,@id)",
+    [RD_STMT_UPDATE_LINK] = "UPDATE RD_DEVICE_LINK_LIST SET anchor=@anchor,bm=@bm "
+        "WHERE DEVICE_ID=@id AND href=@uri",
+    [RD_STMT_SELECT_LINK] = "SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri",
+    [RD_STMT_INSERT_DEVICE] = "INSERT OR IGNORE INTO RD_DEVICE_LIST (ID, di, ttl) "
+        "VALUES ((SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId), @deviceId, @ttl)",
+    [RD_STMT_UPDATE_DEVICE] = "UPDATE RD_DEVICE_LIST SET ttl=@ttl WHERE di=@deviceId",
+    [RD_STMT_SELECT_DEVICE] = "SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId",
+    [RD_STMT_DELETE_DEVICE] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId",
+    [RD_STMT_DELETE_LINK] = "DELETE FROM RD_DEVICE_LINK_LIST "
+        "WHERE ins=@ins AND DEVICE_ID=(SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId)"
+};
+
+static sqlite3_stmt *gRDStatements[RD_STMT_COUNT];
+
+/**
+ * Gets a prepared statement with no bindings, preparing it on first use.
+ * The caller resets the statement when done with it rather than finalizing it.
+ */
+static int getStatement(RDStatement id, sqlite3_stmt **stmt)
+{
+    int res = SQLITE_OK;
+    if (!gRDStatements[id])
+    {
+        res = sqlite3_prepare_v2(gRDDB, gRDStatementSql[id], -1, &gRDStatements[id], NULL);
+    }
+    else
+    {
+        sqlite3_reset(gRDStatements[id]);
+        res = sqlite3_clear_bindings(gRDStatements[id]);
+    }
+    *stmt = gRDStatements[id];
+    return res;
+}
+
+static void finalizeStatements()
+{
+    for (size_t i = 0; i < RD_STMT_COUNT; i++)
+    {
+        sqlite3_finalize(gRDStatements[i]);
+        gRDStatements[i] = NULL;
+    }
+}
+
 static void errorCallback(void *arg, int errCode, const char *errMsg)
 {
     OC_UNUSED(arg);
@@ -122,26 +206,21 @@ static int storeResourceTypes(char **resourceTypes, size_t size, sqlite3_int64 r
 
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeResourceTypes", NULL, NULL, NULL));
 
-    static const char deleteRT[] = "DELETE FROM RD_LINK_RT WHERE LINK_ID=@id";
-    static const char insertRT[] = "INSERT INTO RD_LINK_RT VALUES(@resourceType, @id)";
-    int deleteRTSize = (int)sizeof(deleteRT);
-    int insertRTSize = (int)sizeof(insertRT);
-
     sqlite3_stmt *stmt = NULL;
 
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteRT, deleteRTSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_DELETE_RT, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
+    VERIFY_SQLITE(sqlite3_reset(stmt));
     stmt = NULL;
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertRT, insertRTSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_INSERT_RT, &stmt));
         if (resourceTypes[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
@@ -153,7 +232,7 @@ static int storeResourceTypes(char **resourceTypes, size_t size, sqlite3_int64 r
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         stmt = NULL;
     }
 
@@ -161,7 +240,7 @@ static int storeResourceTypes(char **resourceTypes, size_t size, sqlite3_int64 r
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (SQLITE_OK != res)
     {
         sqlite3_exec(gRDDB, "ROLLBACK TO storeResourceTypes", NULL, NULL, NULL);
@@ -180,24 +259,19 @@ static int storeInterfaces(char **interfaces, size_t size, sqlite3_int64 rowid)
 
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeInterfaces", NULL, NULL, NULL));
 
-    static const char deleteIF[] = "DELETE FROM RD_LINK_IF WHERE LINK_ID=@id";
-    static const char insertIF[] = "INSERT INTO RD_LINK_IF VALUES(@interfaceType, @id)";
-    int deleteIFLength = (int)sizeof(deleteIF);
-    int insertIFLength = (int)sizeof(insertIF);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteIF, deleteIFLength, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_DELETE_IF, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
+    VERIFY_SQLITE(sqlite3_reset(stmt));
     stmt = NULL;
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertIF, insertIFLength, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_INSERT_IF, &stmt));
         if (interfaces[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
@@ -209,7 +283,7 @@ static int storeInterfaces(char **interfaces, size_t size, sqlite3_int64 rowid)
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         stmt = NULL;
     }
 
@@ -217,7 +291,7 @@ static int storeInterfaces(char **interfaces, size_t size, sqlite3_int64 rowid)
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (SQLITE_OK != res)
     {
         sqlite3_exec(gRDDB, "ROLLBACK TO storeInterfaces", NULL, NULL, NULL);
@@ -231,26 +305,21 @@ static int storeEndpoints(OCRepPayload **eps, size_t size, sqlite3_int64 rowid)
     char *ep = NULL;
 
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeEndpoints", NULL, NULL, NULL));
-    static const char deleteEp[] = "DELETE FROM RD_LINK_EP WHERE LINK_ID=@id";
-    static const char insertEp[] = "INSERT INTO RD_LINK_EP VALUES(@ep, @pri, @id)";
-    int deleteEpLength = (int)sizeof(deleteEp);
-    int insertEpLength = (int)sizeof(insertEp);
-
     sqlite3_stmt *stmt = NULL;
 
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteEp, deleteEpLength, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_DELETE_EP, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
+    VERIFY_SQLITE(sqlite3_reset(stmt));
     stmt = NULL;
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertEp, insertEpLength, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_INSERT_EP, &stmt));
         if (OCRepPayloadGetPropString(eps[i], OC_RSRVD_ENDPOINT, &ep))
         {
             if (!stringArgumentWithinBounds(ep))
@@ -271,7 +340,7 @@ static int storeEndpoints(OCRepPayload **eps, size_t size, sqlite3_int64 rowid)
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         stmt = NULL;
         OICFree(ep);
         ep = NULL;
@@ -282,7 +351,7 @@ static int storeEndpoints(OCRepPayload **eps, size_t size, sqlite3_int64 rowid)
 
 exit:
     OICFree(ep);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (SQLITE_OK != res)
     {
         sqlite3_exec(gRDDB, "ROLLBACK TO storeInterfaces", NULL, NULL, NULL);
@@ -323,19 +392,11 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
         OCRepPayload** eps = NULL;
         size_t epsDim[MAX_REP_ARRAY_DEPTH] = {0};
 
-        static const char insertDeviceLLList[] = "INSERT OR IGNORE INTO RD_DEVICE_LINK_LIST (ins, href, DEVICE_ID) "
-            "VALUES((SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri),@uri,@id)";
-        static const char updateDeviceLLList[] = "UPDATE RD_DEVICE_LINK_LIST SET anchor=@anchor,bm=@bm "
-            "WHERE DEVICE_ID=@id AND href=@uri";
-        int insertDeviceLLListSize = (int)sizeof(insertDeviceLLList);
-        int updateDeviceLLListSize = (int)sizeof(updateDeviceLLList);
-
         for (size_t i = 0; (SQLITE_OK == res) && (i < links->arr.dimensions[0]); i++)
         {
             VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeLinkPayload", NULL, NULL, NULL));
 
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceLLList,
-                            insertDeviceLLListSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_STMT_INSERT_LINK, &stmt));
 
             OCRepPayload *link = links->arr.objArray[i];
             VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
@@ -353,11 +414,10 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             {
                 goto exit;
             }
-            VERIFY_SQLITE(sqlite3_finalize(stmt));
+            VERIFY_SQLITE(sqlite3_reset(stmt));
             stmt = NULL;
 
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, updateDeviceLLList,
-                            updateDeviceLLListSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_STMT_UPDATE_LINK, &stmt));
             VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
             if (uri)
             {
@@ -386,13 +446,10 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             {
                 goto exit;
             }
-            VERIFY_SQLITE(sqlite3_finalize(stmt));
+            VERIFY_SQLITE(sqlite3_reset(stmt));
             stmt = NULL;
 
-            static const char input[] = "SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri";
-            int inputSize = (int)sizeof(input);
-
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_STMT_SELECT_LINK, &stmt));
             VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
             if (uri)
             {
@@ -403,7 +460,7 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             if (res == SQLITE_ROW || res == SQLITE_DONE)
             {
                 sqlite3_int64 ins = sqlite3_column_int64(stmt, 0);
-                VERIFY_SQLITE(sqlite3_finalize(stmt));
+                VERIFY_SQLITE(sqlite3_reset(stmt));
                 stmt = NULL;
                 if (!OCRepPayloadSetPropInt(link, OC_RSRVD_INS, ins))
                 {
@@ -419,7 +476,7 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             }
             else
             {
-                VERIFY_SQLITE(sqlite3_finalize(stmt));
+                VERIFY_SQLITE(sqlite3_reset(stmt));
                 stmt = NULL;
             }
 
@@ -460,7 +517,7 @@ static int storeLinkPayload(OCRepPayload *rdPayload, sqlite3_int64 rowid)
             anchor = NULL;
             OICFree(uri);
             uri = NULL;
-            sqlite3_finalize(stmt);
+            sqlite3_reset(stmt);
             stmt = NULL;
             if (SQLITE_OK != res)
             {
@@ -489,11 +546,7 @@ static int storeResources(OCRepPayload *payload)
 
     /* INSERT OR IGNORE then UPDATE to update or insert the row without triggering the cascading deletes */
     sqlite3_stmt *stmt = NULL;
-    static const char insertDeviceList[] = "INSERT OR IGNORE INTO RD_DEVICE_LIST (ID, di, ttl) "
-        "VALUES ((SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId), @deviceId, @ttl)";
-    int insertDeviceListSize = (int)sizeof(insertDeviceList);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceList, insertDeviceListSize,
-                    &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_INSERT_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -508,13 +561,10 @@ static int storeResources(OCRepPayload *payload)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
+    VERIFY_SQLITE(sqlite3_reset(stmt));
     stmt = NULL;
 
-    static const char updateDeviceList[] = "UPDATE RD_DEVICE_LIST SET ttl=@ttl WHERE di=@deviceId";
-    int updateDeviceListSize = (int)sizeof(updateDeviceList);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, updateDeviceList, updateDeviceListSize,
-                    &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_UPDATE_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -529,14 +579,11 @@ static int storeResources(OCRepPayload *payload)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
+    VERIFY_SQLITE(sqlite3_reset(stmt));
     stmt = NULL;
 
     /* Store the rest of the payload */
-    static const char input[] = "SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId";
-    int inputSize = (int)sizeof(input);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_SELECT_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -546,13 +593,13 @@ static int storeResources(OCRepPayload *payload)
     if (res == SQLITE_ROW || res == SQLITE_DONE)
     {
         sqlite3_int64 rowid = sqlite3_column_int64(stmt, 0);
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         stmt = NULL;
         VERIFY_SQLITE(storeLinkPayload(payload, rowid));
     }
     else
     {
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+        VERIFY_SQLITE(sqlite3_reset(stmt));
         stmt = NULL;
     }
 
@@ -560,7 +607,7 @@ static int storeResources(OCRepPayload *payload)
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     OICFree(deviceId);
     if (SQLITE_OK != res)
     {
@@ -569,10 +616,9 @@ exit:
     return res;
 }
 
-static int deleteResources(const char *deviceId, const uint8_t *instanceIds, uint8_t nInstanceIds)
+static int deleteResources(const char *deviceId, const int64_t *instanceIds, uint16_t nInstanceIds)
 {
-    char *delResource = NULL;
-    if (!stringArgumentWithinBounds(deviceId))
+    if (!deviceId || !stringArgumentWithinBounds(deviceId))
     {
         OIC_LOG_V(ERROR, TAG, "Query longer than %d: \n%s", INT_MAX, deviceId);
         return OC_STACK_ERROR;
@@ -584,61 +630,41 @@ static int deleteResources(const char *deviceId, const uint8_t *instanceIds, uin
     sqlite3_stmt *stmt = NULL;
     if (!instanceIds || !nInstanceIds)
     {
-        static const char delDevice[] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId";
-        int delDeviceSize = (int)sizeof(delDevice);
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delDevice, delDeviceSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_DELETE_DEVICE, &stmt));
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
                                         deviceId, (int)strlen(deviceId), SQLITE_STATIC));
-    }
-    else
-    {
-        static const char pre[] = "DELETE FROM RD_DEVICE_LINK_LIST "
-            "WHERE ins IN ("
-            "SELECT RD_DEVICE_LINK_LIST.ins FROM RD_DEVICE_LINK_LIST "
-            "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LIST.di=@deviceId AND RD_DEVICE_LINK_LIST.ins IN (";
-        size_t inLen = nInstanceIds + (nInstanceIds - 1);
-        static const char post[] = "))";
-        size_t delResourceSize = sizeof(pre) + inLen + (sizeof(post) - 1);
-        delResource = OICCalloc(delResourceSize, 1);
-        if (!delResource)
+        res = sqlite3_step(stmt);
+        if (SQLITE_DONE != res)
         {
-            res = SQLITE_NOMEM;
             goto exit;
         }
-        OICStrcat(delResource, delResourceSize, pre);
-        OICStrcat(delResource, delResourceSize, "?");
-        for (uint16_t i = 1; i < nInstanceIds; ++i)
-        {
-            OICStrcat(delResource, delResourceSize, ",?");
-        }
-        OICStrcat(delResource, delResourceSize, post);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delResource, (int)delResourceSize,
-                        &stmt, NULL));
-        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
-                        deviceId, (int)strlen(deviceId), SQLITE_STATIC));
-        assert(sqlite3_bind_parameter_index(stmt, "@deviceId") == 1);
+        VERIFY_SQLITE(sqlite3_reset(stmt));
+        stmt = NULL;
+    }
+    else
+    {
         for (uint16_t i = 0; i < nInstanceIds; ++i)
         {
-            VERIFY_SQLITE(sqlite3_bind_int64(stmt, 2 + i, instanceIds[i]));
+            VERIFY_SQLITE(getStatement(RD_STMT_DELETE_LINK, &stmt));
+            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
+                            deviceId, (int)strlen(deviceId), SQLITE_STATIC));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ins"),
+                            instanceIds[i]));
+            res = sqlite3_step(stmt);
+            if (SQLITE_DONE != res)
+            {
+                goto exit;
+            }
+            VERIFY_SQLITE(sqlite3_reset(stmt));
+            stmt = NULL;
         }
     }
 
-    res = sqlite3_step(stmt);
-    if (SQLITE_DONE != res)
-    {
-        goto exit;
-    }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
-
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
-    OICFree(delResource);
-    sqlite3_finalize(stmt);
+    sqlite3_reset(stmt);
     if (SQLITE_OK != res)
     {
         sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
@@ -648,18 +674,25 @@ exit:
 
 OCStackResult OCRDDatabaseInit()
 {
+    if (gRDDB)
+    {
+        // Already open, keep the connection and its prepared statements
+        return OC_STACK_OK;
+    }
+
     if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
     {
         OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
     }
 
-    sqlite3_stmt *stmt = NULL;
     int res;
     res = sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB, SQLITE_OPEN_READWRITE, NULL);
     if (SQLITE_OK != res)
     {
         OIC_LOG(DEBUG, TAG, "RD database file did not open, as no table exists.");
         OIC_LOG(DEBUG, TAG, "RD creating new table.");
+        sqlite3_close(gRDDB);
+        gRDDB = NULL;
         VERIFY_SQLITE(sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB,
                         SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL));
 
@@ -683,18 +716,18 @@ OCStackResult OCRDDatabaseInit()
 
     if (SQLITE_OK == res)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, "PRAGMA foreign_keys = ON;", -1, &stmt, NULL));
-        res = sqlite3_step(stmt);
-        if (SQLITE_DONE != res)
-        {
-            goto exit;
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL));
+
+        // Discovery reads while publishes write, and a publish commits once per request
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, "PRAGMA journal_mode = WAL;", NULL, NULL, NULL));
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, "PRAGMA synchronous = NORMAL;", NULL, NULL, NULL));
+
+        // Databases created before the indexes existed get them here
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_INDEXES, NULL, NULL, NULL));
+        OIC_LOG(DEBUG, TAG, "RD created indexes.");
     }
 
 exit:
-    sqlite3_finalize(stmt);
     if (SQLITE_OK == res)
     {
         return OC_STACK_OK;
@@ -711,6 +744,7 @@ OCStackResult OCRDDatabaseClose()
 {
     CHECK_DATABASE_INIT;
     int res;
+    finalizeStatements();
     VERIFY_SQLITE(sqlite3_close(gRDDB));
     gRDDB = NULL;
 exit:
@@ -723,16 +757,20 @@ OCStackResult OCRDDatabaseStoreResources(OCRepPayload *payload)
     int res;
     VERIFY_SQLITE(storeResources(payload));
 exit:
+    // Cached discovery results may no longer match the database
+    OCRDDatabaseDiscoveryInvalidate();
     return (SQLITE_OK == res) ? OC_STACK_OK : OC_STACK_ERROR;
 }
 
-OCStackResult OCRDDatabaseDeleteResources(const char *deviceId, const uint8_t *instanceIds,
-        uint8_t nInstanceIds)
+OCStackResult OCRDDatabaseDeleteResources(const char *deviceId, const int64_t *instanceIds,
+        uint16_t nInstanceIds)
 {
     CHECK_DATABASE_INIT;
     int res;
     VERIFY_SQLITE(deleteResources(deviceId, instanceIds, nInstanceIds));
 exit:
+    // Cached discovery results may no longer match the database
+    OCRDDatabaseDiscoveryInvalidate();
     return (SQLITE_OK == res) ? OC_STACK_OK : OC_STACK_ERROR;
 }
 
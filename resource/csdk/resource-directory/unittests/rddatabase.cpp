@@ -25,6 +25,7 @@ extern "C"
     #include "rd_client.h"
     #include "rd_database.h"
     #include "ocstack.h"
+    #include "ocstackinternal.h"
     #include "logger.h"
     #include "oic_malloc.h"
     #include "oic_string.h"
@@ -402,3 +403,92 @@ TEST_F(RDDatabaseTests, DeleteResourcesDevice)
     OCPayloadDestroy((OCPayload *)payloads[0]);
     OCPayloadDestroy((OCPayload *)payloads[1]);
 }
+
+TEST_F(RDDatabaseTests, DiscoverManyResources)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    const char *deviceId = "7a960f46-a52e-4837-bd83-460b1a6dd56b";
+    const size_t nresources = 100;
+    char uris[nresources][MAX_URI_LENGTH];
+    Resource resources[nresources];
+    for (size_t i = 0; i < nresources; ++i)
+    {
+        snprintf(uris[i], MAX_URI_LENGTH, "/a/light/%zu", i);
+        resources[i].uri = uris[i];
+        resources[i].rt = (i % 2) ? "core.light" : "core.light.dimming";
+        resources[i].itf = OC_RSRVD_INTERFACE_DEFAULT;
+        resources[i].bm = OC_DISCOVERABLE;
+    }
+    OCRepPayload *repPayload = CreateRDPublishPayload(deviceId, resources, nresources);
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(repPayload));
+
+    OCDiscoveryPayload *discPayload = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate(NULL, "core.light", &discPayload));
+    ASSERT_TRUE(discPayload != NULL);
+    EXPECT_STREQ(deviceId, discPayload->sid);
+    EXPECT_TRUE(discPayload->next == NULL);
+    EXPECT_EQ(nresources / 2, OCDiscoveryPayloadGetResourceCount(discPayload));
+    for (OCResourcePayload *resource = discPayload->resources; resource; resource = resource->next)
+    {
+        EXPECT_STREQ("core.light", resource->types->value);
+        EXPECT_TRUE(resource->types->next == NULL);
+        EXPECT_STREQ(OC_RSRVD_INTERFACE_DEFAULT, resource->interfaces->value);
+        EndpointsVerify(resource->eps);
+    }
+    OCDiscoveryPayloadDestroy(discPayload);
+    discPayload = NULL;
+
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate(NULL, "core.light%", &discPayload));
+    ASSERT_TRUE(discPayload != NULL);
+    EXPECT_EQ(nresources, OCDiscoveryPayloadGetResourceCount(discPayload));
+    OCDiscoveryPayloadDestroy(discPayload);
+    discPayload = NULL;
+
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCRDDatabaseDiscoveryPayloadCreate(NULL, "core.fan", &discPayload));
+    EXPECT_TRUE(discPayload == NULL);
+
+    OCPayloadDestroy((OCPayload *)repPayload);
+}
+
+TEST_F(RDDatabaseTests, DiscoveryCacheFollowsChanges)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    const char *deviceIds[2] =
+    {
+        "7a960f46-a52e-4837-bd83-460b1a6dd56b",
+        "983656a7-c7e5-49c2-a201-edbeb7606fb5",
+    };
+    OCRepPayload *payloads[2];
+    payloads[0] = CreateResources(deviceIds[0]);
+    payloads[1] = CreateResources(deviceIds[1]);
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(payloads[0]));
+
+    const OCDiscoveryPayload *discPayload = NULL;
+    const OCDiscoveryPayload *cachedPayload = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadGet(NULL, "core.light", &discPayload));
+    ASSERT_TRUE(discPayload != NULL);
+    EXPECT_STREQ(deviceIds[0], discPayload->sid);
+    EXPECT_TRUE(discPayload->next == NULL);
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadGet(NULL, "core.light", &cachedPayload));
+    EXPECT_EQ(discPayload, cachedPayload);
+
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCRDDatabaseDiscoveryPayloadGet(NULL, "core.fan", &discPayload));
+    EXPECT_TRUE(discPayload == NULL);
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCRDDatabaseDiscoveryPayloadGet(NULL, "core.fan", &discPayload));
+    EXPECT_TRUE(discPayload == NULL);
+
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(payloads[1]));
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadGet(NULL, "core.light", &discPayload));
+    ASSERT_TRUE(discPayload != NULL);
+    ASSERT_TRUE(discPayload->next != NULL);
+    EXPECT_TRUE(discPayload->next->next == NULL);
+
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDeleteResources(deviceIds[0], NULL, 0));
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadGet(NULL, "core.light", &discPayload));
+    ASSERT_TRUE(discPayload != NULL);
+    EXPECT_STREQ(deviceIds[1], discPayload->sid);
+    EXPECT_TRUE(discPayload->next == NULL);
+
+    OCPayloadDestroy((OCPayload *)payloads[0]);
+    OCPayloadDestroy((OCPayload *)payloads[1]);
+}
@@ -51,6 +51,38 @@ OCStackResult DeInitACLResource();
  */
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr);
 
+/**
+ * This method is used by PolicyEngine to retrieve all ACEs of a Subject at once.
+ * ACEs are looked up in an index of the ACL, so the cost does not depend on the
+ * number of ACEs of other subjects.
+ *
+ * @param[in] subjectId ID of the subject for which ACEs are required.
+ * @param[out] aceCount number of ACEs returned.
+ *
+ * @return array of the subject's ACEs in ACL order, NULL if there are none. The
+ *         array is valid until the ACL is changed.
+ */
+const OicSecAce_t* const* GetACLResourceDataList(const OicUuid_t *subjectId, size_t *aceCount);
+
+/**
+ * This method is used by PolicyEngine to retrieve all ACEs of a role at once.
+ *
+ * @param[in] role Role for which ACEs are required.
+ * @param[out] aceCount number of ACEs returned.
+ *
+ * @return array of the role's ACEs in ACL order, NULL if there are none. The
+ *         array is valid until the ACL is changed.
+ */
+const OicSecAce_t* const* GetACLResourceDataListByRole(const OicSecRole_t *role, size_t *aceCount);
+
+/**
+ * Get a counter that changes whenever the ACL is changed. Used to invalidate
+ * access decisions derived from the ACL.
+ *
+ * @return ACL generation.
+ */
+uint32_t GetACLGeneration(void);
+
 /**
  * This method is used by PolicyEngine to retrieve ACLs for a set of roles.
  *
@@ -49,6 +49,37 @@ OCStackResult ReadDatabaseFromPS(const char *databaseName, const char *resourceN
  */
 OCStackResult UpdateResourceInPS(const char *databaseName, const char *resourceName, const uint8_t *payload, size_t size);
 
+/**
+ * Creates the lock that guards the updates of the databases in PS. Until it is
+ * called, the databases must only be used by one thread.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult InitPersistentStorageInterface(void);
+
+/**
+ * Frees the lock created by InitPersistentStorageInterface().
+ */
+void DeInitPersistentStorageInterface(void);
+
+/**
+ * Starts a batch of updates of the databases in PS. Until the batch is committed,
+ * updates are kept in memory and reads see them, so a database that is updated
+ * several times is written only once. Batches nest; only the outermost
+ * CommitResourceUpdatesInPS() writes the databases.
+ */
+void BeginResourceUpdatesInPS(void);
+
+/**
+ * Ends a batch of updates started with BeginResourceUpdatesInPS() and writes the
+ * updated databases to PS when it is the outermost batch. A database that fails
+ * to be written stays in memory, where reads still see it, and is written again
+ * by the next update or commit.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult CommitResourceUpdatesInPS(void);
+
 /**
  * Reads the Secure Virtual Database from PS into dynamically allocated
  * memory buffer.
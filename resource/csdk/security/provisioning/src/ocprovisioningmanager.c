@@ -1004,7 +1004,11 @@ OCStackResult OCResetDevice(void* ctx, unsigned short waitTimeForOwnedDeviceDisc
  */
 OCStackResult OCResetSVRDB(void)
 {
-    return ResetSecureResourceInPS();
+    OCStackResult res = ResetSecureResourceInPS();
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAsslClearSessionCache();
+#endif
+    return res;
 }
 
 /**
@@ -854,6 +854,9 @@ static OCStackResult SaveOwnerPSK(OCProvisionDev_t *selectedDeviceInfo)
             }
         }
 
+        // Replacing the owner PSK removes and adds a credential, write the database once
+        BeginResourceUpdatesInPS();
+
         //If duplicate owner PSK is exists, remove it.
         if(0 < credId)
         {
@@ -870,16 +873,24 @@ static OCStackResult SaveOwnerPSK(OCProvisionDev_t *selectedDeviceInfo)
             {
                 OIC_LOG(ERROR, TAG, "Failed to remove the previous OwnerPSK");
                 DeleteCredList(cred);
+                CommitResourceUpdatesInPS();
                 goto exit;
             }
         }
 
         res = AddCredential(cred);
+        OCStackResult commitRes = CommitResourceUpdatesInPS();
         if(res != OC_STACK_OK)
         {
             DeleteCredList(cred);
             return res;
         }
+        if(OC_STACK_OK != commitRes)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to write the OwnerPSK");
+            res = commitRes;
+            goto exit;
+        }
     }
     else
     {
@@ -2613,6 +2624,9 @@ OCStackResult ConfigSelfOwnership(void)
         return OC_STACK_ERROR;
     }
 
+    // Self ownership updates every SVR, write the database once
+    BeginResourceUpdatesInPS();
+
     OCStackResult ret = OC_STACK_OK;
     //Update the pstat resource as Normal Operation.
     ret = SetPstatSelfOwnership(&deviceID);
@@ -2665,6 +2679,11 @@ exit:
         */
         ResetSecureResourceInPS();
     }
+    if ((OC_STACK_OK != CommitResourceUpdatesInPS()) && (OC_STACK_OK == ret))
+    {
+        OIC_LOG (ERROR, TAG, "Unable to write the SVRs in ConfigSelfOwnership");
+        ret = OC_STACK_ERROR;
+    }
 
     return ret;
 }
@@ -45,6 +45,7 @@
 #include "pmutility.h"
 #include "srmutility.h"
 #include "provisioningdatabasemanager.h"
+#include "psinterface.h"
 #include "base64.h"
 #include "utlist.h"
 #include "ocpayload.h"
@@ -1963,14 +1964,22 @@ static OCStackApplicationResult SRPResetDeviceCB(void *ctx, OCDoHandle UNUSED,
         goto error;
     }
 
+    // The credential and the ACEs are removed from the database at once
+    BeginResourceUpdatesInPS();
     OCStackResult res = RemoveCredential(&cred->subject);
     if (res != OC_STACK_RESOURCE_DELETED && res != OC_STACK_NO_RESOURCE)
     {
         OIC_LOG(ERROR, TAG, "OCResetDevice : Failed to remove credential.");
+        CommitResourceUpdatesInPS();
         goto error;
     }
 
     res = RemoveACE(&cred->subject, NULL);
+    if (OC_STACK_OK != CommitResourceUpdatesInPS())
+    {
+        OIC_LOG(ERROR, TAG, "OCResetDevice : Failed to write credential and ACL.");
+        goto error;
+    }
     if (res != OC_STACK_RESOURCE_DELETED && res != OC_STACK_NO_RESOURCE)
     {
         OIC_LOG(ERROR, TAG, "OCResetDevice : Failed to remove ACL.");
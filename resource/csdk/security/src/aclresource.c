@@ -27,6 +27,7 @@
 #include <stdlib.h>
 
 #include "utlist.h"
+#include "uhashmap.h"
 #include "ocstack.h"
 #include "octypes.h"
 #include "ocserverrequest.h"
@@ -69,6 +70,211 @@ static OicSecAcl_t *gAcl = NULL;
 static OCResourceHandle gAclHandle = NULL;
 static OCResourceHandle gAcl2Handle = NULL;
 
+/**
+ * ACEs of one subject in ACL order.
+ */
+typedef struct AclIndexEntry
+{
+    const OicSecAce_t **aces;
+    size_t count;
+    size_t capacity;
+} AclIndexEntry_t;
+
+#define ACL_INDEX_UUID_KEY      'U'
+#define ACL_INDEX_ROLE_KEY      'R'
+#define ACL_INDEX_KEY_SIZE      (1 + ROLEID_LENGTH + 1 + ROLEAUTHORITY_LENGTH)
+
+/**
+ * Index of gAcl->aces by subject UUID and subject role. It is rebuilt on
+ * the next lookup after gAcl changed in a way that is not applied to it
+ * directly.
+ */
+static u_hashmap_t *gAclIndex = NULL;
+static bool gAclIndexValid = false;
+static uint32_t gAclGeneration = 0;
+
+static size_t GetAclIndexUuidKey(const OicUuid_t *uuid, uint8_t *key)
+{
+    key[0] = ACL_INDEX_UUID_KEY;
+    memcpy(key + 1, uuid->id, sizeof(uuid->id));
+    return 1 + sizeof(uuid->id);
+}
+
+static size_t GetAclIndexRoleKey(const OicSecRole_t *role, uint8_t *key)
+{
+    size_t idLength = strnlen(role->id, sizeof(role->id));
+    size_t authorityLength = strnlen(role->authority, sizeof(role->authority));
+
+    key[0] = ACL_INDEX_ROLE_KEY;
+    memcpy(key + 1, role->id, idLength);
+    key[1 + idLength] = '\0';
+    memcpy(key + 2 + idLength, role->authority, authorityLength);
+    return 2 + idLength + authorityLength;
+}
+
+static size_t GetAclIndexAceKey(const OicSecAce_t *ace, uint8_t *key)
+{
+    return (OicSecAceRoleSubject == ace->subjectType) ?
+           GetAclIndexRoleKey(&ace->subjectRole, key) :
+           GetAclIndexUuidKey(&ace->subjectuuid, key);
+}
+
+static void FreeAclIndexEntry(AclIndexEntry_t *entry)
+{
+    if (entry)
+    {
+        OICFree(entry->aces);
+        OICFree(entry);
+    }
+}
+
+static void FreeAclIndex(void)
+{
+    if (gAclIndex)
+    {
+        u_hashmap_iterator_t iterator;
+        void *entry = NULL;
+        u_hashmap_iterator_init(gAclIndex, &iterator);
+        while (u_hashmap_next(&iterator, &entry))
+        {
+            FreeAclIndexEntry((AclIndexEntry_t *)entry);
+        }
+        u_hashmap_free(&gAclIndex);
+    }
+    gAclIndexValid = false;
+}
+
+/**
+ * Marks the index for a rebuild and invalidates decisions made from the ACL.
+ */
+static void InvalidateAclIndex(void)
+{
+    gAclIndexValid = false;
+    gAclGeneration++;
+}
+
+static bool AddAceToAclIndex(const OicSecAce_t *ace, bool prepend)
+{
+    uint8_t key[ACL_INDEX_KEY_SIZE];
+    size_t keyLength = GetAclIndexAceKey(ace, key);
+
+    AclIndexEntry_t *entry = (AclIndexEntry_t *)u_hashmap_get(gAclIndex, key, keyLength);
+    if (!entry)
+    {
+        entry = (AclIndexEntry_t *)OICCalloc(1, sizeof(AclIndexEntry_t));
+        if (!entry || !u_hashmap_put(gAclIndex, key, keyLength, entry))
+        {
+            OICFree(entry);
+            return false;
+        }
+    }
+
+    if (entry->count == entry->capacity)
+    {
+        size_t capacity = entry->capacity ? entry->capacity * 2 : 4;
+        const OicSecAce_t **aces = (const OicSecAce_t **)OICRealloc((void *)entry->aces,
+                                                                    capacity * sizeof(*aces));
+        if (!aces)
+        {
+            return false;
+        }
+        entry->aces = aces;
+        entry->capacity = capacity;
+    }
+
+    if (prepend)
+    {
+        memmove((void *)(entry->aces + 1), (const void *)entry->aces,
+                entry->count * sizeof(*entry->aces));
+        entry->aces[0] = ace;
+    }
+    else
+    {
+        entry->aces[entry->count] = ace;
+    }
+    entry->count++;
+    return true;
+}
+
+static bool BuildAclIndex(void)
+{
+    FreeAclIndex();
+    if (!gAcl)
+    {
+        return false;
+    }
+
+    gAclIndex = u_hashmap_create(0);
+    if (!gAclIndex)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create ACL index");
+        return false;
+    }
+
+    OicSecAce_t *ace = NULL;
+    LL_FOREACH(gAcl->aces, ace)
+    {
+        if (!AddAceToAclIndex(ace, false))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to index ACE");
+            FreeAclIndex();
+            return false;
+        }
+    }
+    gAclIndexValid = true;
+    return true;
+}
+
+/**
+ * Applies a change of gAcl to the index. Changes to an index that is about
+ * to be rebuilt anyway are skipped.
+ */
+static void AddAceToValidAclIndex(const OicSecAce_t *ace, bool prepend)
+{
+    gAclGeneration++;
+    if (gAclIndexValid && !AddAceToAclIndex(ace, prepend))
+    {
+        InvalidateAclIndex();
+    }
+}
+
+/**
+ * Re-collects the ACEs of one UUID subject after some of them were removed.
+ */
+static void ReindexAclSubject(const OicUuid_t *subject)
+{
+    gAclGeneration++;
+    if (!gAclIndexValid)
+    {
+        return;
+    }
+
+    uint8_t key[ACL_INDEX_KEY_SIZE];
+    size_t keyLength = GetAclIndexUuidKey(subject, key);
+    FreeAclIndexEntry((AclIndexEntry_t *)u_hashmap_remove(gAclIndex, key, keyLength));
+
+    OicSecAce_t *ace = NULL;
+    LL_FOREACH(gAcl->aces, ace)
+    {
+        if ((OicSecAceUuidSubject == ace->subjectType) &&
+            (0 == memcmp(&ace->subjectuuid, subject, sizeof(OicUuid_t))) &&
+            !AddAceToAclIndex(ace, false))
+        {
+            InvalidateAclIndex();
+            return;
+        }
+    }
+}
+
+static const AclIndexEntry_t *GetAclIndexEntry(const uint8_t *key, size_t keyLength)
+{
+    if (!gAclIndexValid && !BuildAclIndex())
+    {
+        return NULL;
+    }
+    return (const AclIndexEntry_t *)u_hashmap_get(gAclIndex, key, keyLength);
+}
+
 void FreeRsrc(OicSecRsrc_t *rsrc)
 {
     //Clean each member of resource
@@ -1569,7 +1775,8 @@ OCStackResult RemoveACE(const OicUuid_t *subject, const char *resource)
     {
         LL_FOREACH_SAFE(gAcl->aces, ace, tempAce)
         {
-            if (memcmp(ace->subjectuuid.id, subject->id, sizeof(subject->id)) == 0)
+            if ((OicSecAceUuidSubject == ace->subjectType) &&
+                (memcmp(ace->subjectuuid.id, subject->id, sizeof(subject->id)) == 0))
             {
                 LL_DELETE(gAcl->aces, ace);
                 FreeACE(ace);
@@ -1585,7 +1792,8 @@ OCStackResult RemoveACE(const OicUuid_t *subject, const char *resource)
         //the resource array
         LL_FOREACH_SAFE(gAcl->aces, ace, tempAce)
         {
-            if (memcmp(ace->subjectuuid.id, subject->id, sizeof(subject->id)) == 0)
+            if ((OicSecAceUuidSubject == ace->subjectType) &&
+                (memcmp(ace->subjectuuid.id, subject->id, sizeof(subject->id)) == 0))
             {
                 OicSecRsrc_t* rsrc = NULL;
                 OicSecRsrc_t* tempRsrc = NULL;
@@ -1612,6 +1820,8 @@ OCStackResult RemoveACE(const OicUuid_t *subject, const char *resource)
 
     if (deleteFlag)
     {
+        ReindexAclSubject(subject);
+
         // In case of unit test do not update persistant storage.
         if (memcmp(subject->id, &WILDCARD_SUBJECT_B64_ID, sizeof(subject->id)) == 0)
         {
@@ -1962,6 +2172,7 @@ static OCStackResult RemoveAllAce(void)
             LL_DELETE(gAcl->aces, aceItem);
             FreeACE(aceItem);
         }
+        InvalidateAclIndex();
 
         //Generate empty ACL payload
         ret = AclToCBORPayload(gAcl, OIC_SEC_ACL_LATEST, &payload, &size);
@@ -1988,6 +2199,7 @@ static OCStackResult RemoveAllAce(void)
                 {
                     DeleteACLList(gAcl);
                     gAcl = originAcl;
+                    InvalidateAclIndex();
                 }
                 else
                 {
@@ -2160,6 +2372,7 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
                         OIC_LOG(DEBUG, TAG, "Prepending new ACE:");
                         OIC_LOG_ACE(DEBUG, insertAce);
                         LL_PREPEND(gAcl->aces, insertAce);
+                        AddAceToValidAclIndex(insertAce, true);
                     }
                     else
                     {
@@ -2369,6 +2582,7 @@ static OCStackResult CreateACLResource()
 OCStackResult SetDefaultACL(OicSecAcl_t *acl)
 {
     gAcl = acl;
+    InvalidateAclIndex();
     return OC_STACK_OK;
 }
 
@@ -2631,6 +2845,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NOT_NULL(TAG, gAcl, FATAL);
+    InvalidateAclIndex();
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -2655,14 +2870,58 @@ OCStackResult DeInitACLResource()
         DeleteACLList(gAcl);
         gAcl = NULL;
     }
+    FreeAclIndex();
+    gAclGeneration++;
     return (OC_STACK_OK != ret) ? ret : ret2;
 }
 
-const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr)
+const OicSecAce_t* const* GetACLResourceDataList(const OicUuid_t *subjectId, size_t *aceCount)
 {
-    OicSecAce_t *ace = NULL;
-    OicSecAce_t *begin = NULL;
+    if (NULL == subjectId || NULL == aceCount)
+    {
+        return NULL;
+    }
+    *aceCount = 0;
+
+    uint8_t key[ACL_INDEX_KEY_SIZE];
+    size_t keyLength = GetAclIndexUuidKey(subjectId, key);
+    const AclIndexEntry_t *entry = GetAclIndexEntry(key, keyLength);
+    if (NULL == entry)
+    {
+        return NULL;
+    }
+
+    *aceCount = entry->count;
+    return entry->aces;
+}
+
+const OicSecAce_t* const* GetACLResourceDataListByRole(const OicSecRole_t *role, size_t *aceCount)
+{
+    if (NULL == role || NULL == aceCount)
+    {
+        return NULL;
+    }
+    *aceCount = 0;
+
+    uint8_t key[ACL_INDEX_KEY_SIZE];
+    size_t keyLength = GetAclIndexRoleKey(role, key);
+    const AclIndexEntry_t *entry = GetAclIndexEntry(key, keyLength);
+    if (NULL == entry)
+    {
+        return NULL;
+    }
+
+    *aceCount = entry->count;
+    return entry->aces;
+}
 
+uint32_t GetACLGeneration(void)
+{
+    return gAclGeneration;
+}
+
+const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr)
+{
     if (NULL == subjectId || NULL == savePtr || NULL == gAcl)
     {
         return NULL;
@@ -2671,41 +2930,33 @@ const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **
     OIC_LOG(DEBUG, TAG, "GetACLResourceData: searching for ACE matching subject:");
     OIC_LOG_BUFFER(DEBUG, TAG, subjectId->id, sizeof(subjectId->id));
 
+    size_t aceCount = 0;
+    const OicSecAce_t* const* aces = GetACLResourceDataList(subjectId, &aceCount);
+
     /*
      * savePtr MUST point to NULL if this is the 'first' call to retrieve ACL for
-     * subjectID.
+     * subjectID. On successive calls, continue after the ACE it points to.
      */
-    if (NULL == *savePtr)
-    {
-        begin = gAcl->aces;
-    }
-    else
+    size_t begin = 0;
+    if (NULL != *savePtr)
     {
-        /*
-         * If this is a 'successive' call, search for location pointed by
-         * savePtr and assign 'begin' to the next ACL after it in the linked
-         * list and start searching from there.
-         */
-        LL_FOREACH(gAcl->aces, ace)
+        begin = aceCount;
+        for (size_t i = 0; i < aceCount; i++)
         {
-            if (ace == *savePtr)
+            if (aces[i] == *savePtr)
             {
-                begin = ace->next;
+                begin = i + 1;
+                break;
             }
         }
     }
 
-    // Find the next ACL corresponding to the 'subjectID' and return it.
-    LL_FOREACH(begin, ace)
+    if (begin < aceCount)
     {
-        if ((OicSecAceUuidSubject == ace->subjectType) &&
-            (0 == memcmp(&(ace->subjectuuid), subjectId, sizeof(OicUuid_t))))
-        {
-            OIC_LOG(DEBUG, TAG, "GetACLResourceData: found matching ACE:");
-            OIC_LOG_ACE(DEBUG, ace);
-            *savePtr = ace;
-            return ace;
-        }
+        OIC_LOG(DEBUG, TAG, "GetACLResourceData: found matching ACE:");
+        OIC_LOG_ACE(DEBUG, aces[begin]);
+        *savePtr = (OicSecAce_t *)aces[begin];
+        return aces[begin];
     }
 
     // Cleanup in case no ACL is found
@@ -2801,6 +3052,11 @@ OCStackResult AppendACLObject(const OicSecAcl_t* acl)
         gAcl->aces = acl->aces;
     }
 
+    LL_FOREACH(acl->aces, ace)
+    {
+        AddAceToValidAclIndex(ace, false);
+    }
+
     OIC_LOG_ACL(INFO, gAcl);
 
     size_t size = 0;
@@ -3038,6 +3294,7 @@ OCStackResult UpdateDefaultSecProvACE()
                 {
                     LL_DELETE(gAcl->aces, ace);
                     FreeACE(ace);
+                    InvalidateAclIndex();
                     isRemoved = true;
                 }
             }
@@ -3055,6 +3312,7 @@ OCStackResult UpdateDefaultSecProvACE()
             if (secDefaultAce)
             {
                 LL_APPEND(gAcl->aces, secDefaultAce);
+                AddAceToValidAclIndex(secDefaultAce, false);
 
                 size_t size = 0;
                 uint8_t *payload = NULL;
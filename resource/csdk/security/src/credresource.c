@@ -1517,6 +1517,11 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
         }
     }
 
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    // A resumed session would skip the checks against the new credentials.
+    CAsslClearSessionCache();
+#endif
+
     OIC_LOG(DEBUG, TAG, "OUT Cred UpdatePersistentStorage");
 
     logCredMetadata();
@@ -2096,6 +2101,9 @@ static OCEntityHandlerResult HandlePostRequest(OCEntityHandlerRequest * ehReques
 
     OCStackResult res = OC_STACK_ERROR;
 
+    // Replacing a credential removes and adds it, write the database once
+    BeginResourceUpdatesInPS();
+
     VERIFY_SUCCESS(TAG, OC_STACK_OK == GetDos(&dos), ERROR);
     if ((DOS_RESET == dos.state) ||
         (DOS_RFPRO == dos.state) ||
@@ -2361,6 +2369,11 @@ exit:
             previousMsgId = ehRequest->messageID++;
         }
     }
+    if (OC_STACK_OK != CommitResourceUpdatesInPS())
+    {
+        OIC_LOG(ERROR, TAG, "Failed to write the cred resource to PS");
+        ret = OC_EH_ERROR;
+    }
     //Send response to request originator
     ret = ((SendSRMResponse(ehRequest, ret, NULL, 0)) == OC_STACK_OK) ?
                    OC_EH_OK : OC_EH_ERROR;
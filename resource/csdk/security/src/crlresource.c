@@ -33,6 +33,7 @@
 #include "crlresource.h"
 #include "ocpayloadcbor.h"
 #include "base64.h"
+#include "cainterface.h"
 #include <time.h>
 
 #define TAG  "OIC_SRM_CRL"
@@ -477,6 +478,8 @@ OCStackResult UpdateCRLResource(OicSecCrl_t *crl)
         OIC_LOG(ERROR, TAG, "Can't update global crl");
         return OC_STACK_ERROR;
     }
+    // A resumed session would not be checked against the new CRL.
+    CAsslClearSessionCache();
 
     char currentTime[32] = {0};
     getCurrentUTCTime(currentTime, sizeof(currentTime));
@@ -32,6 +32,7 @@
 #endif /* (__WITH_DTLS__) || (__WITH_TLS__) */
 #include "doxmresource.h"
 #include "pstatresource.h"
+#include "cainterface.h"
 
 #define TAG "OIC_SRM_DOS"
 
@@ -579,6 +580,10 @@ OCStackResult SetDosState(const OicSecDeviceOnboardingState_t desiredState)
                 case OC_STACK_OK:
                 OIC_LOG_V(INFO, TAG, "%s: DOS state changed SUCCESSFULLY from %d to %d.",
                     __func__, oldState, desiredState);
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+                // Sessions of the previous state must not be resumed.
+                CAsslClearSessionCache();
+#endif
                 ret = OC_STACK_OK;
                 break;
 
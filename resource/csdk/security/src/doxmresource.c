@@ -1021,6 +1021,21 @@ static OCEntityHandlerResult HandleDoxmGetRequest (const OCEntityHandlerRequest
     return ehRet;
 }
 
+/**
+ * Sets the owned status. When it changes, the TLS sessions kept for resumption
+ * are dropped, so that no session established before is resumed.
+ */
+static void SetOwned(OicSecDoxm_t *doxm, bool owned)
+{
+    if (doxm->owned != owned)
+    {
+        doxm->owned = owned;
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+        CAsslClearSessionCache();
+#endif
+    }
+}
+
 OCStackResult DoxmUpdateWriteableProperty(const OicSecDoxm_t* src, OicSecDoxm_t* dst)
 {
     OCStackResult result = OC_STACK_OK;
@@ -1040,10 +1055,7 @@ OCStackResult DoxmUpdateWriteableProperty(const OicSecDoxm_t* src, OicSecDoxm_t*
         memcpy(&(dst->deviceID), &(src->deviceID), sizeof(OicUuid_t));
 
         // Update owned status
-        if(dst->owned != src->owned)
-        {
-            dst->owned = src->owned;
-        }
+        SetOwned(dst, src->owned);
 
 #ifdef MULTIPLE_OWNER
         if(src->mom)
@@ -1221,6 +1233,9 @@ static OCEntityHandlerResult HandleDoxmPostRequest(OCEntityHandlerRequest * ehRe
      */
     OicSecDoxm_t *newDoxm = NULL;
 
+    // An ownership transfer step can update several SVRs, write the database once
+    BeginResourceUpdatesInPS();
+
     if (ehRequest->payload)
     {
         uint8_t *payload = ((OCSecurityPayload *)ehRequest->payload)->securityData;
@@ -1640,7 +1655,7 @@ static OCEntityHandlerResult HandleDoxmPostRequest(OCEntityHandlerRequest * ehRe
                     goto exit;
                 }
 
-                gDoxm->owned = true;
+                SetOwned(gDoxm, true);
                 memcpy(&gDoxm->rownerID, &gDoxm->owner, sizeof(OicUuid_t));
 
                 // Update new state in persistent storage
@@ -1706,6 +1721,12 @@ exit:
         previousMsgId = ehRequest->messageID;
     }
 
+    if ((OC_STACK_OK != CommitResourceUpdatesInPS()) && (OC_EH_OK == ehRet))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to write the updated SVRs");
+        ehRet = OC_EH_INTERNAL_SERVER_ERROR;
+    }
+
     //Send payload to request originator
     ehRet = ((SendSRMResponse(ehRequest, ehRet, NULL, 0)) == OC_STACK_OK) ?
                    OC_EH_OK : OC_EH_ERROR;
@@ -2149,7 +2170,7 @@ OCStackResult SetDoxmIsOwned(const bool isowned)
 {
     if (gDoxm)
     {
-        gDoxm->owned = isowned;
+        SetOwned(gDoxm, isowned);
         return OC_STACK_OK;
     }
     return OC_STACK_ERROR;
@@ -2267,7 +2288,7 @@ void RestoreDoxmToInitState()
 
         OicUuid_t emptyUuid = {.id={0}};
         memcpy(&(gDoxm->owner), &emptyUuid, sizeof(OicUuid_t));
-        gDoxm->owned = false;
+        SetOwned(gDoxm, false);
         gDoxm->oxmSel = OIC_JUST_WORKS;
 
         if(!UpdatePersistentStorage(gDoxm))
@@ -2291,7 +2312,7 @@ OCStackResult SetDoxmSelfOwnership(const OicUuid_t* newROwner)
 
     if( newROwner && (false == gDoxm->owned) )
     {
-        gDoxm->owned = true;
+        SetOwned(gDoxm, true);
         memcpy(gDoxm->owner.id, newROwner->id, sizeof(newROwner->id));
         memcpy(gDoxm->rownerID.id, newROwner->id, sizeof(newROwner->id));
 
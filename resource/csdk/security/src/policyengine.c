@@ -22,6 +22,7 @@
 
 #include "utlist.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "policyengine.h"
 #include "resourcemanager.h"
 #include "securevirtualresourcetypes.h"
@@ -40,6 +41,27 @@
 
 #define TAG "OIC_SRM_PE"
 
+#ifndef WITH_ARDUINO
+/**
+ * Number of recent access decisions for UUID subjects that are kept. Decisions
+ * are dropped whenever the ACL changes.
+ */
+#define ACCESS_DECISION_CACHE_SIZE 8
+
+typedef struct AccessDecision
+{
+    bool                used;
+    uint32_t            aclGeneration;
+    OicUuid_t           subjectUuid;
+    uint16_t            requestedPermission;
+    SRMAccessResponse_t responseVal;
+    char                resourceUri[MAX_URI_LENGTH + 1];
+} AccessDecision_t;
+
+static AccessDecision_t g_accessDecisions[ACCESS_DECISION_CACHE_SIZE];
+static size_t g_nextAccessDecision = 0;
+#endif
+
 uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method)
 {
     uint16_t perm = 0;
@@ -385,6 +407,60 @@ static void ProcessMatchingACE(SRMRequestContext_t *context, const OicSecAce_t *
     }
 }
 
+#ifndef WITH_ARDUINO
+static bool GetCachedAccessDecision(SRMRequestContext_t *context)
+{
+    uint32_t aclGeneration = GetACLGeneration();
+    for (size_t i = 0; i < ACCESS_DECISION_CACHE_SIZE; i++)
+    {
+        const AccessDecision_t *decision = &g_accessDecisions[i];
+        if (decision->used &&
+            (decision->aclGeneration == aclGeneration) &&
+            (decision->requestedPermission == context->requestedPermission) &&
+            (0 == memcmp(&decision->subjectUuid, &context->subjectUuid, sizeof(OicUuid_t))) &&
+            (0 == strcmp(decision->resourceUri, context->resourceUri)))
+        {
+            context->responseVal = decision->responseVal;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void CacheAccessDecision(const SRMRequestContext_t *context)
+{
+    AccessDecision_t *decision = &g_accessDecisions[g_nextAccessDecision];
+    g_nextAccessDecision = (g_nextAccessDecision + 1) % ACCESS_DECISION_CACHE_SIZE;
+
+    decision->used = true;
+    decision->aclGeneration = GetACLGeneration();
+    decision->subjectUuid = context->subjectUuid;
+    decision->requestedPermission = context->requestedPermission;
+    decision->responseVal = context->responseVal;
+    OICStrcpy(decision->resourceUri, sizeof(decision->resourceUri), context->resourceUri);
+}
+#endif
+
+/**
+ * Process the ACEs in the passed list until one grants the request.
+ *
+ * @return true if the outcome does not depend on the time of the request.
+ */
+static bool ProcessMatchingACEs(SRMRequestContext_t *context,
+    const OicSecAce_t* const* aces, size_t aceCount)
+{
+    bool isTimeIndependent = true;
+    for (size_t i = 0; (i < aceCount) && !IsAccessGranted(context->responseVal); i++)
+    {
+        if (NULL != aces[i]->validities)
+        {
+            isTimeIndependent = false;
+        }
+        ProcessMatchingACE(context, aces[i]);
+    }
+    return isTimeIndependent;
+}
+
 /**
  * Find ACLs containing context->subject.
  * Search each ACL for requested resource.
@@ -404,38 +480,42 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
 
     OIC_LOG_V(DEBUG, TAG, "Entering %s(%s)", __func__, context->resourceUri);
 
-    const OicSecAce_t *currentAce = NULL;
-    OicSecAce_t *aceSavePtr = NULL;
-
-    OIC_LOG_V(DEBUG, TAG, "Entering ProcessAccessRequest(%s)",
-        context->resourceUri);
-
     // Start out assuming subject not found.
     context->responseVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
 
-    // Loop through all ACLs with a matching Subject searching for the right
-    // ACL for this request.
-    do
+#ifndef WITH_ARDUINO
+    if (GetCachedAccessDecision(context))
     {
-        currentAce = GetACLResourceData(&context->subjectUuid, &aceSavePtr);
-
-        if (NULL != currentAce)
-        {
-            ProcessMatchingACE(context, currentAce);
-        }
-        else
+        OIC_LOG_V(DEBUG, TAG, "%s:using cached decision for subject", __func__);
+    }
+    else
+#endif
+    {
+        // Check the ACEs with a matching Subject, in ACL order, until one grants
+        // this request.
+        size_t aceCount = 0;
+        const OicSecAce_t* const* aces = GetACLResourceDataList(&context->subjectUuid, &aceCount);
+        if (0 == aceCount)
         {
             OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",
                 __func__, context->resourceUri);
         }
-    } while ((NULL != currentAce) && !IsAccessGranted(context->responseVal));
+
+        bool isTimeIndependent = ProcessMatchingACEs(context, aces, aceCount);
+#ifndef WITH_ARDUINO
+        if (isTimeIndependent)
+        {
+            CacheAccessDecision(context);
+        }
+#else
+        OC_UNUSED(isTimeIndependent);
+#endif
+    }
 
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
         // If no subject ACE granted access, try role ACEs.
         if (!IsAccessGranted(context->responseVal))
         {
-            currentAce = NULL;
-            aceSavePtr = NULL;
             OicSecRole_t *roles = NULL;
             size_t roleCount = 0;
             OCStackResult res = GetEndpointRoles(context->endPoint, &roles, &roleCount);
@@ -446,19 +526,18 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
             else
             {
                 OIC_LOG_V(DEBUG, TAG, "Found %u asserted roles for endpoint", (unsigned int) roleCount);
-                do
+                for (size_t i = 0; (i < roleCount) && !IsAccessGranted(context->responseVal); i++)
+                {
+                    size_t aceCount = 0;
+                    const OicSecAce_t* const* aces = GetACLResourceDataListByRole(&roles[i],
+                                                                                 &aceCount);
+                    ProcessMatchingACEs(context, aces, aceCount);
+                }
+                if (!IsAccessGranted(context->responseVal))
                 {
-                    currentAce = GetACLResourceDataByRoles(roles, roleCount, &aceSavePtr);
-                    if (NULL != currentAce)
-                    {
-                        ProcessMatchingACE(context, currentAce);
-                    }
-                    else
-                    {
-                        OIC_LOG_V(INFO, TAG, "%s:no ACL found matching roles for resource %s",
-                            __func__, context->resourceUri);
-                    }
-                } while ((NULL != currentAce) && !IsAccessGranted(context->responseVal));
+                    OIC_LOG_V(INFO, TAG, "%s:no ACL found matching roles for resource %s",
+                        __func__, context->resourceUri);
+                }
 
                 OICFree(roles);
             }
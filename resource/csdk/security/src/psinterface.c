@@ -32,6 +32,9 @@
 #include "ocpayloadcbor.h"
 #include "ocstack.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
+#include "octhread.h"
+#include "utlist.h"
 #include "payload_logging.h"
 #include "resourcemanager.h"
 #include "secureresourcemanager.h"
@@ -58,14 +61,117 @@
 const size_t DB_FILE_SIZE_BLOCK = 1023;
 #endif
 
-typedef enum _PSDatabase
+/**
+ * Initial byte of an indefinite length CBOR map and the break byte that ends it.
+ */
+#define PS_CBOR_INDEFINITE_MAP 0xBF
+#define PS_CBOR_BREAK 0xFF
+
+/**
+ * Suffix of the temporary file a database is written to before it replaces
+ * the database.
+ */
+#define PS_TEMP_FILE_SUFFIX ".tmp"
+
+/**
+ * Database image that is kept in memory while a batch of updates is open, or
+ * after committing it failed.
+ */
+typedef struct PSPendingDatabase
+{
+    char *databaseName;
+    uint8_t *data;
+    size_t size;
+    struct PSPendingDatabase *next;
+} PSPendingDatabase_t;
+
+/**
+ * Lock protecting the batch of updates, created by InitPersistentStorageInterface().
+ * Before that the databases are only used by the thread initializing the stack.
+ */
+static oc_mutex gPSLock = NULL;
+static size_t gBatchDepth = 0;
+static PSPendingDatabase_t *gPendingDatabases = NULL;
+
+static void LockPS(void)
+{
+    if (gPSLock)
+    {
+        oc_mutex_lock(gPSLock);
+    }
+}
+
+static void UnlockPS(void)
+{
+    if (gPSLock)
+    {
+        oc_mutex_unlock(gPSLock);
+    }
+}
+
+OCStackResult InitPersistentStorageInterface(void)
+{
+    if (!gPSLock)
+    {
+        gPSLock = oc_mutex_new();
+        if (!gPSLock)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create PS lock");
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+    return OC_STACK_OK;
+}
+
+void DeInitPersistentStorageInterface(void)
+{
+    if (gPSLock)
+    {
+        oc_mutex_free(gPSLock);
+        gPSLock = NULL;
+    }
+}
+
+/**
+ * Writes data to a file in persistent storage.
+ *
+ * @param ps       is the persistent storage handler.
+ * @param path     is the name of the file.
+ * @param payload  is the data to write.
+ * @param size     is the size of payload.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult WriteFileToPS(const OCPersistentStorage *ps, const char *path,
+                                   const uint8_t *payload, size_t size)
 {
-    PS_DATABASE_SECURITY = 0,
-    PS_DATABASE_DEVICEPROPERTIES
-} PSDatabase;
+    FILE *fp = ps->open(path, "wb");
+    if (!fp)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to open %s", path);
+        return OC_STACK_ERROR;
+    }
+
+    OCStackResult result = OC_STACK_OK;
+    size_t numberItems = ps->write(payload, 1, size, fp);
+    if (size != numberItems)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed writing %" PRIuPTR " in %s", numberItems, path);
+        result = OC_STACK_ERROR;
+    }
+    if (0 != ps->close(fp))
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to close %s", path);
+        result = OC_STACK_ERROR;
+    }
+    return result;
+}
 
 /**
- * Writes CBOR payload to the specified database in persistent storage.
+ * Writes CBOR payload to the specified database in persistent storage. When a
+ * persistent storage rename handler is registered, the payload is written to a
+ * temporary file that then replaces the database, so a failed write leaves the
+ * previous database intact.
  *
  * @param databaseName is the name of the database to access through persistent storage.
  * @param payload      is the CBOR payload to write to the database in persistent storage.
@@ -73,42 +179,205 @@ typedef enum _PSDatabase
  *
  * @return ::OC_STACK_OK for Success, otherwise some error value
  */
-static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload, size_t size)
+static OCStackResult WritePayloadToPS(const char *databaseName, const uint8_t *payload, size_t size)
 {
     if (!databaseName || !payload || (size <= 0))
     {
         return OC_STACK_INVALID_PARAM;
     }
 
-    OCStackResult result = OC_STACK_ERROR;
-
     OIC_LOG_V(DEBUG, TAG, "Writing in the file: %" PRIuPTR, size);
 
     OCPersistentStorage* ps = OCGetPersistentStorageHandler();
-    if (ps)
+    if (!ps)
+    {
+        return OC_STACK_ERROR;
+    }
+    OCPersistentStorageRename psRename = OCGetPersistentStorageRename();
+    if (!psRename)
     {
-        FILE *fp = ps->open(databaseName, "wb");
-        if (fp)
+        OCStackResult result = WriteFileToPS(ps, databaseName, payload, size);
+        if (OC_STACK_OK == result)
         {
-            size_t numberItems = ps->write(payload, 1, size, fp);
-            if (size == numberItems)
-            {
-                OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s", size, databaseName);
-                result = OC_STACK_OK;
-            }
-            else
-            {
-                OIC_LOG_V(ERROR, TAG, "Failed writing %" PRIuPTR " in %s", numberItems, databaseName);
-            }
-            ps->close(fp);
+            OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s", size, databaseName);
         }
-        else
+        return result;
+    }
+
+    size_t tempNameSize = strlen(databaseName) + sizeof(PS_TEMP_FILE_SUFFIX);
+    char *tempName = (char *)OICMalloc(tempNameSize);
+    VERIFY_NOT_NULL_RETURN(TAG, tempName, ERROR, OC_STACK_NO_MEMORY);
+    OICStrcpy(tempName, tempNameSize, databaseName);
+    OICStrcat(tempName, tempNameSize, PS_TEMP_FILE_SUFFIX);
+
+    OCStackResult result = WriteFileToPS(ps, tempName, payload, size);
+    if (OC_STACK_OK == result && 0 != psRename(tempName, databaseName))
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to replace %s", databaseName);
+        result = OC_STACK_ERROR;
+    }
+    if (OC_STACK_OK == result)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s", size, databaseName);
+    }
+    else
+    {
+        ps->unlink(tempName);
+    }
+    OICFree(tempName);
+    return result;
+}
+
+/**
+ * Gets the in memory image of a database. The caller must hold the PS lock.
+ *
+ * @param databaseName is the name of the database.
+ *
+ * @return the image or NULL if no batch has updated the database.
+ */
+static PSPendingDatabase_t *GetPendingDatabase(const char *databaseName)
+{
+    PSPendingDatabase_t *pending = NULL;
+    LL_FOREACH(gPendingDatabases, pending)
+    {
+        if (0 == strcmp(pending->databaseName, databaseName))
         {
-            OIC_LOG(ERROR, TAG, "File open failed.");
+            break;
         }
     }
+    return pending;
+}
 
-    return result;
+static void FreePendingDatabase(PSPendingDatabase_t *pending)
+{
+    if (pending)
+    {
+        OICClearMemory(pending->data, pending->size);
+        OICFree(pending->data);
+        OICFree(pending->databaseName);
+        OICFree(pending);
+    }
+}
+
+/**
+ * Writes the in memory images of the databases. An image that fails to be
+ * written is kept, so reads still see it and the next commit retries it. The
+ * caller must hold the PS lock.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult WritePendingDatabases(void)
+{
+    OCStackResult ret = OC_STACK_OK;
+    PSPendingDatabase_t *pending = NULL;
+    PSPendingDatabase_t *tmp = NULL;
+    LL_FOREACH_SAFE(gPendingDatabases, pending, tmp)
+    {
+        OCStackResult res = WritePayloadToPS(pending->databaseName, pending->data, pending->size);
+        if (OC_STACK_OK != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed to commit updates of %s", pending->databaseName);
+            ret = res;
+            continue;
+        }
+        LL_DELETE(gPendingDatabases, pending);
+        FreePendingDatabase(pending);
+    }
+    return ret;
+}
+
+/**
+ * Stores a database. While a batch of updates is open the database is kept in
+ * memory until the batch is committed, otherwise it is written right away. The
+ * caller must hold the PS lock.
+ *
+ * @param databaseName is the name of the database to access through persistent storage.
+ * @param payload      is the CBOR payload of the whole database.
+ * @param size         is the size of payload.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult StoreDatabaseInPS(const char *databaseName, uint8_t *payload, size_t size)
+{
+    if (!databaseName || !payload || (0 == size))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    PSPendingDatabase_t *pending = GetPendingDatabase(databaseName);
+    if (0 == gBatchDepth && !pending)
+    {
+        return WritePayloadToPS(databaseName, payload, size);
+    }
+
+    uint8_t *data = (uint8_t *)OICMalloc(size);
+    VERIFY_NOT_NULL_RETURN(TAG, data, ERROR, OC_STACK_NO_MEMORY);
+    memcpy(data, payload, size);
+
+    if (!pending)
+    {
+        pending = (PSPendingDatabase_t *)OICCalloc(1, sizeof(PSPendingDatabase_t));
+        if (pending)
+        {
+            pending->databaseName = OICStrdup(databaseName);
+        }
+        if (!pending || !pending->databaseName)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to allocate pending database.");
+            OICFree(pending);
+            OICFree(data);
+            return OC_STACK_NO_MEMORY;
+        }
+        LL_PREPEND(gPendingDatabases, pending);
+    }
+    else
+    {
+        OICClearMemory(pending->data, pending->size);
+        OICFree(pending->data);
+    }
+    pending->data = data;
+    pending->size = size;
+
+    if (0 == gBatchDepth)
+    {
+        // an earlier commit failed, write its images along with this one
+        return WritePendingDatabases();
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "Deferred writing %" PRIuPTR " bytes into %s", size, databaseName);
+    return OC_STACK_OK;
+}
+
+/**
+ * Starts a batch of updates of the databases in PS.
+ */
+void BeginResourceUpdatesInPS(void)
+{
+    LockPS();
+    gBatchDepth++;
+    UnlockPS();
+}
+
+/**
+ * Ends a batch of updates of the databases in PS.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult CommitResourceUpdatesInPS(void)
+{
+    OCStackResult ret = OC_STACK_OK;
+    LockPS();
+    if (0 == gBatchDepth)
+    {
+        OIC_LOG(ERROR, TAG, "No batch of updates to commit.");
+        ret = OC_STACK_ERROR;
+    }
+    else if (0 == --gBatchDepth)
+    {
+        ret = WritePendingDatabases();
+    }
+    UnlockPS();
+    return ret;
 }
 
 /**
@@ -142,6 +411,92 @@ static size_t GetDatabaseSize(const OCPersistentStorage *ps, const char *databas
     return size;
 }
 
+/**
+ * Reads a database, or the named resource in it. The caller must hold the PS lock.
+ *
+ * @param databaseName is the name of the database to access through persistent storage.
+ * @param resourceName is the name of the resource to read, NULL for the whole database.
+ * @param data         is set to the content read, which the caller must OICFree().
+ * @param size         is set to the size of the content read.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult ReadDatabase(const char *databaseName, const char *resourceName,
+                                  uint8_t **data, size_t *size)
+{
+
+    FILE *fp = NULL;
+    OCPersistentStorage *ps = NULL;
+    uint8_t *fsData = NULL;
+    const uint8_t *dbData = NULL;
+    size_t fileSize = 0;
+    OCStackResult ret = OC_STACK_ERROR;
+
+    // An open batch of updates holds the latest content of the database
+    const PSPendingDatabase_t *pending = GetPendingDatabase(databaseName);
+    if (pending)
+    {
+        dbData = pending->data;
+        fileSize = pending->size;
+    }
+    else
+    {
+        ps = OCGetPersistentStorageHandler();
+        VERIFY_NOT_NULL(TAG, ps, ERROR);
+
+        fileSize = GetDatabaseSize(ps, databaseName);
+        OIC_LOG_V(DEBUG, TAG, "File Read Size: %" PRIuPTR, fileSize);
+        if (fileSize)
+        {
+            fsData = (uint8_t *) OICCalloc(1, fileSize);
+            VERIFY_NOT_NULL(TAG, fsData, ERROR);
+
+            fp = ps->open(databaseName, "rb");
+            VERIFY_NOT_NULL(TAG, fp, ERROR);
+            if (ps->read(fsData, 1, fileSize, fp) == fileSize)
+            {
+                dbData = fsData;
+            }
+        }
+    }
+
+    if (dbData)
+    {
+        if (resourceName)
+        {
+            CborParser parser;  // will be initialized in |cbor_parser_init|
+            CborValue cbor;     // will be initialized in |cbor_parser_init|
+            cbor_parser_init(dbData, fileSize, 0, &parser, &cbor);
+            CborValue cborValue = {0};
+            CborError cborFindResult = cbor_value_map_find_value(&cbor, resourceName, &cborValue);
+            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
+            {
+                cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
+                VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+                ret = OC_STACK_OK;
+            }
+            // in case of |else (...)|, svr_data not found
+        }
+        // return everything in case resourceName is NULL
+        else
+        {
+            *size = fileSize;
+            *data = (uint8_t *) OICCalloc(1, fileSize);
+            VERIFY_NOT_NULL(TAG, *data, ERROR);
+            memcpy(*data, dbData, fileSize);
+            ret = OC_STACK_OK;
+        }
+    }
+
+exit:
+    if (fp)
+    {
+        ps->close(fp);
+    }
+    OICFree(fsData);
+    return ret;
+}
+
 /**
  * Reads the database from PS
  * 
@@ -165,59 +520,106 @@ OCStackResult ReadDatabaseFromPS(const char *databaseName, const char *resourceN
         return OC_STACK_INVALID_PARAM;
     }
 
-    FILE *fp = NULL;
-    uint8_t *fsData = NULL;
-    size_t fileSize = 0;
+    LockPS();
+    OCStackResult ret = ReadDatabase(databaseName, resourceName, data, size);
+    UnlockPS();
+
+    OIC_LOG(DEBUG, TAG, "ReadDatabaseFromPS OUT");
+    return ret;
+}
+
+/**
+ * Copies the entries of a database except the named one and adds the new payload
+ * of that entry. The entries are copied as encoded, so resources the update does
+ * not touch are neither decoded nor re-encoded.
+ *
+ * @param dbData        is the encoded database, may be NULL.
+ * @param dbSize        is the size of dbData.
+ * @param resourceName  is the name of the resource that will be updated.
+ * @param payload       is the new CBOR payload of the resource, NULL to remove it.
+ * @param size          is the size of the CBOR payload.
+ * @param outPayload    is set to the new database, which the caller must OICFree().
+ * @param outSize       is set to the size of the new database.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult SpliceResourceIntoDatabase(const uint8_t *dbData, size_t dbSize,
+                                                const char *resourceName,
+                                                const uint8_t *payload, size_t size,
+                                                uint8_t **outPayload, size_t *outSize)
+{
     OCStackResult ret = OC_STACK_ERROR;
+    CborError cborResult = CborNoError;
+    size_t allocSize = dbSize + size + CBOR_ENCODING_SIZE_ADDITION;
+    size_t offset = 0;
 
-    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
-    VERIFY_NOT_NULL(TAG, ps, ERROR);
+    uint8_t *out = (uint8_t *)OICCalloc(1, allocSize);
+    VERIFY_NOT_NULL_RETURN(TAG, out, ERROR, OC_STACK_NO_MEMORY);
 
-    fileSize = GetDatabaseSize(ps, databaseName);
-    OIC_LOG_V(DEBUG, TAG, "File Read Size: %" PRIuPTR, fileSize);
-    if (fileSize)
+    out[offset++] = PS_CBOR_INDEFINITE_MAP;
+
+    // Encode the updated payload first so it will be stored in the database.
+    if (payload && size)
     {
-        fsData = (uint8_t *) OICCalloc(1, fileSize);
-        VERIFY_NOT_NULL(TAG, fsData, ERROR);
+        CborEncoder encoder;  // will be initialized in |cbor_encoder_init|
+        cbor_encoder_init(&encoder, out + offset, allocSize - offset, 0);
+        cborResult = cbor_encode_text_string(&encoder, resourceName, strlen(resourceName));
+        VERIFY_CBOR_SUCCESS(TAG, cborResult, "Failed Adding Value Tag");
+        cborResult = cbor_encode_byte_string(&encoder, payload, size);
+        VERIFY_CBOR_SUCCESS(TAG, cborResult, "Failed Adding Value.");
+        VERIFY_SUCCESS(TAG, CborNoError == cborResult, ERROR);
+        offset += cbor_encoder_get_buffer_size(&encoder, out + offset);
+    }
 
-        fp = ps->open(databaseName, "rb");
-        VERIFY_NOT_NULL(TAG, fp, ERROR);
-        if (ps->read(fsData, 1, fileSize, fp) == fileSize)
+    // Copy every other resource of the database as it is. The updated resource was
+    // added above, so its old entry is skipped to avoid duplicate entries.
+    if (dbData && dbSize)
+    {
+        CborParser parser;  // will be initialized in |cbor_parser_init|
+        CborValue cbor;     // will be initialized in |cbor_parser_init|
+        CborValue entry;    // will be initialized in |cbor_value_enter_container|
+        cborResult = cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
+        VERIFY_CBOR_SUCCESS(TAG, cborResult, "Failed Parsing Database.");
+        VERIFY_SUCCESS(TAG, cbor_value_is_map(&cbor), ERROR);
+        cborResult = cbor_value_enter_container(&cbor, &entry);
+        VERIFY_CBOR_SUCCESS(TAG, cborResult, "Failed Entering Database Map.");
+
+        while (cbor_value_is_valid(&entry))
         {
-            if (resourceName)
+            const uint8_t *entryStart = cbor_value_get_next_byte(&entry);
+            bool isUpdated = false;
+            bool isResource = cbor_value_is_text_string(&entry);
+            if (isResource)
             {
-                CborParser parser;  // will be initialized in |cbor_parser_init|
-                CborValue cbor;     // will be initialized in |cbor_parser_init|
-                cbor_parser_init(fsData, fileSize, 0, &parser, &cbor);
-                CborValue cborValue = {0};
-                CborError cborFindResult = cbor_value_map_find_value(&cbor, resourceName, &cborValue);
-                if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
-                    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
-                    ret = OC_STACK_OK;
-                }
-                // in case of |else (...)|, svr_data not found
+                cborResult = cbor_value_text_string_equals(&entry, resourceName, &isUpdated);
+                VERIFY_CBOR_SUCCESS(TAG, cborResult, "Failed Comparing Resource Name.");
             }
-            // return everything in case resourceName is NULL
-            else
+            cborResult = cbor_value_advance(&entry);
+            VERIFY_CBOR_SUCCESS(TAG, cborResult, "Failed Advancing Resource Name.");
+            VERIFY_SUCCESS(TAG, cbor_value_is_valid(&entry), ERROR);
+            isResource = isResource && cbor_value_is_byte_string(&entry);
+            cborResult = cbor_value_advance(&entry);
+            VERIFY_CBOR_SUCCESS(TAG, cborResult, "Failed Advancing Resource Value.");
+
+            if (isResource && !isUpdated)
             {
-                *size = fileSize;
-                *data = (uint8_t *) OICCalloc(1, fileSize);
-                VERIFY_NOT_NULL(TAG, *data, ERROR);
-                memcpy(*data, fsData, fileSize);
-                ret = OC_STACK_OK;
+                size_t entrySize = (size_t)(cbor_value_get_next_byte(&entry) - entryStart);
+                VERIFY_SUCCESS(TAG, entrySize < allocSize - offset, ERROR);
+                memcpy(out + offset, entryStart, entrySize);
+                offset += entrySize;
             }
         }
     }
-    OIC_LOG(DEBUG, TAG, "ReadDatabaseFromPS OUT");
+
+    out[offset++] = PS_CBOR_BREAK;
+
+    *outPayload = out;
+    *outSize = offset;
+    out = NULL;
+    ret = OC_STACK_OK;
 
 exit:
-    if (fp)
-    {
-        ps->close(fp);
-    }
-    OICFree(fsData);
+    OICFree(out);
     return ret;
 }
 
@@ -244,271 +646,26 @@ OCStackResult UpdateResourceInPS(const char *databaseName, const char *resourceN
     uint8_t *dbData = NULL;
     uint8_t *outPayload = NULL;
 
-    uint8_t *aclCbor = NULL;
-    uint8_t *pstatCbor = NULL;
-    uint8_t *doxmCbor = NULL;
-    uint8_t *amaclCbor = NULL;
-    uint8_t *credCbor = NULL;
-    uint8_t *pconfCbor = NULL;
-    uint8_t *resetPfCbor = NULL;
-    uint8_t *crlCbor = NULL;
-    uint8_t *dpCbor = NULL;
-
-    int64_t cborEncoderResult = CborNoError;
-    OCStackResult ret = ReadDatabaseFromPS(databaseName, NULL, &dbData, &dbSize);
-    if (dbData && dbSize)
+    // The lock is held from reading the database to storing it, so concurrent
+    // updates of different resources do not lose each other.
+    LockPS();
+    OCStackResult ret = ReadDatabase(databaseName, NULL, &dbData, &dbSize);
+    if ((dbData && dbSize) || (payload && size))
     {
-        PSDatabase database = PS_DATABASE_SECURITY;
-        size_t allocSize = 0;
-        size_t aclCborLen = 0;
-        size_t pstatCborLen = 0;
-        size_t doxmCborLen = 0;
-        size_t amaclCborLen = 0;
-        size_t credCborLen = 0;
-        size_t pconfCborLen = 0;
-        size_t resetPfCborLen = 0;
-        size_t crlCborLen = 0;
-        size_t dpCborLen = 0;
-
-        // Determine which database we are working with so we can scope our operations
-        if (0 == strcmp(OC_DEVICE_PROPS_FILE_NAME, databaseName))
-        {
-            database = PS_DATABASE_DEVICEPROPERTIES;
-        }
-
-        // Gets each secure virtual resource from persistent storage
-        // this local scoping intended, for destroying large cbor instances after use
-        {
-            CborParser parser;  // will be initialized in |cbor_parser_init|
-            CborValue cbor;     // will be initialized in |cbor_parser_init|
-            cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
-            CborValue curVal = {0};
-            CborError cborFindResult = CborNoError;
-
-            // Only search for and copy resources owned by the target database
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_ACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &aclCbor, &aclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding ACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PSTAT_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &pstatCbor, &pstatCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PSTAT Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_DOXM_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &doxmCbor, &doxmCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding DOXM Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_AMACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &amaclCbor, &amaclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding AMACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRED_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &credCbor, &credCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding CRED Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PCONF_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &pconfCbor, &pconfCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PCONF Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_RESET_PF_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &resetPfCbor, &resetPfCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Reset Profile Name Value.");
-                }
-                int64_t cborFindCrlResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRL_NAME, &curVal);
-                if ((CborNoError == cborFindCrlResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindCrlResult = cbor_value_dup_byte_string(&curVal, &crlCbor, &crlCborLen, NULL);
-                    if ((CborNoError != cborFindCrlResult) && (CborErrorOutOfMemory != cborFindCrlResult))
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed Finding optional CRL Name Value.");
-                    }
-                    else
-                    {
-                        OIC_LOG(INFO, TAG, "Successfully Finding optional CRL Name Value.");
-                    }
-                }
-            }
-            else
-            {
-                // Device Properties database
-                cborFindResult = cbor_value_map_find_value(&cbor, OC_JSON_DEVICE_PROPS_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &dpCbor, &dpCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Device Properties Name Value.");
-                }
-            }
-        }
-
-        // Updates the added |payload| with the existing secure virtual resource(s)
-        // this local scoping intended, for destroying large cbor instances after use
-        {
-            if (PS_DATABASE_SECURITY == database)
-            {
-                allocSize = aclCborLen + pstatCborLen + doxmCborLen + amaclCborLen
-                          + credCborLen + pconfCborLen + resetPfCborLen + crlCborLen
-                          + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-            else
-            {
-                allocSize = dpCborLen + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-
-
-            outPayload = (uint8_t *)OICCalloc(1, allocSize);
-            VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-            CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-            cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-            CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-            cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-            // Encode the updated payload and add it to our map so it will be stored in the database.
-            if (payload && size)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-                cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-            }
-
-            // Check all of the resources from a particular database to see if we need to encode them. If the resource
-            // currently exists in the database and has not been updated then we need to encode it and add it to the
-            // map. If the resource has been updated then it was encoded and added to the map above so we skip it to
-            // avoid having duplicate entries for the resource in the database.
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                if (strcmp(OIC_JSON_ACL_NAME, resourceName) && aclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_ACL_NAME, strlen(OIC_JSON_ACL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, aclCbor, aclCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Value.");
-                }
-                if (strcmp(OIC_JSON_PSTAT_NAME, resourceName) && pstatCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_PSTAT_NAME, strlen(OIC_JSON_PSTAT_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, pstatCbor, pstatCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Value.");
-                }
-                if (strcmp(OIC_JSON_DOXM_NAME, resourceName) && doxmCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_DOXM_NAME, strlen(OIC_JSON_DOXM_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, doxmCbor, doxmCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Value.");
-                }
-                if (strcmp(OIC_JSON_AMACL_NAME, resourceName) && amaclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_AMACL_NAME, strlen(OIC_JSON_AMACL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, amaclCbor, amaclCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Value.");
-                }
-                if (strcmp(OIC_JSON_CRED_NAME, resourceName) && credCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRED_NAME, strlen(OIC_JSON_CRED_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, credCbor, credCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Value.");
-                }
-                if (strcmp(OIC_JSON_PCONF_NAME, resourceName) && pconfCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_PCONF_NAME, strlen(OIC_JSON_PCONF_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, pconfCbor, pconfCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Value.");
-                }
-                if (strcmp(OIC_JSON_RESET_PF_NAME, resourceName) && resetPfCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_RESET_PF_NAME, strlen(OIC_JSON_RESET_PF_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, resetPfCbor, resetPfCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Value.");
-                }
-                if (strcmp(OIC_JSON_CRL_NAME, resourceName) && crlCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRL_NAME, strlen(OIC_JSON_CRL_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, crlCbor, crlCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Value.");
-                }
-            }
-            else
-            {
-                // Device Properties database
-                if (strcmp(OC_JSON_DEVICE_PROPS_NAME, resourceName) && dpCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OC_JSON_DEVICE_PROPS_NAME, strlen(OC_JSON_DEVICE_PROPS_NAME));
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Device Properties Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, dpCbor, dpCborLen);
-                    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Device Properties Value.");
-                }
-            }
-
-            cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-            outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
-        }
-    }
-    else if (payload && size)
-    {
-        size_t allocSize = size + CBOR_ENCODING_SIZE_ADDITION;
-
-        outPayload = (uint8_t *)OICCalloc(1, allocSize);
-        VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-        CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-        cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-        CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-        cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-        cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-        cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-
-        cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-        outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+        ret = SpliceResourceIntoDatabase(dbData, dbSize, resourceName, payload, size,
+                                         &outPayload, &outSize);
+        VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
     }
 
-    ret = WritePayloadToPS(databaseName, outPayload, outSize);
+    ret = StoreDatabaseInPS(databaseName, outPayload, outSize);
     VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
 
     OIC_LOG(DEBUG, TAG, "UpdateResourceInPS OUT");
 
 exit:
+    UnlockPS();
     OICFree(dbData);
     OICFree(outPayload);
-    OICFree(aclCbor);
-    OICFree(pstatCbor);
-    OICFree(doxmCbor);
-    OICFree(amaclCbor);
-    OICFree(credCbor);
-    OICFree(pconfCbor);
-    OICFree(resetPfCbor);
-    OICFree(crlCbor);
-    OICFree(dpCbor);
     return ret;
 }
 
@@ -667,11 +824,13 @@ OCStackResult ResetSecureResourceInPS(void)
             outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
         }
 
-        ret = WritePayloadToPS(SVR_DB_DAT_FILE_NAME, outPayload, outSize);
+        LockPS();
+        ret = StoreDatabaseInPS(SVR_DB_DAT_FILE_NAME, outPayload, outSize);
+        UnlockPS();
         VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
     }
 
-    SRMDeInitSecureResources();
+    DestroySecureResources();
     InitSecureResources();
     OIC_LOG(DEBUG, TAG, "ResetSecureResourceINPS OUT");
 
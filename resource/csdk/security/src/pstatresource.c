@@ -776,6 +776,9 @@ static OCEntityHandlerResult HandlePstatPostRequest(OCEntityHandlerRequest *ehRe
     static uint16_t previousMsgId = 0;
     bool isDuplicatedMsg = false;
 
+    // A device state change can update several SVRs, write the database once
+    BeginResourceUpdatesInPS();
+
     if (ehRequest->payload && NULL != gPstat)
     {
         uint8_t *payload = ((OCSecurityPayload *) ehRequest->payload)->securityData;
@@ -882,6 +885,11 @@ static OCEntityHandlerResult HandlePstatPostRequest(OCEntityHandlerRequest *ehRe
             }
             if (true == (pstat->cm & RESET))
             {
+                if ((OC_STACK_OK != CommitResourceUpdatesInPS()) && (OC_EH_OK == ehRet))
+                {
+                    OIC_LOG(ERROR, TAG, "Failed to write the updated SVRs");
+                    ehRet = OC_EH_INTERNAL_SERVER_ERROR;
+                }
                 if (OC_STACK_OK != SendSRMResponse(ehRequest, ehRet, NULL, 0))
                 {
                     ehRet = OC_EH_ERROR;
@@ -937,6 +945,12 @@ static OCEntityHandlerResult HandlePstatPostRequest(OCEntityHandlerRequest *ehRe
         }
     }
 
+    if ((OC_STACK_OK != CommitResourceUpdatesInPS()) && (OC_EH_OK == ehRet))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to write the updated SVRs");
+        ehRet = OC_EH_INTERNAL_SERVER_ERROR;
+    }
+
     // Send response payload to request originator
     ehRet = ((SendSRMResponse(ehRequest, ehRet, NULL, 0)) == OC_STACK_OK) ?
         OC_EH_OK : OC_EH_ERROR;
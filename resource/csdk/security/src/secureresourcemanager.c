@@ -33,6 +33,7 @@
 #include "srmresourcestrings.h"
 #include "ocresourcehandler.h"
 #include "ocrandom.h"
+#include "psinterface.h"
 
 #if defined( __WITH_TLS__) || defined(__WITH_DTLS__)
 #include "pkix_interface.h"
@@ -448,10 +449,15 @@ OCPersistentStorage* SRMGetPersistentStorageHandler()
 
 OCStackResult SRMInitSecureResources()
 {
+    OCStackResult ret = InitPersistentStorageInterface();
+    if (OC_STACK_OK != ret)
+    {
+        return ret;
+    }
+
     // TODO: temporarily returning OC_STACK_OK every time until default
     // behavior (for when SVR DB is missing) is settled.
     InitSecureResources();
-    OCStackResult ret = OC_STACK_OK;
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
     if (CA_STATUS_OK != CAregisterPskCredentialsHandler(GetDtlsPskCredentials))
     {
@@ -467,6 +473,7 @@ OCStackResult SRMInitSecureResources()
 void SRMDeInitSecureResources()
 {
     DestroySecureResources();
+    DeInitPersistentStorageInterface();
 }
 
 bool SRMIsSecurityResourceURI(const char* uri)
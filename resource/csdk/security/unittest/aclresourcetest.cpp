@@ -429,6 +429,136 @@ exit:
 }
 
 //'DELETE' ACL test
+TEST(ACLResourceTest, GetACLResourceDataListFollowsChanges)
+{
+    const size_t aceCount = 200;
+
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicSecAcl_t *defaultAcl = NULL;
+    EXPECT_EQ(OC_STACK_OK, GetDefaultACL(&defaultAcl));
+    ASSERT_TRUE(defaultAcl != NULL);
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(defaultAcl));
+
+    size_t count = 0;
+    OicUuid_t wildcard = WILDCARD_SUBJECT_ID;
+    EXPECT_TRUE(NULL != GetACLResourceDataList(&wildcard, &count));
+    EXPECT_EQ((size_t)NUM_ACE_FOR_WILDCARD_IN_DEFAULT_ACL, count);
+
+    // Append many ACEs for one subject and one for a role
+    OicUuid_t subject;
+    memset(subject.id, 0x33, sizeof(subject.id));
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != acl);
+    for (size_t i = 0; i < aceCount; i++)
+    {
+        OicSecAce_t *ace = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+        ASSERT_TRUE(NULL != ace);
+        ace->subjectType = OicSecAceUuidSubject;
+        ace->subjectuuid = subject;
+        ace->permission = PERMISSION_READ;
+        char href[MAX_URI_LENGTH];
+        snprintf(href, sizeof(href), "/a/led%u", (unsigned int)i);
+        EXPECT_TRUE(AddResourceToACE(ace, href, "oic.core", "oic.if.baseline"));
+        LL_APPEND(acl->aces, ace);
+    }
+    OicSecAce_t *roleAce = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+    ASSERT_TRUE(NULL != roleAce);
+    roleAce->subjectType = OicSecAceRoleSubject;
+    OICStrcpy(roleAce->subjectRole.id, sizeof(roleAce->subjectRole.id), "role1");
+    roleAce->permission = PERMISSION_READ;
+    EXPECT_TRUE(AddResourceToACE(roleAce, "/a/led", "oic.core", "oic.if.baseline"));
+    LL_APPEND(acl->aces, roleAce);
+
+    uint32_t generation = GetACLGeneration();
+    AppendACLObject(acl);
+    OICFree(acl);
+    EXPECT_NE(generation, GetACLGeneration());
+
+    const OicSecAce_t* const* aces = GetACLResourceDataList(&subject, &count);
+    ASSERT_EQ(aceCount, count);
+    for (size_t i = 0; i < aceCount; i++)
+    {
+        char href[MAX_URI_LENGTH];
+        snprintf(href, sizeof(href), "/a/led%u", (unsigned int)i);
+        EXPECT_STREQ(href, aces[i]->resources->href);
+    }
+
+    OicSecRole_t role;
+    memset(&role, 0, sizeof(role));
+    OICStrcpy(role.id, sizeof(role.id), "role1");
+    EXPECT_TRUE(NULL != GetACLResourceDataListByRole(&role, &count));
+    EXPECT_EQ(1u, count);
+
+    // The iterating lookup walks the same ACEs
+    const OicSecAce_t *ace = NULL;
+    OicSecAce_t *savePtr = NULL;
+    count = 0;
+    while ((ace = GetACLResourceData(&subject, &savePtr)) != NULL)
+    {
+        count++;
+    }
+    EXPECT_EQ(aceCount, count);
+
+    // Removing an ACE updates the subject's entry
+    generation = GetACLGeneration();
+    RemoveACE(&subject, "/a/led0");
+    EXPECT_NE(generation, GetACLGeneration());
+    aces = GetACLResourceDataList(&subject, &count);
+    ASSERT_EQ(aceCount - 1, count);
+    EXPECT_STREQ("/a/led1", aces[0]->resources->href);
+
+    DeInitACLResource();
+    EXPECT_TRUE(NULL == GetACLResourceDataList(&subject, &count));
+    EXPECT_EQ(0u, count);
+}
+
+TEST(ACLResourceTest, RemoveACEKeepsRoleWithCollidingUuid)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicSecAcl_t *defaultAcl = NULL;
+    EXPECT_EQ(OC_STACK_OK, GetDefaultACL(&defaultAcl));
+    ASSERT_TRUE(defaultAcl != NULL);
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(defaultAcl));
+
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != acl);
+    OicSecAce_t *roleAce = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+    ASSERT_TRUE(NULL != roleAce);
+    roleAce->subjectType = OicSecAceRoleSubject;
+    OICStrcpy(roleAce->subjectRole.id, sizeof(roleAce->subjectRole.id), "role-with-uuid-bytes");
+    roleAce->permission = PERMISSION_READ;
+    EXPECT_TRUE(AddResourceToACE(roleAce, "/a/led", "oic.core", "oic.if.baseline"));
+    LL_APPEND(acl->aces, roleAce);
+
+    // The subject UUID shares its storage with the role id
+    OicUuid_t subject;
+    memcpy(subject.id, roleAce->subjectRole.id, sizeof(subject.id));
+    OicSecRole_t role = roleAce->subjectRole;
+
+    AppendACLObject(acl);
+    OICFree(acl);
+
+    size_t count = 0;
+    EXPECT_TRUE(NULL != GetACLResourceDataListByRole(&role, &count));
+    EXPECT_EQ(1u, count);
+
+    // Neither form of the delete may remove the role ACE
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, RemoveACE(&subject, "/a/led"));
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, RemoveACE(&subject, NULL));
+
+    const OicSecAce_t* const* aces = GetACLResourceDataListByRole(&role, &count);
+    ASSERT_TRUE(NULL != aces);
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ(OicSecAceRoleSubject, aces[0]->subjectType);
+    EXPECT_STREQ("/a/led", aces[0]->resources->href);
+
+    DeInitACLResource();
+}
+
 TEST(ACLResourceTest, ACLDeleteWithSingleResourceTest)
 {
     // Intialize /pstat global, so that the GetDos() calls in aclresource.c
@@ -0,0 +1,161 @@
+/******************************************************************
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+******************************************************************/
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <string.h>
+#include "ocstack.h"
+#include "oic_malloc.h"
+#include "psinterface.h"
+#include "srmtestcommon.h"
+
+#define PS_TEST_DATABASE "psinterface_test.dat"
+
+static size_t GetFileSize(const char *path)
+{
+    size_t size = 0;
+    FILE *fp = fopen(path, "rb");
+    if (fp)
+    {
+        fseek(fp, 0, SEEK_END);
+        size = (size_t)ftell(fp);
+        fclose(fp);
+    }
+    return size;
+}
+
+static bool gFailWrites = false;
+
+static size_t FailingWrite(const void *ptr, size_t size, size_t nmemb, FILE *stream)
+{
+    return gFailWrites ? 0 : fwrite(ptr, size, nmemb, stream);
+}
+
+static bool FileExists(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp)
+    {
+        fclose(fp);
+    }
+    return (NULL != fp);
+}
+
+static bool ResourceEquals(const char *resourceName, const uint8_t *expected, size_t expectedSize)
+{
+    uint8_t *data = NULL;
+    size_t size = 0;
+    bool equals = (OC_STACK_OK == ReadDatabaseFromPS(PS_TEST_DATABASE, resourceName, &data, &size))
+                  && (size == expectedSize) && (0 == memcmp(data, expected, size));
+    OICFree(data);
+    return equals;
+}
+
+TEST(PSInterfaceTest, UpdateResourceKeepsOtherResources)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+    remove(PS_TEST_DATABASE);
+
+    const uint8_t first[] = {0x01, 0x02, 0x03};
+    const uint8_t second[] = {0x04, 0x05};
+    const uint8_t third[] = {0x06};
+
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "first", first, sizeof(first)));
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "second", second, sizeof(second)));
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "first", third, sizeof(third)));
+    EXPECT_TRUE(ResourceEquals("first", third, sizeof(third)));
+    EXPECT_TRUE(ResourceEquals("second", second, sizeof(second)));
+
+    // Removing a resource leaves the others
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "first", NULL, 0));
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_NE(OC_STACK_OK, ReadDatabaseFromPS(PS_TEST_DATABASE, "first", &data, &size));
+    EXPECT_TRUE(NULL == data);
+    EXPECT_TRUE(ResourceEquals("second", second, sizeof(second)));
+
+    remove(PS_TEST_DATABASE);
+    SetPersistentHandler(&ps, false);
+}
+
+TEST(PSInterfaceTest, BatchedUpdatesAreWrittenOnCommit)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+    remove(PS_TEST_DATABASE);
+
+    const uint8_t first[] = {0x01, 0x02, 0x03};
+    const uint8_t second[] = {0x04, 0x05};
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "first", first, sizeof(first)));
+    size_t committedSize = GetFileSize(PS_TEST_DATABASE);
+    EXPECT_NE(0u, committedSize);
+
+    BeginResourceUpdatesInPS();
+    BeginResourceUpdatesInPS();
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "second", second, sizeof(second)));
+    EXPECT_EQ(OC_STACK_OK, CommitResourceUpdatesInPS());
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "first", second, sizeof(second)));
+
+    // Reads see the pending updates before the outermost commit writes them
+    EXPECT_TRUE(ResourceEquals("first", second, sizeof(second)));
+    EXPECT_TRUE(ResourceEquals("second", second, sizeof(second)));
+    EXPECT_EQ(committedSize, GetFileSize(PS_TEST_DATABASE));
+
+    EXPECT_EQ(OC_STACK_OK, CommitResourceUpdatesInPS());
+    EXPECT_NE(committedSize, GetFileSize(PS_TEST_DATABASE));
+    EXPECT_TRUE(ResourceEquals("first", second, sizeof(second)));
+    EXPECT_TRUE(ResourceEquals("second", second, sizeof(second)));
+
+    EXPECT_EQ(OC_STACK_ERROR, CommitResourceUpdatesInPS());
+
+    remove(PS_TEST_DATABASE);
+    SetPersistentHandler(&ps, false);
+}
+
+TEST(PSInterfaceTest, FailedCommitKeepsPendingUpdates)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+    ps.write = FailingWrite;
+    remove(PS_TEST_DATABASE);
+
+    const uint8_t first[] = {0x01, 0x02, 0x03};
+    const uint8_t second[] = {0x04, 0x05};
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "first", first, sizeof(first)));
+    size_t committedSize = GetFileSize(PS_TEST_DATABASE);
+
+    BeginResourceUpdatesInPS();
+    EXPECT_EQ(OC_STACK_OK, UpdateResourceInPS(PS_TEST_DATABASE, "second", second, sizeof(second)));
+    gFailWrites = true;
+    EXPECT_NE(OC_STACK_OK, CommitResourceUpdatesInPS());
+
+    // The database is left as it was and the update is still visible
+    EXPECT_EQ(committedSize, GetFileSize(PS_TEST_DATABASE));
+    EXPECT_FALSE(FileExists(PS_TEST_DATABASE ".tmp"));
+    EXPECT_TRUE(ResourceEquals("first", first, sizeof(first)));
+    EXPECT_TRUE(ResourceEquals("second", second, sizeof(second)));
+
+    // The next commit writes it
+    gFailWrites = false;
+    BeginResourceUpdatesInPS();
+    EXPECT_EQ(OC_STACK_OK, CommitResourceUpdatesInPS());
+    EXPECT_NE(committedSize, GetFileSize(PS_TEST_DATABASE));
+    EXPECT_TRUE(ResourceEquals("second", second, sizeof(second)));
+
+    remove(PS_TEST_DATABASE);
+    SetPersistentHandler(&ps, false);
+}
@@ -171,4 +171,6 @@ void SetPersistentHandler(OCPersistentStorage *ps, bool set)
     }
     EXPECT_EQ(OC_STACK_OK,
             OCRegisterPersistentStorageHandler(ps));
+    EXPECT_EQ(OC_STACK_OK,
+            OCRegisterPersistentStorageRename(set ? rename : NULL));
 }
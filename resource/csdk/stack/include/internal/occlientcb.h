@@ -123,6 +123,13 @@ typedef struct ClientCB {
      * can be explicitly cancelled.*/
     uint32_t TTL;
 
+    /** Position + 1 of this callback in the TTL min-heap, 0 if it has no TTL.*/
+    size_t ttlHeapIndex;
+
+    /** Representation responses are passed to the callback undecoded, see
+     * ::OC_DO_REQUEST_LAZY_PAYLOAD.*/
+    bool lazyPayload;
+
     /** next node in this list.*/
     struct ClientCB    *next;
 } ClientCB;
@@ -226,5 +233,33 @@ void DeleteClientCBList();
  */
 void FindAndDeleteClientCB(ClientCB * cbNode);
 
+/** @ingroup ocstack
+ *
+ * This method is used to change the TTL of a cb node. The TTL must not be changed
+ * directly, as the node is ordered by it for DeleteTimedOutClientCBs.
+ *
+ * @param[in] cbNode    Address to client callback node.
+ * @param[in] ttl       New TTL in coap ticks, 0 for no TTL.
+ */
+void UpdateClientCBTTL(ClientCB *cbNode, uint32_t ttl);
+
+/** @ingroup ocstack
+ *
+ * This method is used to delete all cb nodes in cbList whose TTL has expired.
+ * Presence and observe callbacks have no TTL until they receive a response that
+ * the application keeps the transaction for.
+ */
+void DeleteTimedOutClientCBs();
+
+/** @ingroup ocstack
+ *
+ * This method is used to get the earliest TTL of the cb nodes in cbList.
+ *
+ * @param[out] ttl    Earliest TTL, in coap ticks.
+ *
+ * @return true if a cb node has a TTL, false otherwise.
+ */
+bool GetEarliestClientCBTTL(uint32_t *ttl);
+
 #endif //OC_CLIENT_CB
 
@@ -93,6 +93,12 @@ typedef struct ResourceObserver
     /** next node in this list.*/
     struct ResourceObserver *next;
 
+    /** previous node in this list.*/
+    struct ResourceObserver *prev;
+
+    /** next observer of the same resource.*/
+    struct ResourceObserver *resourceNext;
+
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
@@ -152,6 +158,12 @@ OCStackResult SendListObserverNotification (OCResource * resource,
  */
 void DeleteObserverList();
 
+/**
+ * Delete all observers of a resource. Used when the resource itself is deleted.
+ * @param resource   Observed resource.
+ */
+void DeleteResourceObservers(OCResource *resource);
+
 /**
  * Create a unique observation ID.
  *
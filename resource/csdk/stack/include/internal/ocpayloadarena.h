@@ -0,0 +1,126 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the arena that representation payload trees are
+ * allocated from.
+ *
+ * An arena hands out zeroed memory from large chunks and frees all of it at
+ * once. Every OCRepPayload allocated from an arena holds a reference to it,
+ * so the arena goes away with the last payload of the tree, whichever part
+ * of the tree that is. Memory of an arena is never freed piecewise:
+ * OCPayloadArenaFree() skips it and frees anything else with OICFree(), so
+ * heap allocated values can be mixed into an arena tree.
+ *
+ * All functions accept a NULL arena and then fall back to the heap. The
+ * reference count is atomic, but allocating from an arena is not; the parser
+ * seals its arenas once a tree is built, so that the payloads of a parsed tree
+ * can be changed and freed from different threads like heap payloads.
+ */
+
+#ifndef OC_PAYLOAD_ARENA_H_
+#define OC_PAYLOAD_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct OCPayloadArena OCPayloadArena;
+
+/**
+ * Creates an arena holding one reference.
+ *
+ * @param sizeHint  Expected number of bytes allocated from the arena; sizes
+ *                  the first chunk.
+ *
+ * @return the arena or NULL if out of memory.
+ */
+OCPayloadArena* OCPayloadArenaCreate(size_t sizeHint);
+
+/**
+ * Takes a reference to the arena.
+ *
+ * @return the arena.
+ */
+OCPayloadArena* OCPayloadArenaRetain(OCPayloadArena* arena);
+
+/**
+ * Drops a reference to the arena, freeing all of its memory with the last one.
+ */
+void OCPayloadArenaRelease(OCPayloadArena* arena);
+
+/**
+ * Seals the arena. Later allocations from it are taken from the heap, so the
+ * arena no longer changes.
+ */
+void OCPayloadArenaSeal(OCPayloadArena* arena);
+
+/**
+ * Allocates size zeroed bytes from the arena, or from the heap if it is sealed.
+ *
+ * @return the memory or NULL if out of memory.
+ */
+void* OCPayloadArenaAlloc(OCPayloadArena* arena, size_t size);
+
+/**
+ * Copies length bytes of str and a terminating NUL into the arena.
+ *
+ * @return the copy or NULL if out of memory.
+ */
+char* OCPayloadArenaStrndup(OCPayloadArena* arena, const char* str, size_t length);
+
+/**
+ * Checks whether ptr points into memory of the arena.
+ */
+bool OCPayloadArenaContains(const OCPayloadArena* arena, const void* ptr);
+
+/**
+ * Frees ptr with OICFree() unless it points into memory of the arena.
+ */
+void OCPayloadArenaFree(const OCPayloadArena* arena, void* ptr);
+
+/**
+ * @return the number of heap blocks the arena took for its chunks.
+ */
+size_t OCPayloadArenaGetChunkCount(const OCPayloadArena* arena);
+
+/**
+ * Creates a representation payload in the arena. The payload holds a
+ * reference to the arena and allocates its values from it.
+ *
+ * @return the payload or NULL if out of memory.
+ */
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena);
+
+/**
+ * @return the arena the payload was created in, or NULL.
+ */
+OCPayloadArena* OCRepPayloadGetArena(const OCRepPayload* payload);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OC_PAYLOAD_ARENA_H_
@@ -31,6 +31,12 @@ extern "C"
 OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadFormat format, OCPayloadType type,
         const uint8_t* payload, size_t payloadSize);
 
+/**
+ * Sets whether OCParsePayload allocates representation trees from an arena,
+ * which is the default. See OCRepPayloadCreateWithArena.
+ */
+void OCParsePayloadUseArena(bool useArena);
+
 OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
         uint8_t** outPayload, size_t* size);
 
@@ -65,6 +65,7 @@ typedef struct PRESENCERESOURCE{
  */
 
 struct rsrc_t;
+struct ResourceObserver;
 
 /**
  * following structure will be created in occollection.
@@ -247,6 +248,9 @@ typedef struct OCResource {
 
     /** Resource endpoint type(s). */
     OCTpsSchemeFlags endpointType;
+
+    /** Observers of this resource; linked list through ResourceObserver::resourceNext.*/
+    struct ResourceObserver *observersHead;
 } OCResource;
 
 
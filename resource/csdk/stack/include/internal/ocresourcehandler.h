@@ -266,6 +266,17 @@ OCStackResult DevicePropertiesToCBORPayload(const OCDeviceProperties *deviceProp
  */
 OCStackResult CBORPayloadToDeviceProperties(const uint8_t *payload, size_t size, OCDeviceProperties **deviceProperties);
 
+/**
+ * Drop the cached /oic/res responses. Called whenever the resources, their properties or the
+ * network change. May be called from any thread.
+ */
+void InvalidateDiscoveryCache();
+
+/**
+ * Free the cached /oic/res responses.
+ */
+void DeleteDiscoveryCache();
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
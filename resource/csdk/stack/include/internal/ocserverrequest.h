@@ -226,6 +226,81 @@ OCServerRequest * GetServerRequestUsingHandle (const OCServerRequest * handle);
  */
 void DeleteServerRequest(OCServerRequest * serverRequest);
 
+/**
+ * Encoded notification response shared by the observers of a resource that
+ * requested the same representation.
+ */
+typedef struct OCNotificationCache
+{
+    /** Token of the notification request whose response is captured.*/
+    CAToken_t token;
+
+    /** Length of the token.*/
+    uint8_t tokenLength;
+
+    /** Set once the response has been captured.*/
+    bool captured;
+
+    /** Response code.*/
+    CAResponseResult_t result;
+
+    /** Encoded payload.*/
+    CAPayload_t payload;
+
+    /** Size of the encoded payload.*/
+    size_t payloadSize;
+
+    /** Format of the encoded payload.*/
+    CAPayloadFormat_t payloadFormat;
+
+    /** Version of the payload format.*/
+    uint16_t payloadVersion;
+
+    /** Vendor specific header options of the response.*/
+    CAHeaderOption_t *options;
+
+    /** Number of vendor specific header options.*/
+    uint8_t numOptions;
+} OCNotificationCache;
+
+/**
+ * Capture the encoded response of the notification request with the token of
+ * the cache instead of discarding it after it has been sent.
+ *
+ * @param[in]  cache   Cache to capture into, NULL to stop capturing.
+ *
+ * @return the cache that was capturing before, to be restored when done.
+ */
+OCNotificationCache *SetNotificationCapture(OCNotificationCache *cache);
+
+/**
+ * Free the response held by a notification cache.
+ *
+ * @param[in]  cache   Notification cache.
+ */
+void ClearNotificationCache(OCNotificationCache *cache);
+
+/**
+ * Send a captured notification response to another observer. Only the token,
+ * the observe sequence number and the message type differ between observers.
+ *
+ * @param[in]  cache          Captured notification response.
+ * @param[in]  devAddr        Address of the observer.
+ * @param[in]  token          Token of the observe registration.
+ * @param[in]  tokenLength    Length of the token.
+ * @param[in]  sequenceNum    Observe sequence number.
+ * @param[in]  qos            Quality of service of the notification.
+ * @param[in]  resourceUri    Uri of the observed resource.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult SendCachedNotification(const OCNotificationCache *cache,
+                                     const OCDevAddr *devAddr,
+                                     CAToken_t token, uint8_t tokenLength,
+                                     uint32_t sequenceNum, OCQualityOfService qos,
+                                     char *resourceUri);
+
 /**
  * Handler function for sending a response from a single resource
  *
@@ -236,6 +311,52 @@ void DeleteServerRequest(OCServerRequest * serverRequest);
  */
 OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Payload of a response encoded for the format accepted by a request. It can be sent again
+ * to requests that accept the same format and version.
+ */
+typedef struct OCEncodedPayload
+{
+    /** Encoded payload.*/
+    CAPayload_t payload;
+
+    /** Size of the encoded payload.*/
+    size_t payloadSize;
+
+    /** Format of the encoded payload.*/
+    CAPayloadFormat_t payloadFormat;
+
+    /** Version of the payload format.*/
+    uint16_t payloadVersion;
+} OCEncodedPayload;
+
+/**
+ * Encode a response payload like ::HandleSingleResponse does for the request.
+ *
+ * @param[in]  serverRequest  Request the payload responds to.
+ * @param[in]  payload        Payload of the response.
+ * @param[out] encoded        Encoded payload, to be freed with OICFree(encoded->payload).
+ *
+ * @return
+ *     ::OC_STACK_OK on success, ::OC_STACK_NOT_ACCEPTABLE if the request does not accept
+ *     any format the payload can be encoded in, some other value upon failure.
+ */
+OCStackResult EncodeResponsePayload(const OCServerRequest *serverRequest, OCPayload *payload,
+                                    OCEncodedPayload *encoded);
+
+/**
+ * Send a response with an already encoded payload and delete the request.
+ *
+ * @param[in]  serverRequest  Request to respond to.
+ * @param[in]  ehResult       Result of the response.
+ * @param[in]  encoded        Encoded payload, see ::EncodeResponsePayload.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult HandleEncodedResponse(OCServerRequest *serverRequest, OCEntityHandlerResult ehResult,
+                                    const OCEncodedPayload *encoded);
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
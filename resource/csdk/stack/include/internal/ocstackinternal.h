@@ -178,6 +178,14 @@ OCStackResult OCStackFeedBack(CAToken_t token, uint8_t tokenLength, uint8_t stat
  */
 OCStackResult HandleStackRequests(OCServerProtocolRequest * protocolRequest);
 
+/**
+ * default adapter state change callback method
+ *
+ * @param adapter   CA network adapter type.
+ * @param enabled   current adapter state.
+ */
+void OCDefaultAdapterStateChangedHandler(CATransportAdapter_t adapter, bool enabled);
+
 OCStackResult SendDirectStackResponse(const CAEndpoint_t* endPoint, const uint16_t coapID,
         const CAResponseResult_t responseResult, const CAMessageType_t type,
         const uint8_t numOptions, const CAHeaderOption_t *options,
@@ -324,6 +332,43 @@ OCStackResult OCUpdateResourceInsWithResponse(const char *requestUri,
                                               const OCClientResponse *response);
 #endif
 
+#ifdef RD_SERVER
+/**
+ * Finalizes the statements used to discover resources in the RD database and closes the
+ * connection. It is opened again with the next discovery request.
+ */
+void OCRDDatabaseDiscoveryClose();
+
+/**
+ * Drops the discovery results cached for the RD database. Called whenever resources are
+ * stored in or deleted from the database.
+ */
+void OCRDDatabaseDiscoveryInvalidate();
+
+/**
+ * Search the RD database for queries like ::OCRDDatabaseDiscoveryPayloadCreate, but return
+ * the result cached for the same query if the database has not changed since.
+ *
+ * @param interfaceType is the interface type that is queried.
+ * @param resourceType is the resource type that is queried.
+ * @param discPayload NULL if no resource found or else the cached OCDiscoveryPayload. It is
+ * owned by the cache and valid until the next call or until the cache is invalidated.
+ *
+ * @return ::OC_STACK_OK in case of success or else other value.
+ */
+OCStackResult OCRDDatabaseDiscoveryPayloadGet(const char *interfaceType,
+                                              const char *resourceType,
+                                              const OCDiscoveryPayload **discPayload);
+
+/**
+ * Check the RD database for changes and return a number that changes whenever the results
+ * of ::OCRDDatabaseDiscoveryPayloadGet may have changed.
+ *
+ * @return the current generation of the cached discovery results.
+ */
+uint32_t OCRDDatabaseDiscoveryGetGeneration();
+#endif
+
 /**
  * Delete all of the dynamically allocated elements that were created for the resource attributes.
  *
@@ -71,6 +71,13 @@ OCStackResult TerminateKeepAlive(OCMode mode);
  */
 void ProcessKeepAlive();
 
+/**
+ * Get the time until ProcessKeepAlive has a ping to send or a connection to close.
+ * @param[in]   maxTimeoutMs    Upper bound of the returned value.
+ * @return  milliseconds until the next KeepAlive deadline, at most maxTimeoutMs.
+ */
+uint32_t GetKeepAliveTimeout(uint32_t maxTimeoutMs);
+
 /**
  * This API will be called from RI layer whenever there is a request for KeepAlive.
  * Virtual Resource.
@@ -70,12 +70,32 @@ void OCPayloadDestroy(OCPayload* payload);
 // Representation Payload
 OCRepPayload* OCRepPayloadCreate();
 
+/**
+ * Creates a representation payload whose values are allocated from an arena
+ * instead of one heap block each. The arena is freed with the last payload
+ * of the tree, so a large tree is freed in one go.
+ *
+ * The payload must only be changed and freed through the OCRepPayload
+ * functions; strings and values of the tree must not be freed with OICFree().
+ * The payloads of the tree share the arena, so the tree must not be changed
+ * from several threads at once, even through different payloads.
+ *
+ * @param sizeHint   Expected size of the payload in bytes, 0 if unknown.
+ *
+ * @return the payload or NULL if out of memory.
+ */
+OCRepPayload* OCRepPayloadCreateWithArena(size_t sizeHint);
+
 size_t calcDimTotal(const size_t dimensions[MAX_REP_ARRAY_DEPTH]);
 
 OCRepPayload* OCRepPayloadClone(const OCRepPayload* payload);
 
 OCRepPayload* OCRepPayloadBatchClone(const OCRepPayload* repPayload);
 
+/**
+ * Appends child at the end of the list that parent belongs to. The list is
+ * walked from parent, so passing the last payload appended avoids the walk.
+ */
 void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child);
 
 bool OCRepPayloadSetUri(OCRepPayload* payload, const char* uri);
@@ -89,6 +109,13 @@ bool OCRepPayloadAddInterfaceAsOwner(OCRepPayload* payload, char* iface);
 bool OCRepPayloadIsNull(const OCRepPayload* payload, const char* name);
 bool OCRepPayloadSetNull(OCRepPayload* payload, const char* name);
 
+/**
+ * Removes the property name from the payload and frees its value.
+ *
+ * @return false if the payload has no such property.
+ */
+bool OCRepPayloadRemoveProp(OCRepPayload* payload, const char* name);
+
 bool OCRepPayloadSetPropInt(OCRepPayload* payload, const char* name, int64_t value);
 bool OCRepPayloadGetPropInt(const OCRepPayload* payload, const char* name, int64_t* value);
 
@@ -228,6 +255,93 @@ bool OCRepPayloadGetPropObjectArray(const OCRepPayload* payload, const char* nam
 
 void OCRepPayloadDestroy(OCRepPayload* payload);
 
+// Representation View
+
+/**
+ * Initializes a view of a CBOR encoded representation. Nothing is decoded up
+ * front; each getter walks the encoding with TinyCBOR and decodes only the
+ * requested property. This saves building an OCRepPayload tree when a few
+ * properties of a large representation are needed.
+ *
+ * The view doesn't own the buffer, which must stay valid and unchanged while
+ * the view or any view taken from it is used.
+ *
+ * @param view      View to initialize.
+ * @param cbor      Encoded representation, a CBOR map.
+ * @param size      Size of cbor in bytes.
+ *
+ * @return ::OC_STACK_OK, or ::OC_STACK_MALFORMED_RESPONSE if cbor isn't a map.
+ */
+OCStackResult OCRepPayloadViewInit(OCRepPayloadView* view, const uint8_t* cbor, size_t size);
+
+/**
+ * Gets the type of a property of the view.
+ *
+ * @return true if the property exists.
+ */
+bool OCRepPayloadViewGetPropType(const OCRepPayloadView* view, const char* name,
+        OCRepPayloadPropType* type);
+
+bool OCRepPayloadViewIsNull(const OCRepPayloadView* view, const char* name);
+bool OCRepPayloadViewGetPropInt(const OCRepPayloadView* view, const char* name, int64_t* value);
+bool OCRepPayloadViewGetPropDouble(const OCRepPayloadView* view, const char* name, double* value);
+bool OCRepPayloadViewGetPropBool(const OCRepPayloadView* view, const char* name, bool* value);
+
+/**
+ * Gets a copy of a string property, which the caller frees with OICFree().
+ */
+bool OCRepPayloadViewGetPropString(const OCRepPayloadView* view, const char* name, char** value);
+
+/**
+ * Gets a string property without copying it. The string points into the
+ * encoded buffer and is not NUL terminated. Strings sent in chunks can't be
+ * referenced in place; use OCRepPayloadViewGetPropString() for those.
+ *
+ * @param view      View to read from.
+ * @param name      Name of the property.
+ * @param value     Start of the string.
+ * @param length    Length of the string in bytes.
+ *
+ * @return true on success, false if the property is missing, not a string or chunked.
+ */
+bool OCRepPayloadViewGetPropStringRef(const OCRepPayloadView* view, const char* name,
+        const char** value, size_t* length);
+
+/**
+ * Gets a copy of a byte string property. The caller frees value->bytes with OICFree().
+ */
+bool OCRepPayloadViewGetPropByteString(const OCRepPayloadView* view, const char* name,
+        OCByteString* value);
+
+/**
+ * Gets a view of an object property. The view shares the encoded buffer.
+ */
+bool OCRepPayloadViewGetPropObject(const OCRepPayloadView* view, const char* name,
+        OCRepPayloadView* value);
+
+/**
+ * Gets the href of a root view, which the caller frees with OICFree().
+ */
+bool OCRepPayloadViewGetUri(const OCRepPayloadView* view, char** uri);
+
+/**
+ * Gets the resource types of a root view. The caller frees the list with OCFreeOCStringLL().
+ */
+bool OCRepPayloadViewGetResourceTypes(const OCRepPayloadView* view, OCStringLL** types);
+
+/**
+ * Gets the interfaces of a root view. The caller frees the list with OCFreeOCStringLL().
+ */
+bool OCRepPayloadViewGetInterfaces(const OCRepPayloadView* view, OCStringLL** interfaces);
+
+/**
+ * Decodes the whole view into a representation payload, for callers that need
+ * more than a few properties or the ones the view has no getter for (arrays).
+ *
+ * @return the payload, which the caller frees with OCRepPayloadDestroy(), or NULL on failure.
+ */
+OCRepPayload* OCRepPayloadViewToPayload(const OCRepPayloadView* view);
+
 // Discovery Payload
 OCDiscoveryPayload* OCDiscoveryPayloadCreate();
 
@@ -128,6 +128,35 @@ OCStackResult OCStopMulticastServer();
  */
 OCStackResult OCProcess();
 
+/**
+ * This function returns how long OCProcess() can go without being called, that is the
+ * time until the next client callback timeout, presence check or keep alive deadline.
+ * Call it under the same lock as OCProcess().
+ *
+ * @param maxTimeoutMs    Upper bound of the returned value.
+ *
+ * @return milliseconds until OCProcess() should be called again, at most maxTimeoutMs.
+ */
+uint32_t OCGetProcessTimeout(uint32_t maxTimeoutMs);
+
+/**
+ * This function blocks until OCWakeUpProcess() is called or timeoutMs milliseconds
+ * have passed, so that a thread calling OCProcess() does not have to poll.
+ * Do not call it under the lock used for OCProcess().
+ *
+ * @param timeoutMs    Longest time to wait, usually from OCGetProcessTimeout().
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCWaitForProcess(uint32_t timeoutMs);
+
+/**
+ * This function wakes up the thread blocked in OCWaitForProcess(). The stack calls it
+ * when data is received or a timed event may now be due sooner; applications can call
+ * it to stop waiting.
+ */
+void OCWakeUpProcess();
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -220,6 +249,29 @@ OCStackResult OCDoRequest(OCDoHandle *handle,
                           OCHeaderOption *options,
                           uint8_t numOptions);
 
+/**
+ * This function is @ref OCDoRequest with flags changing how the stack handles
+ * the request, e.g. ::OC_DO_REQUEST_LAZY_PAYLOAD to have representation
+ * responses passed to the callback undecoded.
+ *
+ * @param requestFlags      Combination of ::OCDoRequestFlags.
+ *
+ * See @ref OCDoRequest for the other parameters.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCDoRequestWithFlags(OCDoHandle *handle,
+                                   OCMethod method,
+                                   const char *requestUri,
+                                   const OCDevAddr *destination,
+                                   OCPayload* payload,
+                                   OCConnectivityType connectivityType,
+                                   OCQualityOfService qos,
+                                   OCCallbackData *cbData,
+                                   OCHeaderOption *options,
+                                   uint8_t numOptions,
+                                   OCDoRequestFlags requestFlags);
+
 /**
  * This function cancels a request associated with a specific @ref OCDoResource invocation.
  *
@@ -246,6 +298,19 @@ OCStackResult OCCancel(OCDoHandle handle,
  */
 OCStackResult OCRegisterPersistentStorageHandler(OCPersistentStorage* persistentStorageHandler);
 
+/**
+ * Register the rename handler of the persistent storage, optional. When one is
+ * registered, a database is written to a temporary file that then replaces the
+ * database, so a failed write leaves the previous database intact. Otherwise
+ * databases are written in place.
+ * @param   renameHandler  Renames a file of the registered persistent storage,
+ *                         NULL to write in place.
+ *
+ * @return
+ *     OC_STACK_OK                    No errors; Success.
+ */
+OCStackResult OCRegisterPersistentStorageRename(OCPersistentStorageRename renameHandler);
+
 #ifdef WITH_PRESENCE
 /**
  * When operating in  OCServer or  OCClientServer mode,
@@ -641,6 +706,19 @@ OCStackResult OCNotifyListOfObservers (OCResourceHandle handle,
  */
 OCStackResult OCDoResponse(OCEntityHandlerResponse *response);
 
+/**
+ * This function marks a request as answered later with OCDoResponse(), i.e. as if
+ * its entity handler had returned ::OC_EH_SLOW. Call it from the entity handler
+ * before handing the request to another thread.
+ *
+ * @param requestHandle   Handle of the request passed to the entity handler.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_INVALID_REQUEST_HANDLE if the request
+ * is unknown and ::OC_STACK_NOT_ACCEPTABLE for an observe notification, which has to
+ * be answered before the entity handler returns.
+ */
+OCStackResult OCDeferResponse(OCRequestHandle requestHandle);
+
 //#ifdef DIRECT_PAIRING
 /**
  * The function is responsible for discovery of direct-pairing device is current subnet. It will list
@@ -881,6 +959,13 @@ OCStackResult OCGetPropertyValue(OCPayloadType type, const char *propName, void
 */
 OCPersistentStorage *OCGetPersistentStorageHandler();
 
+/**
+* Get the registered persistent storage rename handler.
+*
+* @return the handler, or NULL if none is registered.
+*/
+OCPersistentStorageRename OCGetPersistentStorageRename();
+
 /**
 * This function return link local zone id related from ifindex.
 *
@@ -111,4 +111,10 @@
  */
 #define MAX_CB_TIMEOUT_SECONDS   (2 * 60 * 60)  // 2 hours = 7200 seconds.
 
+/**
+ * Longest time, in milliseconds, that the C++ wrappers wait between OCProcess() calls
+ * when no timed event of the stack is due sooner.
+ */
+#define MAX_PROCESS_TIMEOUT_MS   (1000)
+
 #endif //OCSTACK_CONFIG_H_
@@ -35,12 +35,170 @@
 
 #include "cacommon.h"
 #include "cainterface.h"
+#include "uhashmap.h"
 
 /// Module Name
 #define TAG "OIC_RI_CLIENTCB"
 
+/// Initial number of slots in the TTL heap
+#define CLIENTCB_TIMEOUT_HEAP_INITIAL_SIZE 16
+
 struct ClientCB *cbList = NULL;
 
+/// Indexes over cbList keyed by token, by invocation handle and by node address
+static u_hashmap_t *g_cbTokenIndex = NULL;
+static u_hashmap_t *g_cbHandleIndex = NULL;
+static u_hashmap_t *g_cbNodeIndex = NULL;
+
+/// Min-heap of the nodes in cbList that have a TTL, ordered by TTL
+static ClientCB **g_cbTimeoutHeap = NULL;
+static size_t g_cbTimeoutHeapCount = 0;
+static size_t g_cbTimeoutHeapCapacity = 0;
+
+static void SetTimeoutHeapNode(size_t pos, ClientCB *cbNode)
+{
+    g_cbTimeoutHeap[pos] = cbNode;
+    cbNode->ttlHeapIndex = pos + 1;
+}
+
+static void SiftUpTimeoutHeap(size_t pos)
+{
+    ClientCB *cbNode = g_cbTimeoutHeap[pos];
+    while (pos > 0)
+    {
+        size_t parent = (pos - 1) / 2;
+        if (g_cbTimeoutHeap[parent]->TTL <= cbNode->TTL)
+        {
+            break;
+        }
+        SetTimeoutHeapNode(pos, g_cbTimeoutHeap[parent]);
+        pos = parent;
+    }
+    SetTimeoutHeapNode(pos, cbNode);
+}
+
+static void SiftDownTimeoutHeap(size_t pos)
+{
+    ClientCB *cbNode = g_cbTimeoutHeap[pos];
+    for (;;)
+    {
+        size_t child = 2 * pos + 1;
+        if (child >= g_cbTimeoutHeapCount)
+        {
+            break;
+        }
+        if (child + 1 < g_cbTimeoutHeapCount
+            && g_cbTimeoutHeap[child + 1]->TTL < g_cbTimeoutHeap[child]->TTL)
+        {
+            child++;
+        }
+        if (cbNode->TTL <= g_cbTimeoutHeap[child]->TTL)
+        {
+            break;
+        }
+        SetTimeoutHeapNode(pos, g_cbTimeoutHeap[child]);
+        pos = child;
+    }
+    SetTimeoutHeapNode(pos, cbNode);
+}
+
+static bool AddToTimeoutHeap(ClientCB *cbNode)
+{
+    if (g_cbTimeoutHeapCount == g_cbTimeoutHeapCapacity)
+    {
+        size_t capacity = g_cbTimeoutHeapCapacity ?
+                          g_cbTimeoutHeapCapacity * 2 : CLIENTCB_TIMEOUT_HEAP_INITIAL_SIZE;
+        ClientCB **heap = (ClientCB **) OICRealloc(g_cbTimeoutHeap, capacity * sizeof(ClientCB *));
+        if (!heap)
+        {
+            return false;
+        }
+        g_cbTimeoutHeap = heap;
+        g_cbTimeoutHeapCapacity = capacity;
+    }
+
+    SetTimeoutHeapNode(g_cbTimeoutHeapCount++, cbNode);
+    SiftUpTimeoutHeap(g_cbTimeoutHeapCount - 1);
+    return true;
+}
+
+static void RemoveFromTimeoutHeap(ClientCB *cbNode)
+{
+    if (!cbNode->ttlHeapIndex)
+    {
+        return;
+    }
+
+    size_t pos = cbNode->ttlHeapIndex - 1;
+    cbNode->ttlHeapIndex = 0;
+    g_cbTimeoutHeapCount--;
+    if (pos == g_cbTimeoutHeapCount)
+    {
+        return;
+    }
+
+    // Move the last node into the hole and restore the heap order around it.
+    ClientCB *moved = g_cbTimeoutHeap[g_cbTimeoutHeapCount];
+    SetTimeoutHeapNode(pos, moved);
+    SiftUpTimeoutHeap(pos);
+    SiftDownTimeoutHeap(moved->ttlHeapIndex - 1);
+}
+
+/*
+ * Remove an index entry only if it still refers to this node, so that a later node
+ * that reused the same key is not dropped from the index.
+ */
+static void RemoveFromIndex(u_hashmap_t *index, const void *key, size_t keyLength,
+                            ClientCB *cbNode)
+{
+    if (u_hashmap_get(index, key, keyLength) == cbNode)
+    {
+        u_hashmap_remove(index, key, keyLength);
+    }
+}
+
+static void RemoveFromIndexes(ClientCB *cbNode)
+{
+    if (cbNode->token && cbNode->tokenLength)
+    {
+        RemoveFromIndex(g_cbTokenIndex, cbNode->token, cbNode->tokenLength, cbNode);
+    }
+    RemoveFromIndex(g_cbHandleIndex, &cbNode->handle, sizeof(cbNode->handle), cbNode);
+    RemoveFromIndex(g_cbNodeIndex, &cbNode, sizeof(cbNode), cbNode);
+    RemoveFromTimeoutHeap(cbNode);
+}
+
+static bool AddToIndexes(ClientCB *cbNode)
+{
+    if (!g_cbTokenIndex)
+    {
+        g_cbTokenIndex = u_hashmap_create(0);
+    }
+    if (!g_cbHandleIndex)
+    {
+        g_cbHandleIndex = u_hashmap_create(0);
+    }
+    if (!g_cbNodeIndex)
+    {
+        g_cbNodeIndex = u_hashmap_create(0);
+    }
+    if (!g_cbTokenIndex || !g_cbHandleIndex || !g_cbNodeIndex)
+    {
+        return false;
+    }
+
+    if ((cbNode->token && cbNode->tokenLength
+         && !u_hashmap_put(g_cbTokenIndex, cbNode->token, cbNode->tokenLength, cbNode))
+        || !u_hashmap_put(g_cbHandleIndex, &cbNode->handle, sizeof(cbNode->handle), cbNode)
+        || !u_hashmap_put(g_cbNodeIndex, &cbNode, sizeof(cbNode), cbNode)
+        || (cbNode->TTL && !AddToTimeoutHeap(cbNode)))
+    {
+        RemoveFromIndexes(cbNode);
+        return false;
+    }
+    return true;
+}
+
 OCStackResult
 AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
             CAMessageType_t type,
@@ -70,7 +228,7 @@ AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
     if (!cbNode)// If it does not already exist, create new node.
 #endif // WITH_PRESENCE
     {
-        cbNode = (ClientCB*) OICMalloc(sizeof(ClientCB));
+        cbNode = (ClientCB*) OICCalloc(1, sizeof(ClientCB));
         if (!cbNode)
         {
             *clientCB = NULL;
@@ -146,6 +304,15 @@ AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
             {
                 cbNode->TTL = ttl;
             }
+            if (!AddToIndexes(cbNode))
+            {
+                OIC_LOG(ERROR, TAG, "Out of memory");
+                OICFree(cbNode->options);
+                OICFree(cbNode->payload);
+                OICFree(cbNode);
+                *clientCB = NULL;
+                goto exit;
+            }
             cbNode->requestUri = requestUri;    // I own it now
             cbNode->devAddr = devAddr;          // I own it now
             OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
@@ -202,6 +369,7 @@ void DeleteClientCB(ClientCB * cbNode)
     if (cbNode)
     {
         LL_DELETE(cbList, cbNode);
+        RemoveFromIndexes(cbNode);
         OIC_LOG (INFO, TAG, "Deleting token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
         OIC_TRACE_BUFFER("OIC_RI_CLIENTCB:DeleteClientCB:token:",
@@ -245,33 +413,62 @@ void DeleteClientCB(ClientCB * cbNode)
     OIC_TRACE_END();
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB* cbNode)
+void UpdateClientCBTTL(ClientCB *cbNode, uint32_t ttl)
 {
     if (!cbNode)
     {
         return;
     }
-    if (cbNode->TTL == 0)
+
+    cbNode->TTL = ttl;
+    if (!ttl)
+    {
+        RemoveFromTimeoutHeap(cbNode);
+    }
+    else if (cbNode->ttlHeapIndex)
+    {
+        // The key of a node already in the heap changed; move it either way as needed.
+        size_t pos = cbNode->ttlHeapIndex - 1;
+        SiftUpTimeoutHeap(pos);
+        SiftDownTimeoutHeap(cbNode->ttlHeapIndex - 1);
+    }
+    else if (!AddToTimeoutHeap(cbNode))
+    {
+        // Without a heap slot the callback would never time out, so drop it now.
+        OIC_LOG(ERROR, TAG, "Out of memory, deleting callback without TTL slot");
+        DeleteClientCB(cbNode);
+    }
+}
+
+void DeleteTimedOutClientCBs()
+{
+    if (!g_cbTimeoutHeapCount)
     {
         return;
     }
+
     coap_tick_t now;
     coap_ticks(&now);
 
-    if (cbNode->TTL < now)
+    // The heap root holds the earliest TTL, so stop at the first live callback.
+    while (g_cbTimeoutHeapCount && g_cbTimeoutHeap[0]->TTL < now)
     {
         OIC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCB(cbNode);
+        DeleteClientCB(g_cbTimeoutHeap[0]);
     }
 }
 
+bool GetEarliestClientCBTTL(uint32_t *ttl)
+{
+    if (!ttl || !g_cbTimeoutHeapCount)
+    {
+        return false;
+    }
+
+    *ttl = g_cbTimeoutHeap[0]->TTL;
+    return true;
+}
+
 ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
                       OCDoHandle handle, const char * requestUri)
 {
@@ -281,30 +478,12 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
     {
         OIC_LOG (INFO, TAG,  "Looking for token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        LL_FOREACH(cbList, out)
-        {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if (memcmp(out->token, token, tokenLength) == 0)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        out = (ClientCB *) u_hashmap_get(g_cbTokenIndex, token, tokenLength);
     }
     else if (handle)
     {
         OIC_LOG (INFO, TAG,  "Looking for handle");
-        LL_FOREACH(cbList, out)
-        {
-            if (out->handle == handle)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        out = (ClientCB *) u_hashmap_get(g_cbHandleIndex, &handle, sizeof(handle));
     }
     else if (requestUri)
     {
@@ -315,12 +494,16 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
             //OIC_LOG_V(INFO, TAG, "%s", out->requestUri);
             if (out->requestUri && strcmp(out->requestUri, requestUri ) == 0)
             {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
+                break;
             }
-            CheckAndDeleteTimedOutCB(out);
         }
     }
+
+    if (out)
+    {
+        OIC_LOG(INFO, TAG, "Found in callback list");
+        return out;
+    }
     OIC_LOG(INFO, TAG, "Callback Not found !!");
     return NULL;
 }
@@ -357,20 +540,20 @@ void DeleteClientCBList()
         DeleteClientCB(out);
     }
     cbList = NULL;
+
+    u_hashmap_free(&g_cbTokenIndex);
+    u_hashmap_free(&g_cbHandleIndex);
+    u_hashmap_free(&g_cbNodeIndex);
+    OICFree(g_cbTimeoutHeap);
+    g_cbTimeoutHeap = NULL;
+    g_cbTimeoutHeapCount = 0;
+    g_cbTimeoutHeapCapacity = 0;
 }
 
 void FindAndDeleteClientCB(ClientCB * cbNode)
 {
-    ClientCB* tmp;
-    if (cbNode)
+    if (cbNode && u_hashmap_get(g_cbNodeIndex, &cbNode, sizeof(cbNode)))
     {
-        LL_FOREACH(cbList, tmp)
-        {
-            if (cbNode == tmp)
-            {
-                DeleteClientCB(tmp);
-                break;
-            }
-        }
+        DeleteClientCB(cbNode);
     }
 }
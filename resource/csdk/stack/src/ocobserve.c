@@ -30,6 +30,7 @@
 #include "ocpayload.h"
 #include "ocserverrequest.h"
 #include "logger.h"
+#include "uhashmap.h"
 
 #include <coap/utlist.h>
 #include <coap/pdu.h>
@@ -43,6 +44,41 @@
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
 static struct ResourceObserver * g_serverObsList = NULL;
+
+/// Indexes over g_serverObsList keyed by observation id and by token
+static u_hashmap_t *g_observerIdIndex = NULL;
+static u_hashmap_t *g_observerTokenIndex = NULL;
+
+/// Number of observers not in the token index because an earlier observer has the same token
+static size_t g_observerSharedTokenCount = 0;
+
+/**
+ * Observers of a resource that get the same representation share one encoded notification.
+ */
+typedef struct NotificationGroup
+{
+    /** Query of the observers.*/
+    const char *query;
+
+    /** Accept format of the observers.*/
+    OCPayloadFormat acceptFormat;
+
+    /** Accept version of the observers.*/
+    uint16_t acceptVersion;
+
+    /** Adapter of the observers, endpoints in the representation may depend on it.*/
+    OCTransportAdapter adapter;
+
+    /** Transport flags of the observers.*/
+    OCTransportFlags flags;
+
+    /** Notification encoded for the first observer of the group.*/
+    OCNotificationCache cache;
+
+    /** next node in this list.*/
+    struct NotificationGroup *next;
+} NotificationGroup;
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -96,6 +132,24 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
     return decidedQoS;
 }
 
+/*
+ * This function checks if the observer is past its time to live, in which case
+ * the next notification is sent as a confirmable message. A presence observer has
+ * TTL set to 0 and never times out as presence has its own mechanisms for timeouts.
+ */
+static bool IsObserverTimedOut(const ResourceObserver *observer)
+{
+    if (observer->TTL == 0)
+    {
+        return false;
+    }
+
+    coap_tick_t now = 0;
+    coap_ticks(&now);
+
+    return observer->TTL < now;
+}
+
 /**
  * Create a get request and pass to entityhandler to notify specific observer.
  *
@@ -137,6 +191,83 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
     return result;
 }
 
+static bool IsInNotificationGroup(const NotificationGroup *group,
+                                  const ResourceObserver *observer)
+{
+    if (group->acceptFormat != observer->acceptFormat
+        || group->acceptVersion != observer->acceptVersion
+        || group->adapter != observer->devAddr.adapter
+        || group->flags != observer->devAddr.flags)
+    {
+        return false;
+    }
+    if (!group->query || !observer->query)
+    {
+        return group->query == observer->query;
+    }
+    return strcmp(group->query, observer->query) == 0;
+}
+
+/**
+ * Notify an observer, reusing the notification encoded for an earlier observer of
+ * the same group when there is one. Otherwise the entity handler is invoked for this
+ * observer and its response is captured for the rest of the group.
+ *
+ * @param observer Observer that need to be notified.
+ * @param qos Quality of service of the notification.
+ * @param groups Groups of the observers notified so far.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendGroupedObserveNotification(ResourceObserver *observer,
+                                                    OCQualityOfService qos,
+                                                    NotificationGroup **groups)
+{
+    NotificationGroup *group = NULL;
+    LL_FOREACH(*groups, group)
+    {
+        if (IsInNotificationGroup(group, observer))
+        {
+            break;
+        }
+    }
+
+    if (group && group->cache.captured)
+    {
+        OCStackResult result = SendCachedNotification(&group->cache, &observer->devAddr,
+                                                      observer->token, observer->tokenLength,
+                                                      observer->resource->sequenceNum, qos,
+                                                      observer->resUri);
+        // Reset Observer TTL.
+        observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+        return result;
+    }
+    if (group)
+    {
+        // The entity handler did not respond right away, nothing to reuse.
+        return SendObserveNotification(observer, qos);
+    }
+
+    group = (NotificationGroup *) OICCalloc(1, sizeof(NotificationGroup));
+    if (!group)
+    {
+        return SendObserveNotification(observer, qos);
+    }
+    group->query = observer->query;
+    group->acceptFormat = observer->acceptFormat;
+    group->acceptVersion = observer->acceptVersion;
+    group->adapter = observer->devAddr.adapter;
+    group->flags = observer->devAddr.flags;
+    group->cache.token = observer->token;
+    group->cache.tokenLength = observer->tokenLength;
+    LL_PREPEND(*groups, group);
+
+    OCNotificationCache *previous = SetNotificationCapture(&group->cache);
+    OCStackResult result = SendObserveNotification(observer, qos);
+    SetNotificationCapture(previous);
+    return result;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -152,73 +283,85 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = g_serverObsList;
+    ResourceObserver * resourceObserver = resPtr->observersHead;
+    ResourceObserver * nextObserver = NULL;
+    NotificationGroup * groups = NULL;
+    NotificationGroup * group = NULL;
+    NotificationGroup * tmpGroup = NULL;
     uint8_t numObs = 0;
     OCServerRequest * request = NULL;
     bool observeErrorFlag = false;
 
-    // Find clients that are observing this resource
+    // Notify the clients that are observing this resource
     while (resourceObserver)
     {
-        if (resourceObserver->resource == resPtr)
-        {
-            numObs++;
+        nextObserver = resourceObserver->resourceNext;
+        numObs++;
 #ifdef WITH_PRESENCE
-            if (method != OC_REST_PRESENCE)
-            {
+        if (method != OC_REST_PRESENCE)
+        {
 #endif
-                qos = DetermineObserverQoS(method, resourceObserver, qos);
-                result = SendObserveNotification(resourceObserver, qos);
-#ifdef WITH_PRESENCE
+            OCQualityOfService observerQos = OC_HIGH_QOS;
+            if (!IsObserverTimedOut(resourceObserver))
+            {
+                observerQos = DetermineObserverQoS(method, resourceObserver, qos);
             }
-            else
+            result = SendGroupedObserveNotification(resourceObserver, observerQos, &groups);
+#ifdef WITH_PRESENCE
+        }
+        else
+        {
+            OCEntityHandlerResponse ehResponse = {0};
+
+            //This is effectively the implementation for the presence entity handler.
+            OIC_LOG(DEBUG, TAG, "This notification is for Presence");
+            result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                    0, resPtr->sequenceNum, qos, resourceObserver->query,
+                    NULL, OC_FORMAT_UNDEFINED, NULL,
+                    resourceObserver->token, resourceObserver->tokenLength,
+                    resourceObserver->resUri, 0, resourceObserver->acceptFormat,
+                    resourceObserver->acceptVersion, &resourceObserver->devAddr);
+
+            if (result == OC_STACK_OK)
             {
-                OCEntityHandlerResponse ehResponse = {0};
+                OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
+                        resPtr->sequenceNum, maxAge, trigger,
+                        resourceType ? resourceType->resourcetypename : NULL);
 
-                //This is effectively the implementation for the presence entity handler.
-                OIC_LOG(DEBUG, TAG, "This notification is for Presence");
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, OC_FORMAT_UNDEFINED, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        resourceObserver->acceptVersion, &resourceObserver->devAddr);
+                if (!presenceResBuf)
+                {
+                    return OC_STACK_NO_MEMORY;
+                }
 
                 if (result == OC_STACK_OK)
                 {
-                    OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
-                            resPtr->sequenceNum, maxAge, trigger,
-                            resourceType ? resourceType->resourcetypename : NULL);
-
-                    if (!presenceResBuf)
-                    {
-                        return OC_STACK_NO_MEMORY;
-                    }
-
-                    if (result == OC_STACK_OK)
-                    {
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)presenceResBuf;
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        ehResponse.resourceHandle = (OCResourceHandle) resPtr;
-                        OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
-                                resourceObserver->resUri);
-                        result = OCDoResponse(&ehResponse);
-                    }
-
-                    OCPresencePayloadDestroy(presenceResBuf);
+                    ehResponse.ehResult = OC_EH_OK;
+                    ehResponse.payload = (OCPayload*)presenceResBuf;
+                    ehResponse.persistentBufferFlag = 0;
+                    ehResponse.requestHandle = (OCRequestHandle) request;
+                    ehResponse.resourceHandle = (OCResourceHandle) resPtr;
+                    OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
+                            resourceObserver->resUri);
+                    result = OCDoResponse(&ehResponse);
                 }
+
+                OCPresencePayloadDestroy(presenceResBuf);
             }
+        }
 #endif
 
-            // Since we are in a loop, set an error flag to indicate at least one error occurred.
-            if (result != OC_STACK_OK)
-            {
-                observeErrorFlag = true;
-            }
+        // Since we are in a loop, set an error flag to indicate at least one error occurred.
+        if (result != OC_STACK_OK)
+        {
+            observeErrorFlag = true;
         }
-        resourceObserver = resourceObserver->next;
+        resourceObserver = nextObserver;
+    }
+
+    LL_FOREACH_SAFE(groups, group, tmpGroup)
+    {
+        ClearNotificationCache(&group->cache);
+        OICFree(group);
     }
 
     if (numObs == 0)
@@ -338,6 +481,112 @@ OCStackResult SendListObserverNotification (OCResource * resource,
     }
 }
 
+/**
+ * Add an observer to the id and token indexes. An observer whose token is already
+ * indexed for another observer is only counted, and indexed once the other goes away.
+ *
+ * @param obsNode Observer to index.
+ *
+ * @return true on success, false if out of memory.
+ */
+static bool AddObserverToIndexes(ResourceObserver *obsNode)
+{
+    if (!g_observerIdIndex)
+    {
+        g_observerIdIndex = u_hashmap_create(0);
+    }
+    if (!g_observerTokenIndex)
+    {
+        g_observerTokenIndex = u_hashmap_create(0);
+    }
+    if (!g_observerIdIndex || !g_observerTokenIndex)
+    {
+        return false;
+    }
+
+    // Presence observers all use observation id 0, which is never looked up.
+    if (obsNode->observeId
+        && !u_hashmap_put(g_observerIdIndex, &obsNode->observeId,
+                          sizeof(obsNode->observeId), obsNode))
+    {
+        return false;
+    }
+
+    if (u_hashmap_get(g_observerTokenIndex, obsNode->token, obsNode->tokenLength))
+    {
+        g_observerSharedTokenCount++;
+    }
+    else if (!u_hashmap_put(g_observerTokenIndex, obsNode->token, obsNode->tokenLength, obsNode))
+    {
+        if (obsNode->observeId)
+        {
+            u_hashmap_remove(g_observerIdIndex, &obsNode->observeId, sizeof(obsNode->observeId));
+        }
+        return false;
+    }
+    return true;
+}
+
+static void RemoveObserverFromIndexes(ResourceObserver *obsNode)
+{
+    if (obsNode->observeId
+        && u_hashmap_get(g_observerIdIndex, &obsNode->observeId,
+                         sizeof(obsNode->observeId)) == obsNode)
+    {
+        u_hashmap_remove(g_observerIdIndex, &obsNode->observeId, sizeof(obsNode->observeId));
+    }
+
+    if (u_hashmap_get(g_observerTokenIndex, obsNode->token, obsNode->tokenLength) != obsNode)
+    {
+        g_observerSharedTokenCount--;
+        return;
+    }
+
+    u_hashmap_remove(g_observerTokenIndex, obsNode->token, obsNode->tokenLength);
+    if (g_observerSharedTokenCount)
+    {
+        // Index the next observer with the same token, if there is one.
+        ResourceObserver *out = NULL;
+        LL_FOREACH (g_serverObsList, out)
+        {
+            if (out != obsNode && out->tokenLength == obsNode->tokenLength
+                && memcmp(out->token, obsNode->token, obsNode->tokenLength) == 0
+                && u_hashmap_put(g_observerTokenIndex, out->token, out->tokenLength, out))
+            {
+                g_observerSharedTokenCount--;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Remove an observer from the observe list, the indexes and the observers of its
+ * resource, and free it.
+ *
+ * @param obsNode Observer to delete.
+ */
+static void DeleteObserver(ResourceObserver *obsNode)
+{
+    RemoveObserverFromIndexes(obsNode);
+    DL_DELETE (g_serverObsList, obsNode);
+
+    ResourceObserver **link = &obsNode->resource->observersHead;
+    while (*link && *link != obsNode)
+    {
+        link = &(*link)->resourceNext;
+    }
+    if (*link)
+    {
+        *link = obsNode->resourceNext;
+    }
+
+    OICFree(obsNode->resUri);
+    OICFree(obsNode->query);
+    OICFree(obsNode->token);
+    OICFree(obsNode);
+}
+
 OCStackResult GenerateObserverId (OCObservationId *observationId)
 {
     ResourceObserver *resObs = NULL;
@@ -428,7 +677,14 @@ OCStackResult AddObserver (const char         *resUri,
             obsNode->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
         }
 
-        LL_APPEND (g_serverObsList, obsNode);
+        if (!AddObserverToIndexes(obsNode))
+        {
+            goto exit;
+        }
+
+        DL_APPEND (g_serverObsList, obsNode);
+        obsNode->resourceNext = resHandle->observersHead;
+        resHandle->observersHead = obsNode;
 
         return OC_STACK_OK;
     }
@@ -438,49 +694,23 @@ exit:
     {
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
+        OICFree(obsNode->token);
         OICFree(obsNode);
     }
     return OC_STACK_NO_MEMORY;
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence callback
- * with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckTimedOutObserver(ResourceObserver* observer)
-{
-    if (!observer || observer->TTL == 0)
-    {
-        return;
-    }
-
-    coap_tick_t now = 0;
-    coap_ticks(&now);
-
-    if (observer->TTL < now)
-    {
-        // Send confirmable notification message to observer.
-        OIC_LOG(INFO, TAG, "Sending High-QoS notification to observer");
-        SendObserveNotification(observer, OC_HIGH_QOS);
-    }
-}
-
 ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 {
     ResourceObserver *out = NULL;
 
     if (observeId)
     {
-        LL_FOREACH (g_serverObsList, out)
+        out = (ResourceObserver *) u_hashmap_get(g_observerIdIndex, &observeId,
+                                                 sizeof(observeId));
+        if (out)
         {
-            if (out->observeId == observeId)
-            {
-                return out;
-            }
-            CheckTimedOutObserver(out);
+            return out;
         }
     }
     OIC_LOG(INFO, TAG, "Observer node not found!!");
@@ -494,17 +724,12 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
         OIC_LOG(INFO, TAG, "Looking for token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
 
-        ResourceObserver *out = NULL;
-        LL_FOREACH (g_serverObsList, out)
+        ResourceObserver *out = (ResourceObserver *) u_hashmap_get(g_observerTokenIndex,
+                                                                   token, tokenLength);
+        if (out)
         {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if ((memcmp(out->token, token, tokenLength) == 0))
-            {
-                OIC_LOG(INFO, TAG, "Found in observer list");
-                return out;
-            }
-            CheckTimedOutObserver(out);
+            OIC_LOG(INFO, TAG, "Found in observer list");
+            return out;
         }
     }
     else
@@ -528,11 +753,7 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
     {
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
-        LL_DELETE (g_serverObsList, obsNode);
-        OICFree(obsNode->resUri);
-        OICFree(obsNode->query);
-        OICFree(obsNode->token);
-        OICFree(obsNode);
+        DeleteObserver(obsNode);
     }
     // it is ok if we did not find the observer...
     return OC_STACK_OK;
@@ -572,10 +793,27 @@ void DeleteObserverList()
     {
         if (out)
         {
-            DeleteObserverUsingToken ((out->token), out->tokenLength);
+            DeleteObserver(out);
         }
     }
     g_serverObsList = NULL;
+
+    u_hashmap_free(&g_observerIdIndex);
+    u_hashmap_free(&g_observerTokenIndex);
+    g_observerSharedTokenCount = 0;
+}
+
+void DeleteResourceObservers(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    while (resource->observersHead)
+    {
+        DeleteObserver(resource->observersHead);
+    }
 }
 
 /*
@@ -34,12 +34,227 @@
 #include "logger.h"
 #include "ocendpoint.h"
 #include "cacommon.h"
+#include "uhashmap.h"
+#include "ocatomic.h"
+#include "ocpayloadarena.h"
 
 #define TAG "OIC_RI_PAYLOAD"
 #define CSV_SEPARATOR ','
 #define MASK_SECURE_FAMS (OC_FLAG_SECURE | OC_MASK_FAMS)
 
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
+/**
+ * Number of values a payload may have before its values are indexed by name.
+ * Walking a short list is cheaper than hashing.
+ */
+#define REP_PAYLOAD_INDEX_THRESHOLD (8)
+
+/**
+ * Alignment of arena allocations; enough for int64_t, double and pointers.
+ */
+#define PAYLOAD_ARENA_ALIGNMENT (8)
+
+/**
+ * Smallest chunk an arena allocates. Each further chunk is at least twice the
+ * size of the previous one, so a tree takes a logarithmic number of chunks.
+ */
+#define PAYLOAD_ARENA_MIN_CHUNK_SIZE (512)
+
+#define PAYLOAD_ARENA_ALIGN(size) \
+    (((size) + PAYLOAD_ARENA_ALIGNMENT - 1) & ~((size_t)PAYLOAD_ARENA_ALIGNMENT - 1))
+
+/**
+ * Name index of the values list of an OCRepPayload. The list stays the source
+ * of truth: the index is rebuilt when the head of the list changes, and values
+ * appended behind the last indexed one are picked up on the next update.
+ */
+typedef struct OCRepPayloadIndex
+{
+    u_hashmap_t *names;
+    OCRepPayloadValue *head;
+    OCRepPayloadValue *tail;
+} OCRepPayloadIndex;
+
+/**
+ * What OCRepPayloadCreate() allocates: the public payload followed by the state
+ * the OCRepPayload functions keep for it, so that the public layout stays as is.
+ */
+typedef struct
+{
+    OCRepPayload payload;
+    OCRepPayloadIndex *index;
+    OCPayloadArena *arena;
+} OCRepPayloadInternal;
+
+#define REP_PAYLOAD_INTERNAL(payload) ((OCRepPayloadInternal*)(payload))
+
+typedef struct OCPayloadArenaChunk
+{
+    struct OCPayloadArenaChunk *next;
+    size_t size;
+    size_t used;
+} OCPayloadArenaChunk;
+
+/**
+ * Chunks are kept newest first; allocations are only carved from the newest.
+ * Once sealed, the chunks no longer change and allocations go to the heap.
+ */
+struct OCPayloadArena
+{
+    OCPayloadArenaChunk *chunks;
+    volatile int32_t refCount;
+    bool sealed;
+};
+
+#define PAYLOAD_ARENA_CHUNK_HEADER_SIZE PAYLOAD_ARENA_ALIGN(sizeof(OCPayloadArenaChunk))
+
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val);
+
+static bool OCPayloadArenaAddChunk(OCPayloadArena* arena, size_t minSize)
+{
+    size_t size = PAYLOAD_ARENA_MIN_CHUNK_SIZE;
+    if (arena->chunks && size < 2 * arena->chunks->size)
+    {
+        size = 2 * arena->chunks->size;
+    }
+    if (size < minSize)
+    {
+        size = minSize;
+    }
+
+    OCPayloadArenaChunk* chunk =
+        (OCPayloadArenaChunk*)OICCalloc(1, PAYLOAD_ARENA_CHUNK_HEADER_SIZE + size);
+    if (!chunk)
+    {
+        return false;
+    }
+    chunk->size = size;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    return true;
+}
+
+OCPayloadArena* OCPayloadArenaCreate(size_t sizeHint)
+{
+    OCPayloadArena* arena = (OCPayloadArena*)OICCalloc(1, sizeof(OCPayloadArena));
+    if (!arena)
+    {
+        return NULL;
+    }
+    if (!OCPayloadArenaAddChunk(arena, PAYLOAD_ARENA_ALIGN(sizeHint)))
+    {
+        OICFree(arena);
+        return NULL;
+    }
+    arena->refCount = 1;
+    return arena;
+}
+
+OCPayloadArena* OCPayloadArenaRetain(OCPayloadArena* arena)
+{
+    if (arena)
+    {
+        oc_atomic_increment(&arena->refCount);
+    }
+    return arena;
+}
+
+void OCPayloadArenaRelease(OCPayloadArena* arena)
+{
+    if (!arena || 0 != oc_atomic_decrement(&arena->refCount))
+    {
+        return;
+    }
+
+    OCPayloadArenaChunk* chunk = arena->chunks;
+    while (chunk)
+    {
+        OCPayloadArenaChunk* next = chunk->next;
+        OICFree(chunk);
+        chunk = next;
+    }
+    OICFree(arena);
+}
+
+void OCPayloadArenaSeal(OCPayloadArena* arena)
+{
+    if (arena)
+    {
+        arena->sealed = true;
+    }
+}
+
+void* OCPayloadArenaAlloc(OCPayloadArena* arena, size_t size)
+{
+    if (!arena || arena->sealed)
+    {
+        return OICCalloc(1, size);
+    }
+
+    // Empty allocations still take space, so that their address is inside a chunk.
+    size = PAYLOAD_ARENA_ALIGN(size ? size : 1);
+    OCPayloadArenaChunk* chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        if (!OCPayloadArenaAddChunk(arena, size))
+        {
+            return NULL;
+        }
+        chunk = arena->chunks;
+    }
+
+    // Chunks are zeroed when allocated and their memory is never reused.
+    void* ptr = (uint8_t*)chunk + PAYLOAD_ARENA_CHUNK_HEADER_SIZE + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+char* OCPayloadArenaStrndup(OCPayloadArena* arena, const char* str, size_t length)
+{
+    char* dup = (char*)OCPayloadArenaAlloc(arena, length + 1);
+    if (dup)
+    {
+        memcpy(dup, str, length);
+        dup[length] = '\0';
+    }
+    return dup;
+}
+
+bool OCPayloadArenaContains(const OCPayloadArena* arena, const void* ptr)
+{
+    if (!arena || !ptr)
+    {
+        return false;
+    }
+
+    const uint8_t* p = (const uint8_t*)ptr;
+    for (const OCPayloadArenaChunk* chunk = arena->chunks; chunk; chunk = chunk->next)
+    {
+        const uint8_t* data = (const uint8_t*)chunk + PAYLOAD_ARENA_CHUNK_HEADER_SIZE;
+        if (p >= data && p < data + chunk->size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OCPayloadArenaFree(const OCPayloadArena* arena, void* ptr)
+{
+    if (!OCPayloadArenaContains(arena, ptr))
+    {
+        OICFree(ptr);
+    }
+}
+
+size_t OCPayloadArenaGetChunkCount(const OCPayloadArena* arena)
+{
+    size_t count = 0;
+    for (const OCPayloadArenaChunk* chunk = arena ? arena->chunks : NULL; chunk; chunk = chunk->next)
+    {
+        ++count;
+    }
+    return count;
+}
 
 void OCPayloadDestroy(OCPayload* payload)
 {
@@ -77,7 +292,7 @@ void OCPayloadDestroy(OCPayload* payload)
 
 OCRepPayload* OCRepPayloadCreate()
 {
-    OCRepPayload* payload = (OCRepPayload*)OICCalloc(1, sizeof(OCRepPayload));
+    OCRepPayload* payload = (OCRepPayload*)OICCalloc(1, sizeof(OCRepPayloadInternal));
 
     if (!payload)
     {
@@ -89,6 +304,44 @@ OCRepPayload* OCRepPayloadCreate()
     return payload;
 }
 
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena)
+{
+    if (!arena)
+    {
+        return OCRepPayloadCreate();
+    }
+
+    OCRepPayload* payload = (OCRepPayload*)OCPayloadArenaAlloc(arena,
+                                                                sizeof(OCRepPayloadInternal));
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    payload->base.type = PAYLOAD_TYPE_REPRESENTATION;
+    REP_PAYLOAD_INTERNAL(payload)->arena = OCPayloadArenaRetain(arena);
+
+    return payload;
+}
+
+OCRepPayload* OCRepPayloadCreateWithArena(size_t sizeHint)
+{
+    OCPayloadArena* arena = OCPayloadArenaCreate(sizeHint);
+    if (!arena)
+    {
+        return NULL;
+    }
+
+    OCRepPayload* payload = OCRepPayloadCreateInArena(arena);
+    OCPayloadArenaRelease(arena);
+    return payload;
+}
+
+OCPayloadArena* OCRepPayloadGetArena(const OCRepPayload* payload)
+{
+    return payload ? REP_PAYLOAD_INTERNAL(payload)->arena : NULL;
+}
+
 void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
 {
     if (!parent)
@@ -105,6 +358,78 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     child->next = NULL;
 }
 
+static void OCRepPayloadFreeIndex(OCRepPayload* payload)
+{
+    OCRepPayloadInternal* internal = REP_PAYLOAD_INTERNAL(payload);
+    if (internal->index)
+    {
+        u_hashmap_free(&internal->index->names);
+        OICFree(internal->index);
+        internal->index = NULL;
+    }
+}
+
+/**
+ * Brings the index of the payload up to date with its values list. Drops the
+ * index if that fails; lookups then walk the list.
+ *
+ * @return the index or NULL if the payload is not indexed.
+ */
+static OCRepPayloadIndex* OCRepPayloadUpdateIndex(OCRepPayload* payload)
+{
+    OCRepPayloadIndex* index = REP_PAYLOAD_INTERNAL(payload)->index;
+    if (!index)
+    {
+        return NULL;
+    }
+
+    if (index->head != payload->values)
+    {
+        u_hashmap_free(&index->names);
+        index->names = u_hashmap_create(0);
+        index->head = payload->values;
+        index->tail = NULL;
+        if (!index->names)
+        {
+            OCRepPayloadFreeIndex(payload);
+            return NULL;
+        }
+    }
+
+    OCRepPayloadValue* val = index->tail ? index->tail->next : payload->values;
+    for (; val; val = val->next)
+    {
+        size_t nameLength = strlen(val->name);
+        // The first value of a name wins, as when walking the list.
+        if (!u_hashmap_get(index->names, val->name, nameLength) &&
+            !u_hashmap_put(index->names, val->name, nameLength, val))
+        {
+            OCRepPayloadFreeIndex(payload);
+            return NULL;
+        }
+        index->tail = val;
+    }
+    return index;
+}
+
+static OCRepPayloadIndex* OCRepPayloadCreateIndex(OCRepPayload* payload)
+{
+    OCRepPayloadInternal* internal = REP_PAYLOAD_INTERNAL(payload);
+    internal->index = (OCRepPayloadIndex*)OICCalloc(1, sizeof(OCRepPayloadIndex));
+    if (!internal->index)
+    {
+        return NULL;
+    }
+    internal->index->names = u_hashmap_create(0);
+    if (!internal->index->names)
+    {
+        OCRepPayloadFreeIndex(payload);
+        return NULL;
+    }
+    internal->index->head = payload->values;
+    return OCRepPayloadUpdateIndex(payload);
+}
+
 static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
 {
     if (!payload || !name)
@@ -112,6 +437,14 @@ static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, con
         return NULL;
     }
 
+    // Getters only read the index, so that a payload can be read from several
+    // threads. It is only used when no value was added behind its back.
+    const OCRepPayloadIndex* index = REP_PAYLOAD_INTERNAL(payload)->index;
+    if (index && index->head == payload->values && (!index->tail || !index->tail->next))
+    {
+        return (OCRepPayloadValue*)u_hashmap_get(index->names, name, strlen(name));
+    }
+
     OCRepPayloadValue* val = payload->values;
     while(val)
     {
@@ -224,7 +557,7 @@ exit:
     return;
 }
 
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
     if (!val)
     {
@@ -233,11 +566,11 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
 
     if (val->type == OCREP_PROP_STRING)
     {
-        OICFree(val->str);
+        OCPayloadArenaFree(arena, val->str);
     }
     else if (val->type == OCREP_PROP_BYTE_STRING)
     {
-        OICFree(val->ocByteStr.bytes);
+        OCPayloadArenaFree(arena, val->ocByteStr.bytes);
     }
     else if (val->type == OCREP_PROP_OBJECT)
     {
@@ -288,17 +621,17 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
     }
 }
 
-static void OCFreeRepPayloadValue(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValue(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
     if (!val)
     {
         return;
     }
 
-    OICFree(val->name);
-    OCFreeRepPayloadValueContents(val);
-    OCFreeRepPayloadValue(val->next);
-    OICFree(val);
+    OCPayloadArenaFree(arena, val->name);
+    OCFreeRepPayloadValueContents(arena, val);
+    OCFreeRepPayloadValue(arena, val->next);
+    OCPayloadArenaFree(arena, val);
 }
 static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
 {
@@ -328,7 +661,7 @@ static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
         destIter->next = (OCRepPayloadValue*) OICCalloc(1, sizeof(OCRepPayloadValue));
         if (!destIter->next)
         {
-            OCFreeRepPayloadValue (headOfClone);
+            OCFreeRepPayloadValue (NULL, headOfClone);
             return NULL;
         }
 
@@ -350,56 +683,65 @@ static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, con
         return NULL;
     }
 
-    OCRepPayloadValue* val = payload->values;
-    if (val == NULL)
+    OCPayloadArena* arena = OCRepPayloadGetArena(payload);
+    OCRepPayloadValue* val = NULL;
+    OCRepPayloadValue* last = NULL;
+    OCRepPayloadIndex* index = OCRepPayloadUpdateIndex(payload);
+    if (index)
     {
-        payload->values = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-        if (!payload->values)
+        val = (OCRepPayloadValue*)u_hashmap_get(index->names, name, strlen(name));
+        last = index->tail;
+    }
+    else
+    {
+        size_t count = 0;
+        for (val = payload->values; val; val = val->next)
         {
-            return NULL;
+            if (0 == strcmp(val->name, name))
+            {
+                break;
+            }
+            last = val;
+            count++;
         }
-        payload->values->name = OICStrdup(name);
-        if (!payload->values->name)
+        if (!val && count >= REP_PAYLOAD_INDEX_THRESHOLD)
         {
-            OICFree(payload->values);
-            payload->values = NULL;
-            return NULL;
+            OCRepPayloadCreateIndex(payload);
         }
-        payload->values->type =type;
-        return payload->values;
     }
 
-    while(val)
+    if (val)
     {
-        if (0 == strcmp(val->name, name))
-        {
-            OCFreeRepPayloadValueContents(val);
-            val->type = type;
-            return val;
-        }
-        else if (val->next == NULL)
-        {
-            val->next = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-            if (!val->next)
-            {
-                return NULL;
-            }
-            val->next->name = OICStrdup(name);
-            if (!val->next->name)
-            {
-                OICFree(val->next);
-                val->next = NULL;
-                return NULL;
-            }
-            val->next->type =type;
-            return val->next;
-        }
+        OCFreeRepPayloadValueContents(arena, val);
+        val->type = type;
+        return val;
+    }
 
-        val = val->next;
+    val = (OCRepPayloadValue*)OCPayloadArenaAlloc(arena, sizeof(OCRepPayloadValue));
+    if (!val)
+    {
+        return NULL;
     }
+    // Names already in the arena are never freed on their own and can be shared.
+    val->name = OCPayloadArenaContains(arena, name) ? (char*)name :
+        OCPayloadArenaStrndup(arena, name, strlen(name));
+    if (!val->name)
+    {
+        OCPayloadArenaFree(arena, val);
+        return NULL;
+    }
+    val->type = type;
 
-    OIC_LOG(ERROR, TAG, "FindAndSetValue reached point after while loop, pointer corruption?");
-    return NULL;
+    if (last)
+    {
+        last->next = val;
+    }
+    else
+    {
+        payload->values = val;
+    }
+    OCRepPayloadUpdateIndex(payload);
+    return val;
 }
 
 bool OCRepPayloadAddResourceType(OCRepPayload* payload, const char* resourceType)
@@ -549,6 +891,51 @@ bool OCRepPayloadSetNull(OCRepPayload* payload, const char* name)
     return OCRepPayloadSetProp(payload, name, NULL, OCREP_PROP_NULL);
 }
 
+bool OCRepPayloadRemoveProp(OCRepPayload* payload, const char* name)
+{
+    if (!payload || !name)
+    {
+        return false;
+    }
+
+    // Bring the index up to date first, so that it only has to drop the value.
+    OCRepPayloadIndex* index = OCRepPayloadUpdateIndex(payload);
+
+    OCRepPayloadValue* prev = NULL;
+    OCRepPayloadValue* val = payload->values;
+    while (val && 0 != strcmp(val->name, name))
+    {
+        prev = val;
+        val = val->next;
+    }
+    if (!val)
+    {
+        return false;
+    }
+
+    if (prev)
+    {
+        prev->next = val->next;
+    }
+    else
+    {
+        payload->values = val->next;
+    }
+    val->next = NULL;
+
+    if (index)
+    {
+        u_hashmap_remove(index->names, val->name, strlen(val->name));
+        index->head = payload->values;
+        if (index->tail == val)
+        {
+            index->tail = prev;
+        }
+    }
+    OCFreeRepPayloadValue(OCRepPayloadGetArena(payload), val);
+    return true;
+}
+
 bool OCRepPayloadSetPropInt(OCRepPayload* payload,
         const char* name, int64_t value)
 {
@@ -603,12 +990,13 @@ bool OCRepPayloadGetPropDouble(const OCRepPayload* payload, const char* name, do
 
 bool OCRepPayloadSetPropString(OCRepPayload* payload, const char* name, const char* value)
 {
-    char* temp = OICStrdup(value);
+    OCPayloadArena* arena = OCRepPayloadGetArena(payload);
+    char* temp = value ? OCPayloadArenaStrndup(arena, value, strlen(value)) : NULL;
     bool b = OCRepPayloadSetPropStringAsOwner(payload, name, temp);
 
     if (!b)
     {
-        OICFree(temp);
+        OCPayloadArenaFree(arena, temp);
     }
     return b;
 }
@@ -1635,12 +2023,15 @@ void OCRepPayloadDestroy(OCRepPayload* payload)
         return;
     }
 
+    OCPayloadArena* arena = OCRepPayloadGetArena(payload);
     OICFree(payload->uri);
     OCFreeOCStringLL(payload->types);
     OCFreeOCStringLL(payload->interfaces);
-    OCFreeRepPayloadValue(payload->values);
+    OCFreeRepPayloadValue(arena, payload->values);
+    OCRepPayloadFreeIndex(payload);
     OCRepPayloadDestroy(payload->next);
-    OICFree(payload);
+    OCPayloadArenaFree(arena, payload);
+    OCPayloadArenaRelease(arena);
 }
 
 OCDiscoveryPayload* OCDiscoveryPayloadCreate()
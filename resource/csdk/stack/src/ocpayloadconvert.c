@@ -36,7 +36,8 @@
 
 #define TAG "OIC_RI_PAYLOADCONVERT"
 
-// Arbitrarily chosen size that seems to contain the majority of packages
+// Arbitrarily chosen size that seems to contain the majority of packages.
+// Smaller payloads are encoded in one pass, larger ones in exactly two.
 #define INIT_SIZE (255)
 
 // Discovery Links Map Length.
@@ -91,26 +92,19 @@ OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
     if (PAYLOAD_TYPE_SECURITY == payload->type)
     {
-        size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
-        if (securityPayloadSize > 0)
-        {
-            curSize = securityPayloadSize;
-        }
+        curSize = ((OCSecurityPayload *)payload)->payloadSize;
     }
-    if (PAYLOAD_TYPE_INTROSPECTION == payload->type)
+    else if (PAYLOAD_TYPE_INTROSPECTION == payload->type)
     {
-        size_t introspectionPayloadSize = ((OCIntrospectionPayload *)payload)->cborPayload.len;
-        if (introspectionPayloadSize > 0)
-        {
-            curSize = introspectionPayloadSize;
-        }
+        curSize = ((OCIntrospectionPayload *)payload)->cborPayload.len;
     }
 
     ret = OC_STACK_NO_MEMORY;
 
     for (;;)
     {
-        out = (uint8_t *)OICCalloc(1, curSize);
+        // Keep a valid buffer for empty payloads.
+        out = (uint8_t *)OICMalloc(curSize ? curSize : 1);
         VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
         err = OCConvertPayloadHelper(payload, format, out, &curSize);
 
@@ -119,6 +113,9 @@ OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
             break;
         }
 
+        // TinyCBOR keeps counting once the buffer is full, so curSize is now the
+        // exact size and the second pass fits.
+        OIC_LOG_V(DEBUG, TAG, "Payload needs %zu bytes, encoding again", curSize);
         OICFree(out);
     }
 
@@ -128,8 +125,8 @@ OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
             (PAYLOAD_TYPE_SECURITY != payload->type) &&
             (PAYLOAD_TYPE_INTROSPECTION != payload->type))
         {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
+            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize ? curSize : 1);
+            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to shrink payload");
             out = out2;
         }
 
@@ -955,7 +952,8 @@ static int64_t OCConvertRepPayload(OCRepPayload *payload, uint8_t *outPayload, s
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed adding rep root map");
     }
 
-    while (payload != NULL && (err == CborNoError))
+    // Carry on when out of memory so that the size of every map is counted.
+    while (payload != NULL)
     {
         CborEncoder rootMap;
         err |= cbor_encoder_create_map(((arrayCount == 1)? &encoder: &rootArray),
@@ -33,6 +33,7 @@
 #include "oic_string.h"
 #include "oic_malloc.h"
 #include "ocpayloadcbor.h"
+#include "ocpayloadarena.h"
 #include "ocstackinternal.h"
 #include "payload_logging.h"
 #include "platform_features.h"
@@ -45,10 +46,20 @@
  */
 #define UINT64_MAX_STRLEN 20
 
+/*
+ * Size of the first arena chunk of a representation tree relative to the
+ * size of its CBOR encoding. The tree takes more room than its encoding.
+ */
+#define REP_PARSE_ARENA_SIZE_FACTOR 4
+
+static bool g_parseUseArena = true;
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, OCPayloadFormat format,
         CborValue *arrayVal);
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot);
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal);
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot,
+        OCPayloadArena *arena);
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal,
+        OCPayloadArena *arena);
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseDiagnosticPayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload **outPayload, const uint8_t *payload, size_t size);
@@ -58,6 +69,7 @@ OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadFormat payloadForm
 {
     OCStackResult result = OC_STACK_MALFORMED_RESPONSE;
     CborError err;
+    OCPayloadArena *arena = NULL;
 
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "Conversion of outPayload failed");
     VERIFY_PARAM_NON_NULL(TAG, payload, "Invalid cbor payload value");
@@ -77,7 +89,17 @@ OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadFormat payloadForm
             result = OCParseDiscoveryPayload(outPayload, payloadFormat, &rootValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &rootValue);
+            if (g_parseUseArena)
+            {
+                // Falls back to the heap if the arena can't be created.
+                arena = OCPayloadArenaCreate(REP_PARSE_ARENA_SIZE_FACTOR * payloadSize);
+            }
+            result = OCParseRepPayload(outPayload, &rootValue, arena);
+            // The payloads of the tree hold their own references. Later
+            // changes to the tree go to the heap, so that its payloads can
+            // be used apart from each other like heap payloads.
+            OCPayloadArenaSeal(arena);
+            OCPayloadArenaRelease(arena);
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &rootValue);
@@ -100,6 +122,11 @@ exit:
     return result;
 }
 
+void OCParsePayloadUseArena(bool useArena)
+{
+    g_parseUseArena = useArena;
+}
+
 static OCStackResult OCParseSecurityPayload(OCPayload** outPayload, const uint8_t *payload,
         size_t size)
 {
@@ -816,8 +843,53 @@ static size_t arrayStep(size_t dimensions[MAX_REP_ARRAY_DEPTH], size_t elementNu
         elementNum;
 }
 
+static CborError OCParseDupTextString(OCPayloadArena *arena, const CborValue *value,
+        char **str, size_t *len)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_text_string(value, str, len, NULL);
+    }
+
+    CborError err = cbor_value_calculate_string_length(value, len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    size_t size = *len + 1;
+    *str = (char *)OCPayloadArenaAlloc(arena, size);
+    if (!*str)
+    {
+        return CborErrorOutOfMemory;
+    }
+    return cbor_value_copy_text_string(value, *str, &size, NULL);
+}
+
+static CborError OCParseDupByteString(OCPayloadArena *arena, const CborValue *value,
+        uint8_t **bytes, size_t *len)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_byte_string(value, bytes, len, NULL);
+    }
+
+    CborError err = cbor_value_calculate_string_length(value, len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    size_t size = *len + 1;
+    *bytes = (uint8_t *)OCPayloadArenaAlloc(arena, size);
+    if (!*bytes)
+    {
+        return CborErrorOutOfMemory;
+    }
+    return cbor_value_copy_byte_string(value, *bytes, &size, NULL);
+}
+
 static CborError OCParseArrayFillArray(const CborValue *parent,
-        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray)
+        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray,
+        OCPayloadArena *arena)
 {
     CborValue insideArray;
 
@@ -850,7 +922,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_DOUBLE:
@@ -873,7 +945,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((double*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((double*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BOOL:
@@ -884,7 +956,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((bool*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((bool*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_STRING:
@@ -897,7 +969,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((char**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((char**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BYTE_STRING:
@@ -910,13 +982,13 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]));
+                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_OBJECT:
                     if (dimensions[1] == 0)
                     {
-                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false);
+                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false, arena);
                         ((OCRepPayload**)targetArray)[i] = tempPl;
                         tempPl = NULL;
                         noAdvance = true;
@@ -924,7 +996,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 default:
@@ -972,7 +1044,7 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
     arr = OICCalloc(dimTotal, allocSize);
     VERIFY_PARAM_NON_NULL(TAG, arr, "Array Parse allocation failed");
 
-    res = OCParseArrayFillArray(container, dimensions, type, arr);
+    res = OCParseArrayFillArray(container, dimensions, type, arr, OCRepPayloadGetArena(out));
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed parse array");
 
     switch (type)
@@ -1028,7 +1100,8 @@ exit:
     return err;
 }
 
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot)
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot,
+        OCPayloadArena *arena)
 {
     CborError err = CborUnknownError;
     char *name = NULL;
@@ -1040,7 +1113,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     {
         if (!*outPayload)
         {
-            *outPayload = OCRepPayloadCreate();
+            *outPayload = OCRepPayloadCreateInArena(arena);
             if (!*outPayload)
             {
                 return CborErrorOutOfMemory;
@@ -1059,7 +1132,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
         {
             if (cbor_value_is_map(objMap) && cbor_value_is_text_string(&repMap))
             {
-                err = cbor_value_dup_text_string(&repMap, &name, &len, NULL);
+                err = OCParseDupTextString(arena, &repMap, &name, &len);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing rootMap");
@@ -1070,14 +1143,14 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                     (0 == strcmp(OC_RSRVD_INTERFACE, name))))
                 {
                     err = cbor_value_advance(&repMap);
-                    free(name);  // Free *TinyCBOR allocated* string.
+                    OCPayloadArenaFree(arena, name);
                     name = NULL;
                     continue;
                 }
             }
             else if (cbor_value_is_array(objMap))
             {
-                name = (char*)OICCalloc(UINT64_MAX_STRLEN + 1, sizeof(char));
+                name = (char*)OCPayloadArenaAlloc(arena, UINT64_MAX_STRLEN + 1);
                 VERIFY_PARAM_NON_NULL(TAG, name, "Failed allocating tag name in the map");
 #ifdef PRIu64
                 snprintf(name, UINT64_MAX_STRLEN + 1, "%" PRIu64, arrayIndex);
@@ -1094,7 +1167,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 else
                 {
                     err = CborErrorDataTooLarge;
-                    OICFree(name);
+                    OCPayloadArenaFree(arena, name);
                     continue;
                 }
 #endif
@@ -1132,7 +1205,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 case CborTextStringType:
                     {
                         char *strval = NULL;
-                        err = cbor_value_dup_text_string(&repMap, &strval, &len, NULL);
+                        err = OCParseDupTextString(arena, &repMap, &strval, &len);
                         VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
                         res = OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
                     }
@@ -1140,7 +1213,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 case CborByteStringType:
                     {
                         uint8_t* bytestrval = NULL;
-                        err = cbor_value_dup_byte_string(&repMap, &bytestrval, &len, NULL);
+                        err = OCParseDupByteString(arena, &repMap, &bytestrval, &len);
                         VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
                         OCByteString tmp = {.bytes = bytestrval, .len = len};
                         res = OCRepPayloadSetPropByteStringAsOwner(curPayload, name, &tmp);
@@ -1149,7 +1222,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 case CborMapType:
                     {
                         OCRepPayload *pl = NULL;
-                        err = OCParseSingleRepPayload(&pl, &repMap, false);
+                        err = OCParseSingleRepPayload(&pl, &repMap, false, arena);
                         VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
                         res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
                     }
@@ -1161,7 +1234,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                         // OCParseArray will fail if the array contains mixed types, try
                         // to parse as payload with non-negative integer value names
                         OCRepPayload *pl = NULL;
-                        err = OCParseSingleRepPayload(&pl, &repMap, false);
+                        err = OCParseSingleRepPayload(&pl, &repMap, false, arena);
                         VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
                         res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
                     }
@@ -1181,7 +1254,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advance repMap");
             }
-            OICFree(name);
+            OCPayloadArenaFree(arena, name);
             name = NULL;
             ++arrayIndex;
         }
@@ -1194,13 +1267,14 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     }
 
 exit:
-    OICFree(name);
+    OCPayloadArenaFree(arena, name);
     OCRepPayloadDestroy(*outPayload);
     *outPayload = NULL;
     return err;
 }
 
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root,
+        OCPayloadArena *arena)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     CborError err;
@@ -1219,7 +1293,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
     }
     while (cbor_value_is_valid(&rootMap))
     {
-        temp = OCRepPayloadCreate();
+        temp = OCRepPayloadCreateInArena(arena);
         ret = OC_STACK_NO_MEMORY;
         VERIFY_PARAM_NON_NULL(TAG, temp, "Failed allocating memory");
 
@@ -1265,7 +1339,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
 
         if (cbor_value_is_map(&rootMap))
         {
-            err = OCParseSingleRepPayload(&temp, &rootMap, true);
+            err = OCParseSingleRepPayload(&temp, &rootMap, true, arena);
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed to parse single rep payload");
         }
 
@@ -1395,3 +1469,318 @@ exit:
     OCDiagnosticPayloadDestroy(payload);
     return ret;
 }
+
+/*
+ * Mask and limit of the additional information in the initial byte of a CBOR
+ * item. Below the limit it is the length itself, else it gives the number of
+ * length bytes following the initial byte.
+ */
+#define CBOR_ADDITIONAL_INFO_MASK 0x1f
+#define CBOR_ADDITIONAL_INFO_INLINE_LIMIT 24
+
+static bool OCRepPayloadViewEnterMap(const OCRepPayloadView *view, CborParser *parser,
+        CborValue *map)
+{
+    if (!view || !view->data)
+    {
+        return false;
+    }
+    return CborNoError == cbor_parser_init(view->data, view->size, 0, parser, map) &&
+        cbor_value_is_map(map);
+}
+
+static bool OCRepPayloadViewFindValue(const OCRepPayloadView *view, const char *name,
+        CborParser *parser, CborValue *value)
+{
+    CborValue map;
+    if (!name || !OCRepPayloadViewEnterMap(view, parser, &map))
+    {
+        return false;
+    }
+    // The eager parser moves these out of the properties of a root payload.
+    if (view->isRoot &&
+        ((0 == strcmp(OC_RSRVD_HREF, name)) ||
+         (0 == strcmp(OC_RSRVD_RESOURCE_TYPE, name)) ||
+         (0 == strcmp(OC_RSRVD_INTERFACE, name))))
+    {
+        return false;
+    }
+    return CborNoError == cbor_value_map_find_value(&map, name, value) &&
+        cbor_value_is_valid(value);
+}
+
+OCStackResult OCRepPayloadViewInit(OCRepPayloadView *view, const uint8_t *cbor, size_t size)
+{
+    VERIFY_PARAM_NON_NULL(TAG, view, "Invalid Parameter view");
+    VERIFY_PARAM_NON_NULL(TAG, cbor, "Invalid Parameter cbor");
+
+    view->data = cbor;
+    view->size = size;
+    view->isRoot = true;
+
+    CborParser parser;
+    CborValue map;
+    if (!OCRepPayloadViewEnterMap(view, &parser, &map))
+    {
+        view->data = NULL;
+        view->size = 0;
+        return OC_STACK_MALFORMED_RESPONSE;
+    }
+    return OC_STACK_OK;
+
+exit:
+    return OC_STACK_INVALID_PARAM;
+}
+
+bool OCRepPayloadViewGetPropType(const OCRepPayloadView *view, const char *name,
+        OCRepPayloadPropType *type)
+{
+    CborParser parser;
+    CborValue value;
+    if (!type || !OCRepPayloadViewFindValue(view, name, &parser, &value))
+    {
+        return false;
+    }
+    *type = DecodeCborType(cbor_value_get_type(&value));
+    return true;
+}
+
+bool OCRepPayloadViewIsNull(const OCRepPayloadView *view, const char *name)
+{
+    CborParser parser;
+    CborValue value;
+    return OCRepPayloadViewFindValue(view, name, &parser, &value) &&
+        cbor_value_is_null(&value);
+}
+
+bool OCRepPayloadViewGetPropInt(const OCRepPayloadView *view, const char *name, int64_t *value)
+{
+    CborParser parser;
+    CborValue val;
+    if (!value || !OCRepPayloadViewFindValue(view, name, &parser, &val) ||
+        !cbor_value_is_integer(&val))
+    {
+        return false;
+    }
+    return CborNoError == cbor_value_get_int64(&val, value);
+}
+
+bool OCRepPayloadViewGetPropDouble(const OCRepPayloadView *view, const char *name, double *value)
+{
+    CborParser parser;
+    CborValue val;
+    if (!value || !OCRepPayloadViewFindValue(view, name, &parser, &val))
+    {
+        return false;
+    }
+
+    switch (cbor_value_get_type(&val))
+    {
+        case CborDoubleType:
+            return CborNoError == cbor_value_get_double(&val, value);
+        case CborFloatType:
+            {
+                float floatval = 0;
+                if (CborNoError != cbor_value_get_float(&val, &floatval))
+                {
+                    return false;
+                }
+                *value = floatval;
+                return true;
+            }
+        case CborIntegerType:
+            {
+                // Like OCRepPayloadGetPropDouble, integers convert.
+                int64_t intval = 0;
+                if (CborNoError != cbor_value_get_int64(&val, &intval))
+                {
+                    return false;
+                }
+                *value = (double)intval;
+                return true;
+            }
+        default:
+            return false;
+    }
+}
+
+bool OCRepPayloadViewGetPropBool(const OCRepPayloadView *view, const char *name, bool *value)
+{
+    CborParser parser;
+    CborValue val;
+    if (!value || !OCRepPayloadViewFindValue(view, name, &parser, &val) ||
+        !cbor_value_is_boolean(&val))
+    {
+        return false;
+    }
+    return CborNoError == cbor_value_get_boolean(&val, value);
+}
+
+bool OCRepPayloadViewGetPropString(const OCRepPayloadView *view, const char *name, char **value)
+{
+    CborParser parser;
+    CborValue val;
+    if (!value || !OCRepPayloadViewFindValue(view, name, &parser, &val) ||
+        !cbor_value_is_text_string(&val))
+    {
+        return false;
+    }
+    size_t len = 0;
+    return CborNoError == cbor_value_dup_text_string(&val, value, &len, NULL);
+}
+
+bool OCRepPayloadViewGetPropStringRef(const OCRepPayloadView *view, const char *name,
+        const char **value, size_t *length)
+{
+    CborParser parser;
+    CborValue val;
+    if (!value || !length || !OCRepPayloadViewFindValue(view, name, &parser, &val) ||
+        !cbor_value_is_text_string(&val) || !cbor_value_is_length_known(&val))
+    {
+        return false;
+    }
+
+    size_t len = 0;
+    if (CborNoError != cbor_value_get_string_length(&val, &len))
+    {
+        return false;
+    }
+
+    // A definite length string is its header followed by the bytes.
+    const uint8_t *item = cbor_value_get_next_byte(&val);
+    const uint8_t *end = view->data + view->size;
+    uint8_t additional = *item & CBOR_ADDITIONAL_INFO_MASK;
+    size_t header = 1;
+    if (additional >= CBOR_ADDITIONAL_INFO_INLINE_LIMIT)
+    {
+        header += (size_t)1 << (additional - CBOR_ADDITIONAL_INFO_INLINE_LIMIT);
+    }
+    if (header > (size_t)(end - item) || len > (size_t)(end - item) - header)
+    {
+        return false;
+    }
+
+    *value = (const char *)(item + header);
+    *length = len;
+    return true;
+}
+
+bool OCRepPayloadViewGetPropByteString(const OCRepPayloadView *view, const char *name,
+        OCByteString *value)
+{
+    CborParser parser;
+    CborValue val;
+    if (!value || !OCRepPayloadViewFindValue(view, name, &parser, &val) ||
+        !cbor_value_is_byte_string(&val))
+    {
+        return false;
+    }
+    return CborNoError == cbor_value_dup_byte_string(&val, &value->bytes, &value->len, NULL);
+}
+
+bool OCRepPayloadViewGetPropObject(const OCRepPayloadView *view, const char *name,
+        OCRepPayloadView *value)
+{
+    CborParser parser;
+    CborValue val;
+    if (!value || !OCRepPayloadViewFindValue(view, name, &parser, &val) ||
+        !cbor_value_is_map(&val))
+    {
+        return false;
+    }
+
+    value->data = cbor_value_get_next_byte(&val);
+    value->size = (size_t)(view->data + view->size - value->data);
+    value->isRoot = false;
+    return true;
+}
+
+bool OCRepPayloadViewGetUri(const OCRepPayloadView *view, char **uri)
+{
+    CborParser parser;
+    CborValue map;
+    CborValue val;
+    if (!uri || !OCRepPayloadViewEnterMap(view, &parser, &map) || !view->isRoot ||
+        CborNoError != cbor_value_map_find_value(&map, OC_RSRVD_HREF, &val) ||
+        !cbor_value_is_text_string(&val))
+    {
+        return false;
+    }
+    size_t len = 0;
+    return CborNoError == cbor_value_dup_text_string(&val, uri, &len, NULL);
+}
+
+static bool OCRepPayloadViewGetStringLL(const OCRepPayloadView *view, char *name,
+        OCStringLL **list)
+{
+    CborParser parser;
+    CborValue map;
+    if (!list || !OCRepPayloadViewEnterMap(view, &parser, &map) || !view->isRoot)
+    {
+        return false;
+    }
+
+    *list = NULL;
+    if (CborNoError != OCParseStringLL(&map, name, list))
+    {
+        OCFreeOCStringLL(*list);
+        *list = NULL;
+        return false;
+    }
+    return NULL != *list;
+}
+
+bool OCRepPayloadViewGetResourceTypes(const OCRepPayloadView *view, OCStringLL **types)
+{
+    return OCRepPayloadViewGetStringLL(view, OC_RSRVD_RESOURCE_TYPE, types);
+}
+
+bool OCRepPayloadViewGetInterfaces(const OCRepPayloadView *view, OCStringLL **interfaces)
+{
+    return OCRepPayloadViewGetStringLL(view, OC_RSRVD_INTERFACE, interfaces);
+}
+
+OCRepPayload* OCRepPayloadViewToPayload(const OCRepPayloadView *view)
+{
+    CborParser parser;
+    CborValue map;
+    if (!OCRepPayloadViewEnterMap(view, &parser, &map))
+    {
+        return NULL;
+    }
+
+    if (view->isRoot)
+    {
+        OCPayload *payload = NULL;
+        if (OC_STACK_OK != OCParsePayload(&payload, OC_FORMAT_CBOR,
+                PAYLOAD_TYPE_REPRESENTATION, view->data, view->size))
+        {
+            return NULL;
+        }
+        return (OCRepPayload *)payload;
+    }
+
+    OCPayloadArena *arena = NULL;
+    if (g_parseUseArena)
+    {
+        // Size the arena from the encoding of the object, not the rest of the buffer.
+        CborValue next = map;
+        if (CborNoError != cbor_value_advance(&next))
+        {
+            return NULL;
+        }
+        size_t encodedSize = (size_t)(cbor_value_get_next_byte(&next) - view->data);
+        arena = OCPayloadArenaCreate(REP_PARSE_ARENA_SIZE_FACTOR * encodedSize);
+    }
+
+    OCRepPayload *payload = NULL;
+    CborError err = OCParseSingleRepPayload(&payload, &map, false, arena);
+    OCPayloadArenaSeal(arena);
+    OCPayloadArenaRelease(arena);
+    if (CborNoError != err)
+    {
+        OIC_LOG(ERROR, TAG, "CBOR error converting view to payload");
+        return NULL;
+    }
+    return payload;
+}
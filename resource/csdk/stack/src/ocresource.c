@@ -56,6 +56,8 @@
 #include "oickeepalive.h"
 #include "ocpayloadcbor.h"
 #include "psinterface.h"
+#include "ocatomic.h"
+#include "utlist.h"
 
 #ifdef ROUTING_GATEWAY
 #include "routingmanager.h"
@@ -1299,17 +1301,12 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCResource *pointer = (OCResource *) OCGetResourceHandleAtUri(resourceUri);
+    if (!pointer)
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
-        {
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
     }
-    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
+    return pointer;
 }
 
 OCStackResult CheckRequestsEndpoint(const OCDevAddr *reqDevAddr,
@@ -1641,18 +1638,30 @@ static OCStackResult EHRequest(OCEntityHandlerRequest *ehRequest, OCPayloadType
  * @param interfaceQuery The interface query parameter.
  * @param resourceTypeQuery The resourceType query parameter.
  * @param discPayload The payload that will be added with the resource information if found at RD.
+ * @param rdPayload The discovery payloads of the RD that were appended to discPayload. They are
+ * owned by the RD discovery cache and must be detached with detachResourcesAtRD().
  *
  * @return ::OC_STACK_OK if any resources are found else ::OC_STACK_NO_RESOURCE.
  * In case if RD server is not started, it returns ::OC_STACK_NO_RESOURCE.
  */
 static OCStackResult findResourcesAtRD(const char *interfaceQuery,
-                                       const char *resourceTypeQuery, OCDiscoveryPayload **discPayload)
+                                       const char *resourceTypeQuery, OCDiscoveryPayload **discPayload,
+                                       const OCDiscoveryPayload **rdPayload)
 {
     OCStackResult result = OC_STACK_NO_RESOURCE;
+    *rdPayload = NULL;
     if (OCGetResourceHandleAtUri(OC_RSRVD_RD_URI) != NULL)
     {
-        result = OCRDDatabaseDiscoveryPayloadCreate(interfaceQuery, resourceTypeQuery,
-            (*discPayload) ? &(*discPayload)->next : discPayload);
+        result = OCRDDatabaseDiscoveryPayloadGet(interfaceQuery, resourceTypeQuery, rdPayload);
+        if (*rdPayload)
+        {
+            OCDiscoveryPayload **tail = discPayload;
+            while (*tail)
+            {
+                tail = &(*tail)->next;
+            }
+            *tail = (OCDiscoveryPayload *)*rdPayload;
+        }
     }
     if ((*discPayload) && (*discPayload)->resources)
     {
@@ -1660,6 +1669,30 @@ static OCStackResult findResourcesAtRD(const char *interfaceQuery,
     }
     return result;
 }
+
+/**
+ * Detach the discovery payloads appended by findResourcesAtRD() so that they are not destroyed
+ * with the response payload.
+ *
+ * @param discPayload The response payload.
+ * @param rdPayload The discovery payloads of the RD.
+ */
+static void detachResourcesAtRD(OCDiscoveryPayload **discPayload,
+                                const OCDiscoveryPayload *rdPayload)
+{
+    if (!rdPayload)
+    {
+        return;
+    }
+    for (OCDiscoveryPayload **tail = discPayload; *tail; tail = &(*tail)->next)
+    {
+        if (*tail == rdPayload)
+        {
+            *tail = NULL;
+            break;
+        }
+    }
+}
 #endif
 
 /**
@@ -1741,6 +1774,311 @@ static bool isUnicast(OCServerRequest *request)
            (request->devAddr.adapter != OC_ADAPTER_GATT_BTLE));
 }
 
+/**
+ * Build the /oic/res response for the local resources and, on an RD server, for the resources
+ * published to it.
+ *
+ * @param request The discovery request.
+ * @param resource The first resource to consider.
+ * @param virtualUriInRequest ::OC_WELL_KNOWN_URI or ::OC_MQ_BROKER_URI.
+ * @param interfaceQuery The interface query parameter.
+ * @param resourceTypeQuery The resourceType query parameter.
+ * @param networkInfo The network information the endpoints of the resources are taken from.
+ * @param infoSize The number of entries of networkInfo.
+ * @param payload The discovery payload, NULL if no resource matches.
+ * @param rdPayload The discovery payloads of the RD appended to payload, see
+ * findResourcesAtRD().
+ *
+ * @return ::OC_STACK_OK if any resources are found, ::OC_STACK_NO_RESOURCE if none are,
+ * some other value upon failure.
+ */
+static OCStackResult buildDiscoveryPayload(OCServerRequest *request, OCResource *resource,
+                                           OCVirtualResources virtualUriInRequest,
+                                           char *interfaceQuery, char *resourceTypeQuery,
+                                           CAEndpoint_t *networkInfo, size_t infoSize,
+                                           OCPayload **payload,
+                                           const OCDiscoveryPayload **rdPayload)
+{
+    OCStackResult result;
+    *rdPayload = NULL;
+#ifndef MQ_BROKER
+    OC_UNUSED(virtualUriInRequest);
+#endif
+
+    result = discoveryPayloadCreateAndAddDeviceId(payload);
+    VERIFY_PARAM_NON_NULL(TAG, *payload, "Failed creating Discovery Payload.");
+    VERIFY_SUCCESS(result);
+
+    OCDiscoveryPayload *discPayload = (OCDiscoveryPayload *)*payload;
+    if (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_DEFAULT))
+    {
+        result = addDiscoveryBaselineCommonProperties(discPayload);
+        VERIFY_SUCCESS(result);
+    }
+    OCResourceProperty prop = OC_DISCOVERABLE;
+#ifdef MQ_BROKER
+    prop = (OC_MQ_BROKER_URI == virtualUriInRequest) ? OC_MQ_BROKER : prop;
+#endif
+    for (; resource && result == OC_STACK_OK; resource = resource->next)
+    {
+        // This case will handle when no resource type and it is oic.if.ll.
+        // Do not assume check if the query is ll
+        if (!resourceTypeQuery &&
+            (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
+        {
+            // Only include discoverable type
+            if (resource->resourceProperties & prop)
+            {
+                result = BuildVirtualResourceResponse(resource,
+                                                               discPayload,
+                                                               &request->devAddr,
+                                                               networkInfo,
+                                                               infoSize);
+            }
+        }
+        else if (includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
+        {
+            result = BuildVirtualResourceResponse(resource,
+                                                           discPayload,
+                                                           &request->devAddr,
+                                                           networkInfo,
+                                                           infoSize);
+        }
+        else
+        {
+            result = OC_STACK_OK;
+        }
+    }
+    if (discPayload->resources == NULL)
+    {
+        result = OC_STACK_NO_RESOURCE;
+        OCPayloadDestroy(*payload);
+        *payload = NULL;
+    }
+
+#ifdef RD_SERVER
+    result = findResourcesAtRD(interfaceQuery, resourceTypeQuery,
+                               (OCDiscoveryPayload **)payload, rdPayload);
+#endif
+
+exit:
+    return result;
+}
+
+/** Maximum number of encoded /oic/res responses kept. */
+#define DISCOVERY_CACHE_SIZE 16
+
+/**
+ * Encoded /oic/res response. Besides the query filters and the accept format, the endpoints
+ * and ports in the response depend on the transport the request was received on.
+ */
+typedef struct DiscoveryResponse
+{
+    char *interfaceQuery;
+    char *resourceTypeQuery;
+    OCPayloadFormat acceptFormat;
+    uint16_t acceptVersion;
+    OCTransportAdapter adapter;
+    OCTransportFlags flags;
+    uint32_t ifindex;
+
+    /** ::OC_STACK_OK or ::OC_STACK_NO_RESOURCE, which has no payload. */
+    OCStackResult result;
+    OCEncodedPayload encoded;
+    struct DiscoveryResponse *next;
+} DiscoveryResponse;
+
+/** Cached responses, most recently used first. */
+static DiscoveryResponse *g_discoveryCache = NULL;
+static size_t g_discoveryCacheCount = 0;
+
+/** Incremented by InvalidateDiscoveryCache(), which may be called from other threads. */
+static volatile int32_t g_discoveryGeneration = 0;
+
+/** State the cached responses were built for. */
+static int32_t g_discoveryCacheGeneration = 0;
+static CAEndpoint_t *g_discoveryNetworkInfo = NULL;
+static size_t g_discoveryNetworkInfoSize = 0;
+#ifdef RD_SERVER
+static uint32_t g_discoveryRDGeneration = 0;
+#endif
+
+void InvalidateDiscoveryCache()
+{
+    oc_atomic_increment(&g_discoveryGeneration);
+}
+
+static void deleteDiscoveryResponse(DiscoveryResponse *response)
+{
+    OICFree(response->interfaceQuery);
+    OICFree(response->resourceTypeQuery);
+    OICFree(response->encoded.payload);
+    OICFree(response);
+}
+
+void DeleteDiscoveryCache()
+{
+    DiscoveryResponse *response = NULL;
+    DiscoveryResponse *tmp = NULL;
+    LL_FOREACH_SAFE(g_discoveryCache, response, tmp)
+    {
+        LL_DELETE(g_discoveryCache, response);
+        deleteDiscoveryResponse(response);
+    }
+    g_discoveryCacheCount = 0;
+    OICFree(g_discoveryNetworkInfo);
+    g_discoveryNetworkInfo = NULL;
+    g_discoveryNetworkInfoSize = 0;
+}
+
+/**
+ * Drop the cached responses if the resources, the network or the resources published to the
+ * RD have changed since they were built.
+ *
+ * @param networkInfo The current network information.
+ * @param infoSize The number of entries of networkInfo.
+ */
+static void validateDiscoveryCache(const CAEndpoint_t *networkInfo, size_t infoSize)
+{
+    int32_t generation = oc_atomic_add(&g_discoveryGeneration, 0);
+    // Addresses can change without the adapter changing state
+    bool valid = (generation == g_discoveryCacheGeneration) &&
+                 (infoSize == g_discoveryNetworkInfoSize) &&
+                 (!infoSize || 0 == memcmp(networkInfo, g_discoveryNetworkInfo,
+                                           infoSize * sizeof(CAEndpoint_t)));
+#ifdef RD_SERVER
+    uint32_t rdGeneration = 0;
+    if (OCGetResourceHandleAtUri(OC_RSRVD_RD_URI) != NULL)
+    {
+        rdGeneration = OCRDDatabaseDiscoveryGetGeneration();
+    }
+    valid = valid && (rdGeneration == g_discoveryRDGeneration);
+#endif
+    if (valid)
+    {
+        return;
+    }
+
+    DeleteDiscoveryCache();
+    g_discoveryCacheGeneration = generation;
+#ifdef RD_SERVER
+    g_discoveryRDGeneration = rdGeneration;
+#endif
+    if (infoSize)
+    {
+        // Without a copy the next request finds a different network and starts over
+        g_discoveryNetworkInfo = (CAEndpoint_t *)OICMalloc(infoSize * sizeof(CAEndpoint_t));
+        if (g_discoveryNetworkInfo)
+        {
+            memcpy(g_discoveryNetworkInfo, networkInfo, infoSize * sizeof(CAEndpoint_t));
+            g_discoveryNetworkInfoSize = infoSize;
+        }
+    }
+}
+
+static bool queryEquals(const char *a, const char *b)
+{
+    return (a == b) || (a && b && 0 == strcmp(a, b));
+}
+
+static bool discoveryResponseMatches(const DiscoveryResponse *response,
+                                     const OCServerRequest *request,
+                                     const char *interfaceQuery, const char *resourceTypeQuery)
+{
+    return (response->acceptFormat == request->acceptFormat) &&
+           (response->acceptVersion == request->acceptVersion) &&
+           (response->adapter == request->devAddr.adapter) &&
+           (response->flags == request->devAddr.flags) &&
+           (response->ifindex == request->devAddr.ifindex) &&
+           queryEquals(response->interfaceQuery, interfaceQuery) &&
+           queryEquals(response->resourceTypeQuery, resourceTypeQuery);
+}
+
+/**
+ * Find the cached response to a discovery request.
+ *
+ * @param request The discovery request.
+ * @param interfaceQuery The interface query parameter.
+ * @param resourceTypeQuery The resourceType query parameter.
+ *
+ * @return the response, valid until the next call, or NULL if none is cached.
+ */
+static const DiscoveryResponse *findDiscoveryResponse(const OCServerRequest *request,
+                                                      const char *interfaceQuery,
+                                                      const char *resourceTypeQuery)
+{
+    DiscoveryResponse *response = NULL;
+    LL_FOREACH(g_discoveryCache, response)
+    {
+        if (discoveryResponseMatches(response, request, interfaceQuery, resourceTypeQuery))
+        {
+            LL_DELETE(g_discoveryCache, response);
+            LL_PREPEND(g_discoveryCache, response);
+            return response;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Encode and cache the response to a discovery request.
+ *
+ * @param request The discovery request.
+ * @param interfaceQuery The interface query parameter.
+ * @param resourceTypeQuery The resourceType query parameter.
+ * @param result The result of building the discovery payload.
+ * @param payload The discovery payload.
+ *
+ * @return the response, valid until the next call, or NULL if it is not cached.
+ */
+static const DiscoveryResponse *addDiscoveryResponse(const OCServerRequest *request,
+                                                     const char *interfaceQuery,
+                                                     const char *resourceTypeQuery,
+                                                     OCStackResult result,
+                                                     OCPayload *payload)
+{
+    if (!((OC_STACK_OK == result && payload) || OC_STACK_NO_RESOURCE == result))
+    {
+        return NULL;
+    }
+
+    DiscoveryResponse *response = (DiscoveryResponse *)OICCalloc(1, sizeof(DiscoveryResponse));
+    if (!response)
+    {
+        return NULL;
+    }
+    response->interfaceQuery = interfaceQuery ? OICStrdup(interfaceQuery) : NULL;
+    response->resourceTypeQuery = resourceTypeQuery ? OICStrdup(resourceTypeQuery) : NULL;
+    response->acceptFormat = request->acceptFormat;
+    response->acceptVersion = request->acceptVersion;
+    response->adapter = request->devAddr.adapter;
+    response->flags = request->devAddr.flags;
+    response->ifindex = request->devAddr.ifindex;
+    response->result = result;
+    if ((interfaceQuery && !response->interfaceQuery) ||
+        (resourceTypeQuery && !response->resourceTypeQuery) ||
+        (OC_STACK_OK == result &&
+         OC_STACK_OK != EncodeResponsePayload(request, payload, &response->encoded)))
+    {
+        deleteDiscoveryResponse(response);
+        return NULL;
+    }
+
+    LL_PREPEND(g_discoveryCache, response);
+    if (++g_discoveryCacheCount > DISCOVERY_CACHE_SIZE)
+    {
+        DiscoveryResponse *last = g_discoveryCache;
+        while (last->next)
+        {
+            last = last->next;
+        }
+        LL_DELETE(g_discoveryCache, last);
+        deleteDiscoveryResponse(last);
+        g_discoveryCacheCount--;
+    }
+    return response;
+}
+
 static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource* resource)
 {
     if (!request || !resource)
@@ -1751,6 +2089,8 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     OCPayload* payload = NULL;
     char *interfaceQuery = NULL;
     char *resourceTypeQuery = NULL;
+    const OCDiscoveryPayload *rdPayload = NULL;
+    const DiscoveryResponse *discoveryResponse = NULL;
 
     OIC_LOG(INFO, TAG, "Entering HandleVirtualResource");
 
@@ -1825,64 +2165,30 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
             interfaceQuery = OICStrdup(OC_RSRVD_INTERFACE_LL);
         }
 
-        discoveryResult = discoveryPayloadCreateAndAddDeviceId(&payload);
-        VERIFY_PARAM_NON_NULL(TAG, payload, "Failed creating Discovery Payload.");
-        VERIFY_SUCCESS(discoveryResult);
-
-        OCDiscoveryPayload *discPayload = (OCDiscoveryPayload *)payload;
-        if (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_DEFAULT))
+        // Notifications may be captured for other observers and are always built afresh
+        bool cacheable = (OC_WELL_KNOWN_URI == virtualUriInRequest) && !request->notificationFlag;
+        if (cacheable)
         {
-            discoveryResult = addDiscoveryBaselineCommonProperties(discPayload);
-            VERIFY_SUCCESS(discoveryResult);
-        }
-        OCResourceProperty prop = OC_DISCOVERABLE;
-#ifdef MQ_BROKER
-        prop = (OC_MQ_BROKER_URI == virtualUriInRequest) ? OC_MQ_BROKER : prop;
-#endif
-        for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
-        {
-            // This case will handle when no resource type and it is oic.if.ll.
-            // Do not assume check if the query is ll
-            if (!resourceTypeQuery &&
-                (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
-            {
-                // Only include discoverable type
-                if (resource->resourceProperties & prop)
-                {
-                    discoveryResult = BuildVirtualResourceResponse(resource,
-                                                                   discPayload,
-                                                                   &request->devAddr,
-                                                                   networkInfo,
-                                                                   infoSize);
-                }
-            }
-            else if (includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
-            {
-                discoveryResult = BuildVirtualResourceResponse(resource,
-                                                               discPayload,
-                                                               &request->devAddr,
-                                                               networkInfo,
-                                                               infoSize);
-            }
-            else
-            {
-                discoveryResult = OC_STACK_OK;
-            }
+            validateDiscoveryCache(networkInfo, infoSize);
+            discoveryResponse = findDiscoveryResponse(request, interfaceQuery, resourceTypeQuery);
         }
-        if (discPayload->resources == NULL)
+        if (discoveryResponse)
         {
-            discoveryResult = OC_STACK_NO_RESOURCE;
-            OCPayloadDestroy(payload);
-            payload = NULL;
+            discoveryResult = discoveryResponse->result;
         }
-
-        if (networkInfo)
+        else
         {
-            OICFree(networkInfo);
+            discoveryResult = buildDiscoveryPayload(request, resource, virtualUriInRequest,
+                                                    interfaceQuery, resourceTypeQuery,
+                                                    networkInfo, infoSize, &payload, &rdPayload);
+            if (cacheable)
+            {
+                discoveryResponse = addDiscoveryResponse(request, interfaceQuery,
+                                                         resourceTypeQuery, discoveryResult,
+                                                         payload);
+            }
         }
-#ifdef RD_SERVER
-        discoveryResult = findResourcesAtRD(interfaceQuery, resourceTypeQuery, (OCDiscoveryPayload **)&payload);
-#endif
+        OICFree(networkInfo);
     }
     else if (virtualUriInRequest == OC_DEVICE_URI)
     {
@@ -1961,7 +2267,14 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
         OIC_LOG_PAYLOAD(DEBUG, payload);
         if(discoveryResult == OC_STACK_OK)
         {
-            SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
+            if (discoveryResponse)
+            {
+                HandleEncodedResponse(request, OC_EH_OK, &discoveryResponse->encoded);
+            }
+            else
+            {
+                SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
+            }
         }
         else // Error handling
         {
@@ -1995,6 +2308,9 @@ exit:
     {
         OICFree(resourceTypeQuery);
     }
+#ifdef RD_SERVER
+    detachResourcesAtRD((OCDiscoveryPayload **)&payload, rdPayload);
+#endif
     OCPayloadDestroy(payload);
 
     // To ignore the message, OC_STACK_CONTINUE is sent
@@ -2462,6 +2778,9 @@ static OCStackResult SetAttributeInternal(OCResource *resource,
         return OC_STACK_INVALID_PARAM;
     }
 
+    // The device name is part of the baseline discovery response
+    InvalidateDiscoveryCache();
+
     // See if the attribute already exists in the list.
     for (resAttrib = resource->rsrcAttributes; resAttrib; resAttrib = resAttrib->next)
     {
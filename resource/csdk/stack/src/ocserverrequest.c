@@ -73,6 +73,9 @@ RB_HEAD(ServerResponseTree, OCServerResponse) g_serverResponseTree =
                                                             RB_INITIALIZER(&g_serverResponseTree);
 RB_GENERATE(ServerResponseTree, OCServerResponse, entry, RBResponseTokenCmp)
 
+/// Notification cache capturing the response of the notification being sent, if any
+static OCNotificationCache *g_notificationCapture = NULL;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
@@ -494,97 +497,295 @@ OCStackResult FormOCEntityHandlerRequest(OCEntityHandlerRequest * entityHandlerR
     return OC_STACK_INVALID_PARAM;
 }
 
-OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+/**
+ * Send a response, on all adapters if the endpoint does not name one.
+ *
+ * @param[in] responseEndpoint  endpoint of the requester
+ * @param[in] responseInfo      response to send
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendResponseToEndpoint(CAEndpoint_t *responseEndpoint,
+                                            CAResponseInfo_t *responseInfo)
 {
-    OCStackResult result = OC_STACK_ERROR;
+    OCStackResult result = OC_STACK_OK;
+#ifdef WITH_PRESENCE
+    CATransportAdapter_t CAConnTypes[] = {
+                            CA_ADAPTER_IP,
+                            CA_ADAPTER_GATT_BTLE,
+                            CA_ADAPTER_RFCOMM_BTEDR,
+                            CA_ADAPTER_NFC
+#ifdef RA_ADAPTER
+                            , CA_ADAPTER_REMOTE_ACCESS
+#endif
+                            , CA_ADAPTER_TCP
+                        };
+
+    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+
+    CATransportAdapter_t adapter = responseEndpoint->adapter;
+    // Default adapter, try to send response out on all adapters.
+    if (adapter == CA_DEFAULT_ADAPTER)
+    {
+        adapter =
+            (CATransportAdapter_t)(
+                CA_ADAPTER_IP           |
+                CA_ADAPTER_GATT_BTLE    |
+                CA_ADAPTER_RFCOMM_BTEDR |
+                CA_ADAPTER_NFC
+#ifdef RA_ADAP
+                | CA_ADAPTER_REMOTE_ACCESS
+#endif
+                | CA_ADAPTER_TCP
+            );
+    }
+
+    OCStackResult tempResult = OC_STACK_OK;
+
+    for(size_t i = 0; i < size; i++ )
+    {
+        responseEndpoint->adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
+        if(responseEndpoint->adapter)
+        {
+            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
+            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
+            tempResult = OCSendResponse(responseEndpoint, responseInfo);
+        }
+        if(OC_STACK_OK != tempResult)
+        {
+            result = tempResult;
+        }
+    }
+#else
+
+    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
+    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint->addr);
+    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint->adapter);
+    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo->result);
+    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo->info.resourceUri);
+
+    result = OCSendResponse(responseEndpoint, responseInfo);
+#endif
+
+    return result;
+}
+
+/**
+ * Keep the encoded response of a notification so that it can be sent to other observers.
+ *
+ * @param[in] cache             notification cache to fill
+ * @param[in] responseInfo      response that is about to be sent
+ * @param[in] numVendorOptions  number of vendor specific options at the end of the options
+ *
+ * @return true if the cache took ownership of the payload of the response.
+ */
+static bool CaptureNotification(OCNotificationCache *cache, const CAResponseInfo_t *responseInfo,
+                                uint8_t numVendorOptions)
+{
+    if (numVendorOptions)
+    {
+        cache->options = (CAHeaderOption_t *) OICCalloc(numVendorOptions,
+                                                        sizeof(CAHeaderOption_t));
+        if (!cache->options)
+        {
+            OIC_LOG(ERROR, TAG, "Memory alloc for cached options failed");
+            return false;
+        }
+        memcpy(cache->options,
+               responseInfo->info.options + (responseInfo->info.numOptions - numVendorOptions),
+               sizeof(CAHeaderOption_t) * numVendorOptions);
+        cache->numOptions = numVendorOptions;
+    }
+
+    cache->result = responseInfo->result;
+    cache->payload = responseInfo->info.payload;
+    cache->payloadSize = responseInfo->info.payloadSize;
+    cache->payloadFormat = responseInfo->info.payloadFormat;
+    cache->payloadVersion = responseInfo->info.payloadVersion;
+    cache->captured = true;
+    return true;
+}
+
+OCNotificationCache *SetNotificationCapture(OCNotificationCache *cache)
+{
+    OCNotificationCache *previous = g_notificationCapture;
+    g_notificationCapture = cache;
+    return previous;
+}
+
+void ClearNotificationCache(OCNotificationCache *cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+    OICFree(cache->payload);
+    OICFree(cache->options);
+    cache->payload = NULL;
+    cache->payloadSize = 0;
+    cache->options = NULL;
+    cache->numOptions = 0;
+    cache->captured = false;
+}
+
+OCStackResult SendCachedNotification(const OCNotificationCache *cache,
+                                     const OCDevAddr *devAddr,
+                                     CAToken_t token, uint8_t tokenLength,
+                                     uint32_t sequenceNum, OCQualityOfService qos,
+                                     char *resourceUri)
+{
+    if (!cache || !cache->captured || !devAddr || tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
     CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
     CAResponseInfo_t responseInfo = {.result = CA_EMPTY};
-    CAHeaderOption_t* optionsPointer = NULL;
+    char rspToken[CA_MAX_TOKEN_LEN + 1] = {0};
 
-    if(!ehResponse || !ehResponse->requestHandle)
+    CopyDevAddrToEndpoint(devAddr, &responseEndpoint);
+
+    responseInfo.result = cache->result;
+    responseInfo.info.type = (qos == OC_HIGH_QOS) ? CA_MSG_CONFIRM : CA_MSG_NONCONFIRM;
+    responseInfo.info.messageId = 0;
+    responseInfo.info.resourceUri = resourceUri;
+    responseInfo.info.dataType = CA_RESPONSE_DATA;
+    responseInfo.info.token = (CAToken_t)rspToken;
+    memcpy(responseInfo.info.token, token, tokenLength);
+    responseInfo.info.tokenLength = tokenLength;
+
+    responseInfo.info.numOptions = cache->numOptions + 1;
+    responseInfo.info.options = (CAHeaderOption_t *) OICCalloc(responseInfo.info.numOptions,
+                                                               sizeof(CAHeaderOption_t));
+    if (!responseInfo.info.options)
     {
-        OIC_LOG(ERROR, TAG, "ehResponse/requestHandle is NULL");
-        return OC_STACK_ERROR;
+        OIC_LOG(FATAL, TAG, "Memory alloc for options failed");
+        return OC_STACK_NO_MEMORY;
     }
 
-    OCServerRequest *serverRequest = (OCServerRequest *)ehResponse->requestHandle;
+    responseInfo.info.options[0].protocolID = CA_COAP_ID;
+    responseInfo.info.options[0].optionID = COAP_OPTION_OBSERVE;
+    responseInfo.info.options[0].optionLength = sizeof(uint32_t);
+    uint8_t* observationData = (uint8_t*)responseInfo.info.options[0].optionData;
+    for (size_t i = sizeof(uint32_t); i; --i)
+    {
+        observationData[i - 1] = sequenceNum & 0xFF;
+        sequenceNum >>= 8;
+    }
+    if (cache->numOptions)
+    {
+        memcpy(responseInfo.info.options + 1, cache->options,
+               sizeof(CAHeaderOption_t) * cache->numOptions);
+    }
 
-    CopyDevAddrToEndpoint(&serverRequest->devAddr, &responseEndpoint);
+    responseInfo.isMulticast = false;
+    // The payload is only read while the response is cloned for sending.
+    responseInfo.info.payload = cache->payload;
+    responseInfo.info.payloadSize = cache->payloadSize;
+    responseInfo.info.payloadFormat = cache->payloadFormat;
+    responseInfo.info.payloadVersion = cache->payloadVersion;
 
-    responseInfo.info.messageId = serverRequest->coapID;
-    responseInfo.info.resourceUri = serverRequest->resourceUrl;
-    responseInfo.result = ConvertEHResultToCAResult(ehResponse->ehResult, serverRequest->method);
-    responseInfo.info.dataType = CA_RESPONSE_DATA;
+    OCStackResult result = SendResponseToEndpoint(&responseEndpoint, &responseInfo);
+
+    OICFree(responseInfo.info.options);
+    return result;
+}
+
+/**
+ * Fill in the parts of a response that only depend on the request: message type, token,
+ * observe and vendor specific header options.
+ *
+ * @param[in]  serverRequest     request to respond to
+ * @param[in]  ehResult          result of the entity handler
+ * @param[in]  vendorOptions     vendor specific header options of the response
+ * @param[in]  numVendorOptions  number of vendor specific header options
+ * @param[out] responseInfo      response to fill, its options are to be freed by the caller
+ * @param[out] rspToken          buffer of CA_MAX_TOKEN_LEN + 1 bytes for the token
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult InitResponseInfo(OCServerRequest *serverRequest,
+                                      OCEntityHandlerResult ehResult,
+                                      const OCHeaderOption *vendorOptions,
+                                      uint8_t numVendorOptions,
+                                      CAResponseInfo_t *responseInfo,
+                                      char *rspToken)
+{
+    CAHeaderOption_t* optionsPointer = NULL;
+
+    responseInfo->info.messageId = serverRequest->coapID;
+    responseInfo->info.resourceUri = serverRequest->resourceUrl;
+    responseInfo->result = ConvertEHResultToCAResult(ehResult, serverRequest->method);
+    responseInfo->info.dataType = CA_RESPONSE_DATA;
 
     if(serverRequest->notificationFlag && serverRequest->qos == OC_HIGH_QOS)
     {
-        responseInfo.info.type = CA_MSG_CONFIRM;
+        responseInfo->info.type = CA_MSG_CONFIRM;
     }
     else if(serverRequest->notificationFlag && serverRequest->qos != OC_HIGH_QOS)
     {
-        responseInfo.info.type = CA_MSG_NONCONFIRM;
+        responseInfo->info.type = CA_MSG_NONCONFIRM;
     }
     else if(!serverRequest->notificationFlag && !serverRequest->slowFlag &&
             serverRequest->qos == OC_HIGH_QOS)
     {
-        responseInfo.info.type = CA_MSG_ACKNOWLEDGE;
+        responseInfo->info.type = CA_MSG_ACKNOWLEDGE;
     }
     else if(!serverRequest->notificationFlag && serverRequest->slowFlag &&
             serverRequest->qos == OC_HIGH_QOS)
     {
         // To assign new messageId in CA.
-        responseInfo.info.messageId = 0;
-        responseInfo.info.type = CA_MSG_CONFIRM;
+        responseInfo->info.messageId = 0;
+        responseInfo->info.type = CA_MSG_CONFIRM;
     }
     else if(!serverRequest->notificationFlag)
     {
-        responseInfo.info.type = CA_MSG_NONCONFIRM;
+        responseInfo->info.type = CA_MSG_NONCONFIRM;
     }
     else
     {
         OIC_LOG(ERROR, TAG, "default responseInfo type is NON");
-        responseInfo.info.type = CA_MSG_NONCONFIRM;
+        responseInfo->info.type = CA_MSG_NONCONFIRM;
     }
 
-    char rspToken[CA_MAX_TOKEN_LEN + 1] = {0};
-    responseInfo.info.messageId = serverRequest->coapID;
-    responseInfo.info.token = (CAToken_t)rspToken;
+    responseInfo->info.messageId = serverRequest->coapID;
+    responseInfo->info.token = (CAToken_t)rspToken;
 
-    memcpy(responseInfo.info.token, serverRequest->requestToken, serverRequest->tokenLength);
-    responseInfo.info.tokenLength = serverRequest->tokenLength;
+    memcpy(responseInfo->info.token, serverRequest->requestToken, serverRequest->tokenLength);
+    responseInfo->info.tokenLength = serverRequest->tokenLength;
 
     if((serverRequest->observeResult == OC_STACK_OK)&&
        (serverRequest->observationOption != MAX_SEQUENCE_NUMBER + 1))
     {
-        responseInfo.info.numOptions = ehResponse->numSendVendorSpecificHeaderOptions + 1;
+        responseInfo->info.numOptions = numVendorOptions + 1;
     }
     else
     {
-        responseInfo.info.numOptions = ehResponse->numSendVendorSpecificHeaderOptions;
+        responseInfo->info.numOptions = numVendorOptions;
     }
 
-    if(responseInfo.info.numOptions > 0)
+    if(responseInfo->info.numOptions > 0)
     {
-        responseInfo.info.options = (CAHeaderOption_t *)
-                                      OICCalloc(responseInfo.info.numOptions,
+        responseInfo->info.options = (CAHeaderOption_t *)
+                                      OICCalloc(responseInfo->info.numOptions,
                                               sizeof(CAHeaderOption_t));
 
-        if(!responseInfo.info.options)
+        if(!responseInfo->info.options)
         {
             OIC_LOG(FATAL, TAG, "Memory alloc for options failed");
             return OC_STACK_NO_MEMORY;
         }
 
-        optionsPointer = responseInfo.info.options;
+        optionsPointer = responseInfo->info.options;
 
         // TODO: This exposes CoAP specific details.  At some point, this should be
         // re-factored and handled in the CA layer.
         if(serverRequest->observeResult == OC_STACK_OK)
         {
-            responseInfo.info.options[0].protocolID = CA_COAP_ID;
-            responseInfo.info.options[0].optionID = COAP_OPTION_OBSERVE;
-            responseInfo.info.options[0].optionLength = sizeof(uint32_t);
-            uint8_t* observationData = (uint8_t*)responseInfo.info.options[0].optionData;
+            responseInfo->info.options[0].protocolID = CA_COAP_ID;
+            responseInfo->info.options[0].optionID = COAP_OPTION_OBSERVE;
+            responseInfo->info.options[0].optionLength = sizeof(uint32_t);
+            uint8_t* observationData = (uint8_t*)responseInfo->info.options[0].optionData;
             uint32_t observationOption= serverRequest->observationOption;
 
             for (size_t i=sizeof(uint32_t); i; --i)
@@ -597,22 +798,106 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
             optionsPointer += 1;
         }
 
-        if (ehResponse->numSendVendorSpecificHeaderOptions)
+        if (numVendorOptions)
         {
-            memcpy(optionsPointer, ehResponse->sendVendorSpecificHeaderOptions,
+            memcpy(optionsPointer, vendorOptions,
                             sizeof(OCHeaderOption) *
-                            ehResponse->numSendVendorSpecificHeaderOptions);
+                            numVendorOptions);
         }
     }
     else
     {
-        responseInfo.info.options = NULL;
+        responseInfo->info.options = NULL;
     }
 
-    responseInfo.isMulticast = false;
-    responseInfo.info.payload = NULL;
-    responseInfo.info.payloadSize = 0;
-    responseInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
+    responseInfo->isMulticast = false;
+    responseInfo->info.payload = NULL;
+    responseInfo->info.payloadSize = 0;
+    responseInfo->info.payloadFormat = CA_FORMAT_UNDEFINED;
+    return OC_STACK_OK;
+}
+
+/**
+ * Encode the payload of a response in the format accepted by the request.
+ *
+ * @param[in]  serverRequest  request to respond to
+ * @param[in]  payload        payload of the response
+ * @param[out] responseInfo   response to add the encoded payload to
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult ConvertResponsePayload(const OCServerRequest *serverRequest,
+                                            OCPayload *payload,
+                                            CAResponseInfo_t *responseInfo)
+{
+    OCStackResult result = OC_STACK_OK;
+    switch(serverRequest->acceptFormat)
+    {
+        case OC_FORMAT_UNDEFINED:
+            // No preference set by the client, so default to CBOR then
+        case OC_FORMAT_CBOR:
+        case OC_FORMAT_VND_OCF_CBOR:
+            if((result = OCConvertPayload(payload, serverRequest->acceptFormat,
+                            &responseInfo->info.payload, &responseInfo->info.payloadSize))
+                    != OC_STACK_OK)
+            {
+                OIC_LOG(ERROR, TAG, "Error converting payload");
+                return result;
+            }
+            // Add CONTENT_FORMAT OPT if payload exist
+            if (payload->type != PAYLOAD_TYPE_DIAGNOSTIC &&
+                    responseInfo->info.payloadSize > 0)
+            {
+                responseInfo->info.payloadFormat = OCToCAPayloadFormat(
+                        serverRequest->acceptFormat);
+                if (CA_FORMAT_UNDEFINED == responseInfo->info.payloadFormat)
+                {
+                    responseInfo->info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+                }
+                if ((OC_FORMAT_VND_OCF_CBOR == serverRequest->acceptFormat))
+                {
+                    // Add versioning information for this format
+                    responseInfo->info.payloadVersion = serverRequest->acceptVersion;
+                    if (!responseInfo->info.payloadVersion)
+                    {
+                        responseInfo->info.payloadVersion = DEFAULT_VERSION_VALUE;
+                    }
+
+                }
+            }
+            break;
+        default:
+            responseInfo->result = CA_NOT_ACCEPTABLE;
+    }
+    return result;
+}
+
+OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+{
+    OCStackResult result = OC_STACK_ERROR;
+    CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
+    CAResponseInfo_t responseInfo = {.result = CA_EMPTY};
+    char rspToken[CA_MAX_TOKEN_LEN + 1] = {0};
+    bool payloadCaptured = false;
+
+    if(!ehResponse || !ehResponse->requestHandle)
+    {
+        OIC_LOG(ERROR, TAG, "ehResponse/requestHandle is NULL");
+        return OC_STACK_ERROR;
+    }
+
+    OCServerRequest *serverRequest = (OCServerRequest *)ehResponse->requestHandle;
+
+    CopyDevAddrToEndpoint(&serverRequest->devAddr, &responseEndpoint);
+
+    result = InitResponseInfo(serverRequest, ehResponse->ehResult,
+                              ehResponse->sendVendorSpecificHeaderOptions,
+                              ehResponse->numSendVendorSpecificHeaderOptions,
+                              &responseInfo, rspToken);
+    if (OC_STACK_OK != result)
+    {
+        return result;
+    }
 
     // Put the JSON prefix and suffix around the payload
     if(ehResponse->payload)
@@ -626,109 +911,92 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
             responseInfo.isMulticast = false;
         }
 
-        switch(serverRequest->acceptFormat)
+        result = ConvertResponsePayload(serverRequest, ehResponse->payload, &responseInfo);
+        if (OC_STACK_OK != result)
         {
-            case OC_FORMAT_UNDEFINED:
-                // No preference set by the client, so default to CBOR then
-            case OC_FORMAT_CBOR:
-            case OC_FORMAT_VND_OCF_CBOR:
-                if((result = OCConvertPayload(ehResponse->payload, serverRequest->acceptFormat,
-                                &responseInfo.info.payload, &responseInfo.info.payloadSize))
-                        != OC_STACK_OK)
-                {
-                    OIC_LOG(ERROR, TAG, "Error converting payload");
-                    OICFree(responseInfo.info.options);
-                    return result;
-                }
-                // Add CONTENT_FORMAT OPT if payload exist
-                if (ehResponse->payload->type != PAYLOAD_TYPE_DIAGNOSTIC &&
-                        responseInfo.info.payloadSize > 0)
-                {
-                    responseInfo.info.payloadFormat = OCToCAPayloadFormat(
-                            serverRequest->acceptFormat);
-                    if (CA_FORMAT_UNDEFINED == responseInfo.info.payloadFormat)
-                    {
-                        responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
-                    }
-                    if ((OC_FORMAT_VND_OCF_CBOR == serverRequest->acceptFormat))
-                    {
-                        // Add versioning information for this format
-                        responseInfo.info.payloadVersion = serverRequest->acceptVersion;
-                        if (!responseInfo.info.payloadVersion)
-                        {
-                            responseInfo.info.payloadVersion = DEFAULT_VERSION_VALUE;
-                        }
-
-                    }
-                }
-                break;
-            default:
-                responseInfo.result = CA_NOT_ACCEPTABLE;
+            OICFree(responseInfo.info.options);
+            return result;
         }
     }
 
-#ifdef WITH_PRESENCE
-    CATransportAdapter_t CAConnTypes[] = {
-                            CA_ADAPTER_IP,
-                            CA_ADAPTER_GATT_BTLE,
-                            CA_ADAPTER_RFCOMM_BTEDR,
-                            CA_ADAPTER_NFC
-#ifdef RA_ADAPTER
-                            , CA_ADAPTER_REMOTE_ACCESS
-#endif
-                            , CA_ADAPTER_TCP
-                        };
+    if (g_notificationCapture && !g_notificationCapture->captured
+        && serverRequest->notificationFlag
+        && g_notificationCapture->tokenLength == serverRequest->tokenLength
+        && memcmp(g_notificationCapture->token, serverRequest->requestToken,
+                  serverRequest->tokenLength) == 0)
+    {
+        payloadCaptured = CaptureNotification(g_notificationCapture, &responseInfo,
+                                              ehResponse->numSendVendorSpecificHeaderOptions);
+    }
 
-    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+    result = SendResponseToEndpoint(&responseEndpoint, &responseInfo);
 
-    CATransportAdapter_t adapter = responseEndpoint.adapter;
-    // Default adapter, try to send response out on all adapters.
-    if (adapter == CA_DEFAULT_ADAPTER)
+    if (!payloadCaptured)
     {
-        adapter =
-            (CATransportAdapter_t)(
-                CA_ADAPTER_IP           |
-                CA_ADAPTER_GATT_BTLE    |
-                CA_ADAPTER_RFCOMM_BTEDR |
-                CA_ADAPTER_NFC
-#ifdef RA_ADAP
-                | CA_ADAPTER_REMOTE_ACCESS
-#endif
-                | CA_ADAPTER_TCP
-            );
+        OICFree(responseInfo.info.payload);
     }
+    OICFree(responseInfo.info.options);
+    //Delete the request
+    DeleteServerRequest(serverRequest);
+    return result;
+}
 
-    result = OC_STACK_OK;
-    OCStackResult tempResult = OC_STACK_OK;
+OCStackResult EncodeResponsePayload(const OCServerRequest *serverRequest, OCPayload *payload,
+                                    OCEncodedPayload *encoded)
+{
+    if (!serverRequest || !payload || !encoded)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
 
-    for(size_t i = 0; i < size; i++ )
+    CAResponseInfo_t responseInfo = {.result = CA_EMPTY};
+    OCStackResult result = ConvertResponsePayload(serverRequest, payload, &responseInfo);
+    if (OC_STACK_OK != result)
     {
-        responseEndpoint.adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
-        if(responseEndpoint.adapter)
-        {
-            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
-            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
-            tempResult = OCSendResponse(&responseEndpoint, &responseInfo);
-        }
-        if(OC_STACK_OK != tempResult)
-        {
-            result = tempResult;
-        }
+        return result;
+    }
+    if (CA_NOT_ACCEPTABLE == responseInfo.result)
+    {
+        return OC_STACK_NOT_ACCEPTABLE;
     }
-#else
 
-    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
-    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint.addr);
-    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint.adapter);
-    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo.result);
-    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo.info.resourceUri);
+    encoded->payload = responseInfo.info.payload;
+    encoded->payloadSize = responseInfo.info.payloadSize;
+    encoded->payloadFormat = responseInfo.info.payloadFormat;
+    encoded->payloadVersion = responseInfo.info.payloadVersion;
+    return OC_STACK_OK;
+}
 
-    result = OCSendResponse(&responseEndpoint, &responseInfo);
-#endif
+OCStackResult HandleEncodedResponse(OCServerRequest *serverRequest, OCEntityHandlerResult ehResult,
+                                    const OCEncodedPayload *encoded)
+{
+    if (!serverRequest || !encoded)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
+    CAResponseInfo_t responseInfo = {.result = CA_EMPTY};
+    char rspToken[CA_MAX_TOKEN_LEN + 1] = {0};
+
+    CopyDevAddrToEndpoint(&serverRequest->devAddr, &responseEndpoint);
+
+    OCStackResult result = InitResponseInfo(serverRequest, ehResult, NULL, 0,
+                                            &responseInfo, rspToken);
+    if (OC_STACK_OK != result)
+    {
+        return result;
+    }
+
+    // The payload is only read while the response is cloned for sending.
+    responseInfo.info.payload = encoded->payload;
+    responseInfo.info.payloadSize = encoded->payloadSize;
+    responseInfo.info.payloadFormat = encoded->payloadFormat;
+    responseInfo.info.payloadVersion = encoded->payloadVersion;
+
+    result = SendResponseToEndpoint(&responseEndpoint, &responseInfo);
 
-    OICFree(responseInfo.info.payload);
     OICFree(responseInfo.info.options);
-    //Delete the request
     DeleteServerRequest(serverRequest);
     return result;
 }
@@ -53,6 +53,8 @@
 #include "ocrandom.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
+#include "octhread.h"
 #include "logger.h"
 #include "trace.h"
 #include "ocserverrequest.h"
@@ -71,6 +73,7 @@
 #include "ocatomic.h"
 #include "platform_features.h"
 #include "oic_platform.h"
+#include "uhashmap.h"
 
 #if defined(TCP_ADAPTER) && defined(WITH_CLOUD)
 #include "occonnectionmanager.h"
@@ -136,6 +139,9 @@ static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
 OCResource *headResource = NULL;
 static OCResource *tailResource = NULL;
+// Indexes over the resource list, kept in sync by insertResource()/deleteResource().
+static u_hashmap_t *g_resourceUriIndex = NULL;
+static u_hashmap_t *g_resourceHandleIndex = NULL;
 static OCResourceHandle platformResource = {0};
 static OCResourceHandle deviceResource = {0};
 static OCResourceHandle introspectionResource = {0};
@@ -167,6 +173,7 @@ CAAdapterStateChangedCB g_adapterHandler = NULL;
 CAConnectionStateChangedCB g_connectionHandler = NULL;
 // Persistent Storage callback handler for open/read/write/close/unlink
 static OCPersistentStorage *g_PersistentStorageHandler = NULL;
+static OCPersistentStorageRename g_PersistentStorageRename = NULL;
 // Number of users of OCStack, based on the successful calls to OCInit2 prior to OCStop
 // The variable must not be declared static because it is also referenced by the unit test
 uint32_t g_ocStackStartCount = 0;
@@ -175,6 +182,12 @@ volatile int32_t g_ocStackStartStopThreadCount = 0;
 
 bool g_multicastServerStopped = false;
 
+// Lets a thread calling OCProcess() sleep in OCWaitForProcess() until OCWakeUpProcess().
+// Kept for the life of the process so that waking up never races with OCStop().
+static oc_mutex g_processMutex = NULL;
+static oc_cond g_processCond = NULL;
+static bool g_processWakeUp = false;
+
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
@@ -216,11 +229,13 @@ static OCDoHandle GenerateInvocationHandle();
 static OCStackResult initResources();
 
 /**
- * Add a resource to the end of the linked list of resources.
+ * Add a resource to the end of the linked list of resources and to the resource indexes.
+ * The uri of the resource must be set before it is inserted.
  *
  * @param resource Resource to be added
+ * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static void insertResource(OCResource *resource);
+static OCStackResult insertResource(OCResource *resource);
 
 /**
  * Find a resource in the linked list of resources.
@@ -427,14 +442,6 @@ static OCStackResult ResetPresenceTTL(ClientCB *cbNode, uint32_t maxAgeSeconds);
  */
 static OCStackResult OCSendRequest(const CAEndpoint_t *object, CARequestInfo_t *requestInfo);
 
-/**
- * default adapter state change callback method
- *
- * @param adapter   CA network adapter type.
- * @param enabled   current adapter state.
- */
-static void OCDefaultAdapterStateChangedHandler(CATransportAdapter_t adapter, bool enabled);
-
 /**
  * default connection state change callback method
  *
@@ -1385,6 +1392,30 @@ exit:
     return result;
 }
 
+/**
+ * Checks whether requestUri asks for the batch interface, whose responses
+ * HandleBatchResponse rewrites.
+ */
+static bool IsBatchRequestUri(const char *requestUri)
+{
+    bool isBatch = false;
+    char *interfaceName = NULL;
+    char *rtTypeName = NULL;
+    char *uriQuery = NULL;
+    char *uriWithoutQuery = NULL;
+    if (requestUri &&
+        OC_STACK_OK == getQueryFromUri(requestUri, &uriQuery, &uriWithoutQuery) && uriQuery &&
+        OC_STACK_OK == ExtractFiltersFromQuery(uriQuery, &interfaceName, &rtTypeName))
+    {
+        isBatch = interfaceName && (0 == strcmp(OC_RSRVD_INTERFACE_BATCH, interfaceName));
+    }
+    OICFree(interfaceName);
+    OICFree(rtTypeName);
+    OICFree(uriQuery);
+    OICFree(uriWithoutQuery);
+    return isBatch;
+}
+
 OCStackResult HandleBatchResponse(char *requestUri, OCRepPayload **payload)
 {
     if (requestUri && *payload)
@@ -1823,8 +1854,24 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                     return;
                 }
 
+                response->rawPayload = responseInfo->info.payload;
+                response->rawPayloadSize = responseInfo->info.payloadSize;
+                response->payloadFormat = CAToOCPayloadFormat(responseInfo->info.payloadFormat);
+
+                // The callback decodes a single representation itself.
+                OCRepPayloadView view;
+                bool lazy = cbNode->lazyPayload && PAYLOAD_TYPE_REPRESENTATION == type &&
+                        OC_FORMAT_CBOR == response->payloadFormat &&
+                        !IsBatchRequestUri(cbNode->requestUri) &&
+                        OC_STACK_OK == OCRepPayloadViewInit(&view, response->rawPayload,
+                                                            response->rawPayloadSize);
+
                 // In case of error, still want application to receive the error message.
-                if (OCResultToSuccess(response->result) || PAYLOAD_TYPE_REPRESENTATION == type ||
+                if (lazy)
+                {
+                    OIC_LOG(DEBUG, TAG, "Passing representation undecoded");
+                }
+                else if (OCResultToSuccess(response->result) || PAYLOAD_TYPE_REPRESENTATION == type ||
                         PAYLOAD_TYPE_DIAGNOSTIC == type)
                 {
                     if (OC_STACK_OK != OCParsePayload(&response->payload,
@@ -1963,8 +2010,8 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    UpdateClientCBTTL(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                       MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -2085,6 +2132,9 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
 
     OCHandleResponse(endPoint, responseInfo);
 
+    // Presence responses move the presence timeouts.
+    OCWakeUpProcess();
+
     OIC_LOG(INFO, TAG, "Exit HandleCAResponses");
     OIC_TRACE_END();
 }
@@ -2747,6 +2797,9 @@ OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFlags,
       OCDefaultAdapterStateChangedHandler, OCDefaultConnectionStateChangedHandler));
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
+    // Received data waits for OCProcess(), wake it up instead of polling.
+    CARegisterReceiveQueueHandler(OCWakeUpProcess);
+
     switch (myStackMode)
     {
         case OC_CLIENT:
@@ -2779,6 +2832,22 @@ OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFlags,
     PresenceTimeOutSize = sizeof (PresenceTimeOut) / sizeof (PresenceTimeOut[0]) - 1;
 #endif // WITH_PRESENCE
 
+    if (!g_processMutex)
+    {
+        g_processMutex = oc_mutex_new();
+        g_processCond = oc_cond_new();
+        if (!g_processMutex || !g_processCond)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create process wait objects");
+            oc_mutex_free(g_processMutex);
+            oc_cond_free(g_processCond);
+            g_processMutex = NULL;
+            g_processCond = NULL;
+            result = OC_STACK_NO_MEMORY;
+            goto exit;
+        }
+    }
+
     //Update Stack state to initialized
     stackState = OC_STACK_INITIALIZED;
 
@@ -2890,6 +2959,11 @@ OCStackResult OCDeInitializeInternal()
     DeleteObserverList();
     // Free memory dynamically allocated for resources
     deleteAllResources();
+    DeleteDiscoveryCache();
+#ifdef RD_SERVER
+    // Close the connection used to discover resources in the RD database
+    OCRDDatabaseDiscoveryClose();
+#endif
     // Remove all the client callbacks
     DeleteClientCBList();
     // Terminate connectivity-abstraction layer.
@@ -3242,6 +3316,23 @@ OCStackResult OCDoRequest(OCDoHandle *handle,
                             OCCallbackData *cbData,
                             OCHeaderOption *options,
                             uint8_t numOptions)
+{
+    return OCDoRequestWithFlags(handle, method, requestUri, destination, payload,
+                                connectivityType, qos, cbData, options, numOptions,
+                                OC_DO_REQUEST_DEFAULT);
+}
+
+OCStackResult OCDoRequestWithFlags(OCDoHandle *handle,
+                                   OCMethod method,
+                                   const char *requestUri,
+                                   const OCDevAddr *destination,
+                                   OCPayload* payload,
+                                   OCConnectivityType connectivityType,
+                                   OCQualityOfService qos,
+                                   OCCallbackData *cbData,
+                                   OCHeaderOption *options,
+                                   uint8_t numOptions,
+                                   OCDoRequestFlags requestFlags)
 {
     OIC_LOG(INFO, TAG, "Entering OCDoResource");
 
@@ -3504,6 +3595,12 @@ OCStackResult OCDoRequest(OCDoHandle *handle,
     resourceUri = NULL;   // Client CB list entry now owns it
     resourceType = NULL;  // Client CB list entry now owns it
 
+    // Set before the request goes out, so that it applies to every response.
+    clientCB->lazyPayload = (0 != (requestFlags & OC_DO_REQUEST_LAZY_PAYLOAD));
+
+    // The new callback may time out before the current wait ends.
+    OCWakeUpProcess();
+
 #ifdef WITH_PRESENCE
     if (method == OC_REST_PRESENCE)
     {
@@ -3728,6 +3825,17 @@ OCPersistentStorage *OCGetPersistentStorageHandler()
     return g_PersistentStorageHandler;
 }
 
+OCStackResult OCRegisterPersistentStorageRename(OCPersistentStorageRename renameHandler)
+{
+    g_PersistentStorageRename = renameHandler;
+    return OC_STACK_OK;
+}
+
+OCPersistentStorageRename OCGetPersistentStorageRename()
+{
+    return g_PersistentStorageRename;
+}
+
 #ifdef WITH_PRESENCE
 
 OCStackResult OCProcessPresence()
@@ -3773,6 +3881,8 @@ OCStackResult OCProcessPresence()
             clientResponse.devAddr = *cbNode->devAddr;
             FixUpClientResponse(&clientResponse);
             clientResponse.payload = NULL;
+            clientResponse.rawPayload = NULL;
+            clientResponse.rawPayloadSize = 0;
 
             // Increment the TTLLevel (going to a next state), so we don't keep
             // sending presence notification to client.
@@ -3837,6 +3947,7 @@ OCStackResult OCProcess()
     OCProcessPresence();
 #endif
     CAHandleRequestResponse();
+    DeleteTimedOutClientCBs();
 
 #ifdef ROUTING_GATEWAY
     RMProcess();
@@ -3848,6 +3959,106 @@ OCStackResult OCProcess()
     return OC_STACK_OK;
 }
 
+/**
+ * Milliseconds from now until the coap tick deadline, rounded up, at most maxTimeoutMs.
+ */
+static uint32_t TicksToTimeout(uint32_t deadline, uint32_t now, uint32_t maxTimeoutMs)
+{
+    if (deadline <= now)
+    {
+        return 0;
+    }
+    uint64_t timeout = ((uint64_t)(deadline - now) * MILLISECONDS_PER_SECOND
+                        + COAP_TICKS_PER_SECOND - 1) / COAP_TICKS_PER_SECOND;
+    return (timeout < maxTimeoutMs) ? (uint32_t)timeout : maxTimeoutMs;
+}
+
+uint32_t OCGetProcessTimeout(uint32_t maxTimeoutMs)
+{
+    if (stackState != OC_STACK_INITIALIZED)
+    {
+        return maxTimeoutMs;
+    }
+
+    uint32_t timeout = maxTimeoutMs;
+    uint32_t now = GetTicks(0);
+
+    // DeleteTimedOutClientCBs() deletes a callback once its TTL has passed.
+    uint32_t ttl = 0;
+    if (GetEarliestClientCBTTL(&ttl) && ttl < UINT32_MAX)
+    {
+        timeout = TicksToTimeout(ttl + 1, now, timeout);
+    }
+
+#ifdef WITH_PRESENCE
+    ClientCB *cbNode = NULL;
+    LL_FOREACH(cbList, cbNode)
+    {
+        if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence
+            || !cbNode->presence->timeOut)
+        {
+            continue;
+        }
+        if (cbNode->presence->TTLlevel == PresenceTimeOutSize)
+        {
+            // OCProcessPresence() has a presence timeout to report.
+            return 0;
+        }
+        if (cbNode->presence->TTLlevel < PresenceTimeOutSize)
+        {
+            timeout = TicksToTimeout(cbNode->presence->timeOut[cbNode->presence->TTLlevel],
+                                     now, timeout);
+        }
+    }
+#endif
+
+#ifdef ROUTING_GATEWAY
+    // Routing manager timers count in seconds and are not tracked here.
+    if (timeout > MILLISECONDS_PER_SECOND)
+    {
+        timeout = MILLISECONDS_PER_SECOND;
+    }
+#endif
+
+#ifdef TCP_ADAPTER
+    timeout = GetKeepAliveTimeout(timeout);
+#endif
+    return timeout;
+}
+
+OCStackResult OCWaitForProcess(uint32_t timeoutMs)
+{
+    if (!g_processMutex)
+    {
+        OIC_LOG(ERROR, TAG, "OCWaitForProcess has failed. ocstack is not initialized");
+        return OC_STACK_ERROR;
+    }
+
+    oc_mutex_lock(g_processMutex);
+    // A wait of 0 microseconds would never time out.
+    if (!g_processWakeUp && timeoutMs > 0)
+    {
+        oc_cond_wait_for(g_processCond, g_processMutex, (uint64_t)timeoutMs * US_PER_MS);
+    }
+    g_processWakeUp = false;
+    oc_mutex_unlock(g_processMutex);
+    return OC_STACK_OK;
+}
+
+void OCWakeUpProcess()
+{
+    if (!g_processMutex)
+    {
+        return;
+    }
+
+    oc_mutex_lock(g_processMutex);
+    g_processWakeUp = true;
+    // The client and server wrappers may both be waiting.
+    oc_cond_broadcast(g_processCond);
+    oc_mutex_unlock(g_processMutex);
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OCStartPresence(const uint32_t ttl)
 {
@@ -4042,39 +4253,34 @@ OCStackResult OCCreateResourceWithEp(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    if (OCGetResourceHandleAtUri(uri))
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
     if (!pointer)
     {
-        result = OC_STACK_NO_MEMORY;
-        goto exit;
+        return OC_STACK_NO_MEMORY;
     }
     pointer->sequenceNum = OC_OFFSET_SEQUENCE_NUMBER;
 
-    insertResource(pointer);
-
     // Set the uri
     pointer->uri = OICStrdup(uri);
     if (!pointer->uri)
     {
-        result = OC_STACK_NO_MEMORY;
-        goto exit;
+        OICFree(pointer);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    result = insertResource(pointer);
+    if (result != OC_STACK_OK)
+    {
+        OICFree(pointer->uri);
+        OICFree(pointer);
+        return result;
     }
 
     // Set properties.  Set OC_ACTIVE
@@ -4463,6 +4669,7 @@ OCStackResult BindTpsTypeToResource(OCResource* resource,
 
     OIC_LOG_V(INFO, TAG, "Binding %d TPS flags to %s", supportedTps, resource->uri);
     resource->endpointType = supportedTps;
+    InvalidateDiscoveryCache();
     return result;
 }
 
@@ -4604,6 +4811,7 @@ OCStackResult OCSetResourceProperties(OCResourceHandle handle, uint8_t resourceP
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties | resourceProperties);
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 
@@ -4618,6 +4826,7 @@ OCStackResult OCClearResourceProperties(OCResourceHandle handle, uint8_t resourc
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties & ~resourceProperties);
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 
@@ -4919,6 +5128,28 @@ OCStackResult OCDoResponse(OCEntityHandlerResponse *ehResponse)
     return result;
 }
 
+OCStackResult OCDeferResponse(OCRequestHandle requestHandle)
+{
+    VERIFY_NON_NULL(requestHandle, ERROR, OC_STACK_INVALID_PARAM);
+
+    OCServerRequest *serverRequest = GetServerRequestUsingHandle((OCServerRequest *)requestHandle);
+    if (!serverRequest)
+    {
+        OIC_LOG(ERROR, TAG, "Request to defer not found");
+        return OC_STACK_INVALID_REQUEST_HANDLE;
+    }
+
+    // A notification is sent before OCNotifyAllObservers() returns.
+    if (serverRequest->notificationFlag)
+    {
+        return OC_STACK_NOT_ACCEPTABLE;
+    }
+
+    // Set before the entity handler returns, in case the response is sent first.
+    serverRequest->slowFlag = 1;
+    return OC_STACK_OK;
+}
+
 //#ifdef DIRECT_PAIRING
 const OCDPDev_t* OCDiscoverDirectPairingDevices(unsigned short waittime)
 {
@@ -4999,6 +5230,7 @@ OCStackResult OCChangeResourceProperty(OCResourceProperty * inputProperty,
     {
         *inputProperty = (OCResourceProperty) (*inputProperty | resourceProperties);
     }
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 #endif
@@ -5150,8 +5382,45 @@ OCStackResult initResources()
     return result;
 }
 
-void insertResource(OCResource *resource)
+/**
+ * Length of the part of a URI the resource URI index is keyed on. URIs are compared up to
+ * MAX_URI_LENGTH characters, so every lookup and update of the index has to use this.
+ */
+static size_t resourceUriKeyLength(const char *uri)
+{
+    return strnlen(uri, MAX_URI_LENGTH);
+}
+
+OCStackResult insertResource(OCResource *resource)
 {
+    InvalidateDiscoveryCache();
+    if (!g_resourceUriIndex)
+    {
+        g_resourceUriIndex = u_hashmap_create(0);
+    }
+    if (!g_resourceHandleIndex)
+    {
+        g_resourceHandleIndex = u_hashmap_create(0);
+    }
+    if (!g_resourceUriIndex || !g_resourceHandleIndex)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create resource index");
+        return OC_STACK_NO_MEMORY;
+    }
+
+    if (!u_hashmap_put(g_resourceUriIndex, resource->uri,
+                       resourceUriKeyLength(resource->uri), resource))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to index resource uri");
+        return OC_STACK_NO_MEMORY;
+    }
+    if (!u_hashmap_put(g_resourceHandleIndex, &resource, sizeof(resource), resource))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to index resource handle");
+        u_hashmap_remove(g_resourceUriIndex, resource->uri, resourceUriKeyLength(resource->uri));
+        return OC_STACK_NO_MEMORY;
+    }
+
     if (!headResource)
     {
         headResource = resource;
@@ -5163,21 +5432,12 @@ void insertResource(OCResource *resource)
         tailResource = resource;
     }
     resource->next = NULL;
+    return OC_STACK_OK;
 }
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
-
-    while (pointer)
-    {
-        if (pointer == resource)
-        {
-            return resource;
-        }
-        pointer = pointer->next;
-    }
-    return NULL;
+    return (OCResource *) u_hashmap_get(g_resourceHandleIndex, &resource, sizeof(resource));
 }
 
 void deleteAllResources()
@@ -5213,6 +5473,9 @@ void deleteAllResources()
     deleteResource((OCResource *) presenceResource.handle);
     memset(&presenceResource, 0, sizeof(presenceResource));
 #endif // WITH_PRESENCE
+
+    u_hashmap_free(&g_resourceUriIndex);
+    u_hashmap_free(&g_resourceHandleIndex);
 }
 
 OCStackResult deleteResource(OCResource *resource)
@@ -5226,6 +5489,12 @@ OCStackResult deleteResource(OCResource *resource)
     }
 
     OIC_LOG_V (INFO, TAG, "Deleting resource %s", resource->uri);
+    InvalidateDiscoveryCache();
+
+    if (!findResource(resource))
+    {
+        return OC_STACK_ERROR;
+    }
 
     temp = headResource;
     while (temp)
@@ -5248,6 +5517,9 @@ OCStackResult deleteResource(OCResource *resource)
                 SendPresenceNotification(resource->rsrcType, OC_PRESENCE_TRIGGER_DELETE);
             }
 #endif
+            // The observers have been notified and cannot outlive the resource.
+            DeleteResourceObservers(temp);
+
             // Only resource in list.
             if (temp == headResource && temp == tailResource)
             {
@@ -5270,6 +5542,9 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            u_hashmap_remove(g_resourceUriIndex, temp->uri, resourceUriKeyLength(temp->uri));
+            u_hashmap_remove(g_resourceHandleIndex, &temp, sizeof(temp));
+
             deleteResourceElements(temp);
             OICFree(temp);
             temp = NULL;
@@ -5369,6 +5644,8 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
 {
     OCResourceType *pointer = NULL;
     OCResourceType *previous = NULL;
+
+    InvalidateDiscoveryCache();
     if (!resource || !resourceType)
     {
         return;
@@ -5464,6 +5741,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
     OCResourceInterface *previous = NULL;
 
     newInterface->next = NULL;
+    InvalidateDiscoveryCache();
 
     OCResourceInterface **firstInterface = &(resource->rsrcInterface);
 
@@ -5930,18 +6208,13 @@ OCResourceHandle OCGetResourceHandleAtUri(const char *uri)
         return NULL;
     }
 
-    OCResource *pointer = headResource;
-
-    while (pointer)
+    OCResource *pointer = (OCResource *) u_hashmap_get(g_resourceUriIndex, uri,
+                                                       resourceUriKeyLength(uri));
+    if (pointer)
     {
-        if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-        {
-            OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
     }
-    return NULL;
+    return pointer;
 }
 
 OCStackResult OCSetHeaderOption(OCHeaderOption* ocHdrOpt, size_t* numOptions, uint16_t optionID,
@@ -6028,6 +6301,8 @@ OCStackResult OCGetHeaderOption(OCHeaderOption* ocHdrOpt, size_t numOptions,
 void OCDefaultAdapterStateChangedHandler(CATransportAdapter_t adapter, bool enabled)
 {
     OIC_LOG(DEBUG, TAG, "OCDefaultAdapterStateChangedHandler");
+    // Endpoints in cached discovery responses may be gone
+    InvalidateDiscoveryCache();
     if (g_adapterHandler)
     {
         g_adapterHandler(adapter, enabled);
@@ -618,6 +618,48 @@ void ProcessKeepAlive()
     }
 }
 
+uint32_t GetKeepAliveTimeout(uint32_t maxTimeoutMs)
+{
+    if (!g_isKeepAliveInitialized)
+    {
+        return maxTimeoutMs;
+    }
+
+    uint64_t timeout = (uint64_t)maxTimeoutMs * US_PER_MS;
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+    size_t len = u_arraylist_length(g_keepAliveConnectionTable);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        KeepAliveEntry_t *entry = (KeepAliveEntry_t *)u_arraylist_get(g_keepAliveConnectionTable,
+                                                                      i);
+        if (NULL == entry)
+        {
+            continue;
+        }
+
+        // Same deadlines as ProcessKeepAlive.
+        uint64_t period = entry->interval * KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+        if (OC_CLIENT == entry->mode && entry->sentPingMsg)
+        {
+            period = KEEPALIVE_RESPONSE_TIMEOUT_SEC * USECS_PER_SEC;
+        }
+
+        uint64_t elapsed = currentTime - entry->timeStamp;
+        if (elapsed >= period)
+        {
+            return 0;
+        }
+        if (period - elapsed < timeout)
+        {
+            timeout = period - elapsed;
+        }
+    }
+
+    // Round up so that the deadline has passed when ProcessKeepAlive runs.
+    return (uint32_t)((timeout + US_PER_MS - 1) / US_PER_MS);
+}
+
 void IncreaseInterval(KeepAliveEntry_t *entry)
 {
     VERIFY_NON_NULL_NR(entry, FATAL);
@@ -18,6 +18,7 @@
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
+#include <inttypes.h>
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,12 +29,14 @@
 
 #include "octypes.h"
 #include "ocstack.h"
+#include "ocstackinternal.h"
 #include "ocrandom.h"
 #include "logger.h"
 #include "ocpayload.h"
 #include "ocendpoint.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "utlist.h"
 
 #define TAG "OIC_RI_RESOURCEDIRECTORY"
 
@@ -51,23 +54,62 @@ static const char *gRDPath = "RD.db";
 
 static sqlite3 *gRDDB = NULL;
 
-/* Column indices of RD_DEVICE_LINK_LIST table */
-static const uint8_t ins_index = 0;
-static const uint8_t href_index = 1;
-static const uint8_t rel_index = 2;
-static const uint8_t anchor_index = 3;
-static const uint8_t bm_index = 4;
-static const uint8_t d_index = 5;
+/* Column indices of the discovery query */
+static const uint8_t device_index = 0;
+static const uint8_t ins_index = 1;
+static const uint8_t kind_index = 2;
+static const uint8_t value_index = 4;
+static const uint8_t pri_index = 5;
+static const uint8_t di_index = 6;
+static const uint8_t href_index = 7;
+static const uint8_t rel_index = 8;
+static const uint8_t anchor_index = 9;
+static const uint8_t bm_index = 10;
+
+/* Kinds of rows of the discovery query, in the order they are returned for a link */
+typedef enum
+{
+    RD_ROW_LINK = 0,
+    RD_ROW_RT,
+    RD_ROW_IF,
+    RD_ROW_EP
+} RDRowKind;
+
+/* How a query parameter is matched */
+typedef enum
+{
+    RD_MATCH_NONE = 0,
+    RD_MATCH_EXACT,
+    RD_MATCH_LIKE,
+    RD_MATCH_COUNT
+} RDMatch;
+
+/* Discovery statements by resource type and interface match, kept until the database is closed */
+static sqlite3_stmt *gRDDiscoveryStmt[RD_MATCH_COUNT][RD_MATCH_COUNT];
 
-/* Column indices of RD_LINK_RT table */
-static const uint8_t rt_value_index = 0;
+/* Maximum number of queries whose discovery results are cached */
+#define RD_DISCOVERY_CACHE_SIZE 16
+
+/* Discovery result of a query, kept until the RD database changes */
+typedef struct RDDiscoveryCacheEntry
+{
+    char *interfaceType;
+    char *resourceType;
+    OCStackResult result;
+    OCDiscoveryPayload *payload;
+    struct RDDiscoveryCacheEntry *next;
+} RDDiscoveryCacheEntry;
 
-/* Column indices of RD_LINK_IF table */
-static const uint8_t if_value_index = 0;
+/* Cached discovery results, most recently used first */
+static RDDiscoveryCacheEntry *gRDDiscoveryCache = NULL;
+static size_t gRDDiscoveryCacheCount = 0;
 
-/* Column indices of RD_LINK_EP table */
-static const uint8_t ep_value_index = 0;
-static const uint8_t pri_value_index = 1;
+/* Reads the data_version of the discovery connection */
+static sqlite3_stmt *gRDDataVersionStmt = NULL;
+/* data_version the cached results were read at */
+static int gRDDataVersion = -1;
+/* Incremented whenever the cached results are dropped */
+static uint32_t gRDDiscoveryGeneration = 0;
 
 #define VERIFY_SQLITE(arg) \
 if (SQLITE_OK != (arg)) \
@@ -84,6 +126,7 @@ OCStackResult OCRDDatabaseSetStorageFilename(const char *filename)
         OIC_LOG(ERROR, TAG, "The persistent storage filename is invalid");
         return OC_STACK_INVALID_PARAM;
     }
+    OCRDDatabaseDiscoveryClose();
     gRDPath = filename;
     return OC_STACK_OK;
 }
@@ -132,235 +175,315 @@ exit:
     return result;
 }
 
-/* stmt is of form "SELECT * FROM RD_DEVICE_LINK_LIST ..." */
-static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayload *discPayload)
+void OCRDDatabaseDiscoveryClose()
 {
-    int res = sqlite3_step(stmt);
-    if (SQLITE_ROW != res)
+    OCRDDatabaseDiscoveryInvalidate();
+    sqlite3_finalize(gRDDataVersionStmt);
+    gRDDataVersionStmt = NULL;
+    gRDDataVersion = -1;
+    for (size_t i = 0; i < RD_MATCH_COUNT; i++)
     {
-        return OC_STACK_NO_RESOURCE;
+        for (size_t j = 0; j < RD_MATCH_COUNT; j++)
+        {
+            sqlite3_finalize(gRDDiscoveryStmt[i][j]);
+            gRDDiscoveryStmt[i][j] = NULL;
+        }
     }
+    sqlite3_close(gRDDB);
+    gRDDB = NULL;
+}
 
+/*
+ * Queries without wildcards are matched exactly so that the indexes on the resource type
+ * and interface columns can be used.
+ */
+static RDMatch GetQueryMatch(const char *query)
+{
+    if (!query)
+    {
+        return RD_MATCH_NONE;
+    }
+    return strpbrk(query, "%_") ? RD_MATCH_LIKE : RD_MATCH_EXACT;
+}
+
+/*
+ * Prepares the discovery query for the given matches, or resets the one prepared before.
+ *
+ * The query returns the matching links of all devices but this server ordered by device and
+ * link. Each link is a RD_ROW_LINK row followed by a row for each of its resource types,
+ * interfaces and endpoints, so the whole discovery payload is built from a single query.
+ */
+static int GetDiscoveryStatement(RDMatch rtMatch, RDMatch itfMatch, sqlite3_stmt **stmt)
+{
+    if (gRDDiscoveryStmt[rtMatch][itfMatch])
+    {
+        *stmt = gRDDiscoveryStmt[rtMatch][itfMatch];
+        sqlite3_reset(*stmt);
+        return sqlite3_clear_bindings(*stmt);
+    }
+
+    static const char pre[] = "WITH matches AS ("
+        "SELECT DISTINCT RD_DEVICE_LINK_LIST.ins AS ins, RD_DEVICE_LINK_LIST.DEVICE_ID AS dev "
+        "FROM RD_DEVICE_LINK_LIST "
+        "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID ";
+    static const char rtJoin[] =
+        "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.ins=RD_LINK_RT.LINK_ID ";
+    static const char itfJoin[] =
+        "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.ins=RD_LINK_IF.LINK_ID ";
+    static const char where[] = "WHERE RD_DEVICE_LIST.di<>@serverId ";
+    static const char rtExact[] = "AND RD_LINK_RT.rt=@resourceType ";
+    static const char rtLike[] = "AND RD_LINK_RT.rt LIKE @resourceType ";
+    static const char itfExact[] = "AND RD_LINK_IF.if=@interfaceType ";
+    static const char itfLike[] = "AND RD_LINK_IF.if LIKE @interfaceType ";
+    static const char post[] = ") "
+        "SELECT matches.dev, matches.ins, 0, 0, NULL, NULL, RD_DEVICE_LIST.di, "
+        "RD_DEVICE_LINK_LIST.href, RD_DEVICE_LINK_LIST.rel, RD_DEVICE_LINK_LIST.anchor, "
+        "RD_DEVICE_LINK_LIST.bm FROM matches "
+        "INNER JOIN RD_DEVICE_LINK_LIST ON RD_DEVICE_LINK_LIST.ins=matches.ins "
+        "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LIST.ID=matches.dev "
+        "UNION ALL SELECT matches.dev, matches.ins, 1, RD_LINK_RT.rowid, RD_LINK_RT.rt, "
+        "NULL, NULL, NULL, NULL, NULL, NULL FROM matches "
+        "INNER JOIN RD_LINK_RT ON RD_LINK_RT.LINK_ID=matches.ins "
+        "UNION ALL SELECT matches.dev, matches.ins, 2, RD_LINK_IF.rowid, RD_LINK_IF.if, "
+        "NULL, NULL, NULL, NULL, NULL, NULL FROM matches "
+        "INNER JOIN RD_LINK_IF ON RD_LINK_IF.LINK_ID=matches.ins "
+        "UNION ALL SELECT matches.dev, matches.ins, 3, RD_LINK_EP.rowid, RD_LINK_EP.ep, "
+        "RD_LINK_EP.pri, NULL, NULL, NULL, NULL, NULL FROM matches "
+        "INNER JOIN RD_LINK_EP ON RD_LINK_EP.LINK_ID=matches.ins "
+        "ORDER BY 1, 2, 3, 4";
+
+    char input[sizeof(pre) + sizeof(rtJoin) + sizeof(itfJoin) + sizeof(where) +
+               sizeof(rtLike) + sizeof(itfLike) + sizeof(post)] = { 0 };
+    OICStrcat(input, sizeof(input), pre);
+    if (RD_MATCH_NONE != rtMatch)
+    {
+        OICStrcat(input, sizeof(input), rtJoin);
+    }
+    if (RD_MATCH_NONE != itfMatch)
+    {
+        OICStrcat(input, sizeof(input), itfJoin);
+    }
+    OICStrcat(input, sizeof(input), where);
+    if (RD_MATCH_NONE != rtMatch)
+    {
+        OICStrcat(input, sizeof(input), (RD_MATCH_LIKE == rtMatch) ? rtLike : rtExact);
+    }
+    if (RD_MATCH_NONE != itfMatch)
+    {
+        OICStrcat(input, sizeof(input), (RD_MATCH_LIKE == itfMatch) ? itfLike : itfExact);
+    }
+    OICStrcat(input, sizeof(input), post);
+
+    int res = sqlite3_prepare_v2(gRDDB, input, -1, &gRDDiscoveryStmt[rtMatch][itfMatch], NULL);
+    *stmt = gRDDiscoveryStmt[rtMatch][itfMatch];
+    return res;
+}
+
+/* stmt is the discovery query, see GetDiscoveryStatement() */
+static OCStackResult DiscoveryPayloadCreate(sqlite3_stmt *stmt, OCDiscoveryPayload **payload)
+{
     OCStackResult result;
+    OCDiscoveryPayload **tail = payload;
+    OCDiscoveryPayload *discPayload = NULL;
+    sqlite3_int64 discDevice = 0;
+    OCResourcePayload **resourceTail = NULL;
     OCResourcePayload *resourcePayload = NULL;
+    sqlite3_int64 resourceIns = 0;
+    OCEndpointPayload **epTail = NULL;
     OCEndpointPayload *epPayload = NULL;
-    sqlite3_stmt *stmtRT = NULL;
-    sqlite3_stmt *stmtIF = NULL;
-    sqlite3_stmt *stmtEP = NULL;
-    sqlite3_stmt *stmtDI = NULL;
-    while (SQLITE_ROW == res)
-    {
-        resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
-        VERIFY_NON_NULL(resourcePayload);
-
-        sqlite3_int64 id = sqlite3_column_int64(stmt, ins_index);
-        const unsigned char *uri = sqlite3_column_text(stmt, href_index);
-        const unsigned char *rel = sqlite3_column_text(stmt, rel_index);
-        const unsigned char *anchor = sqlite3_column_text(stmt, anchor_index);
-        sqlite3_int64 bitmap = sqlite3_column_int64(stmt, bm_index);
-        sqlite3_int64 deviceId = sqlite3_column_int64(stmt, d_index);
-        OIC_LOG_V(DEBUG, TAG, " %s %" PRId64, uri, (int64_t) deviceId);
-
-        resourcePayload->uri = OICStrdup((char *)uri);
-        VERIFY_NON_NULL(resourcePayload->uri)
-        if (rel)
-        {
-            resourcePayload->rel = OICStrdup((char *)rel);
-            VERIFY_NON_NULL(resourcePayload->rel);
-        }
-        if (anchor)
-        {
-            resourcePayload->anchor = OICStrdup((char *)anchor);
-            VERIFY_NON_NULL(resourcePayload->anchor);
-        }
 
-        const char rt[] = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=@id";
-        int rtSize = (int)sizeof(rt);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, rtSize, &stmtRT, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtRT, sqlite3_bind_parameter_index(stmtRT, "@id"), id));
-        while (SQLITE_ROW == sqlite3_step(stmtRT))
-        {
-            const unsigned char *tempRt = sqlite3_column_text(stmtRT, rt_value_index);
-            result = appendStringLL(&resourcePayload->types, tempRt);
-            if (OC_STACK_OK != result)
-            {
-                goto exit;
-            }
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtRT));
-        stmtRT = NULL;
-
-        const char itf[] = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=@id";
-        int itfSize = (int)sizeof(itf);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, itfSize, &stmtIF, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtIF, sqlite3_bind_parameter_index(stmtIF, "@id"), id));
-        while (SQLITE_ROW == sqlite3_step(stmtIF))
+    int res;
+    while (SQLITE_ROW == (res = sqlite3_step(stmt)))
+    {
+        sqlite3_int64 device = sqlite3_column_int64(stmt, device_index);
+        sqlite3_int64 ins = sqlite3_column_int64(stmt, ins_index);
+        int kind = sqlite3_column_int(stmt, kind_index);
+        if (RD_ROW_LINK == kind)
         {
-            const unsigned char *tempItf = sqlite3_column_text(stmtIF, if_value_index);
-            result = appendStringLL(&resourcePayload->interfaces, tempItf);
-            if (OC_STACK_OK != result)
+            if (!discPayload || discDevice != device)
             {
-                goto exit;
+                const unsigned char *di = sqlite3_column_text(stmt, di_index);
+                OIC_LOG_V(DEBUG, TAG, " %s", di);
+                discPayload = OCDiscoveryPayloadCreate();
+                VERIFY_NON_NULL(discPayload);
+                *tail = discPayload;
+                tail = &discPayload->next;
+                discPayload->sid = OICStrdup((const char *)di);
+                VERIFY_NON_NULL(discPayload->sid);
+                discDevice = device;
+                resourceTail = &discPayload->resources;
             }
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtIF));
-        stmtIF = NULL;
-
-        resourcePayload->bitmap = (uint8_t)(bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE));
 
-        const char ep[] = "SELECT ep,pri FROM RD_LINK_EP WHERE LINK_ID=@id";
-        int epSize = (int)sizeof(ep);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, ep, epSize, &stmtEP, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtEP, sqlite3_bind_parameter_index(stmtEP, "@id"), id));
-        while (SQLITE_ROW == sqlite3_step(stmtEP))
-        {
-            epPayload = (OCEndpointPayload *)OICCalloc(1, sizeof(OCEndpointPayload));
-            VERIFY_NON_NULL(epPayload);
-            const unsigned char *tempEp = sqlite3_column_text(stmtEP, ep_value_index);
-            result = OCParseEndpointString((const char *)tempEp, epPayload);
-            if (OC_STACK_OK != result)
+            const unsigned char *uri = sqlite3_column_text(stmt, href_index);
+            const unsigned char *rel = sqlite3_column_text(stmt, rel_index);
+            const unsigned char *anchor = sqlite3_column_text(stmt, anchor_index);
+            sqlite3_int64 bitmap = sqlite3_column_int64(stmt, bm_index);
+            OIC_LOG_V(DEBUG, TAG, " %s %" PRId64, uri, (int64_t) device);
+
+            resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
+            VERIFY_NON_NULL(resourcePayload);
+            *resourceTail = resourcePayload;
+            resourceTail = &resourcePayload->next;
+            resourceIns = ins;
+            epTail = &resourcePayload->eps;
+
+            resourcePayload->uri = OICStrdup((char *)uri);
+            VERIFY_NON_NULL(resourcePayload->uri)
+            if (rel)
             {
-                goto exit;
+                resourcePayload->rel = OICStrdup((char *)rel);
+                VERIFY_NON_NULL(resourcePayload->rel);
             }
-            sqlite3_int64 pri = sqlite3_column_int64(stmtEP, pri_value_index);
-            epPayload->pri = (uint16_t)pri;
-            OCEndpointPayload **tmp = &resourcePayload->eps;
-            while (*tmp)
+            if (anchor)
             {
-                tmp = &(*tmp)->next;
+                resourcePayload->anchor = OICStrdup((char *)anchor);
+                VERIFY_NON_NULL(resourcePayload->anchor);
             }
-            *tmp = epPayload;
-            epPayload = NULL;
+            resourcePayload->bitmap = (uint8_t)(bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE));
+            continue;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtEP));
-        stmtEP = NULL;
-
-        const char di[] = "SELECT di FROM RD_DEVICE_LIST "
-            "INNER JOIN RD_DEVICE_LINK_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=@deviceId";
-        int diSize = (int)sizeof(di);
-        const uint8_t di_index = 0;
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, di, diSize, &stmtDI, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtDI, sqlite3_bind_parameter_index(stmtDI, "@deviceId"), deviceId));
-        res = sqlite3_step(stmtDI);
-        if (SQLITE_ROW == res || SQLITE_DONE == res)
+
+        // The link row comes first, so this belongs to resourcePayload
+        if (!resourcePayload || resourceIns != ins)
         {
-            const unsigned char *tempDi = sqlite3_column_text(stmtDI, di_index);
-            OIC_LOG_V(DEBUG, TAG, " %s", tempDi);
-            discPayload->sid = OICStrdup((char *)tempDi);
-            VERIFY_NON_NULL(discPayload->sid);
+            continue;
+        }
+        const unsigned char *value = sqlite3_column_text(stmt, value_index);
+        switch (kind)
+        {
+            case RD_ROW_RT:
+                result = appendStringLL(&resourcePayload->types, value);
+                if (OC_STACK_OK != result)
+                {
+                    goto exit;
+                }
+                break;
+            case RD_ROW_IF:
+                result = appendStringLL(&resourcePayload->interfaces, value);
+                if (OC_STACK_OK != result)
+                {
+                    goto exit;
+                }
+                break;
+            case RD_ROW_EP:
+                epPayload = (OCEndpointPayload *)OICCalloc(1, sizeof(OCEndpointPayload));
+                VERIFY_NON_NULL(epPayload);
+                result = OCParseEndpointString((const char *)value, epPayload);
+                if (OC_STACK_OK != result)
+                {
+                    goto exit;
+                }
+                epPayload->pri = (uint16_t)sqlite3_column_int64(stmt, pri_index);
+                *epTail = epPayload;
+                epTail = &epPayload->next;
+                epPayload = NULL;
+                break;
+            default:
+                break;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtDI));
-        stmtDI = NULL;
-
-        OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
-        resourcePayload = NULL;
-        res = sqlite3_step(stmt);
     }
-    result = OC_STACK_OK;
+    if (SQLITE_DONE != res)
+    {
+        OIC_LOG_V(ERROR, TAG, "Error in discovery query, Error Message: %s", sqlite3_errmsg(gRDDB));
+        result = OC_STACK_ERROR;
+        goto exit;
+    }
+    result = *payload ? OC_STACK_OK : OC_STACK_NO_RESOURCE;
 
 exit:
-    sqlite3_finalize(stmtDI);
-    sqlite3_finalize(stmtEP);
-    sqlite3_finalize(stmtIF);
-    sqlite3_finalize(stmtRT);
     OICFree(epPayload);
-    OCDiscoveryResourceDestroy(resourcePayload);
     return result;
 }
 
-static OCStackResult CheckResources(const char *interfaceType, const char *resourceType,
-        OCDiscoveryPayload *discPayload)
+static OCStackResult OpenDiscoveryDatabase()
 {
-    if (!interfaceType && !resourceType)
+    if (gRDDB)
     {
-        return OC_STACK_INVALID_QUERY;
+        return OC_STACK_OK;
     }
-    if (!discPayload || !discPayload->sid)
+    if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
     {
-        return OC_STACK_INTERNAL_SERVER_ERROR;
+        OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
+    }
+    /*
+     * The connection is kept open for the prepared statements. It is not read-only so that
+     * it can checkpoint the write-ahead log of the RD server when it is the last one closed.
+     */
+    if (SQLITE_OK != sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB,
+                                     SQLITE_OPEN_READWRITE, NULL))
+    {
+        OCRDDatabaseDiscoveryClose();
+        return OC_STACK_ERROR;
+    }
+    return OC_STACK_OK;
+}
+
+static OCStackResult DiscoveryPayloadQuery(const char *interfaceType,
+        const char *resourceType,
+        OCDiscoveryPayload **payload)
+{
+    OCStackResult result;
+    OCDiscoveryPayload *head = NULL;
+    sqlite3_stmt *stmt = NULL;
+
+    if (!interfaceType && !resourceType)
+    {
+        return OC_STACK_NO_RESOURCE;
     }
 
-    size_t sidLength = strlen(discPayload->sid);
+    const char *serverID = OCGetServerInstanceIDString();
+    if (!serverID)
+    {
+        serverID = "";
+    }
+    size_t serverIDLength = strlen(serverID);
     size_t resourceTypeLength = resourceType ? strlen(resourceType) : 0;
     size_t interfaceTypeLength = interfaceType ? strlen(interfaceType) : 0;
-
-    if ((sidLength > INT_MAX) ||
+    if ((serverIDLength > INT_MAX) ||
         (resourceTypeLength > INT_MAX) ||
         (interfaceTypeLength > INT_MAX))
     {
         return OC_STACK_INVALID_QUERY;
     }
 
-    OCStackResult result = OC_STACK_OK;
-    sqlite3_stmt *stmt = NULL;
-    if (resourceType)
+    RDMatch rtMatch = GetQueryMatch(resourceType);
+    RDMatch itfMatch = GetQueryMatch(interfaceType);
+    if (interfaceType && (0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
+            0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT)))
     {
-        if (!interfaceType || 0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
-                0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_RT.rt LIKE @resourceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
-                            resourceType, (int)resourceTypeLength, SQLITE_STATIC));
-        }
-        else
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di "
-                                "AND RD_LINK_RT.rt LIKE @resourceType "
-                                "AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
-                            resourceType, (int)resourceTypeLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
-                            interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
-        }
-        result = ResourcePayloadCreate(stmt, discPayload);
+        itfMatch = RD_MATCH_NONE;
     }
-    else if (interfaceType)
+
+    result = OpenDiscoveryDatabase();
+    if (OC_STACK_OK != result)
     {
-        if (0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
-                0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-        }
-        else
-        {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
-                            interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
-        }
-        result = ResourcePayloadCreate(stmt, discPayload);
+        goto exit;
     }
 
+    VERIFY_SQLITE(GetDiscoveryStatement(rtMatch, itfMatch, &stmt));
+    VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@serverId"),
+                    serverID, (int)serverIDLength, SQLITE_STATIC));
+    if (RD_MATCH_NONE != rtMatch)
+    {
+        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
+                        resourceType, (int)resourceTypeLength, SQLITE_STATIC));
+    }
+    if (RD_MATCH_NONE != itfMatch)
+    {
+        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
+                        interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
+    }
+    result = DiscoveryPayloadCreate(stmt, &head);
+
 exit:
-    sqlite3_finalize(stmt);
+    if (OC_STACK_OK != result)
+    {
+        OCPayloadDestroy((OCPayload *) head);
+        head = NULL;
+    }
+    *payload = head;
+    // Ends the read transaction but keeps the statement prepared
+    sqlite3_reset(stmt);
     return result;
 }
 
@@ -368,11 +491,6 @@ OCStackResult OCRDDatabaseDiscoveryPayloadCreate(const char *interfaceType,
         const char *resourceType,
         OCDiscoveryPayload **payload)
 {
-    OCStackResult result;
-    OCDiscoveryPayload *head = NULL;
-    OCDiscoveryPayload **tail = &head;
-    sqlite3_stmt *stmt = NULL;
-
     if (*payload)
     {
         /*
@@ -380,61 +498,140 @@ OCStackResult OCRDDatabaseDiscoveryPayloadCreate(const char *interfaceType,
          * caller provided payload.
          */
         OIC_LOG_V(ERROR, TAG, "Payload is already allocated");
-        result = OC_STACK_INTERNAL_SERVER_ERROR;
-        goto exit;
+        return OC_STACK_INTERNAL_SERVER_ERROR;
     }
+    return DiscoveryPayloadQuery(interfaceType, resourceType, payload);
+}
 
-    if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
+static bool QueryEquals(const char *a, const char *b)
+{
+    return (a == b) || (a && b && 0 == strcmp(a, b));
+}
+
+static void DiscoveryCacheEntryDelete(RDDiscoveryCacheEntry *entry)
+{
+    OICFree(entry->interfaceType);
+    OICFree(entry->resourceType);
+    OCPayloadDestroy((OCPayload *) entry->payload);
+    OICFree(entry);
+}
+
+void OCRDDatabaseDiscoveryInvalidate()
+{
+    RDDiscoveryCacheEntry *entry = NULL;
+    RDDiscoveryCacheEntry *tmp = NULL;
+    LL_FOREACH_SAFE(gRDDiscoveryCache, entry, tmp)
     {
-        OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
+        LL_DELETE(gRDDiscoveryCache, entry);
+        DiscoveryCacheEntryDelete(entry);
     }
-    sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB, SQLITE_OPEN_READONLY, NULL);
-    if (!gRDDB)
+    gRDDiscoveryCacheCount = 0;
+    gRDDiscoveryGeneration++;
+}
+
+/*
+ * The RD database can also be changed by connections this process does not know of, such as
+ * another process serving the same file. Their commits change the data_version of the
+ * discovery connection.
+ */
+static void DiscoveryCacheCheckVersion()
+{
+    if (!gRDDataVersionStmt &&
+        SQLITE_OK != sqlite3_prepare_v2(gRDDB, "PRAGMA data_version", -1, &gRDDataVersionStmt,
+                                        NULL))
     {
-        result = OC_STACK_ERROR;
-        goto exit;
+        OCRDDatabaseDiscoveryInvalidate();
+        return;
+    }
+    int version = -1;
+    if (SQLITE_ROW == sqlite3_step(gRDDataVersionStmt))
+    {
+        version = sqlite3_column_int(gRDDataVersionStmt, 0);
     }
+    sqlite3_reset(gRDDataVersionStmt);
+    if (version < 0 || version != gRDDataVersion)
+    {
+        OCRDDatabaseDiscoveryInvalidate();
+    }
+    gRDDataVersion = version;
+}
 
-    const char *serverID = OCGetServerInstanceIDString();
-    const char input[] = "SELECT di FROM RD_DEVICE_LIST";
-    int inputSize = (int)sizeof(input);
-    const uint8_t di_index = 0;
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-    while (SQLITE_ROW == sqlite3_step(stmt))
-    {
-        const unsigned char *di = sqlite3_column_text(stmt, di_index);
-        if (0 == strcmp((const char *)di, serverID))
-        {
-            continue;
-        }
-        *tail = OCDiscoveryPayloadCreate();
-        result = OC_STACK_INTERNAL_SERVER_ERROR;
-        VERIFY_NON_NULL(*tail);
-        (*tail)->sid = (char *)OICCalloc(1, UUID_STRING_SIZE);
-        VERIFY_NON_NULL((*tail)->sid);
-        memcpy((*tail)->sid, di, UUID_STRING_SIZE);
-        result = CheckResources(interfaceType, resourceType, *tail);
-        if (OC_STACK_OK == result)
-        {
-            tail = &(*tail)->next;
-        }
-        else
+uint32_t OCRDDatabaseDiscoveryGetGeneration()
+{
+    if (OC_STACK_OK == OpenDiscoveryDatabase())
+    {
+        DiscoveryCacheCheckVersion();
+    }
+    return gRDDiscoveryGeneration;
+}
+
+OCStackResult OCRDDatabaseDiscoveryPayloadGet(const char *interfaceType,
+        const char *resourceType,
+        const OCDiscoveryPayload **payload)
+{
+    *payload = NULL;
+    if (OC_STACK_OK != OpenDiscoveryDatabase())
+    {
+        return OC_STACK_ERROR;
+    }
+    DiscoveryCacheCheckVersion();
+
+    RDDiscoveryCacheEntry *entry = NULL;
+    LL_FOREACH(gRDDiscoveryCache, entry)
+    {
+        if (QueryEquals(entry->interfaceType, interfaceType) &&
+            QueryEquals(entry->resourceType, resourceType))
         {
-            OCPayloadDestroy((OCPayload *) *tail);
-            *tail = NULL;
+            break;
         }
     }
-    result = head ? OC_STACK_OK : OC_STACK_NO_RESOURCE;
 
-exit:
-    if (OC_STACK_OK != result)
+    if (entry)
+    {
+        // Keep the most recently used entries at the head
+        LL_DELETE(gRDDiscoveryCache, entry);
+        LL_PREPEND(gRDDiscoveryCache, entry);
+        *payload = entry->payload;
+        return entry->result;
+    }
+
+    OCDiscoveryPayload *head = NULL;
+    OCStackResult result = DiscoveryPayloadQuery(interfaceType, resourceType, &head);
+    if (OC_STACK_OK != result && OC_STACK_NO_RESOURCE != result)
+    {
+        // Errors are not cached, the next request tries again
+        return result;
+    }
+
+    entry = (RDDiscoveryCacheEntry *)OICCalloc(1, sizeof(RDDiscoveryCacheEntry));
+    if (!entry)
     {
         OCPayloadDestroy((OCPayload *) head);
-        head = NULL;
+        return OC_STACK_NO_MEMORY;
+    }
+    entry->interfaceType = interfaceType ? OICStrdup(interfaceType) : NULL;
+    entry->resourceType = resourceType ? OICStrdup(resourceType) : NULL;
+    entry->result = result;
+    entry->payload = head;
+    if ((interfaceType && !entry->interfaceType) || (resourceType && !entry->resourceType))
+    {
+        DiscoveryCacheEntryDelete(entry);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    LL_PREPEND(gRDDiscoveryCache, entry);
+    if (++gRDDiscoveryCacheCount > RD_DISCOVERY_CACHE_SIZE)
+    {
+        RDDiscoveryCacheEntry *last = gRDDiscoveryCache;
+        while (last->next)
+        {
+            last = last->next;
+        }
+        LL_DELETE(gRDDiscoveryCache, last);
+        DiscoveryCacheEntryDelete(last);
+        gRDDiscoveryCacheCount--;
     }
     *payload = head;
-    sqlite3_finalize(stmt);
-    sqlite3_close(gRDDB);
     return result;
 }
 #endif
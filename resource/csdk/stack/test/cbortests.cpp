@@ -24,8 +24,10 @@ extern "C"
     #include "ocstack.h"
     #include "ocpayload.h"
     #include "ocpayloadcbor.h"
+    #include "ocpayloadarena.h"
     #include "logger.h"
     #include "oic_malloc.h"
+    #include "oic_string.h"
 }
 
 #include "gtest/gtest.h"
@@ -45,7 +47,9 @@ extern "C"
 #include <string.h>
 
 #include <iostream>
+#include <set>
 #include <stdint.h>
+#include <thread>
 
 #include "gtest_helper.h"
 
@@ -309,3 +313,830 @@ TEST(CborHeterogeneousArrayTest, ConvertParseTest)
     OICFree(payload_cbor);
     OCPayloadDestroy(payload_out);
 }
+
+static OCRepPayload *CreateLargeRepPayload(const char *uri)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        return NULL;
+    }
+    OCRepPayloadSetUri(payload, uri);
+    OCRepPayloadAddResourceType(payload, "oic.r.sensor");
+    OCRepPayloadAddInterface(payload, "oic.if.baseline");
+    for (int i = 0; i < 16; ++i)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "value%d", i);
+        OCRepPayloadSetPropInt(payload, name, i * 1000);
+        snprintf(name, sizeof(name), "name%d", i);
+        OCRepPayloadSetPropString(payload, name, "a reasonably long string property value");
+    }
+    int64_t samples[32];
+    for (int i = 0; i < 32; ++i)
+    {
+        samples[i] = i * 37;
+    }
+    size_t dim[MAX_REP_ARRAY_DEPTH] = { 32, 0, 0 };
+    OCRepPayloadSetIntArray(payload, "samples", samples, dim);
+    return payload;
+}
+
+static OCDiscoveryPayload *CreateDiscoveryPayload(size_t resourceCount)
+{
+    OCDiscoveryPayload *payload = OCDiscoveryPayloadCreate();
+    if (!payload)
+    {
+        return NULL;
+    }
+    payload->sid = OICStrdup("88b7c7f0-4b51-4e0a-9faa-cfb439fd7f49");
+    for (size_t i = 0; i < resourceCount; ++i)
+    {
+        OCResourcePayload *resource = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
+        if (!resource)
+        {
+            break;
+        }
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/a/light/%u", (unsigned int)i);
+        resource->uri = OICStrdup(uri);
+        OCResourcePayloadAddStringLL(&resource->types, "oic.r.switch.binary");
+        OCResourcePayloadAddStringLL(&resource->types, "oic.r.light.brightness");
+        OCResourcePayloadAddStringLL(&resource->interfaces, "oic.if.baseline");
+        OCResourcePayloadAddStringLL(&resource->interfaces, "oic.if.a");
+        resource->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+        OCDiscoveryPayloadAddNewResource(payload, resource);
+    }
+    return payload;
+}
+
+TEST(CborConvertTest, CollectionConvertParseTest)
+{
+    // Each member alone is larger than a small first guess of the buffer size.
+    OCRepPayload *payload_in = CreateLargeRepPayload("/a/room");
+    ASSERT_TRUE(payload_in != NULL);
+    OCRepPayloadAppend(payload_in, CreateLargeRepPayload("/a/light/0"));
+    OCRepPayloadAppend(payload_in, CreateLargeRepPayload("/a/light/1"));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, OC_FORMAT_CBOR,
+            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCPayload *payload_out = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, OC_FORMAT_CBOR,
+            PAYLOAD_TYPE_REPRESENTATION, payload_cbor, payload_cbor_size));
+
+    const char *uris[] = { "/a/room", "/a/light/0", "/a/light/1" };
+    size_t count = 0;
+    for (OCRepPayload *rep = (OCRepPayload*) payload_out; rep; rep = rep->next)
+    {
+        ASSERT_LT(count, sizeof(uris) / sizeof(uris[0]));
+        EXPECT_STREQ(uris[count], rep->uri);
+        int64_t value = 0;
+        EXPECT_TRUE(OCRepPayloadGetPropInt(rep, "value15", &value));
+        EXPECT_EQ(15000, value);
+        count++;
+    }
+    EXPECT_EQ(3u, count);
+
+    OICFree(payload_cbor);
+    OCPayloadDestroy(payload_out);
+}
+
+TEST(RepPayloadIndexTest, ManyProperties)
+{
+    const int count = 200;
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(payload != NULL);
+
+    char name[16];
+    for (int i = 0; i < count; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        ASSERT_TRUE(OCRepPayloadSetPropInt(payload, name, i));
+    }
+    // Setting an existing property replaces it in place.
+    ASSERT_TRUE(OCRepPayloadSetPropString(payload, "prop7", "seven"));
+
+    int index = 0;
+    for (OCRepPayloadValue *val = payload->values; val; val = val->next)
+    {
+        snprintf(name, sizeof(name), "prop%d", index++);
+        EXPECT_STREQ(name, val->name);
+    }
+    EXPECT_EQ(count, index);
+
+    for (int i = 0; i < count; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        if (7 == i)
+        {
+            char *str = NULL;
+            ASSERT_TRUE(OCRepPayloadGetPropString(payload, name, &str));
+            EXPECT_STREQ("seven", str);
+            OICFree(str);
+            continue;
+        }
+        int64_t value = -1;
+        ASSERT_TRUE(OCRepPayloadGetPropInt(payload, name, &value));
+        EXPECT_EQ(i, value);
+    }
+    int64_t value = 0;
+    EXPECT_FALSE(OCRepPayloadGetPropInt(payload, "missing", &value));
+
+    OCRepPayloadDestroy(payload);
+}
+
+TEST(RepPayloadIndexTest, ValuesEditedDirectly)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(payload != NULL);
+
+    char name[16];
+    for (int i = 0; i < 20; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        ASSERT_TRUE(OCRepPayloadSetPropInt(payload, name, i));
+    }
+
+    // Append behind the last value, as code building the list by hand does.
+    OCRepPayloadValue *last = payload->values;
+    while (last->next)
+    {
+        last = last->next;
+    }
+    last->next = (OCRepPayloadValue *) OICCalloc(1, sizeof(OCRepPayloadValue));
+    ASSERT_TRUE(last->next != NULL);
+    last->next->name = OICStrdup("appended");
+    last->next->type = OCREP_PROP_INT;
+    last->next->i = 42;
+
+    int64_t value = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "appended", &value));
+    EXPECT_EQ(42, value);
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "appended", 43));
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "appended", &value));
+    EXPECT_EQ(43, value);
+
+    // Replace the whole list.
+    OCRepPayloadValue *values = payload->values;
+    payload->values = (OCRepPayloadValue *) OICCalloc(1, sizeof(OCRepPayloadValue));
+    ASSERT_TRUE(payload->values != NULL);
+    payload->values->name = OICStrdup("only");
+    payload->values->type = OCREP_PROP_BOOL;
+    payload->values->b = true;
+
+    bool flag = false;
+    EXPECT_TRUE(OCRepPayloadGetPropBool(payload, "only", &flag));
+    EXPECT_TRUE(flag);
+    EXPECT_FALSE(OCRepPayloadGetPropInt(payload, "prop3", &value));
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "prop3", 3));
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "prop3", &value));
+    EXPECT_EQ(3, value);
+
+    // Free the detached list through a payload that owns it.
+    OCRepPayload *detached = OCRepPayloadCreate();
+    ASSERT_TRUE(detached != NULL);
+    detached->values = values;
+    OCRepPayloadDestroy(detached);
+    OCRepPayloadDestroy(payload);
+}
+
+static void ExpectProps(const OCRepPayload *payload, const std::set<int> &present, int count)
+{
+    char name[16];
+    for (int i = 0; i < count; ++i)
+    {
+        int64_t value = -1;
+        snprintf(name, sizeof(name), "prop%d", i);
+        if (present.count(i))
+        {
+            EXPECT_TRUE(OCRepPayloadGetPropInt(payload, name, &value)) << name;
+            EXPECT_EQ(i, value);
+        }
+        else
+        {
+            EXPECT_FALSE(OCRepPayloadGetPropInt(payload, name, &value)) << name;
+        }
+    }
+}
+
+TEST(RepPayloadIndexTest, LookupAcrossThreshold)
+{
+    // The index is built once a payload has 8 values.
+    const int count = 12;
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(payload != NULL);
+
+    std::set<int> present;
+    char name[16];
+    for (int i = 0; i < count; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        ASSERT_TRUE(OCRepPayloadSetPropInt(payload, name, i));
+        present.insert(i);
+        ExpectProps(payload, present, count);
+    }
+
+    // Replacing a value keeps its place on both sides of the threshold.
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "prop2", 2));
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "prop10", 10));
+    int position = 0;
+    for (OCRepPayloadValue *val = payload->values; val; val = val->next)
+    {
+        snprintf(name, sizeof(name), "prop%d", position++);
+        EXPECT_STREQ(name, val->name);
+    }
+    EXPECT_EQ(count, position);
+
+    OCRepPayloadDestroy(payload);
+}
+
+TEST(RepPayloadIndexTest, LookupAfterRemovals)
+{
+    const int count = 12;
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(payload != NULL);
+
+    std::set<int> present;
+    char name[16];
+    for (int i = 0; i < count; ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", i);
+        ASSERT_TRUE(OCRepPayloadSetPropInt(payload, name, i));
+        present.insert(i);
+    }
+
+    EXPECT_FALSE(OCRepPayloadRemoveProp(payload, "missing"));
+    EXPECT_FALSE(OCRepPayloadRemoveProp(NULL, "prop0"));
+    EXPECT_FALSE(OCRepPayloadRemoveProp(payload, NULL));
+
+    // The head, the tail and one in the middle, then down below the threshold.
+    const int removals[] = { 0, 11, 5, 1, 10, 3 };
+    for (size_t i = 0; i < sizeof(removals) / sizeof(removals[0]); ++i)
+    {
+        snprintf(name, sizeof(name), "prop%d", removals[i]);
+        ASSERT_TRUE(OCRepPayloadRemoveProp(payload, name));
+        EXPECT_FALSE(OCRepPayloadRemoveProp(payload, name));
+        present.erase(removals[i]);
+        ExpectProps(payload, present, count);
+    }
+
+    // Removed names can be set again, and go to the end of the list.
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "prop11", 11));
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "prop0", 0));
+    present.insert(11);
+    present.insert(0);
+    ExpectProps(payload, present, count);
+
+    OCRepPayloadValue *last = payload->values;
+    size_t length = 1;
+    while (last->next)
+    {
+        last = last->next;
+        ++length;
+    }
+    EXPECT_STREQ("prop0", last->name);
+    EXPECT_EQ(present.size(), length);
+
+    // Removing everything leaves an empty payload that still works.
+    for (std::set<int>::iterator it = present.begin(); it != present.end(); ++it)
+    {
+        snprintf(name, sizeof(name), "prop%d", *it);
+        ASSERT_TRUE(OCRepPayloadRemoveProp(payload, name));
+    }
+    EXPECT_TRUE(payload->values == NULL);
+    ExpectProps(payload, std::set<int>(), count);
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "prop4", 4));
+    std::set<int> four;
+    four.insert(4);
+    ExpectProps(payload, four, count);
+
+    OCRepPayloadDestroy(payload);
+}
+
+TEST(RepPayloadArenaTest, MixedOwnership)
+{
+    OCRepPayload *payload = OCRepPayloadCreateWithArena(0);
+    ASSERT_TRUE(payload != NULL);
+    ASSERT_TRUE(OCRepPayloadGetArena(payload) != NULL);
+
+    char name[16];
+    for (int i = 0; i < 100; ++i)
+    {
+        snprintf(name, sizeof(name), "name%d", i);
+        ASSERT_TRUE(OCRepPayloadSetPropString(payload, name, "a reasonably long string"));
+    }
+    EXPECT_LT(1u, OCPayloadArenaGetChunkCount(OCRepPayloadGetArena(payload)));
+
+    // Heap allocated values can be mixed in and are freed with the tree.
+    ASSERT_TRUE(OCRepPayloadSetPropStringAsOwner(payload, "owned", OICStrdup("heap")));
+    OCRepPayload *child = OCRepPayloadCreate();
+    ASSERT_TRUE(child != NULL);
+    ASSERT_TRUE(OCRepPayloadSetPropInt(child, "x", 1));
+    ASSERT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload, "child", child));
+
+    // Replacing values drops arena and heap memory alike.
+    ASSERT_TRUE(OCRepPayloadSetPropInt(payload, "name3", 3));
+    ASSERT_TRUE(OCRepPayloadSetPropString(payload, "owned", "arena"));
+
+    int64_t value = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "name3", &value));
+    EXPECT_EQ(3, value);
+    char *str = NULL;
+    ASSERT_TRUE(OCRepPayloadGetPropString(payload, "owned", &str));
+    EXPECT_STREQ("arena", str);
+    OICFree(str);
+    ASSERT_TRUE(OCRepPayloadGetPropString(payload, "name99", &str));
+    EXPECT_STREQ("a reasonably long string", str);
+    OICFree(str);
+
+    OCRepPayload *clone = OCRepPayloadClone(payload);
+    ASSERT_TRUE(clone != NULL);
+    EXPECT_TRUE(OCRepPayloadGetArena(clone) == NULL);
+    OCRepPayloadDestroy(payload);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(clone, "name3", &value));
+    OCRepPayloadDestroy(clone);
+}
+
+TEST(RepPayloadArenaTest, ParsedObjectOutlivesRoot)
+{
+    OCRepPayload *payload_in = CreateLargeRepPayload("/a/room");
+    ASSERT_TRUE(payload_in != NULL);
+    ASSERT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload_in, "light",
+                                                 CreateLargeRepPayload("/a/light")));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, OC_FORMAT_CBOR,
+                                            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCPayload *payload_out = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                                          payload_cbor, payload_cbor_size));
+    OICFree(payload_cbor);
+    OCRepPayload *root = (OCRepPayload *) payload_out;
+    ASSERT_TRUE(OCRepPayloadGetArena(root) != NULL);
+
+    // Take the nested object out of the tree; it keeps the arena alive.
+    OCRepPayloadValue *val = root->values;
+    while (val && strcmp("light", val->name))
+    {
+        val = val->next;
+    }
+    ASSERT_TRUE(val != NULL);
+    ASSERT_EQ(OCREP_PROP_OBJECT, val->type);
+    OCRepPayload *light = val->obj;
+    val->type = OCREP_PROP_NULL;
+    val->obj = NULL;
+    EXPECT_TRUE(OCRepPayloadGetArena(root) == OCRepPayloadGetArena(light));
+    OCPayloadDestroy(payload_out);
+
+    char *str = NULL;
+    ASSERT_TRUE(OCRepPayloadGetPropString(light, "name15", &str));
+    EXPECT_STREQ("a reasonably long string property value", str);
+    OICFree(str);
+    OCRepPayloadDestroy(light);
+}
+
+/**
+ * Counts the heap blocks a representation tree holds, arena chunks included.
+ */
+static size_t CountRepPayloadBlocks(const OCRepPayload *payload, const OCPayloadArena *counted)
+{
+    size_t blocks = 0;
+    for (; payload; payload = payload->next)
+    {
+        const OCPayloadArena *arena = OCRepPayloadGetArena(payload);
+        if (arena && arena != counted)
+        {
+            // The arena itself and its chunks.
+            blocks += 1 + OCPayloadArenaGetChunkCount(arena);
+            counted = arena;
+        }
+        blocks += OCPayloadArenaContains(arena, payload) ? 0 : 1;
+        blocks += payload->uri ? 1 : 0;
+        for (const OCStringLL *ll = payload->types; ll; ll = ll->next)
+        {
+            blocks += 2;
+        }
+        for (const OCStringLL *ll = payload->interfaces; ll; ll = ll->next)
+        {
+            blocks += 2;
+        }
+        for (const OCRepPayloadValue *val = payload->values; val; val = val->next)
+        {
+            blocks += OCPayloadArenaContains(arena, val) ? 0 : 1;
+            blocks += OCPayloadArenaContains(arena, val->name) ? 0 : 1;
+            if (OCREP_PROP_STRING == val->type)
+            {
+                blocks += OCPayloadArenaContains(arena, val->str) ? 0 : 1;
+            }
+            else if (OCREP_PROP_BYTE_STRING == val->type)
+            {
+                blocks += OCPayloadArenaContains(arena, val->ocByteStr.bytes) ? 0 : 1;
+            }
+            else if (OCREP_PROP_OBJECT == val->type)
+            {
+                blocks += CountRepPayloadBlocks(val->obj, counted);
+            }
+            else if (OCREP_PROP_ARRAY == val->type)
+            {
+                size_t dimTotal = calcDimTotal(val->arr.dimensions);
+                blocks += 1;
+                for (size_t i = 0; i < dimTotal; ++i)
+                {
+                    if (OCREP_PROP_STRING == val->arr.type)
+                    {
+                        blocks += val->arr.strArray[i] ? 1 : 0;
+                    }
+                    else if (OCREP_PROP_OBJECT == val->arr.type)
+                    {
+                        blocks += CountRepPayloadBlocks(val->arr.objArray[i], counted);
+                    }
+                }
+            }
+        }
+    }
+    return blocks;
+}
+
+TEST(RepPayloadArenaTest, ParsedTreeMatchesHeapParse)
+{
+    OCRepPayload *payload_in = CreateLargeRepPayload("/a/room");
+    ASSERT_TRUE(payload_in != NULL);
+    char name[16];
+    for (int i = 0; i < 8; ++i)
+    {
+        snprintf(name, sizeof(name), "light%d", i);
+        ASSERT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload_in, name,
+                                                     CreateLargeRepPayload("/a/light")));
+    }
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, OC_FORMAT_CBOR,
+                                            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCPayload *payload_out[2] = { NULL, NULL };
+    size_t blocks[2] = { 0, 0 };
+    for (int useArena = 0; useArena < 2; ++useArena)
+    {
+        OCParsePayloadUseArena(0 != useArena);
+        ASSERT_EQ(OC_STACK_OK, OCParsePayload(&payload_out[useArena], OC_FORMAT_CBOR,
+                                              PAYLOAD_TYPE_REPRESENTATION,
+                                              payload_cbor, payload_cbor_size));
+        blocks[useArena] = CountRepPayloadBlocks((OCRepPayload *) payload_out[useArena], NULL);
+    }
+    OCParsePayloadUseArena(true);
+    OICFree(payload_cbor);
+
+    // The arena holds the tree in a few chunks instead of a block per value.
+    EXPECT_TRUE(OCRepPayloadGetArena((OCRepPayload *) payload_out[0]) == NULL);
+    EXPECT_TRUE(OCRepPayloadGetArena((OCRepPayload *) payload_out[1]) != NULL);
+    EXPECT_GT(blocks[0] / 4, blocks[1]);
+
+    // Both trees hold the same representation.
+    uint8_t *cbor[2] = { NULL, NULL };
+    size_t cborSize[2] = { 0, 0 };
+    for (int i = 0; i < 2; ++i)
+    {
+        ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload_out[i], OC_FORMAT_CBOR,
+                                                &cbor[i], &cborSize[i]));
+        OCPayloadDestroy(payload_out[i]);
+    }
+    ASSERT_EQ(cborSize[0], cborSize[1]);
+    EXPECT_EQ(0, memcmp(cbor[0], cbor[1], cborSize[0]));
+    OICFree(cbor[0]);
+    OICFree(cbor[1]);
+}
+
+TEST(RepPayloadArenaTest, ParsedPayloadsUsedFromSeveralThreads)
+{
+    OCRepPayload *payload_in = CreateLargeRepPayload("/a/room");
+    ASSERT_TRUE(payload_in != NULL);
+    ASSERT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload_in, "light",
+                                                 CreateLargeRepPayload("/a/light")));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, OC_FORMAT_CBOR,
+                                            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCPayload *payload_out = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                                          payload_cbor, payload_cbor_size));
+    OICFree(payload_cbor);
+    OCRepPayload *root = (OCRepPayload *) payload_out;
+    OCPayloadArena *arena = OCRepPayloadGetArena(root);
+    ASSERT_TRUE(arena != NULL);
+    size_t chunks = OCPayloadArenaGetChunkCount(arena);
+
+    // Take the nested object out of the tree.
+    OCRepPayloadValue *lightVal = root->values;
+    while (lightVal && strcmp("light", lightVal->name))
+    {
+        lightVal = lightVal->next;
+    }
+    ASSERT_TRUE(lightVal != NULL);
+    ASSERT_EQ(OCREP_PROP_OBJECT, lightVal->type);
+    OCRepPayload *light = lightVal->obj;
+    lightVal->type = OCREP_PROP_NULL;
+    lightVal->obj = NULL;
+    EXPECT_EQ(arena, OCRepPayloadGetArena(light));
+
+    // Values set after the parse are on the heap, so both payloads can be
+    // changed and freed at the same time.
+    std::thread other([root]()
+    {
+        char name[16];
+        for (int i = 0; i < 100; ++i)
+        {
+            snprintf(name, sizeof(name), "room%d", i);
+            EXPECT_TRUE(OCRepPayloadSetPropString(root, name, "a reasonably long string"));
+        }
+        OCRepPayloadDestroy(root);
+    });
+    char name[16];
+    for (int i = 0; i < 100; ++i)
+    {
+        snprintf(name, sizeof(name), "light%d", i);
+        EXPECT_TRUE(OCRepPayloadSetPropString(light, name, "a reasonably long string"));
+        OCRepPayloadValue *val = light->values;
+        while (val && strcmp(name, val->name))
+        {
+            val = val->next;
+        }
+        ASSERT_TRUE(val != NULL);
+        EXPECT_FALSE(OCPayloadArenaContains(arena, val));
+        EXPECT_FALSE(OCPayloadArenaContains(arena, val->str));
+    }
+    other.join();
+
+    EXPECT_EQ(chunks, OCPayloadArenaGetChunkCount(arena));
+    char *str = NULL;
+    ASSERT_TRUE(OCRepPayloadGetPropString(light, "name15", &str));
+    EXPECT_STREQ("a reasonably long string property value", str);
+    OICFree(str);
+    OCRepPayloadDestroy(light);
+}
+
+TEST(RepPayloadViewTest, ReadsPropertiesInPlace)
+{
+    OCRepPayload *payload_in = CreateLargeRepPayload("/a/room");
+    ASSERT_TRUE(payload_in != NULL);
+    OCRepPayload *light = CreateLargeRepPayload("/a/light");
+    ASSERT_TRUE(light != NULL);
+    ASSERT_TRUE(OCRepPayloadSetPropBool(light, "on", true));
+    ASSERT_TRUE(OCRepPayloadSetPropString(light, OC_RSRVD_HREF, "/a/light"));
+    ASSERT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload_in, "light", light));
+    ASSERT_TRUE(OCRepPayloadSetPropDouble(payload_in, "temp", 21.5));
+    ASSERT_TRUE(OCRepPayloadSetNull(payload_in, "nothing"));
+    uint8_t bytes[] = { 0x01, 0x02, 0x03 };
+    OCByteString byteString = { bytes, sizeof(bytes) };
+    ASSERT_TRUE(OCRepPayloadSetPropByteString(payload_in, "bytes", byteString));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, OC_FORMAT_CBOR,
+                                            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCRepPayloadView view;
+    ASSERT_EQ(OC_STACK_OK, OCRepPayloadViewInit(&view, payload_cbor, payload_cbor_size));
+
+    int64_t intval = 0;
+    EXPECT_TRUE(OCRepPayloadViewGetPropInt(&view, "value3", &intval));
+    EXPECT_EQ(3000, intval);
+    double doubleval = 0;
+    EXPECT_TRUE(OCRepPayloadViewGetPropDouble(&view, "temp", &doubleval));
+    EXPECT_EQ(21.5, doubleval);
+    EXPECT_TRUE(OCRepPayloadViewGetPropDouble(&view, "value3", &doubleval));
+    EXPECT_EQ(3000.0, doubleval);
+    EXPECT_TRUE(OCRepPayloadViewIsNull(&view, "nothing"));
+    EXPECT_FALSE(OCRepPayloadViewIsNull(&view, "temp"));
+    EXPECT_FALSE(OCRepPayloadViewGetPropInt(&view, "missing", &intval));
+    EXPECT_FALSE(OCRepPayloadViewGetPropInt(&view, "name3", &intval));
+
+    // Strings are referenced in the received buffer.
+    const char *ref = NULL;
+    size_t len = 0;
+    ASSERT_TRUE(OCRepPayloadViewGetPropStringRef(&view, "name7", &ref, &len));
+    EXPECT_EQ(std::string("a reasonably long string property value"), std::string(ref, len));
+    EXPECT_TRUE((const uint8_t *) ref > payload_cbor);
+    EXPECT_TRUE((const uint8_t *) ref + len <= payload_cbor + payload_cbor_size);
+    char *str = NULL;
+    ASSERT_TRUE(OCRepPayloadViewGetPropString(&view, "name7", &str));
+    EXPECT_STREQ("a reasonably long string property value", str);
+    OICFree(str);
+
+    OCByteString byteval = { NULL, 0 };
+    ASSERT_TRUE(OCRepPayloadViewGetPropByteString(&view, "bytes", &byteval));
+    ASSERT_EQ(sizeof(bytes), byteval.len);
+    EXPECT_EQ(0, memcmp(bytes, byteval.bytes, sizeof(bytes)));
+    OICFree(byteval.bytes);
+
+    // href, rt and if are not properties of the root, but of nested objects.
+    OCRepPayloadPropType type;
+    EXPECT_FALSE(OCRepPayloadViewGetPropType(&view, OC_RSRVD_RESOURCE_TYPE, &type));
+    ASSERT_TRUE(OCRepPayloadViewGetPropType(&view, "samples", &type));
+    EXPECT_EQ(OCREP_PROP_ARRAY, type);
+    char *uri = NULL;
+    EXPECT_FALSE(OCRepPayloadViewGetUri(&view, &uri));
+    OCStringLL *types = NULL;
+    ASSERT_TRUE(OCRepPayloadViewGetResourceTypes(&view, &types));
+    EXPECT_STREQ("oic.r.sensor", types->value);
+    OCFreeOCStringLL(types);
+
+    OCRepPayloadView lightView;
+    ASSERT_TRUE(OCRepPayloadViewGetPropObject(&view, "light", &lightView));
+    bool boolval = false;
+    EXPECT_TRUE(OCRepPayloadViewGetPropBool(&lightView, "on", &boolval));
+    EXPECT_TRUE(boolval);
+    ASSERT_TRUE(OCRepPayloadViewGetPropType(&lightView, OC_RSRVD_HREF, &type));
+    EXPECT_EQ(OCREP_PROP_STRING, type);
+    EXPECT_FALSE(OCRepPayloadViewGetUri(&lightView, &uri));
+
+    OICFree(payload_cbor);
+}
+
+TEST(RepPayloadViewTest, ToPayloadMatchesParse)
+{
+    OCRepPayload *payload_in = CreateLargeRepPayload("/a/room");
+    ASSERT_TRUE(payload_in != NULL);
+    ASSERT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload_in, "light",
+                                                 CreateLargeRepPayload("/a/light")));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, OC_FORMAT_CBOR,
+                                            &payload_cbor, &payload_cbor_size));
+    OCRepPayloadDestroy(payload_in);
+
+    OCPayload *parsed = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&parsed, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                                          payload_cbor, payload_cbor_size));
+    OCRepPayload *parsedLight = NULL;
+    ASSERT_TRUE(OCRepPayloadGetPropObject((OCRepPayload *) parsed, "light", &parsedLight));
+
+    OCRepPayloadView view;
+    ASSERT_EQ(OC_STACK_OK, OCRepPayloadViewInit(&view, payload_cbor, payload_cbor_size));
+    OCRepPayload *root = OCRepPayloadViewToPayload(&view);
+    ASSERT_TRUE(root != NULL);
+    OCRepPayloadView lightView;
+    ASSERT_TRUE(OCRepPayloadViewGetPropObject(&view, "light", &lightView));
+    OCRepPayload *light = OCRepPayloadViewToPayload(&lightView);
+    ASSERT_TRUE(light != NULL);
+
+    uint8_t *cbor1 = NULL;
+    size_t size1 = 0;
+    uint8_t *cbor2 = NULL;
+    size_t size2 = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload(parsed, OC_FORMAT_CBOR, &cbor1, &size1));
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) root, OC_FORMAT_CBOR, &cbor2, &size2));
+    ASSERT_EQ(size1, size2);
+    EXPECT_EQ(0, memcmp(cbor1, cbor2, size1));
+    OICFree(cbor1);
+    OICFree(cbor2);
+
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) parsedLight, OC_FORMAT_CBOR,
+                                            &cbor1, &size1));
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) light, OC_FORMAT_CBOR, &cbor2, &size2));
+    ASSERT_EQ(size1, size2);
+    EXPECT_EQ(0, memcmp(cbor1, cbor2, size1));
+    OICFree(cbor1);
+    OICFree(cbor2);
+
+    OCRepPayloadDestroy(light);
+    OCRepPayloadDestroy(root);
+    OCRepPayloadDestroy(parsedLight);
+    OCPayloadDestroy(parsed);
+    OICFree(payload_cbor);
+}
+
+TEST(RepPayloadViewTest, RejectsNonMap)
+{
+    OCRepPayloadView view;
+    const uint8_t array[] = { 0x80 };
+    EXPECT_EQ(OC_STACK_MALFORMED_RESPONSE, OCRepPayloadViewInit(&view, array, sizeof(array)));
+    const uint8_t truncated[] = { 0xa1, 0x61 };
+    ASSERT_EQ(OC_STACK_OK, OCRepPayloadViewInit(&view, truncated, sizeof(truncated)));
+    int64_t intval = 0;
+    EXPECT_FALSE(OCRepPayloadViewGetPropInt(&view, "a", &intval));
+    EXPECT_TRUE(OCRepPayloadViewToPayload(&view) == NULL);
+}
+
+// The encoding holds exactly one CBOR item and nothing after it.
+static void ExpectExactlyOneItem(const uint8_t *cbor, size_t size)
+{
+    CborParser parser;
+    CborValue value;
+    ASSERT_EQ(CborNoError, cbor_parser_init(cbor, size, 0, &parser, &value));
+    ASSERT_EQ(CborNoError, cbor_value_advance(&value));
+    EXPECT_EQ(cbor + size, cbor_value_get_next_byte(&value));
+}
+
+// Converts, parses and converts again; both encodings must be identical.
+static void ExpectStableConversion(OCPayload *payload, size_t *encodedSize)
+{
+    uint8_t *cbor = NULL;
+    size_t size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload, OC_FORMAT_CBOR, &cbor, &size));
+    ExpectExactlyOneItem(cbor, size);
+
+    OCPayload *parsed = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&parsed, OC_FORMAT_CBOR, payload->type, cbor, size));
+    uint8_t *again = NULL;
+    size_t againSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload(parsed, OC_FORMAT_CBOR, &again, &againSize));
+    ASSERT_EQ(size, againSize);
+    EXPECT_EQ(0, memcmp(cbor, again, size));
+
+    *encodedSize = size;
+    OICFree(again);
+    OCPayloadDestroy(parsed);
+    OICFree(cbor);
+}
+
+TEST(CborConvertTest, SmallRepIsExactlySized)
+{
+    OCRepPayload *rep = OCRepPayloadCreate();
+    ASSERT_TRUE(rep != NULL);
+    OCRepPayloadSetUri(rep, "/a/light");
+    OCRepPayloadSetPropBool(rep, "value", true);
+
+    size_t size = 0;
+    ExpectStableConversion((OCPayload*) rep, &size);
+    EXPECT_LT(0u, size);
+    EXPECT_GT(64u, size);
+    OCRepPayloadDestroy(rep);
+}
+
+TEST(CborConvertTest, LargeCollectionIsExactlySized)
+{
+    OCRepPayload *rep = CreateLargeRepPayload("/a/room");
+    ASSERT_TRUE(rep != NULL);
+    for (int i = 0; i < 4; ++i)
+    {
+        OCRepPayloadAppend(rep, CreateLargeRepPayload("/a/light"));
+    }
+
+    size_t size = 0;
+    ExpectStableConversion((OCPayload*) rep, &size);
+    EXPECT_LT(1024u, size);
+    OCRepPayloadDestroy(rep);
+}
+
+TEST(CborConvertTest, DiscoveryIsExactlySized)
+{
+    OCDiscoveryPayload *discovery = CreateDiscoveryPayload(50);
+    ASSERT_TRUE(discovery != NULL);
+
+    uint8_t *cbor = NULL;
+    size_t size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) discovery, OC_FORMAT_CBOR,
+            &cbor, &size));
+    EXPECT_LT(1024u, size);
+    ExpectExactlyOneItem(cbor, size);
+
+    OCPayload *parsed = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&parsed, OC_FORMAT_CBOR, PAYLOAD_TYPE_DISCOVERY,
+            cbor, size));
+    size_t count = 0;
+    for (OCResourcePayload *resource = ((OCDiscoveryPayload*) parsed)->resources; resource;
+         resource = resource->next)
+    {
+        count++;
+    }
+    EXPECT_EQ(50u, count);
+
+    OCPayloadDestroy(parsed);
+    OICFree(cbor);
+    OCDiscoveryPayloadDestroy(discovery);
+}
+
+TEST(CborConvertTest, SecurityPayloadIsCopied)
+{
+    uint8_t securityData[1024];
+    for (size_t i = 0; i < sizeof(securityData); ++i)
+    {
+        securityData[i] = (uint8_t) i;
+    }
+    OCSecurityPayload *security = OCSecurityPayloadCreate(securityData, sizeof(securityData));
+    ASSERT_TRUE(security != NULL);
+
+    uint8_t *cbor = NULL;
+    size_t size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) security, OC_FORMAT_CBOR,
+            &cbor, &size));
+    ASSERT_EQ(sizeof(securityData), size);
+    EXPECT_EQ(0, memcmp(securityData, cbor, size));
+
+    OICFree(cbor);
+    OCSecurityPayloadDestroy(security);
+}
@@ -29,6 +29,8 @@ extern "C"
     #include "oic_string.h"
     #include "oic_time.h"
     #include "ocresourcehandler.h"
+    #include "ocobserve.h"
+    #include "ocpayloadcbor.h"
 }
 
 #include "gtest/gtest.h"
@@ -48,8 +50,17 @@ extern "C"
 #include <string.h>
 
 #include <iostream>
+#include <set>
+#include <vector>
 #include <stdint.h>
 
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
 #include "gtest_helper.h"
 
 using namespace std;
@@ -146,6 +157,49 @@ OCEntityHandlerResult entityHandler(OCEntityHandlerFlag /*flag*/,
     return OC_EH_OK;
 }
 
+static int g_notifyHandlerCalls = 0;
+static int64_t g_notifyValue = 0;
+
+OCEntityHandlerResult notifyEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void* /*callbackParam*/)
+{
+    g_notifyHandlerCalls++;
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "value", g_notifyValue);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    OCStackResult result = OCDoResponse(&response);
+    OCPayloadDestroy((OCPayload *) payload);
+
+    return (OC_STACK_OK == result) ? OC_EH_OK : OC_EH_ERROR;
+}
+
+static OCStackResult g_deferResult = OC_STACK_ERROR;
+
+// Answers before returning, the way a request handed to another thread may be.
+OCEntityHandlerResult deferringEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void* /*callbackParam*/)
+{
+    g_deferResult = OCDeferResponse(entityHandlerRequest->requestHandle);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+
+    return (OC_STACK_OK == g_deferResult) ? OC_EH_SLOW : OC_EH_OK;
+}
+
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
@@ -181,6 +235,236 @@ uint8_t InitResourceIndex()
 #endif
 }
 
+#ifdef __linux__
+/**
+ * Plain UDP socket on the loopback interface that speaks just enough CoAP to send
+ * requests to the stack and to look at the messages the stack sends to it.
+ */
+class LoopbackCoapPeer
+{
+public:
+    struct Message
+    {
+        uint8_t type;
+        uint8_t code;
+        std::vector<uint8_t> token;
+        bool hasObserve;
+        uint32_t observe;
+        std::vector<uint8_t> payload;
+    };
+
+    LoopbackCoapPeer() : m_fd(socket(AF_INET, SOCK_DGRAM, 0)), m_port(0)
+    {
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        if (m_fd >= 0
+            && 0 == bind(m_fd, (struct sockaddr *) &addr, sizeof(addr))
+            && 0 == getsockname(m_fd, (struct sockaddr *) &addr, &length))
+        {
+            m_port = ntohs(addr.sin_port);
+        }
+    }
+
+    ~LoopbackCoapPeer()
+    {
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+    }
+
+    bool IsOpen() const
+    {
+        return m_port != 0;
+    }
+
+    OCDevAddr Address() const
+    {
+        OCDevAddr devAddr = {};
+        devAddr.adapter = OC_ADAPTER_IP;
+        devAddr.flags = OC_IP_USE_V4;
+        devAddr.port = m_port;
+        OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+        return devAddr;
+    }
+
+    /** Send a GET for path and query to the stack listening on port. */
+    bool SendGet(uint16_t port, uint16_t messageId, const std::vector<uint8_t> &token,
+                 const char *path, const char *query, bool confirmable = false)
+    {
+        std::vector<uint8_t> datagram;
+        datagram.push_back((confirmable ? 0x40 : 0x50)       // Version 1, CON or NON
+                           | (uint8_t) token.size());
+        datagram.push_back(0x01);                               // GET
+        datagram.push_back(messageId >> 8);
+        datagram.push_back(messageId & 0xFF);
+        datagram.insert(datagram.end(), token.begin(), token.end());
+
+        uint16_t lastOption = 0;
+        std::string segments(path);
+        for (size_t start = 1; start <= segments.size(); )
+        {
+            size_t end = segments.find('/', start);
+            end = (std::string::npos == end) ? segments.size() : end;
+            AddOption(datagram, lastOption, 11, segments.substr(start, end - start));
+            start = end + 1;
+        }
+        if (query)
+        {
+            AddOption(datagram, lastOption, 15, query);
+        }
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        return (ssize_t) datagram.size() == sendto(m_fd, datagram.data(), datagram.size(), 0,
+                                                   (struct sockaddr *) &addr, sizeof(addr));
+    }
+
+    /** Send a non-confirmable 2.05 response carrying a CBOR payload to the stack on port. */
+    bool SendContent(uint16_t port, uint16_t messageId, const std::vector<uint8_t> &token,
+                     const uint8_t *payload, size_t payloadSize)
+    {
+        std::vector<uint8_t> datagram;
+        datagram.push_back(0x50 | (uint8_t) token.size());    // Version 1, NON
+        datagram.push_back(0x45);                               // 2.05 Content
+        datagram.push_back(messageId >> 8);
+        datagram.push_back(messageId & 0xFF);
+        datagram.insert(datagram.end(), token.begin(), token.end());
+
+        uint16_t lastOption = 0;
+        AddOption(datagram, lastOption, 12, std::string(1, (char) 60));    // application/cbor
+        datagram.push_back(0xFF);
+        datagram.insert(datagram.end(), payload, payload + payloadSize);
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        return (ssize_t) datagram.size() == sendto(m_fd, datagram.data(), datagram.size(), 0,
+                                                   (struct sockaddr *) &addr, sizeof(addr));
+    }
+
+    /** Wait for a message, running the stack in between, and parse it. */
+    bool Receive(Message &message, long timeoutMs)
+    {
+        uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + timeoutMs;
+        do
+        {
+            OCProcess();
+            struct pollfd fds = { m_fd, POLLIN, 0 };
+            if (poll(&fds, 1, 10) > 0)
+            {
+                uint8_t buffer[2048];
+                ssize_t length = recv(m_fd, buffer, sizeof(buffer), 0);
+                if (length > 0 && Parse(buffer, (size_t) length, message))
+                {
+                    return true;
+                }
+            }
+        } while (OICGetCurrentTime(TIME_IN_MS) < deadline);
+        return false;
+    }
+
+private:
+    static void AddOption(std::vector<uint8_t> &datagram, uint16_t &lastOption,
+                          uint16_t option, const std::string &value)
+    {
+        // Only short deltas and values are needed here.
+        uint8_t delta = (uint8_t) (option - lastOption);
+        if (value.size() < 13)
+        {
+            datagram.push_back((uint8_t) (delta << 4 | value.size()));
+        }
+        else
+        {
+            datagram.push_back((uint8_t) (delta << 4 | 13));
+            datagram.push_back((uint8_t) (value.size() - 13));
+        }
+        datagram.insert(datagram.end(), value.begin(), value.end());
+        lastOption = option;
+    }
+
+    static bool ReadExtended(const uint8_t *&p, const uint8_t *end, uint32_t &value)
+    {
+        if (13 == value)
+        {
+            if (p + 1 > end)
+            {
+                return false;
+            }
+            value = 13 + p[0];
+            p += 1;
+        }
+        else if (14 == value)
+        {
+            if (p + 2 > end)
+            {
+                return false;
+            }
+            value = 269 + (p[0] << 8 | p[1]);
+            p += 2;
+        }
+        return value != 15;
+    }
+
+    static bool Parse(const uint8_t *data, size_t length, Message &message)
+    {
+        if (length < 4 || (data[0] >> 6) != 1)
+        {
+            return false;
+        }
+        size_t tokenLength = data[0] & 0x0F;
+        if (4 + tokenLength > length)
+        {
+            return false;
+        }
+        message.type = (data[0] >> 4) & 0x03;
+        message.code = data[1];
+        message.token.assign(data + 4, data + 4 + tokenLength);
+        message.hasObserve = false;
+        message.observe = 0;
+        message.payload.clear();
+
+        const uint8_t *p = data + 4 + tokenLength;
+        const uint8_t *end = data + length;
+        uint32_t option = 0;
+        while (p < end && 0xFF != *p)
+        {
+            uint32_t delta = *p >> 4;
+            uint32_t optionLength = *p & 0x0F;
+            p++;
+            if (!ReadExtended(p, end, delta) || !ReadExtended(p, end, optionLength)
+                || p + optionLength > end)
+            {
+                return false;
+            }
+            option += delta;
+            if (6 == option)
+            {
+                message.hasObserve = true;
+                for (uint32_t i = 0; i < optionLength; i++)
+                {
+                    message.observe = message.observe << 8 | p[i];
+                }
+            }
+            p += optionLength;
+        }
+        if (p < end)
+        {
+            message.payload.assign(p + 1, end);
+        }
+        return true;
+    }
+
+    int m_fd;
+    uint16_t m_port;
+};
+#endif // __linux__
+
 extern "C" uint32_t g_ocStackStartCount;
 
 OCDeviceProperties* getTestDeviceProps()
@@ -303,6 +587,36 @@ TEST(StackStart, StackStartSuccessiveInits)
     EXPECT_EQ(0u, g_ocStackStartCount);
 }
 
+TEST(StackProcess, WaitTimesOut)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT_SERVER);
+
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    uint32_t timeout = OCGetProcessTimeout(100);
+    EXPECT_GE(100u, timeout);
+
+    uint64_t start = OICGetCurrentTime(TIME_IN_MS);
+    EXPECT_EQ(OC_STACK_OK, OCWaitForProcess(timeout));
+    EXPECT_GE(OICGetCurrentTime(TIME_IN_MS) - start + 1, static_cast<uint64_t>(timeout));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackProcess, WakeUpEndsWait)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT_SERVER);
+
+    // A wake up that comes before the wait is not lost.
+    OCWakeUpProcess();
+    uint64_t start = OICGetCurrentTime(TIME_IN_MS);
+    EXPECT_EQ(OC_STACK_OK, OCWaitForProcess(60 * 1000));
+    EXPECT_GT(static_cast<uint64_t>(1000), OICGetCurrentTime(TIME_IN_MS) - start);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackStart, SetPlatformInfoValid)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -2339,6 +2653,635 @@ TEST(StackResourceAccess, DeleteMiddleResource)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResourceAccess, FindResourceByUriScaling)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting FindResourceByUriScaling test");
+
+    const size_t resourceCounts[] = { 10, 1000, 10000 };
+    const size_t countCount = sizeof(resourceCounts) / sizeof(resourceCounts[0]);
+    const size_t lookups = 100000;
+    uint64_t elapsed[countCount];
+
+    for (size_t c = 0; c < sizeof(resourceCounts) / sizeof(resourceCounts[0]); c++)
+    {
+        InitStack(OC_SERVER);
+
+        const size_t count = resourceCounts[c];
+        std::vector<OCResourceHandle> handles(count);
+        char uri[MAX_URI_LENGTH];
+        for (size_t i = 0; i < count; i++)
+        {
+            snprintf(uri, sizeof(uri), "/a/scale/%zu", i);
+            ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handles[i],
+                                                    "core.led",
+                                                    "core.rw",
+                                                    uri,
+                                                    0,
+                                                    NULL,
+                                                    OC_DISCOVERABLE));
+        }
+
+        uint64_t start = OICGetCurrentTime(TIME_IN_US);
+        for (size_t i = 0; i < lookups; i++)
+        {
+            size_t index = (i * 7919) % count;
+            snprintf(uri, sizeof(uri), "/a/scale/%zu", index);
+            ASSERT_EQ(handles[index], (OCResourceHandle) FindResourceByUri(uri));
+        }
+        elapsed[c] = OICGetCurrentTime(TIME_IN_US) - start;
+
+        // A deleted resource must no longer be found by its uri.
+        EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handles[0]));
+        EXPECT_EQ(NULL, OCGetResourceHandleAtUri("/a/scale/0"));
+        snprintf(uri, sizeof(uri), "/a/scale/%zu", count - 1);
+        EXPECT_EQ(handles[count - 1], OCGetResourceHandleAtUri(uri));
+
+        EXPECT_EQ(OC_STACK_OK, OCStop());
+    }
+
+    // With a thousand times more resources a linear search would take about a
+    // thousand times longer; an indexed lookup stays within a small factor.
+    uint64_t baseline = (elapsed[0] > 1000) ? elapsed[0] : 1000;
+    EXPECT_LT(elapsed[countCount - 1], 20 * baseline);
+}
+
+TEST(StackClientCB, LookupByTokenAndHandleAndExpire)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting LookupByTokenAndHandleAndExpire test");
+    InitStack(OC_CLIENT);
+
+    const size_t count = 1000;
+    std::vector<ClientCB *> nodes(count);
+    std::vector<OCDoHandle> handles(count);
+    OCCallbackData cbData = { NULL, asyncDoResourcesCallback, NULL };
+    char uri[MAX_URI_LENGTH];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CAToken_t token = NULL;
+        ASSERT_EQ(CA_STATUS_OK, CAGenerateToken(&token, CA_MAX_TOKEN_LEN));
+        handles[i] = (OCDoHandle) OICMalloc(sizeof(uint8_t));
+        ASSERT_TRUE(handles[i] != NULL);
+        snprintf(uri, sizeof(uri), "/a/cb/%zu", i);
+
+        // Odd callbacks get a TTL in the past and must be expired.
+        uint32_t ttl = (i % 2) ? 1 : UINT32_MAX;
+        ASSERT_EQ(OC_STACK_OK, AddClientCB(&nodes[i], &cbData, CA_MSG_CONFIRM,
+                                           token, CA_MAX_TOKEN_LEN, NULL, 0, NULL, 0,
+                                           CA_FORMAT_UNDEFINED, &handles[i], OC_REST_GET,
+                                           NULL, OICStrdup(uri), NULL, ttl));
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(nodes[i], GetClientCB(nodes[i]->token, nodes[i]->tokenLength, NULL, NULL));
+        EXPECT_EQ(nodes[i], GetClientCB(NULL, 0, handles[i], NULL));
+    }
+
+    DeleteTimedOutClientCBs();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ((i % 2) ? NULL : nodes[i], GetClientCB(NULL, 0, handles[i], NULL));
+    }
+
+    FindAndDeleteClientCB(nodes[0]);
+    EXPECT_EQ(NULL, GetClientCB(NULL, 0, handles[0], NULL));
+    EXPECT_EQ(nodes[2], GetClientCB(NULL, 0, handles[2], NULL));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackClientCB, UpdatedTTLExpires)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting UpdatedTTLExpires test");
+    InitStack(OC_CLIENT);
+
+    const size_t count = 8;
+    ClientCB *nodes[count];
+    OCDoHandle handles[count];
+    OCCallbackData cbData = { NULL, asyncDoResourcesCallback, NULL };
+    char uri[MAX_URI_LENGTH];
+
+    // Node 0 observes and starts without a TTL, the others never expire.
+    for (size_t i = 0; i < count; i++)
+    {
+        CAToken_t token = NULL;
+        ASSERT_EQ(CA_STATUS_OK, CAGenerateToken(&token, CA_MAX_TOKEN_LEN));
+        handles[i] = (OCDoHandle) OICMalloc(sizeof(uint8_t));
+        ASSERT_TRUE(handles[i] != NULL);
+        snprintf(uri, sizeof(uri), "/a/ttl/%zu", i);
+        ASSERT_EQ(OC_STACK_OK, AddClientCB(&nodes[i], &cbData, CA_MSG_CONFIRM,
+                                           token, CA_MAX_TOKEN_LEN, NULL, 0, NULL, 0,
+                                           CA_FORMAT_UNDEFINED, &handles[i],
+                                           i ? OC_REST_GET : OC_REST_OBSERVE,
+                                           NULL, OICStrdup(uri), NULL, UINT32_MAX));
+    }
+    EXPECT_EQ(0u, nodes[0]->TTL);
+
+    uint32_t earliest = 0;
+    DeleteTimedOutClientCBs();
+    EXPECT_EQ(nodes[0], GetClientCB(NULL, 0, handles[0], NULL));
+    ASSERT_TRUE(GetEarliestClientCBTTL(&earliest));
+    EXPECT_EQ(UINT32_MAX, earliest);
+
+    // The observe callback gets a TTL once a response keeps it alive.
+    UpdateClientCBTTL(nodes[0], 1);
+    ASSERT_TRUE(GetEarliestClientCBTTL(&earliest));
+    EXPECT_EQ(1u, earliest);
+    DeleteTimedOutClientCBs();
+    EXPECT_EQ(NULL, GetClientCB(NULL, 0, handles[0], NULL));
+
+    // Lowering the TTL of a node deep in the heap moves it to the root.
+    UpdateClientCBTTL(nodes[count - 1], 1);
+    ASSERT_TRUE(GetEarliestClientCBTTL(&earliest));
+    EXPECT_EQ(1u, earliest);
+    DeleteTimedOutClientCBs();
+    EXPECT_EQ(NULL, GetClientCB(NULL, 0, handles[count - 1], NULL));
+
+    // Clearing the TTL takes a node out of the heap for good.
+    for (size_t i = 1; i < count - 1; i++)
+    {
+        UpdateClientCBTTL(nodes[i], 0);
+    }
+    EXPECT_FALSE(GetEarliestClientCBTTL(&earliest));
+    DeleteTimedOutClientCBs();
+    for (size_t i = 1; i < count - 1; i++)
+    {
+        EXPECT_EQ(nodes[i], GetClientCB(NULL, 0, handles[i], NULL));
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+#ifdef __linux__
+TEST(StackObserve, NotificationEncodedOnceForAllObservers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting NotificationEncodedOnceForAllObservers test");
+    InitStack(OC_SERVER);
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+    OCDevAddr devAddr = peer.Address();
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led/notified",
+                                            notifyEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCResource *resource = (OCResource *) handle;
+
+    const uint8_t count = 5;
+    std::set<std::vector<uint8_t>> tokens;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t token[CA_MAX_TOKEN_LEN];
+        memset(token, 0xA0 + i, sizeof(token));
+        tokens.insert(std::vector<uint8_t>(token, token + sizeof(token)));
+
+        OCObservationId id;
+        ASSERT_EQ(OC_STACK_OK, GenerateObserverId(&id));
+        ASSERT_EQ(OC_STACK_OK, AddObserver("/a/led/notified", NULL, id,
+                                           (CAToken_t) token, CA_MAX_TOKEN_LEN,
+                                           resource, OC_LOW_QOS, OC_FORMAT_CBOR, 0, &devAddr));
+    }
+
+    uint32_t previousObserve = 0;
+    for (int round = 1; round <= 2; round++)
+    {
+        g_notifyHandlerCalls = 0;
+        g_notifyValue = round;
+        EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+
+        // The entity handler runs once, its encoded response goes to every observer.
+        EXPECT_EQ(1, g_notifyHandlerCalls);
+
+        std::set<std::vector<uint8_t>> notified;
+        std::vector<uint8_t> payload;
+        uint32_t observe = 0;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            LoopbackCoapPeer::Message message;
+            ASSERT_TRUE(peer.Receive(message, 2000));
+            EXPECT_EQ(0x45, message.code);    // 2.05 Content
+            EXPECT_TRUE(notified.insert(message.token).second);
+            ASSERT_TRUE(message.hasObserve);
+            if (0 == i)
+            {
+                payload = message.payload;
+                observe = message.observe;
+            }
+            EXPECT_EQ(observe, message.observe);
+            EXPECT_EQ(payload, message.payload);
+        }
+        EXPECT_EQ(tokens, notified);
+        EXPECT_FALSE(payload.empty());
+        EXPECT_EQ(resource->sequenceNum, observe);
+        EXPECT_LT(previousObserve, observe);
+        previousObserve = observe;
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+typedef struct
+{
+    bool called;
+    bool decoded;
+    int64_t value;
+} LazyResponseResult;
+
+static OCStackApplicationResult LazyResponseCB(void *ctx, OCDoHandle /*handle*/,
+                                               OCClientResponse *clientResponse)
+{
+    LazyResponseResult *result = (LazyResponseResult *) ctx;
+    result->called = true;
+    result->decoded = (NULL != clientResponse->payload);
+    if (result->decoded)
+    {
+        OCRepPayloadGetPropInt((OCRepPayload *) clientResponse->payload, "value", &result->value);
+    }
+    else
+    {
+        OCRepPayloadView view;
+        EXPECT_EQ(OC_STACK_OK, OCRepPayloadViewInit(&view, clientResponse->rawPayload,
+                                                    clientResponse->rawPayloadSize));
+        EXPECT_TRUE(OCRepPayloadViewGetPropInt(&view, "value", &result->value));
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+TEST(StackClient, LazyPayloadIsAskedForWithTheRequest)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting LazyPayloadIsAskedForWithTheRequest test");
+    InitStack(OC_CLIENT);
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+    OCDevAddr devAddr = peer.Address();
+
+    OCRepPayload *rep = OCRepPayloadCreate();
+    ASSERT_TRUE(rep != NULL);
+    ASSERT_TRUE(OCRepPayloadSetPropInt(rep, "value", 42));
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) rep, OC_FORMAT_CBOR, &cbor, &cborSize));
+    OCRepPayloadDestroy(rep);
+
+    const OCDoRequestFlags flags[] = { OC_DO_REQUEST_DEFAULT, OC_DO_REQUEST_LAZY_PAYLOAD };
+    for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++)
+    {
+        LazyResponseResult result = { false, false, 0 };
+        OCCallbackData cbData = { &result, LazyResponseCB, NULL };
+        ASSERT_EQ(OC_STACK_OK, OCDoRequestWithFlags(NULL, OC_REST_GET, "/a/lazy", &devAddr,
+                                                    NULL, CT_DEFAULT, OC_LOW_QOS, &cbData,
+                                                    NULL, 0, flags[i]));
+
+        LoopbackCoapPeer::Message request;
+        ASSERT_TRUE(peer.Receive(request, 2000));
+        EXPECT_EQ(0x01, request.code);      // GET
+        ASSERT_TRUE(peer.SendContent(caglobals.ip.u4.port, (uint16_t) (0x2000 + i),
+                                     request.token, cbor, cborSize));
+
+        uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + 2000;
+        while (!result.called && OICGetCurrentTime(TIME_IN_MS) < deadline)
+        {
+            OCProcess();
+            usleep(10 * 1000);
+        }
+        ASSERT_TRUE(result.called);
+        EXPECT_EQ(OC_DO_REQUEST_DEFAULT == flags[i], result.decoded);
+        EXPECT_EQ(42, result.value);
+    }
+    OICFree(cbor);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+/** Send a unicast discovery for resourceType to the stack and wait for the response. */
+static bool DiscoverResourceType(LoopbackCoapPeer &peer, uint16_t messageId,
+                                 const char *resourceType, LoopbackCoapPeer::Message &response)
+{
+    std::string query = std::string("rt=") + resourceType;
+    std::vector<uint8_t> token(CA_MAX_TOKEN_LEN, (uint8_t) messageId);
+    return peer.SendGet(caglobals.ip.u4.port, messageId, token, OC_RSRVD_WELL_KNOWN_URI,
+                        query.c_str())
+           && peer.Receive(response, 2000);
+}
+
+static bool PayloadContains(const LoopbackCoapPeer::Message &message, const char *text)
+{
+    std::string payload(message.payload.begin(), message.payload.end());
+    return std::string::npos != payload.find(text);
+}
+
+/**
+ * Rename a resource type behind the stack's back, so only a rebuilt discovery response
+ * can see the change.
+ */
+static void RenameResourceTypeInPlace(OCResourceHandle handle, const char *from, const char *to)
+{
+    ASSERT_EQ(strlen(from), strlen(to));
+    for (OCResourceType *type = ((OCResource *) handle)->rsrcType; type; type = type->next)
+    {
+        if (0 == strcmp(type->resourcetypename, from))
+        {
+            memcpy(type->resourcetypename, to, strlen(to));
+            return;
+        }
+    }
+    FAIL() << "no resource type " << from;
+}
+
+TEST(StackDiscoveryCache, RepeatedDiscoveryIsServedFromCache)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting RepeatedDiscoveryIsServedFromCache test");
+    InitStack(OC_SERVER);
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.hit", "core.rw", "/a/cachehit",
+                                            0, NULL, OC_DISCOVERABLE));
+
+    LoopbackCoapPeer::Message message;
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3001, "core.hit", message));
+    EXPECT_EQ(0x45, message.code);
+    EXPECT_TRUE(PayloadContains(message, "/a/cachehit"));
+
+    // A rebuilt response would no longer match the resource
+    RenameResourceTypeInPlace(handle, "core.hit", "core.hiu");
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3002, "core.hit", message));
+    EXPECT_EQ(0x45, message.code);
+    EXPECT_TRUE(PayloadContains(message, "/a/cachehit"));
+
+    InvalidateDiscoveryCache();
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3003, "core.hit", message));
+    EXPECT_EQ(0x84, message.code);      // 4.04 Not Found
+
+    RenameResourceTypeInPlace(handle, "core.hiu", "core.hit");
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackDiscoveryCache, NoResourceResponseIsCached)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting NoResourceResponseIsCached test");
+    InitStack(OC_SERVER);
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.nonf", "core.rw", "/a/cachenone",
+                                            0, NULL, OC_DISCOVERABLE));
+
+    LoopbackCoapPeer::Message message;
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3101, "core.none", message));
+    EXPECT_EQ(0x84, message.code);
+
+    // The cached 4.04 is kept until something invalidates it
+    RenameResourceTypeInPlace(handle, "core.nonf", "core.none");
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3102, "core.none", message));
+    EXPECT_EQ(0x84, message.code);
+
+    InvalidateDiscoveryCache();
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3103, "core.none", message));
+    EXPECT_EQ(0x45, message.code);
+    EXPECT_TRUE(PayloadContains(message, "/a/cachenone"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackDiscoveryCache, ResourceChangesInvalidateCache)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ResourceChangesInvalidateCache test");
+    InitStack(OC_SERVER);
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+    LoopbackCoapPeer::Message message;
+
+    // OCCreateResource, replacing a cached 4.04
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3201, "core.inv", message));
+    EXPECT_EQ(0x84, message.code);
+    OCResourceHandle created;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&created, "core.inv", "core.rw", "/a/invcreated",
+                                            0, NULL, OC_DISCOVERABLE));
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3202, "core.inv", message));
+    EXPECT_EQ(0x45, message.code);
+    EXPECT_TRUE(PayloadContains(message, "/a/invcreated"));
+
+    // OCBindResourceTypeToResource
+    OCResourceHandle bound;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&bound, "core.other", "core.rw", "/a/invbound",
+                                            0, NULL, OC_DISCOVERABLE));
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3203, "core.inv", message));
+    EXPECT_FALSE(PayloadContains(message, "/a/invbound"));
+    ASSERT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(bound, "core.inv"));
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3204, "core.inv", message));
+    EXPECT_TRUE(PayloadContains(message, "/a/invbound"));
+
+    // OCSetResourceProperties
+    OCResourceHandle hidden;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&hidden, "core.inv", "core.rw", "/a/invhidden",
+                                            0, NULL, OC_ACTIVE));
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3205, "core.inv", message));
+    EXPECT_FALSE(PayloadContains(message, "/a/invhidden"));
+    ASSERT_EQ(OC_STACK_OK, OCSetResourceProperties(hidden, OC_DISCOVERABLE));
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3206, "core.inv", message));
+    EXPECT_TRUE(PayloadContains(message, "/a/invhidden"));
+
+    // OCDeleteResource
+    ASSERT_EQ(OC_STACK_OK, OCDeleteResource(created));
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3207, "core.inv", message));
+    EXPECT_EQ(0x45, message.code);
+    EXPECT_FALSE(PayloadContains(message, "/a/invcreated"));
+    EXPECT_TRUE(PayloadContains(message, "/a/invbound"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackDiscoveryCache, AdapterChangeInvalidatesCache)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting AdapterChangeInvalidatesCache test");
+    InitStack(OC_SERVER);
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.nic", "core.rw", "/a/cachenic",
+                                            0, NULL, OC_DISCOVERABLE));
+
+    LoopbackCoapPeer::Message message;
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3301, "core.nic", message));
+    EXPECT_EQ(0x45, message.code);
+
+    RenameResourceTypeInPlace(handle, "core.nic", "core.nid");
+    OCDefaultAdapterStateChangedHandler(CA_ADAPTER_IP, true);
+    ASSERT_TRUE(DiscoverResourceType(peer, 0x3302, "core.nic", message));
+    EXPECT_EQ(0x84, message.code);
+
+    RenameResourceTypeInPlace(handle, "core.nid", "core.nic");
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackServerRequest, DeferredResponseIsSeparate)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DeferredResponseIsSeparate test");
+    InitStack(OC_SERVER);
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDeferResponse(NULL));
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led/deferred",
+                                            deferringEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE));
+
+    g_deferResult = OC_STACK_ERROR;
+    std::vector<uint8_t> token(CA_MAX_TOKEN_LEN, 0xB1);
+    ASSERT_TRUE(peer.SendGet(caglobals.ip.u4.port, 0x1234, token, "/a/led/deferred", NULL,
+                             true));
+
+    // Answered before the handler returned, yet not piggybacked on the ACK.
+    LoopbackCoapPeer::Message message;
+    do
+    {
+        ASSERT_TRUE(peer.Receive(message, 2000));
+    } while (0 == message.code);
+    EXPECT_EQ(OC_STACK_OK, g_deferResult);
+    EXPECT_EQ(0, message.type);         // CON
+    EXPECT_EQ(0x45, message.code);      // 2.05 Content
+    EXPECT_EQ(token, message.token);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackServerRequest, NotificationCannotBeDeferred)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting NotificationCannotBeDeferred test");
+    InitStack(OC_SERVER);
+
+    LoopbackCoapPeer peer;
+    ASSERT_TRUE(peer.IsOpen());
+    OCDevAddr devAddr = peer.Address();
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led/deferred",
+                                            deferringEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    uint8_t token[CA_MAX_TOKEN_LEN];
+    memset(token, 0xB2, sizeof(token));
+    OCObservationId id;
+    ASSERT_EQ(OC_STACK_OK, GenerateObserverId(&id));
+    ASSERT_EQ(OC_STACK_OK, AddObserver("/a/led/deferred", NULL, id,
+                                       (CAToken_t) token, CA_MAX_TOKEN_LEN,
+                                       (OCResource *) handle, OC_LOW_QOS, OC_FORMAT_CBOR, 0,
+                                       &devAddr));
+
+    // The notification is still sent from within OCNotifyAllObservers().
+    g_deferResult = OC_STACK_ERROR;
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_NOT_ACCEPTABLE, g_deferResult);
+
+    LoopbackCoapPeer::Message message;
+    ASSERT_TRUE(peer.Receive(message, 2000));
+    EXPECT_EQ(1, message.type);         // NON
+    EXPECT_EQ(0x45, message.code);
+    EXPECT_TRUE(message.hasObserve);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+#endif // __linux__
+
+TEST(StackObserve, ObserverIndexAndResourceList)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ObserverIndexAndResourceList test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led/observed",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCResource *resource = (OCResource *) handle;
+
+    OCDevAddr devAddr = {};
+    devAddr.adapter = OC_ADAPTER_IP;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+
+    const uint8_t count = 10;
+    OCObservationId ids[count];
+    uint8_t tokens[count][CA_MAX_TOKEN_LEN];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        memset(tokens[i], i + 1, sizeof(tokens[i]));
+        ASSERT_EQ(OC_STACK_OK, GenerateObserverId(&ids[i]));
+        ASSERT_EQ(OC_STACK_OK, AddObserver("/a/led/observed", NULL, ids[i],
+                                           (CAToken_t) tokens[i], CA_MAX_TOKEN_LEN,
+                                           resource, OC_LOW_QOS, OC_FORMAT_CBOR, 0, &devAddr));
+    }
+
+    size_t observers = 0;
+    for (ResourceObserver *obs = resource->observersHead; obs; obs = obs->resourceNext)
+    {
+        EXPECT_EQ(resource, obs->resource);
+        observers++;
+    }
+    EXPECT_EQ(count, observers);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        ResourceObserver *obs = GetObserverUsingId(ids[i]);
+        ASSERT_TRUE(obs != NULL);
+        EXPECT_EQ(obs, GetObserverUsingToken((CAToken_t) tokens[i], CA_MAX_TOKEN_LEN));
+    }
+
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t) tokens[0], CA_MAX_TOKEN_LEN));
+    EXPECT_EQ(NULL, GetObserverUsingId(ids[0]));
+    EXPECT_TRUE(GetObserverUsingId(ids[1]) != NULL);
+
+    // Deleting the resource removes its observers.
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+    for (uint8_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(NULL, GetObserverUsingId(ids[i]));
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 // Visual Studio versions earlier than 2015 have bugs in is_pod and report the wrong answer.
 #if !defined(_MSC_VER) || (_MSC_VER >= 1900)
 TEST(PODTests, OCHeaderOption)
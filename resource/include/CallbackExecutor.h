@@ -0,0 +1,162 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the executor that runs the application callbacks of the
+ * client wrapper, so that a discovery returning many resources does not start
+ * a thread per resource.
+ */
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    /**
+     * Runs callbacks either inline or on a pool of worker threads taking them
+     * from one queue in order. When callbacks are queued but no worker has
+     * finished one for a while, e.g. because the callbacks being run wait for
+     * a queued one, the pool grows by a thread at a time up to a limit; the
+     * added threads end once they have been idle for a while.
+     *
+     * A callback must not wait for a callback posted with its own key, which
+     * only runs after it returns. The pool cannot grow out of that; it is
+     * logged when the later callbacks of a key have been held up for a while.
+     */
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        CallbackExecutor();
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        /**
+         * The executor used by the client wrapper.
+         */
+        static CallbackExecutor& instance();
+
+        /**
+         * Sets how callbacks are run. A running pool is drained and stopped
+         * first if the settings change. Ignored when called from a callback.
+         *
+         * @param execution    Inline or on the thread pool.
+         * @param threadCount  Number of worker threads, 0 for the default.
+         */
+        void configure(CallbackExecution execution, size_t threadCount);
+
+        /**
+         * Runs the task according to the configuration. The pool threads are
+         * started on first use.
+         */
+        void post(Task task);
+
+        /**
+         * Runs the task according to the configuration, after the earlier
+         * tasks posted with the same key. Until then it counts as queued.
+         *
+         * @param key   Serialization key, e.g. the context of a request.
+         * @param task  Task to run.
+         */
+        void post(const void* key, Task task);
+
+        /**
+         * Queues the task behind the earlier tasks posted with the same key,
+         * so tasks of one key run one at a time and in order while tasks of
+         * different keys run in parallel.
+         *
+         * @param key   Serialization key, e.g. a resource handle.
+         * @param task  Task to run.
+         * @return false without running the task when configured Inline.
+         */
+        bool postSerialized(const void* key, Task task);
+
+        /**
+         * Returns the queue depth and execution counters.
+         */
+        CallbackExecutorStats getStats() const;
+
+        /**
+         * Returns true when tasks are run by the thread posting them.
+         */
+        bool isInline() const;
+
+    private:
+        // Tasks waiting behind a running task of the same key. A key is
+        // present while one of its tasks is queued or running.
+        struct Strand
+        {
+            std::deque<Task> tasks;
+            // When the running task started, unset until the first one
+            // does, and whether the monitor has reported it holding up the
+            // others.
+            std::chrono::steady_clock::time_point started;
+            bool reported;
+
+            Strand() : reported(false) {}
+        };
+
+        void enqueue(Task task);
+        void push(Task task);
+        void serialize(const void* key, Task task);
+        void startThread();
+        void stop();
+        bool isWorkerThread() const;
+        void run();
+        void monitor();
+        void runSerialized(const void* key, Task task);
+
+        // Guards everything below except m_executed. Never held while a
+        // task runs or while a worker is joined.
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cond;
+        CallbackExecution m_execution;
+        size_t m_threadCount;
+        std::deque<Task> m_tasks;
+        std::map<std::thread::id, std::thread> m_threads;
+        // Adds a worker when the queue does not move.
+        std::thread m_monitor;
+        std::condition_variable m_monitorCond;
+        size_t m_idle;
+        bool m_stopping;
+        size_t m_maxQueued;
+        std::map<const void*, Strand> m_strands;
+        // Tasks in all m_strands, which count as queued.
+        size_t m_strandQueued;
+
+        std::atomic<uint64_t> m_executed;
+    };
+}
+
+#endif // OC_CALLBACK_EXECUTOR_H_
@@ -0,0 +1,57 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the lock that serializes the C++ wrappers' calls into
+ * the C stack.
+ */
+
+#ifndef OC_CSDK_LOCK_H_
+#define OC_CSDK_LOCK_H_
+
+#include <mutex>
+
+namespace OC
+{
+    /**
+     * Recursive lock serializing the C++ wrappers' calls into the C stack,
+     * including OCProcess(). Entity handlers and callbacks run with it held
+     * may call back into the platform.
+     *
+     * The C stack's resource, observer and callback tables are not safe for
+     * concurrent readers, so lookups take the lock exclusively as well.
+     */
+    class CsdkLock
+    {
+    public:
+        CsdkLock() = default;
+
+        CsdkLock(const CsdkLock&) = delete;
+        CsdkLock& operator=(const CsdkLock&) = delete;
+
+        void lock();
+        void unlock();
+
+    private:
+        std::recursive_mutex m_mutex;
+    };
+}
+
+#endif // OC_CSDK_LOCK_H_
@@ -28,6 +28,7 @@
 
 #include <OCApi.h>
 #include <IClientWrapper.h>
+#include <CsdkLock.h>
 #include <InitializeException.h>
 #include <ResourceInitException.h>
 
@@ -136,7 +137,7 @@ namespace OC
 
     public:
 
-        InProcClientWrapper(std::weak_ptr<std::recursive_mutex> csdkLock,
+        InProcClientWrapper(std::weak_ptr<CsdkLock> csdkLock,
                             PlatformConfig cfg);
         virtual ~InProcClientWrapper();
 
@@ -256,7 +257,7 @@ namespace OC
         void convert(const OCDPDev_t *list, PairedDevices& dpList);
         std::thread m_listeningThread;
         bool m_threadRun;
-        std::weak_ptr<std::recursive_mutex> m_csdkLock;
+        std::weak_ptr<CsdkLock> m_csdkLock;
 
     private:
         PlatformConfig  m_cfg;
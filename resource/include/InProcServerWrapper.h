@@ -24,6 +24,7 @@
 #include <thread>
 #include <mutex>
 
+#include <CsdkLock.h>
 #include <IServerWrapper.h>
 
 namespace OC
@@ -32,7 +33,7 @@ namespace OC
     {
     public:
         InProcServerWrapper(
-            std::weak_ptr<std::recursive_mutex> csdkLock,
+            std::weak_ptr<CsdkLock> csdkLock,
             PlatformConfig cfg);
         virtual ~InProcServerWrapper();
 
@@ -94,7 +95,7 @@ namespace OC
         void processFunc();
         std::thread m_processThread;
         bool m_threadRun;
-        std::weak_ptr<std::recursive_mutex> m_csdkLock;
+        std::weak_ptr<CsdkLock> m_csdkLock;
         PlatformConfig  m_cfg;
     };
 }
@@ -111,6 +111,33 @@ namespace OC
         Gateway  /**< Client server mode along with routing capabilities.*/
     };
 
+    /**
+     * How the wrappers run the application callbacks and entity handlers.
+     */
+    enum class CallbackExecution
+    {
+        ThreadPool, /**< on a pool of worker threads.*/
+        Inline      /**< on the stack thread that delivered the response or request.*/
+    };
+
+    /**
+     * Counters of the callback executor.
+     */
+    struct CallbackExecutorStats
+    {
+        /** callbacks waiting for a worker thread or for an earlier one of their key. */
+        size_t queueDepth;
+
+        /** largest queueDepth seen. */
+        size_t maxQueueDepth;
+
+        /** callbacks run so far. */
+        uint64_t executed;
+
+        /** worker threads running. */
+        size_t threads;
+    };
+
     /**
      * Quality of Service attempts to abstract the guarantees provided by the underlying transport
      * protocol. The precise definitions of each quality of service level depend on the
@@ -176,6 +203,32 @@ namespace OC
          */
         bool                       useLegacyCleanup;
 
+        /** how the application callbacks are run. */
+        CallbackExecution          callbackExecution;
+
+        /**
+         * worker threads for CallbackExecution::ThreadPool, 0 for the default. Callbacks
+         * of one request run in order; threads are added while all of them are stuck.
+         */
+        size_t                     callbackThreads;
+
+        /**
+         * how the entity handlers are run. With ThreadPool, requests for different
+         * resources are handled in parallel while requests for one resource stay in
+         * order, and every request is answered with a separate (slow) response.
+         */
+        CallbackExecution          requestExecution;
+
+        /** worker threads for requestExecution ThreadPool, 0 for the default. */
+        size_t                     requestThreads;
+
+        /**
+         * whether representations received for get and observe are decoded on access.
+         * Attributes are then read from the received CBOR as they are asked for, which
+         * saves decoding attributes that are never read.
+         */
+        bool                       lazyRepresentations;
+
         public:
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -189,7 +242,12 @@ namespace OC
                 port(0),
                 QoS(QualityOfService::NaQos),
                 ps(ps_),
-                useLegacyCleanup(false)
+                useLegacyCleanup(false),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(0),
+                requestExecution(CallbackExecution::Inline),
+                requestThreads(0),
+                lazyRepresentations(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig()
@@ -202,7 +260,12 @@ namespace OC
                 port(0),
                 QoS(QualityOfService::NaQos),
                 ps(nullptr),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(0),
+                requestExecution(CallbackExecution::Inline),
+                requestThreads(0),
+                lazyRepresentations(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -220,7 +283,12 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(0),
+                requestExecution(CallbackExecution::Inline),
+                requestThreads(0),
+                lazyRepresentations(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -238,7 +306,12 @@ namespace OC
                 port(port_),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(0),
+                requestExecution(CallbackExecution::Inline),
+                requestThreads(0),
+                lazyRepresentations(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -256,7 +329,12 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(0),
+                requestExecution(CallbackExecution::Inline),
+                requestThreads(0),
+                lazyRepresentations(false)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -272,7 +350,12 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(0),
+                requestExecution(CallbackExecution::Inline),
+                requestThreads(0),
+                lazyRepresentations(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -291,7 +374,12 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(0),
+                requestExecution(CallbackExecution::Inline),
+                requestThreads(0),
+                lazyRepresentations(false)
         {}
 
     };
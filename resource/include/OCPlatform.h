@@ -791,6 +791,13 @@ namespace OC
          * @return Returns ::OC_STACK_OK if success.
          */
         OCStackResult setDeviceId(const OCUUIdentity *deviceId);
+
+        /**
+         * gets the counters of the executor running the client callbacks
+         *
+         * @return queue depth, largest queue depth, callbacks run and worker threads.
+         */
+        CallbackExecutorStats getCallbackExecutorStats();
     }
 }
 
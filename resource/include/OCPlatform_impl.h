@@ -318,7 +318,7 @@ namespace OC
                         const std::vector<std::string>& interfaces);
 
         OCStackResult sendResponse(const std::shared_ptr<OCResourceResponse> pResponse);
-        std::weak_ptr<std::recursive_mutex> csdkLock();
+        std::weak_ptr<CsdkLock> csdkLock();
 
         OCStackResult findDirectPairingDevices(unsigned short waittime,
                                          GetDirectPairedCallback callback);
@@ -347,7 +347,7 @@ namespace OC
         std::unique_ptr<WrapperFactory> m_WrapperInstance;
         IServerWrapper::Ptr m_server;
         IClientWrapper::Ptr m_client;
-        std::shared_ptr<std::recursive_mutex> m_csdkLock;
+        std::shared_ptr<CsdkLock> m_csdkLock;
         std::mutex m_startCountLock;
         uint32_t m_startCount;
 
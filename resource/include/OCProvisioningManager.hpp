@@ -561,12 +561,12 @@ namespace OC
     class OCSecureResource
     {
         private:
-            std::weak_ptr<std::recursive_mutex> m_csdkLock;
+            std::weak_ptr<CsdkLock> m_csdkLock;
             OCProvisionDev_t *devPtr;   // pointer to device.
 
         public:
             OCSecureResource();
-            OCSecureResource(std::weak_ptr<std::recursive_mutex> csdkLock, OCProvisionDev_t *dPtr);
+            OCSecureResource(std::weak_ptr<CsdkLock> csdkLock, OCProvisionDev_t *dPtr);
 
             ~OCSecureResource();
 
@@ -32,6 +32,7 @@
 #include <sstream>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include <AttributeValue.h>
 #include <StringConstants.h>
@@ -65,6 +66,14 @@ namespace OC
 
             void setPayload(const OCRepPayload* rep);
 
+            /**
+             * Adds a representation that decodes its attributes from cbor as they
+             * are asked for. cbor is copied.
+             *
+             * @return false if cbor isn't a single representation.
+             */
+            bool setLazyPayload(const uint8_t* cbor, size_t size);
+
             OCRepPayload* getPayload() const;
 
             const std::vector<OCRepresentation>& representations() const;
@@ -128,7 +137,7 @@ namespace OC
             // It is believed that this is a result of incompatible compiler
             // options between the gradle JNI and armeabi scons build, however
             // this fix will work in the meantime.
-            OCRepresentation(): m_interfaceType(InterfaceType::None){}
+            OCRepresentation(): m_lazyView(), m_interfaceType(InterfaceType::None){}
 
 #if defined(_MSC_VER) && (_MSC_VER < 1900)
             OCRepresentation(OCRepresentation&& o)
@@ -227,6 +236,7 @@ namespace OC
             }
 
             const std::map<std::string, AttributeValue>& getValues() const {
+                loadValues();
                 return m_values;
             }
 
@@ -246,6 +256,7 @@ namespace OC
             template<typename T, typename std::enable_if<IsSupportedType<T>::value, int>::type = 0>
             bool getValue(const std::string& str, T& val) const
             {
+                loadAttribute(str);
                 auto x = m_values.find(str);
 
                 if (x != m_values.end())
@@ -266,6 +277,7 @@ namespace OC
             template<typename T, typename std::enable_if<!IsSupportedType<T>::value, int>::type = 0>
             bool getValue(const std::string& str, T& val) const
             {
+                loadAttribute(str);
                 auto item = m_values.find(str);
 
                 if (item != m_values.end())
@@ -299,6 +311,7 @@ namespace OC
             template<typename T, typename std::enable_if<IsSupportedType<T>::value, int>::type = 0>
             T getValue(const std::string& str) const
             {
+                loadAttribute(str);
                 auto x = m_values.find(str);
                 if (x != m_values.end())
                 {
@@ -316,6 +329,7 @@ namespace OC
             template<typename T, typename std::enable_if<!IsSupportedType<T>::value, int>::type = 0>
             T getValue(const std::string& str) const
             {
+                loadAttribute(str);
                 T val = T();
                 auto x = m_values.find(str);
                 if (x != m_values.end())
@@ -341,6 +355,7 @@ namespace OC
             */
             bool getAttributeValue(const std::string& str, AttributeValue& attrValue) const
             {
+                loadAttribute(str);
                 auto x = m_values.find(str);
 
                 if (x != m_values.end())
@@ -588,6 +603,30 @@ namespace OC
             static void assignAttributeValueContent(const std::vector<std::vector<int>>&  val, AttributeValue& attributeValue);
             static void assignAttributeValueContent(const std::vector<std::vector<std::vector<int>>>&  val, AttributeValue& attributeValue);
 
+            // A representation received with PlatformConfig::lazyRepresentations keeps
+            // the CBOR it came in and decodes attributes into m_values as they are
+            // asked for. Accessors for single attributes decode just that one, all
+            // others decode the rest first. Decoding changes the representation, so
+            // even const access must not happen concurrently.
+            void setLazyPayload(const std::shared_ptr<const std::vector<uint8_t>>& data,
+                    const OCRepPayloadView& view);
+            void loadAttribute(const std::string& str) const
+            {
+                if (m_lazyData)
+                {
+                    loadLazyAttribute(str);
+                }
+            }
+            void loadValues() const
+            {
+                if (m_lazyData)
+                {
+                    loadLazyValues();
+                }
+            }
+            void loadLazyAttribute(const std::string& str) const;
+            void loadLazyValues() const;
+
             template<typename T>
             void payload_array_helper(const OCRepPayloadValue* pl, size_t depth);
             template<typename T>
@@ -631,6 +670,10 @@ namespace OC
             std::vector<std::string> m_interfaces;
             std::vector<std::string> m_dataModelVersions;
 
+            // Received CBOR of attributes not decoded yet, see setLazyPayload.
+            mutable std::shared_ptr<const std::vector<uint8_t>> m_lazyData;
+            mutable OCRepPayloadView m_lazyView;
+
             InterfaceType m_interfaceType;
     };
 
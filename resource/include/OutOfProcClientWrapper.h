@@ -22,13 +22,14 @@
 #define OC_OUT_OF_PROC_CLIENT_WRAPPER_H_
 
 #include <OCApi.h>
+#include <CsdkLock.h>
 
 namespace OC
 {
     class OutOfProcClientWrapper : public IClientWrapper
     {
     public:
-        OutOfProcClientWrapper(std::weak_ptr<std::recursive_mutex> /*csdkLock*/,
+        OutOfProcClientWrapper(std::weak_ptr<CsdkLock> /*csdkLock*/,
                                PlatformConfig /*cfg*/)
         {}
 
@@ -40,10 +40,10 @@ namespace OC
         typedef std::shared_ptr<IWrapperFactory> Ptr;
 
         virtual IClientWrapper::Ptr CreateClientWrapper(
-            std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg,
+            std::weak_ptr<CsdkLock> csdkLock, PlatformConfig cfg,
             OCStackResult *result) =0;
         virtual IServerWrapper::Ptr CreateServerWrapper(
-            std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg,
+            std::weak_ptr<CsdkLock> csdkLock, PlatformConfig cfg,
             OCStackResult *result) =0;
         virtual ~IWrapperFactory(){}
     };
@@ -55,7 +55,7 @@ namespace OC
         WrapperFactory(){}
 
         virtual IClientWrapper::Ptr CreateClientWrapper(
-            std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg, OCStackResult *result)
+            std::weak_ptr<CsdkLock> csdkLock, PlatformConfig cfg, OCStackResult *result)
         {
             if (result)
             {
@@ -83,7 +83,7 @@ namespace OC
         }
 
         virtual IServerWrapper::Ptr CreateServerWrapper(
-            std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg, OCStackResult *result)
+            std::weak_ptr<CsdkLock> csdkLock, PlatformConfig cfg, OCStackResult *result)
         {
             if (result)
             {
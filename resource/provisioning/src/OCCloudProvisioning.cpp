@@ -78,7 +78,7 @@ namespace OC
         {
             CloudProvisionContext *context = new CloudProvisionContext(callback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCCloudCertificateIssueRequest(static_cast<void*>(context), &m_devAddr,
                     &OCCloudProvisioning::callbackWrapper);
         }
@@ -106,7 +106,7 @@ namespace OC
         {
             CloudProvisionContext *context = new CloudProvisionContext(callback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCCloudAclIndividualGetInfo(static_cast<void*>(context), aclId.c_str(),
                     &m_devAddr,
                     &OCCloudProvisioning::callbackWrapper);
@@ -135,7 +135,7 @@ namespace OC
         {
             AclIdContext *context = new AclIdContext(callback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCCloudGetAclIdByDevice(static_cast<void*>(context), deviceId.c_str(),
                     &m_devAddr,
                     &OCCloudProvisioning::aclIdResponseWrapper);
@@ -163,7 +163,7 @@ namespace OC
         {
             CloudProvisionContext *context = new CloudProvisionContext(callback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCCloudGetCRL(static_cast<void*>(context), &m_devAddr,
                     &OCCloudProvisioning::callbackWrapper);
         }
@@ -194,7 +194,7 @@ namespace OC
         {
             CloudProvisionContext *context = new CloudProvisionContext(callback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCCloudPostCRL(static_cast<void*>(context), thisUpdate.c_str(),
                     nextUpdate.c_str(), crl, serialNumbers, &m_devAddr,
                     &OCCloudProvisioning::callbackWrapper);
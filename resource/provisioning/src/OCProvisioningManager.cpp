@@ -73,7 +73,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCInitPM(dbPath.c_str());
         }
         else
@@ -95,7 +95,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDiscoverUnownedDevices(timeout, &pDevList);
             if (result == OC_STACK_OK)
             {
@@ -134,7 +134,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDiscoverOwnedDevices(timeout, &pDevList);
             if (result == OC_STACK_OK)
             {
@@ -173,7 +173,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDiscoverSingleDevice(timeout, deviceID, &pDev);
             if (result == OC_STACK_OK)
             {
@@ -221,7 +221,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCSetOwnerTransferCallbackData(oxm, callbackData);
             if (result == OC_STACK_OK && (OIC_RANDOM_DEVICE_PIN == oxm))
             {
@@ -249,7 +249,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDiscoverSingleDeviceInUnicast(timeout, deviceID, hostAddress.c_str(),
                             connType, &pDev);
 
@@ -290,7 +290,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDiscoverMultipleOwnerEnabledDevices(timeout, &pDevList);
             if (result == OC_STACK_OK)
             {
@@ -328,7 +328,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDiscoverMultipleOwnedDevices(timeout, &pDevList);
             if (result == OC_STACK_OK)
             {
@@ -365,7 +365,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDiscoverMultipleOwnerEnabledSingleDevice(timeout, deviceID, &pDev);
             if (result == OC_STACK_OK)
             {
@@ -412,7 +412,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             SetInputPinCB(inputPin);
             g_inputPinCallbackRegistered = true;
         }
@@ -432,7 +432,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             UnsetInputPinCB();
             g_inputPinCallbackRegistered = false;
         }
@@ -478,7 +478,7 @@ namespace OC
             InputPinContext* inputPinContext = new InputPinContext(inputPinCB);
             if (nullptr != inputPinContext)
             {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
+                std::lock_guard<CsdkLock> lock(*cLock);
                 result = SetInputPinWithContextCB(&inputPinCallbackWrapper, static_cast<void*>(inputPinContext));
                 if (OC_STACK_OK == result)
                 {
@@ -514,7 +514,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             UnsetInputPinWithContextCB();
             if (nullptr != inputPinCallbackHandle)
             {
@@ -538,7 +538,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = SetRandomPinPolicy(pinSize, pinType);
         }
         else
@@ -560,7 +560,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             result = OCGetDevInfoFromNetwork(timeout, &owned, &unowned);
 
@@ -614,7 +614,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             SetGeneratePinCB(displayPin);
             g_displayPinCallbackRegistered = true;
         }
@@ -634,7 +634,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             UnsetGeneratePinCB();
             g_displayPinCallbackRegistered = false;
         }
@@ -680,7 +680,7 @@ namespace OC
             DisplayPinContext* displayPinContext = new DisplayPinContext(displayPinCB);
             if (nullptr != displayPinContext)
             {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
+                std::lock_guard<CsdkLock> lock(*cLock);
                 result = SetDisplayPinWithContextCB(&displayPinCallbackWrapper, static_cast<void*>(displayPinContext));
                 if (OC_STACK_OK == result)
                 {
@@ -715,7 +715,7 @@ namespace OC
         auto cLock = OCPlatform_impl::Instance().csdkLock().lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             UnsetDisplayPinWithContextCB();
             if (nullptr != displayPinCallbackHandle)
             {
@@ -749,7 +749,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             OicUuid_t targetDev;
             result = ConvertStrToUuid(uuid.c_str(), &targetDev);
@@ -784,7 +784,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCSaveACL(const_cast<OicSecAcl_t*>(acl));
         }
         else
@@ -834,7 +834,7 @@ namespace OC
         if (cLock)
         {
             DisplayNumContext* context = new DisplayNumContext(displayNumCB);
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             SetDisplayNumCB(static_cast<void*>(context), &OCSecure::displayNumCallbackWrapper);
             result = OC_STACK_OK;
         }
@@ -853,7 +853,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             DisplayNumContext* context = static_cast<DisplayNumContext*>(UnsetDisplayNumCB());
             if (context)
             {
@@ -901,7 +901,7 @@ namespace OC
         if (cLock)
         {
             UserConfirmNumContext* context = new UserConfirmNumContext(userConfirmCB);
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             SetUserConfirmCB(static_cast<void*>(context), &OCSecure::confirmUserCallbackWrapper);
             result = OC_STACK_OK;
         }
@@ -920,7 +920,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             UserConfirmNumContext* context = static_cast<UserConfirmNumContext*>(UnsetUserConfirmCB());
             if (context)
             {
@@ -943,7 +943,7 @@ namespace OC
         auto cLock = OCPlatform_impl::Instance().csdkLock().lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             SetVerifyOption(optionMask);
             result = OC_STACK_OK;
         }
@@ -962,7 +962,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCConfigSelfOwnership();
         }
         else
@@ -1011,7 +1011,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCSaveTrustCertChain(trustCertChain, chainSize, encodingType, credId );
         }
         else
@@ -1030,7 +1030,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCReadTrustCertChain(credId, trustCertChain, chainSize);
         }
         else
@@ -1066,7 +1066,7 @@ namespace OC
         if (cLock)
         {
             TrustCertChainContext* context = new TrustCertChainContext(callback);
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCRegisterTrustCertChainNotifier(static_cast<void*>(context),
                     &OCSecure::certCallbackWrapper);
         }
@@ -1086,7 +1086,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCRemoveTrustCertChainNotifier();
             result = OC_STACK_OK;
         }
@@ -1111,7 +1111,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = SetDeviceIdSeed(seed, seedSize);
         }
         else
@@ -1133,12 +1133,12 @@ namespace OC
         callbackWrapperImpl(ctx, nOfRes, arr, hasError);
     }
 
-    OCSecureResource::OCSecureResource(): m_csdkLock(std::weak_ptr<std::recursive_mutex>()),
+    OCSecureResource::OCSecureResource(): m_csdkLock(std::weak_ptr<CsdkLock>()),
                                         devPtr(nullptr)
     {
     }
 
-    OCSecureResource::OCSecureResource(std::weak_ptr<std::recursive_mutex> csdkLock,
+    OCSecureResource::OCSecureResource(std::weak_ptr<CsdkLock> csdkLock,
             OCProvisionDev_t *dPtr)
         :m_csdkLock(csdkLock), devPtr(dPtr)
     {
@@ -1167,7 +1167,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoOwnershipTransfer(static_cast<void*>(context),
                     devPtr, &OCSecureResource::callbackWrapper);
         }
@@ -1195,7 +1195,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoMultipleOwnershipTransfer(static_cast<void*>(context),
                     devPtr, &OCSecureResource::callbackWrapper);
         }
@@ -1220,7 +1220,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCIsSubownerOfDevice(devPtr, subowner);
         }
         else
@@ -1253,7 +1253,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCProvisionACL(static_cast<void*>(context),
                     devPtr, const_cast<OicSecAcl_t*>(acl),
                     &OCSecureResource::callbackWrapper);
@@ -1282,7 +1282,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCProvisionCredentials(static_cast<void*>(context),
                     cred.getCredentialType(),
                     cred.getCredentialKeySize(),
@@ -1314,7 +1314,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCProvisionPairwiseDevices(static_cast<void*>(context),
                     cred.getCredentialType(),
                     cred.getCredentialKeySize(),
@@ -1346,7 +1346,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             result = OCUnlinkDevices(static_cast<void*>(context),
                     devPtr, device2.getDevPtr(), &OCSecureResource::callbackWrapper);
@@ -1375,7 +1375,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             result = OCRemoveDevice(static_cast<void*>(context), waitTimeForOwnedDeviceDiscovery,
                     devPtr, &OCSecureResource::callbackWrapper);
@@ -1397,7 +1397,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             OCUuidList_t* linkedDevs = nullptr, *tmp = nullptr;
             result = OCGetLinkedStatus(&devUuid, &linkedDevs, &numOfDevices);
@@ -1439,7 +1439,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCProvisionDirectPairing(static_cast<void*>(context),
                     devPtr, const_cast<OicSecPconf_t*>(pconf),
                     &OCSecureResource::callbackWrapper);
@@ -1474,7 +1474,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCProvisionTrustCertChain(static_cast<void*>(context),
                     type, credId, devPtr,
                     &OCSecureResource::callbackWrapper);
@@ -1557,7 +1557,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             if(devPtr && devPtr->doxm)
             {
                 result = OCSelectOwnershipTransferMethod(devPtr->doxm->oxm, devPtr->doxm->oxmLen,
@@ -1585,7 +1585,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             if (devPtr && devPtr->doxm)
             {
                 result = OCSelectOwnershipTransferMethod(devPtr->doxm->oxm, devPtr->doxm->oxmLen,
@@ -1636,7 +1636,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCSelectMOTMethod(static_cast<void*>(context),
                     devPtr, oxmSelVal,
                     &OCSecureResource::callbackWrapper);
@@ -1665,7 +1665,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCChangeMOTMode(static_cast<void*>(context),
                     devPtr, momType,
                     &OCSecureResource::callbackWrapper);
@@ -1697,7 +1697,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCAddPreconfigPin(devPtr, preconfPIN,
                     preconfPINLength);
         }
@@ -1735,7 +1735,7 @@ namespace OC
         {
             ProvisionContext* context = new ProvisionContext(resultCallback);
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCProvisionPreconfigPin(static_cast<void*>(context),
                     devPtr, preconfPin, preconfPinLength,
                     &OCSecureResource::callbackWrapper);
@@ -0,0 +1,380 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace OC
+{
+    namespace
+    {
+        // Pool size when PlatformConfig::callbackThreads is 0.
+        const size_t DEFAULT_CALLBACK_THREADS = 4;
+
+        // Threads added while every worker is stuck, on top of the pool size.
+        const size_t MAX_EXTRA_CALLBACK_THREADS = 16;
+
+        // How long queued callbacks may wait without any callback finishing
+        // before a thread is added.
+        const std::chrono::milliseconds STALL_TIMEOUT(100);
+
+        // How long an added thread waits for work before it ends.
+        const std::chrono::seconds EXTRA_THREAD_IDLE_TIMEOUT(5);
+
+        // How long a task may hold up the later tasks of its key before the
+        // monitor reports it.
+        const std::chrono::seconds STRAND_STALL_TIMEOUT(2);
+
+        // The executor whose worker is the current thread, if any.
+        thread_local const CallbackExecutor* t_executor = nullptr;
+    }
+
+    CallbackExecutor::CallbackExecutor()
+        : m_execution(CallbackExecution::ThreadPool),
+          m_threadCount(DEFAULT_CALLBACK_THREADS),
+          m_idle(0),
+          m_stopping(false),
+          m_maxQueued(0),
+          m_strandQueued(0),
+          m_executed(0)
+    {
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        if (isWorkerThread())
+        {
+            // The process exits from a callback; a worker cannot join itself.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& thread : m_threads)
+            {
+                thread.second.detach();
+            }
+            if (m_monitor.joinable())
+            {
+                m_monitor.detach();
+            }
+            return;
+        }
+        stop();
+    }
+
+    CallbackExecutor& CallbackExecutor::instance()
+    {
+        static CallbackExecutor s_executor;
+        return s_executor;
+    }
+
+    void CallbackExecutor::configure(CallbackExecution execution, size_t threadCount)
+    {
+        if (0 == threadCount)
+        {
+            threadCount = std::max(DEFAULT_CALLBACK_THREADS,
+                                   static_cast<size_t>(std::thread::hardware_concurrency()));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (execution == m_execution && threadCount == m_threadCount)
+            {
+                return;
+            }
+            if (isWorkerThread())
+            {
+                oclog() << "CallbackExecutor cannot be configured from a callback" << std::flush;
+                return;
+            }
+            m_execution = execution;
+            m_threadCount = threadCount;
+        }
+
+        // Already queued callbacks still run on the old pool.
+        stop();
+    }
+
+    void CallbackExecutor::post(Task task)
+    {
+        if (isInline())
+        {
+            task();
+            ++m_executed;
+            return;
+        }
+        enqueue(std::move(task));
+    }
+
+    void CallbackExecutor::post(const void* key, Task task)
+    {
+        if (isInline())
+        {
+            task();
+            ++m_executed;
+            return;
+        }
+        serialize(key, std::move(task));
+    }
+
+    bool CallbackExecutor::postSerialized(const void* key, Task task)
+    {
+        if (isInline())
+        {
+            return false;
+        }
+        serialize(key, std::move(task));
+        return true;
+    }
+
+    CallbackExecutorStats CallbackExecutor::getStats() const
+    {
+        CallbackExecutorStats stats;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.queueDepth = m_tasks.size() + m_strandQueued;
+        stats.maxQueueDepth = m_maxQueued;
+        stats.executed = m_executed.load();
+        stats.threads = m_threads.size();
+        return stats;
+    }
+
+    bool CallbackExecutor::isInline() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return CallbackExecution::Inline == m_execution;
+    }
+
+    void CallbackExecutor::enqueue(Task task)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        push(std::move(task));
+    }
+
+    void CallbackExecutor::push(Task task)
+    {
+        m_tasks.push_back(std::move(task));
+        m_maxQueued = std::max(m_maxQueued, m_tasks.size() + m_strandQueued);
+
+        if (m_threads.empty())
+        {
+            for (size_t i = 0; i < m_threadCount; ++i)
+            {
+                startThread();
+            }
+            if (!m_monitor.joinable())
+            {
+                m_monitor = std::thread(&CallbackExecutor::monitor, this);
+            }
+        }
+        m_cond.notify_one();
+    }
+
+    void CallbackExecutor::serialize(const void* key, Task task)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto strand = m_strands.find(key);
+        if (strand != m_strands.end())
+        {
+            // The worker running this key picks it up when it is done.
+            strand->second.tasks.push_back(std::move(task));
+            ++m_strandQueued;
+            m_maxQueued = std::max(m_maxQueued, m_tasks.size() + m_strandQueued);
+            return;
+        }
+        m_strands[key];
+
+        push(std::bind(&CallbackExecutor::runSerialized, this, key, std::move(task)));
+    }
+
+    void CallbackExecutor::startThread()
+    {
+        // Called with m_mutex held, so the thread finds itself in m_threads.
+        std::thread thread(&CallbackExecutor::run, this);
+        std::thread::id id = thread.get_id();
+        m_threads[id] = std::move(thread);
+        ++m_idle;
+    }
+
+    void CallbackExecutor::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cond.notify_all();
+
+        // A draining callback may still post and start new workers, so join
+        // until none are left. m_mutex is not held meanwhile so it can. The
+        // monitor keeps watching until then, the callbacks may still get stuck.
+        for (;;)
+        {
+            std::map<std::thread::id, std::thread> threads;
+            std::thread monitor;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_threads.empty())
+                {
+                    m_stopping = false;
+                    monitor.swap(m_monitor);
+                }
+                else
+                {
+                    threads.swap(m_threads);
+                }
+            }
+
+            if (threads.empty())
+            {
+                m_monitorCond.notify_all();
+                if (monitor.joinable())
+                {
+                    monitor.join();
+                }
+                return;
+            }
+            for (auto& thread : threads)
+            {
+                thread.second.join();
+            }
+        }
+    }
+
+    bool CallbackExecutor::isWorkerThread() const
+    {
+        return this == t_executor;
+    }
+
+    void CallbackExecutor::runSerialized(const void* key, Task task)
+    {
+        // Drain the key on this worker rather than posting again, so the
+        // tasks of a key never wait for a worker behind other keys.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto strand = m_strands.find(key);
+        for (;;)
+        {
+            strand->second.started = std::chrono::steady_clock::now();
+            strand->second.reported = false;
+            lock.unlock();
+
+            task();
+
+            lock.lock();
+            if (strand->second.tasks.empty())
+            {
+                m_strands.erase(strand);
+                return;
+            }
+            task = std::move(strand->second.tasks.front());
+            strand->second.tasks.pop_front();
+            --m_strandQueued;
+            ++m_executed;
+        }
+    }
+
+    void CallbackExecutor::monitor()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t executed = m_executed.load();
+        // stop() takes the thread out of m_monitor when the monitor should end.
+        while (m_monitor.get_id() == std::this_thread::get_id())
+        {
+            m_monitorCond.wait_for(lock, STALL_TIMEOUT);
+
+            // Every worker is inside a callback and none finished, so they may
+            // be waiting for a callback that is still queued.
+            uint64_t now = m_executed.load();
+            if (!m_tasks.empty() && 0 == m_idle && now == executed)
+            {
+                if (m_threads.size() < m_threadCount + MAX_EXTRA_CALLBACK_THREADS)
+                {
+                    startThread();
+                    m_cond.notify_one();
+                }
+                else
+                {
+                    oclog() << "CallbackExecutor: all " << m_threads.size()
+                            << " threads are stuck, callbacks are delayed" << std::flush;
+                }
+            }
+            executed = now;
+
+            // More threads do not help tasks queued behind their key; only the
+            // task running for that key can release them.
+            auto time = std::chrono::steady_clock::now();
+            for (auto& strand : m_strands)
+            {
+                if (!strand.second.tasks.empty() && !strand.second.reported
+                    && std::chrono::steady_clock::time_point() != strand.second.started
+                    && time - strand.second.started > STRAND_STALL_TIMEOUT)
+                {
+                    oclog() << "CallbackExecutor: " << strand.second.tasks.size()
+                            << " callbacks wait behind one of the same key that has not"
+                            << " returned; it may be waiting for them" << std::flush;
+                    strand.second.reported = true;
+                }
+            }
+        }
+    }
+
+    void CallbackExecutor::run()
+    {
+        t_executor = this;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            if (!m_tasks.empty())
+            {
+                Task task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                --m_idle;
+                lock.unlock();
+
+                task();
+                ++m_executed;
+
+                lock.lock();
+                ++m_idle;
+                continue;
+            }
+
+            // Queued callbacks are drained before the pool stops.
+            if (m_stopping)
+            {
+                --m_idle;
+                return;
+            }
+
+            if (m_threads.size() <= m_threadCount)
+            {
+                m_cond.wait(lock);
+                continue;
+            }
+
+            // Threads added while the pool was busy end once it is quiet again.
+            if (std::cv_status::timeout == m_cond.wait_for(lock, EXTRA_THREAD_IDLE_TIMEOUT)
+                && m_tasks.empty() && !m_stopping && m_threads.size() > m_threadCount)
+            {
+                auto self = m_threads.find(std::this_thread::get_id());
+                self->second.detach();
+                m_threads.erase(self);
+                --m_idle;
+                return;
+            }
+        }
+    }
+}
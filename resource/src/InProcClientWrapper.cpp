@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "InProcClientWrapper.h"
+#include "CallbackExecutor.h"
 #include "ocstack.h"
 
 #include "OCPlatform.h"
@@ -34,7 +35,7 @@ using namespace std;
 namespace OC
 {
     InProcClientWrapper::InProcClientWrapper(
-        std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
+        std::weak_ptr<CsdkLock> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
               m_cfg { cfg }
     {
@@ -77,6 +78,7 @@ namespace OC
         if (m_threadRun && m_listeningThread.joinable())
         {
             m_threadRun = false;
+            OCWakeUpProcess();
             m_listeningThread.join();
         }
         return OC_STACK_OK;
@@ -87,11 +89,13 @@ namespace OC
         while(m_threadRun)
         {
             OCStackResult result;
+            uint32_t timeout = MAX_PROCESS_TIMEOUT_MS;
             auto cLock = m_csdkLock.lock();
             if (cLock)
             {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
+                std::lock_guard<CsdkLock> lock(*cLock);
                 result = OCProcess();
+                timeout = OCGetProcessTimeout(MAX_PROCESS_TIMEOUT_MS);
             }
             else
             {
@@ -103,13 +107,27 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until the stack has work or a timer is due.
+            if (OC_STACK_OK != OCWaitForProcess(timeout))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
     OCRepresentation parseGetSetCallback(OCClientResponse* clientResponse)
     {
+        MessageContainer oc;
+        if (clientResponse->payload == nullptr && clientResponse->rawPayload &&
+            oc.setLazyPayload(clientResponse->rawPayload, clientResponse->rawPayloadSize))
+        {
+            // Left undecoded by the stack, see OC_DO_REQUEST_LAZY_PAYLOAD.
+            OCRepresentation root = oc.back();
+            root.setDevAddr(clientResponse->devAddr);
+            root.setUri(clientResponse->resourceUri);
+            return root;
+        }
+
         if (clientResponse->payload == nullptr ||
                 (
                     clientResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION
@@ -119,7 +137,6 @@ namespace OC
             return OCRepresentation();
         }
 
-        MessageContainer oc;
         oc.setPayload(clientResponse->payload);
 
         std::vector<OCRepresentation>::const_iterator it = oc.representations().begin();
@@ -184,8 +201,7 @@ namespace OC
 
             for(auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                CallbackExecutor::instance().post(context, std::bind(context->callback, resource));
             }
         }
         catch (std::exception &e)
@@ -233,16 +249,15 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                CallbackExecutor::instance().post(context, std::bind(context->callback, resource));
             }
             return OC_STACK_KEEP_TRANSACTION;
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
         std::string resourceURI = clientResponse->resourceUri;
-        std::thread exec(context->errorCallback, resourceURI, result);
-        exec.detach();
+        CallbackExecutor::instance().post(context,
+            std::bind(context->errorCallback, resourceURI, result));
         return OC_STACK_KEEP_TRANSACTION;
     }
 
@@ -271,7 +286,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoResource(nullptr, OC_REST_DISCOVER,
                                   resourceUri.str().c_str(),
                                   nullptr, nullptr, connectivityType,
@@ -320,7 +335,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoResource(nullptr, OC_REST_DISCOVER,
                                   resourceUri.str().c_str(),
                                   nullptr, nullptr, connectivityType,
@@ -378,8 +393,8 @@ namespace OC
                                     reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            CallbackExecutor::instance().post(context,
+                std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -415,7 +430,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoResource(nullptr, OC_REST_DISCOVER,
                                   resourceUri.str().c_str(),
                                   nullptr, nullptr, connectivityType,
@@ -450,8 +465,8 @@ namespace OC
 
             //send the error callback
             std::string uri = clientResponse->resourceUri;
-            std::thread exec(context->errorCallback, uri, result);
-            exec.detach();
+            CallbackExecutor::instance().post(context,
+                std::bind(context->errorCallback, uri, result));
             return OC_STACK_KEEP_TRANSACTION;
         }
 
@@ -477,8 +492,8 @@ namespace OC
                             reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            CallbackExecutor::instance().post(context,
+                std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -521,7 +536,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoResource(nullptr, OC_REST_DISCOVER,
                                   resourceUri.str().c_str(),
                                   nullptr, nullptr, connectivityType,
@@ -556,9 +571,8 @@ namespace OC
                     << clientResponse->result
                     << std::flush;
 
-            std::thread exec(context->callback, clientResponse->result,
-                             resourceURI, nullptr);
-            exec.detach();
+            CallbackExecutor::instance().post(context,
+                std::bind(context->callback, clientResponse->result, resourceURI, nullptr));
 
             return OC_STACK_DELETE_TRANSACTION;
         }
@@ -579,9 +593,8 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, clientResponse->result,
-                                 resourceURI, resource);
-                exec.detach();
+                CallbackExecutor::instance().post(context,
+                    std::bind(context->callback, clientResponse->result, resourceURI, resource));
             }
         }
         catch (std::exception &e)
@@ -620,7 +633,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
             result = OCDoResource(
                                   nullptr, OC_REST_GET,
@@ -652,8 +665,7 @@ namespace OC
         {
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            CallbackExecutor::instance().post(context, std::bind(context->callback, rep));
         }
         catch(OC::OCException& e)
         {
@@ -690,7 +702,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoResource(nullptr, OC_REST_DISCOVER,
                                   deviceUri.str().c_str(),
                                   nullptr, nullptr, connectivityType,
@@ -790,19 +802,15 @@ namespace OC
                                             createdUri);
                 for (auto resource : container.Resources())
                 {
-                    std::thread exec(context->callback, result,
-                                     createdUri,
-                                     resource);
-                    exec.detach();
+                    CallbackExecutor::instance().post(context,
+                        std::bind(context->callback, result, createdUri, resource));
                 }
             }
             else
             {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-                std::thread exec(context->callback, result,
-                                 createdUri,
-                                 nullptr);
-                exec.detach();
+                CallbackExecutor::instance().post(context,
+                    std::bind(context->callback, result, createdUri, nullptr));
             }
         }
         catch (std::exception &e)
@@ -838,7 +846,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
             result = OCDoResource(nullptr, OC_REST_PUT,
@@ -880,8 +888,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        CallbackExecutor::instance().post(context,
+            std::bind(context->callback, serverHeaderOptions, rep, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -912,10 +920,10 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(
+            result = OCDoRequestWithFlags(
                                   nullptr, OC_REST_GET,
                                   uri.c_str(),
                                   &devAddr, nullptr,
@@ -923,7 +931,9 @@ namespace OC
                                   static_cast<OCQualityOfService>(QoS),
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
-                                  (uint8_t)headerOptions.size());
+                                  (uint8_t)headerOptions.size(),
+                                  m_cfg.lazyRepresentations ? OC_DO_REQUEST_LAZY_PAYLOAD
+                                                            : OC_DO_REQUEST_DEFAULT);
         }
         else
         {
@@ -956,8 +966,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        CallbackExecutor::instance().post(context,
+            std::bind(context->callback, serverHeaderOptions, attrs, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1079,7 +1089,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
             result = OCDoResource(nullptr, OC_REST_POST,
@@ -1126,7 +1136,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCDoHandle handle;
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
@@ -1159,8 +1169,8 @@ namespace OC
         parseServerHeaderOptions(clientResponse, serverHeaderOptions);
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        CallbackExecutor::instance().post(context,
+            std::bind(context->callback, serverHeaderOptions, clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1192,7 +1202,7 @@ namespace OC
         {
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             result = OCDoResource(nullptr, OC_REST_DELETE,
                                   uri.c_str(), &devAddr,
@@ -1234,9 +1244,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        CallbackExecutor::instance().post(context,
+            std::bind(context->callback, serverHeaderOptions, attrs, result, sequenceNumber));
         if (sequenceNumber == MAX_SEQUENCE_NUMBER + 1)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -1286,17 +1295,19 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(handle, method,
+            result = OCDoRequestWithFlags(handle, method,
                                   url.c_str(), &devAddr,
                                   nullptr,
                                   CT_DEFAULT,
                                   static_cast<OCQualityOfService>(QoS),
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
-                                  (uint8_t)headerOptions.size());
+                                  (uint8_t)headerOptions.size(),
+                                  m_cfg.lazyRepresentations ? OC_DO_REQUEST_LAZY_PAYLOAD
+                                                            : OC_DO_REQUEST_DEFAULT);
         }
         else
         {
@@ -1327,7 +1338,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
             result = OCCancel(handle,
@@ -1356,10 +1367,9 @@ namespace OC
         std::string url = clientResponse->devAddr.addr;
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        CallbackExecutor::instance().post(context,
+            std::bind(context->callback, clientResponse->result,
+                      clientResponse->sequenceNumber, url));
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -1410,7 +1420,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCCancel(handle, OC_LOW_QOS, NULL, 0);
         }
         else
@@ -1445,7 +1455,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             std::ostringstream os;
             os << host << OC_RSRVD_DEVICE_PRESENCE_URI;
@@ -1546,7 +1556,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             list = OCDiscoverDirectPairingDevices(waittime);
             if (NULL == list)
@@ -1558,8 +1568,7 @@ namespace OC
             else {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                CallbackExecutor::instance().post(std::bind(callback, dpDeviceList));
                 result = OC_STACK_OK;
             }
         }
@@ -1586,7 +1595,7 @@ namespace OC
 
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             list = OCGetDirectPairedDevices();
             if (NULL == list)
@@ -1597,8 +1606,7 @@ namespace OC
             else {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                CallbackExecutor::instance().post(std::bind(callback, dpDeviceList));
                 result = OC_STACK_OK;
             }
         }
@@ -1618,8 +1626,8 @@ namespace OC
             static_cast<ClientCallbackContext::DirectPairingContext*>(ctx);
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, cloneDevice(peer), result);
-        exec.detach();
+        CallbackExecutor::instance().post(context,
+            std::bind(context->callback, cloneDevice(peer), result));
     }
 
     OCStackResult InProcClientWrapper::DoDirectPairing(std::shared_ptr<OCDirectPairing> peer,
@@ -1638,7 +1646,7 @@ namespace OC
         auto cLock = m_csdkLock.lock();
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDoDirectPairing(static_cast<void*>(context), peer->getDev(),
                     pmSel, const_cast<char*>(pinNumber.c_str()), directPairingCallback);
             delete context;
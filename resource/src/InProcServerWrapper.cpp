@@ -39,6 +39,7 @@
 #include <oic_string.h>
 #include <OCPlatform.h>
 #include <OCUtilities.h>
+#include "CallbackExecutor.h"
 #include "logger.h"
 
 #define TAG "OIC_SERVER_WRAPPER"
@@ -54,6 +55,7 @@ namespace OC
         std::map <OCResourceHandle, OC::EntityHandler>  entityHandlerMap;
         std::map <OCResourceHandle, std::string> resourceUriMap;
         EntityHandler defaultDeviceEntityHandler;
+        CallbackExecutor requestExecutor;
     }
 }
 
@@ -187,6 +189,35 @@ OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
 }
 
 
+// Runs a dispatched entity handler. The stack only answers an error result itself
+// when the handler runs inline, so the error response is sent from here.
+void DispatchedEntityHandler(const EntityHandler& entityHandler,
+                             const std::shared_ptr<OCResourceRequest>& pRequest)
+{
+    OCEntityHandlerResult result = entityHandler(pRequest);
+
+    switch (result)
+    {
+        case OC_EH_ERROR:
+        case OC_EH_FORBIDDEN:
+        case OC_EH_INTERNAL_SERVER_ERROR:
+        case OC_EH_RESOURCE_NOT_FOUND:
+        {
+            auto pResponse = std::make_shared<OC::OCResourceResponse>();
+            pResponse->setRequestHandle(pRequest->getRequestHandle());
+            pResponse->setResourceHandle(pRequest->getResourceHandle());
+            pResponse->setResponseResult(result);
+            if (OC_STACK_OK != OCPlatform::sendResponse(pResponse))
+            {
+                oclog() << "Error sending error response of dispatched request" << std::flush;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
 OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
                                            OCEntityHandlerRequest * entityHandlerRequest,
                                            void* /*callbackParam*/)
@@ -237,7 +268,22 @@ OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
         // Call CPP Application Entity Handler
         if(entityHandlerEntry->second)
         {
-            result = entityHandlerEntry->second(pRequest);
+            // Requests for one resource stay in order. Observe registrations and
+            // notifications are answered before the stack moves on, so they run
+            // here. A dispatched request is marked slow before it is posted, as
+            // the handler may answer it before this returns.
+            if (!OC::details::requestExecutor.isInline()
+                && !(flag & OC_OBSERVE_FLAG)
+                && OC_STACK_OK == OCDeferResponse(entityHandlerRequest->requestHandle))
+            {
+                OC::details::requestExecutor.postSerialized(entityHandlerRequest->resource,
+                    std::bind(DispatchedEntityHandler, entityHandlerEntry->second, pRequest));
+                result = OC_EH_SLOW;
+            }
+            else
+            {
+                result = entityHandlerEntry->second(pRequest);
+            }
         }
         else
         {
@@ -257,10 +303,11 @@ OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
 namespace OC
 {
     InProcServerWrapper::InProcServerWrapper(
-        std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
+        std::weak_ptr<CsdkLock> csdkLock, PlatformConfig cfg)
      : m_threadRun(false), m_csdkLock(csdkLock),
        m_cfg { cfg }
     {
+        details::requestExecutor.configure(m_cfg.requestExecution, m_cfg.requestThreads);
     }
 
     OCStackResult InProcServerWrapper::start()
@@ -282,6 +329,7 @@ namespace OC
         if(m_processThread.joinable())
         {
             m_threadRun = false;
+            OCWakeUpProcess();
             m_processThread.join();
         }
 
@@ -294,10 +342,12 @@ namespace OC
         while(cLock && m_threadRun)
         {
             OCStackResult result;
+            uint32_t timeout;
 
             {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
+                std::lock_guard<CsdkLock> lock(*cLock);
                 result = OCProcess();
+                timeout = OCGetProcessTimeout(MAX_PROCESS_TIMEOUT_MS);
             }
 
             if(OC_STACK_ERROR == result)
@@ -306,7 +356,11 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until the stack has work or a timer is due.
+            if (OC_STACK_OK != OCWaitForProcess(timeout))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -316,7 +370,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCSetDeviceInfo(deviceInfo);
         }
         return result;
@@ -328,7 +382,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCSetPlatformInfo(platformInfo);
         }
         return result;
@@ -341,7 +395,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCSetPropertyValue(type, propName.c_str(), (void *)propValue.c_str());
         }
         return result;
@@ -354,7 +408,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             void *value = NULL;
             result = OCGetPropertyValue(type, propName.c_str(), &value);
             if (value && OC_STACK_OK == result)
@@ -374,7 +428,7 @@ namespace OC
         void *value = NULL;
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCGetPropertyValue(type, propName.c_str(), &value);
         }
 
@@ -416,7 +470,7 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
 
             if(NULL != eHandler)
             {
@@ -494,7 +548,7 @@ namespace OC
 
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCDeleteResource(resourceHandle);
 
             if(result == OC_STACK_OK)
@@ -522,7 +576,7 @@ namespace OC
         OCStackResult result;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCBindResourceTypeToResource(resourceHandle, resourceTypeName.c_str());
         }
         else
@@ -545,7 +599,7 @@ namespace OC
         OCStackResult result;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCBindResourceInterfaceToResource(resourceHandle,
                         resourceInterfaceName.c_str());
         }
@@ -567,7 +621,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCStartPresence(seconds);
         }
 
@@ -584,7 +638,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if(cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             result = OCStopPresence();
         }
 
@@ -667,7 +721,7 @@ namespace OC
 
             if(cLock)
             {
-                std::lock_guard<std::recursive_mutex> lock(*cLock);
+                std::lock_guard<CsdkLock> lock(*cLock);
                 result = OCDoResponse(&response);
             }
             else
@@ -690,7 +744,7 @@ namespace OC
         OCStackResult result = OC_STACK_ERROR;
         if (cLock)
         {
-            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            std::lock_guard<CsdkLock> lock(*cLock);
             supportedTps = OCGetSupportedEndpointTpsFlags();
 
             if (OC_NO_TPS != supportedTps)
@@ -28,6 +28,7 @@
 //
 //*********************************************************************
 #include <OCPlatform.h>
+#include <CallbackExecutor.h>
 namespace OC
 {
     namespace OCPlatform
@@ -393,5 +394,10 @@ namespace OC
         {
             return OCPlatform_impl::Instance().setDeviceId(deviceId);
         }
+
+        CallbackExecutorStats getCallbackExecutorStats()
+        {
+            return CallbackExecutor::instance().getStats();
+        }
     } // namespace OCPlatform
 } //namespace OC
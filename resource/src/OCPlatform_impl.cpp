@@ -42,6 +42,7 @@
 #include "OCApi.h"
 #include "OCException.h"
 #include "OCUtilities.h"
+#include "CallbackExecutor.h"
 #include "ocpayload.h"
 #include "iotivity_debug.h"
 
@@ -86,6 +87,7 @@ namespace OC
 
         // Reload from the global configuration.
         m_cfg = globalConfig();
+        CallbackExecutor::instance().configure(m_cfg.callbackExecution, m_cfg.callbackThreads);
 
         // First caller gets to initialize the underlying objects and start the stack.
         OCStackResult res = init(m_cfg);
@@ -244,7 +246,7 @@ namespace OC
     OCPlatform_impl::OCPlatform_impl(const PlatformConfig& config)
      : m_cfg             { config },
        m_WrapperInstance { make_unique<WrapperFactory>() },
-       m_csdkLock        { std::make_shared<std::recursive_mutex>() },
+       m_csdkLock        { std::make_shared<CsdkLock>() },
        m_startCount(0)
     {
         if (m_cfg.useLegacyCleanup)
@@ -270,6 +272,8 @@ namespace OC
     OCStackResult OCPlatform_impl::notifyAllObservers(OCResourceHandle resourceHandle,
                                                 QualityOfService QoS)
     {
+        // The entity handler runs for each observer before this returns.
+        std::lock_guard<CsdkLock> lock(*m_csdkLock);
         return result_guard(OCNotifyAllObservers(resourceHandle,
                     static_cast<OCQualityOfService>(QoS)));
     }
@@ -297,6 +301,7 @@ namespace OC
         }
 
         OCRepPayload* pl = pResponse->getResourceRepresentation().getPayload();
+        std::lock_guard<CsdkLock> lock(*m_csdkLock);
         OCStackResult result =
                    OCNotifyListOfObservers(resourceHandle,
                             &observationIds[0], (uint8_t)observationIds.size(),
@@ -639,7 +644,7 @@ namespace OC
         return checked_guard(m_server, &IServerWrapper::sendResponse,
                              pResponse);
     }
-    std::weak_ptr<std::recursive_mutex> OCPlatform_impl::csdkLock()
+    std::weak_ptr<CsdkLock> OCPlatform_impl::csdkLock()
     {
         return m_csdkLock;
     }
@@ -685,11 +690,13 @@ namespace OC
 
     OCStackResult OCPlatform_impl::getDeviceId(OCUUIdentity *myUuid)
     {
+        std::lock_guard<CsdkLock> lock(*m_csdkLock);
         return OCGetDeviceId(myUuid);
     }
 
     OCStackResult OCPlatform_impl::setDeviceId(const OCUUIdentity *myUuid)
     {
+        std::lock_guard<CsdkLock> lock(*m_csdkLock);
         return OCSetDeviceId(myUuid);
     }
 } //namespace OC
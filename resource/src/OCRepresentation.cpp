@@ -75,19 +75,68 @@ namespace OC
         }
     }
 
+    bool MessageContainer::setLazyPayload(const uint8_t* cbor, size_t size)
+    {
+        OCRepPayloadView view;
+        if (!cbor || OC_STACK_OK != OCRepPayloadViewInit(&view, cbor, size))
+        {
+            return false;
+        }
+
+        // The view points into the copy, which the representation shares with
+        // the nested representations it hands out.
+        auto data = std::make_shared<const std::vector<uint8_t>>(cbor, cbor + size);
+        view.data = data->data();
+
+        OCRepresentation cur;
+        char* uri = nullptr;
+        if (OCRepPayloadViewGetUri(&view, &uri))
+        {
+            cur.setUri(uri);
+            OICFree(uri);
+        }
+
+        OCStringLL* ll = nullptr;
+        if (OCRepPayloadViewGetResourceTypes(&view, &ll))
+        {
+            for (OCStringLL* type = ll; type; type = type->next)
+            {
+                cur.addResourceType(type->value);
+            }
+            OCFreeOCStringLL(ll);
+        }
+
+        ll = nullptr;
+        if (OCRepPayloadViewGetInterfaces(&view, &ll))
+        {
+            for (OCStringLL* iface = ll; iface; iface = iface->next)
+            {
+                cur.addResourceInterface(iface->value);
+            }
+            OCFreeOCStringLL(ll);
+        }
+
+        cur.setLazyPayload(data, view);
+        this->addRepresentation(cur);
+        return true;
+    }
+
     OCRepPayload* MessageContainer::getPayload() const
     {
         OCRepPayload* root = nullptr;
+        OCRepPayload* last = nullptr;
         for(const auto& r : representations())
         {
+            OCRepPayload* payload = r.getPayload();
             if (!root)
             {
-                root = r.getPayload();
+                root = payload;
             }
             else
             {
-                OCRepPayloadAppend(root, r.getPayload());
+                OCRepPayloadAppend(last, payload);
             }
+            last = payload;
         }
 
         return root;
@@ -614,6 +663,130 @@ namespace OC
         }
     }
 
+    void OCRepresentation::setLazyPayload(
+            const std::shared_ptr<const std::vector<uint8_t>>& data,
+            const OCRepPayloadView& view)
+    {
+        m_lazyData = data;
+        m_lazyView = view;
+    }
+
+    void OCRepresentation::loadLazyAttribute(const std::string& str) const
+    {
+        OCRepPayloadPropType type;
+        if (m_values.find(str) != m_values.end() ||
+            !OCRepPayloadViewGetPropType(&m_lazyView, str.c_str(), &type))
+        {
+            return;
+        }
+
+        const char* name = str.c_str();
+        switch (type)
+        {
+            case OCREP_PROP_NULL:
+                m_values[str] = OC::NullType();
+                break;
+            case OCREP_PROP_INT:
+                {
+                    int64_t val = 0;
+                    if (OCRepPayloadViewGetPropInt(&m_lazyView, name, &val))
+                    {
+                        m_values[str] = val;
+                    }
+                }
+                break;
+            case OCREP_PROP_DOUBLE:
+                {
+                    double val = 0;
+                    if (OCRepPayloadViewGetPropDouble(&m_lazyView, name, &val))
+                    {
+                        m_values[str] = val;
+                    }
+                }
+                break;
+            case OCREP_PROP_BOOL:
+                {
+                    bool val = false;
+                    if (OCRepPayloadViewGetPropBool(&m_lazyView, name, &val))
+                    {
+                        m_values[str] = val;
+                    }
+                }
+                break;
+            case OCREP_PROP_STRING:
+                {
+                    const char* ref = nullptr;
+                    size_t len = 0;
+                    char* val = nullptr;
+                    if (OCRepPayloadViewGetPropStringRef(&m_lazyView, name, &ref, &len))
+                    {
+                        m_values[str] = std::string(ref, len);
+                    }
+                    else if (OCRepPayloadViewGetPropString(&m_lazyView, name, &val))
+                    {
+                        m_values[str] = std::string(val);
+                        OICFree(val);
+                    }
+                }
+                break;
+            case OCREP_PROP_BYTE_STRING:
+                {
+                    OCByteString val = {nullptr, 0};
+                    if (OCRepPayloadViewGetPropByteString(&m_lazyView, name, &val))
+                    {
+                        m_values[str] = std::vector<uint8_t>(val.bytes, val.bytes + val.len);
+                        OICFree(val.bytes);
+                    }
+                }
+                break;
+            case OCREP_PROP_OBJECT:
+                {
+                    OCRepPayloadView view;
+                    if (OCRepPayloadViewGetPropObject(&m_lazyView, name, &view))
+                    {
+                        OCRepresentation cur;
+                        cur.setLazyPayload(m_lazyData, view);
+                        m_values[str] = cur;
+                    }
+                }
+                break;
+            default:
+                // Arrays take the whole decoder, so decode everything.
+                loadLazyValues();
+                break;
+        }
+    }
+
+    void OCRepresentation::loadLazyValues() const
+    {
+        std::shared_ptr<const std::vector<uint8_t>> data;
+        data.swap(m_lazyData);
+
+        OCRepPayload* pl = OCRepPayloadViewToPayload(&m_lazyView);
+        if (!pl)
+        {
+            throw OCException(OC::Exception::INVALID_REPRESENTATION, OC_STACK_MALFORMED_RESPONSE);
+        }
+
+        OCRepresentation cur;
+        try
+        {
+            cur.setPayload(pl);
+        }
+        catch (...)
+        {
+            OCRepPayloadDestroy(pl);
+            throw;
+        }
+        OCRepPayloadDestroy(pl);
+
+        // Attributes already decoded or set stay as they are.
+        for (auto& val : cur.m_values)
+        {
+            m_values.insert(std::move(val));
+        }
+    }
+
     void OCRepresentation::addChild(const OCRepresentation& rep)
     {
         m_children.push_back(rep);
@@ -735,11 +908,14 @@ namespace OC
 
     bool OCRepresentation::hasAttribute(const std::string& str) const
     {
+        loadAttribute(str);
         return m_values.find(str) != m_values.end();
     }
 
     bool OCRepresentation::emptyData() const
     {
+        loadValues();
+
         // This logic is meant to determine whether based on the JSON serialization rules
         // if this object will result in empty JSON.  URI is only serialized if there is valid
         // data, ResourceType and Interfaces are only serialized if we are a nothing, a
@@ -776,11 +952,13 @@ namespace OC
 
     size_t OCRepresentation::numberOfAttributes() const
     {
+        loadValues();
         return m_values.size();
     }
 
     bool OCRepresentation::erase(const std::string& str)
     {
+        loadValues();
         return (m_values.erase(str) != 0);
     }
 
@@ -791,6 +969,7 @@ namespace OC
 
     bool OCRepresentation::isNULL(const std::string& str) const
     {
+        loadAttribute(str);
         auto x = m_values.find(str);
 
         if (m_values.end() != x)
@@ -850,12 +1029,14 @@ namespace OC
 
     OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key)
     {
+        loadAttribute(key);
         OCRepresentation::AttributeItem attr{key, m_values};
         return std::move(attr);
     }
 
     const OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key) const
     {
+        loadAttribute(key);
         OCRepresentation::AttributeItem attr{key, m_values};
         return std::move(attr);
     }
@@ -953,41 +1134,49 @@ namespace OC
 
     OCRepresentation::iterator OCRepresentation::begin()
     {
+        loadValues();
         return OCRepresentation::iterator(m_values.begin(), m_values);
     }
 
     OCRepresentation::const_iterator OCRepresentation::begin() const
     {
+        loadValues();
          return OCRepresentation::const_iterator(m_values.begin(), m_values);
     }
 
     OCRepresentation::const_iterator OCRepresentation::cbegin() const
     {
+        loadValues();
         return OCRepresentation::const_iterator(m_values.cbegin(), m_values);
     }
 
     OCRepresentation::iterator OCRepresentation::end()
     {
+        loadValues();
         return OCRepresentation::iterator(m_values.end(), m_values);
     }
 
     OCRepresentation::const_iterator OCRepresentation::end() const
     {
+        loadValues();
         return OCRepresentation::const_iterator(m_values.end(), m_values);
     }
 
     OCRepresentation::const_iterator OCRepresentation::cend() const
     {
+        loadValues();
         return OCRepresentation::const_iterator(m_values.cend(), m_values);
     }
 
     size_t OCRepresentation::size() const
     {
+        loadValues();
         return m_values.size();
     }
 
     bool OCRepresentation::empty() const
     {
+        loadValues();
         return m_values.empty();
     }
 
@@ -1203,6 +1392,7 @@ namespace OC
 
     std::string OCRepresentation::getValueToString(const std::string& key) const
     {
+        loadAttribute(key);
         auto x = m_values.find(key);
         if (x != m_values.end())
         {
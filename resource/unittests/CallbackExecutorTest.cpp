@@ -0,0 +1,300 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <CallbackExecutor.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace CallbackExecutorTests
+        {
+            using namespace OC;
+
+            TEST(CallbackExecutorTest, InlineRunsOnCallingThread)
+            {
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::Inline, 1);
+
+                std::thread::id caller;
+                executor.post([&caller]{ caller = std::this_thread::get_id(); });
+
+                EXPECT_EQ(std::this_thread::get_id(), caller);
+                CallbackExecutorStats stats = executor.getStats();
+                EXPECT_EQ(1u, stats.executed);
+                EXPECT_EQ(0u, stats.threads);
+            }
+
+            TEST(CallbackExecutorTest, ThreadPoolRunsAllTasks)
+            {
+                const size_t taskCount = 1000;
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::ThreadPool, 3);
+
+                std::mutex mutex;
+                std::condition_variable cond;
+                size_t done = 0;
+                for (size_t i = 0; i < taskCount; ++i)
+                {
+                    executor.post([&]
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        ++done;
+                        cond.notify_one();
+                    });
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+                EXPECT_TRUE(cond.wait_for(lock, std::chrono::seconds(10),
+                                          [&]{ return taskCount == done; }));
+                lock.unlock();
+
+                CallbackExecutorStats stats = executor.getStats();
+                EXPECT_LE(3u, stats.threads);
+                EXPECT_LE(1u, stats.maxQueueDepth);
+            }
+
+            TEST(CallbackExecutorTest, ReconfigureDrainsQueuedTasks)
+            {
+                const size_t taskCount = 100;
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::ThreadPool, 2);
+
+                std::atomic<size_t> done(0);
+                for (size_t i = 0; i < taskCount; ++i)
+                {
+                    executor.post([&done]{ ++done; });
+                }
+                executor.configure(CallbackExecution::Inline, 2);
+
+                EXPECT_EQ(taskCount, done.load());
+                CallbackExecutorStats stats = executor.getStats();
+                EXPECT_EQ(taskCount, stats.executed);
+                EXPECT_EQ(0u, stats.queueDepth);
+                EXPECT_EQ(0u, stats.threads);
+            }
+
+            TEST(CallbackExecutorTest, TaskCanPostFromWorker)
+            {
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::ThreadPool, 2);
+
+                std::mutex mutex;
+                std::condition_variable cond;
+                bool nestedRan = false;
+                executor.post([&]
+                {
+                    executor.post([&]
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        nestedRan = true;
+                        cond.notify_one();
+                    });
+                });
+
+                std::unique_lock<std::mutex> lock(mutex);
+                EXPECT_TRUE(cond.wait_for(lock, std::chrono::seconds(10),
+                                          [&]{ return nestedRan; }));
+            }
+
+            TEST(CallbackExecutorTest, PoolGrowsWhenWorkersAreBlocked)
+            {
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::ThreadPool, 1);
+
+                // The only worker waits for a callback queued behind it.
+                std::mutex mutex;
+                std::condition_variable cond;
+                bool secondRan = false;
+                bool firstSawSecond = false;
+                executor.post([&]
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    firstSawSecond = cond.wait_for(lock, std::chrono::seconds(10),
+                                                   [&]{ return secondRan; });
+                });
+                executor.post([&]
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    secondRan = true;
+                    cond.notify_all();
+                });
+
+                executor.configure(CallbackExecution::Inline, 1);
+                EXPECT_TRUE(firstSawSecond);
+            }
+
+            TEST(CallbackExecutorTest, ReconfigureWhileCallbackPosts)
+            {
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::ThreadPool, 1);
+
+                // The callback posts while configure() waits for the pool.
+                std::atomic<bool> started(false);
+                std::atomic<size_t> done(0);
+                executor.post([&]
+                {
+                    started = true;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    executor.post([&done]{ ++done; });
+                    ++done;
+                });
+                while (!started)
+                {
+                    std::this_thread::yield();
+                }
+                executor.configure(CallbackExecution::ThreadPool, 2);
+
+                EXPECT_EQ(2u, done.load());
+                EXPECT_EQ(0u, executor.getStats().queueDepth);
+            }
+
+            TEST(CallbackExecutorTest, PostWithKeyRunsInline)
+            {
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::Inline, 1);
+
+                std::thread::id caller;
+                executor.post(&executor, [&caller]{ caller = std::this_thread::get_id(); });
+                EXPECT_EQ(std::this_thread::get_id(), caller);
+            }
+
+            TEST(CallbackExecutorTest, PostSerializedIsRefusedInline)
+            {
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::Inline, 1);
+
+                bool ran = false;
+                EXPECT_TRUE(executor.isInline());
+                EXPECT_FALSE(executor.postSerialized(&executor, [&ran]{ ran = true; }));
+                EXPECT_FALSE(ran);
+
+                executor.configure(CallbackExecution::ThreadPool, 1);
+                EXPECT_FALSE(executor.isInline());
+                executor.configure(CallbackExecution::Inline, 1);
+            }
+
+            TEST(CallbackExecutorTest, PostSerializedKeepsOrderPerKey)
+            {
+                const size_t keyCount = 4;
+                const size_t tasksPerKey = 200;
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::ThreadPool, 4);
+
+                int keys[keyCount];
+                std::vector<std::vector<size_t>> seen(keyCount);
+                std::vector<std::atomic<int>> running(keyCount);
+                std::atomic<bool> overlapped(false);
+                std::atomic<size_t> done(0);
+
+                for (size_t i = 0; i < tasksPerKey; ++i)
+                {
+                    for (size_t k = 0; k < keyCount; ++k)
+                    {
+                        auto task = [&, i, k]
+                        {
+                            if (0 != running[k]++)
+                            {
+                                overlapped = true;
+                            }
+                            seen[k].push_back(i);
+                            --running[k];
+                            ++done;
+                        };
+                        // Client callbacks use post(), entity handlers postSerialized().
+                        if (k % 2)
+                        {
+                            executor.post(&keys[k], task);
+                        }
+                        else
+                        {
+                            ASSERT_TRUE(executor.postSerialized(&keys[k], task));
+                        }
+                    }
+                }
+
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (keyCount * tasksPerKey != done.load()
+                       && std::chrono::steady_clock::now() < deadline)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                ASSERT_EQ(keyCount * tasksPerKey, done.load());
+                EXPECT_FALSE(overlapped.load());
+                for (size_t k = 0; k < keyCount; ++k)
+                {
+                    ASSERT_EQ(tasksPerKey, seen[k].size());
+                    for (size_t i = 0; i < tasksPerKey; ++i)
+                    {
+                        EXPECT_EQ(i, seen[k][i]);
+                    }
+                }
+            }
+
+            TEST(CallbackExecutorTest, TasksBehindTheirKeyCountAsQueued)
+            {
+                CallbackExecutor executor;
+                executor.configure(CallbackExecution::ThreadPool, 2);
+
+                int key;
+                std::mutex mutex;
+                std::condition_variable cond;
+                bool started = false;
+                bool release = false;
+                std::atomic<size_t> done(0);
+                executor.post(&key, [&]
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    started = true;
+                    cond.notify_all();
+                    cond.wait_for(lock, std::chrono::seconds(10), [&]{ return release; });
+                    ++done;
+                });
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ASSERT_TRUE(cond.wait_for(lock, std::chrono::seconds(10),
+                                              [&]{ return started; }));
+                }
+                for (int i = 0; i < 3; ++i)
+                {
+                    executor.post(&key, [&]{ ++done; });
+                }
+
+                CallbackExecutorStats stats = executor.getStats();
+                EXPECT_EQ(3u, stats.queueDepth);
+                EXPECT_LE(3u, stats.maxQueueDepth);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    release = true;
+                    cond.notify_all();
+                }
+                executor.configure(CallbackExecution::Inline, 1);
+                EXPECT_EQ(4u, done.load());
+                EXPECT_EQ(0u, executor.getStats().queueDepth);
+            }
+        }
+    }
+}
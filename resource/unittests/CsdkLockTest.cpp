@@ -0,0 +1,65 @@
+//******************************************************************
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <gtest/gtest.h>
+#include <CsdkLock.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace CsdkLockTests
+        {
+            using namespace OC;
+
+            TEST(CsdkLockTest, IsRecursive)
+            {
+                CsdkLock csdkLock;
+                std::lock_guard<CsdkLock> outer(csdkLock);
+                std::lock_guard<CsdkLock> inner(csdkLock);
+            }
+
+            TEST(CsdkLockTest, ExcludesOtherThreads)
+            {
+                CsdkLock csdkLock;
+                int value = 0;
+                std::atomic<bool> otherDone(false);
+
+                std::thread other;
+                {
+                    std::lock_guard<CsdkLock> lock(csdkLock);
+                    other = std::thread([&]
+                    {
+                        std::lock_guard<CsdkLock> otherLock(csdkLock);
+                        EXPECT_EQ(1, value);
+                        otherDone = true;
+                    });
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    EXPECT_FALSE(otherDone.load());
+                    value = 1;
+                }
+                other.join();
+                EXPECT_TRUE(otherDone.load());
+            }
+        }
+    }
+}
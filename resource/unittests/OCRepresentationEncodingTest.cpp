@@ -363,6 +363,86 @@ namespace OCRepresentationEncodingTest
         OCPayloadDestroy(cparsed);
     }
 
+    TEST(RepresentationEncoding, LazyPayload)
+    {
+        OC::OCRepresentation startRep;
+        startRep.addResourceType("core.light");
+        startRep.addResourceInterface("oic.if.baseline");
+        startRep.setNULL("NullAttr");
+        startRep.setValue("IntAttr", 77);
+        startRep.setValue("DoubleAttr", 3.333);
+        startRep.setValue("BoolAttr", true);
+        startRep.setValue("StringAttr", std::string("String attr"));
+        uint8_t binval[] = {0x1, 0x2, 0x3, 0x4};
+        OCByteString byteString = {binval, sizeof(binval)};
+        startRep.setValue("ByteStringAttr", byteString);
+        startRep.setValue("IntArrAttr", std::vector<int>{1, 2, 3});
+        OC::OCRepresentation subRep;
+        subRep.setValue("SubIntAttr", 5);
+        subRep.setValue("SubStringAttr", std::string("Sub attr"));
+        startRep.setValue("ObjAttr", subRep);
+
+        OC::MessageContainer mc1;
+        mc1.addRepresentation(startRep);
+        OCRepPayload* cstart = mc1.getPayload();
+
+        uint8_t* cborData;
+        size_t cborSize;
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)cstart, OC_FORMAT_CBOR, &cborData, &cborSize));
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+        OCPayloadDestroy((OCPayload*)cstart);
+
+        OC::MessageContainer mc2;
+        mc2.setPayload(cparsed);
+        OCPayloadDestroy(cparsed);
+        OC::MessageContainer mc3;
+        EXPECT_TRUE(mc3.setLazyPayload(cborData, cborSize));
+        OICFree(cborData);
+        ASSERT_EQ(1u, mc3.representations().size());
+        const OC::OCRepresentation& eager = mc2.representations()[0];
+
+        // Single attributes are decoded as they are asked for.
+        OC::OCRepresentation r = mc3.representations()[0];
+        EXPECT_EQ(eager.getResourceTypes(), r.getResourceTypes());
+        EXPECT_EQ(eager.getResourceInterfaces(), r.getResourceInterfaces());
+        EXPECT_TRUE(r.hasAttribute("IntAttr"));
+        EXPECT_FALSE(r.hasAttribute("MissingAttr"));
+        EXPECT_TRUE(r.isNULL("NullAttr"));
+        EXPECT_EQ(77, r.getValue<int>("IntAttr"));
+        EXPECT_EQ(3.333, r.getValue<double>("DoubleAttr"));
+        EXPECT_EQ(true, r.getValue<bool>("BoolAttr"));
+        EXPECT_EQ("String attr", r.getValue<std::string>("StringAttr"));
+        std::string str = r["StringAttr"];
+        EXPECT_EQ("String attr", str);
+        EXPECT_EQ(eager.getValueToString("ByteStringAttr"), r.getValueToString("ByteStringAttr"));
+        OC::OCRepresentation sub = r.getValue<OC::OCRepresentation>("ObjAttr");
+        EXPECT_EQ(5, sub.getValue<int>("SubIntAttr"));
+        EXPECT_EQ("Sub attr", sub.getValue<std::string>("SubStringAttr"));
+
+        // Values set before the rest is decoded are kept.
+        r.setValue("IntAttr", 78);
+        EXPECT_EQ((std::vector<int>{1, 2, 3}), r.getValue<std::vector<int>>("IntArrAttr"));
+        EXPECT_EQ(78, r.getValue<int>("IntAttr"));
+        EXPECT_EQ(eager.numberOfAttributes(), r.numberOfAttributes());
+        EXPECT_TRUE(r.erase("BoolAttr"));
+        EXPECT_FALSE(r.hasAttribute("BoolAttr"));
+
+        // Decoding everything gives what the eager conversion gives.
+        OC::OCRepresentation all = mc3.representations()[0];
+        all.getValues();
+        EXPECT_EQ(eager, all);
+    }
+
+    TEST(RepresentationEncoding, LazyPayloadNeedsSingleMap)
+    {
+        const uint8_t array[] = {0x82, 0xa0, 0xa0};
+        OC::MessageContainer mc;
+        EXPECT_FALSE(mc.setLazyPayload(array, sizeof(array)));
+        EXPECT_EQ(0u, mc.representations().size());
+    }
+
     TEST(RepresentationEncoding, RepAttributeEmpty)
     {
         OC::OCRepresentation startRep;